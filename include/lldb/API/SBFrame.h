@@ -158,6 +158,24 @@ public:
 
     lldb::SBValueList
     GetVariables (const lldb::SBVariablesOptions& options);
+
+    //------------------------------------------------------------------
+    /// Snapshot the variables selected by \a options in one call.
+    ///
+    /// Writes a JSON array with one dictionary per variable holding its
+    /// "name", "type", "value", "summary", "error" and "num_children",
+    /// plus a "children" array of the same dictionaries for the first
+    /// \a max_children children, down to \a max_depth levels.  The
+    /// frame's stack memory is read in one go up front.
+    ///
+    /// @return
+    ///     False if the frame is invalid or the process is running.
+    //------------------------------------------------------------------
+    bool
+    GetVariablesAsJSON (const lldb::SBVariablesOptions& options,
+                        uint32_t max_depth,
+                        uint32_t max_children,
+                        lldb::SBStream &stream);
     
     lldb::SBValueList
     GetRegisters ();
@@ -323,6 +323,25 @@ public:
     bool
     IsInstrumentationRuntimePresent(InstrumentationRuntimeType type);
 
+    //------------------------------------------------------------------
+    /// Get statistics about the packets exchanged with the remote debug
+    /// server as JSON: for each packet type the number of packets, the
+    /// bytes sent and received and a histogram of the round trip times.
+    ///
+    /// @return
+    ///   \b true if the process keeps packet statistics, \b false
+    ///   otherwise.
+    //------------------------------------------------------------------
+    bool
+    GetPacketStatisticsAsJSON (lldb::SBStream &stream);
+
+    //------------------------------------------------------------------
+    /// Clear the packet statistics, e.g. before an operation that is to
+    /// be measured.
+    //------------------------------------------------------------------
+    void
+    ResetPacketStatistics ();
+
 protected:
     friend class SBAddress;
     friend class SBBreakpoint;
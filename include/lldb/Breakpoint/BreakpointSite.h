@@ -262,6 +262,8 @@ private:
     // The StopInfoBreakpoint knows when it is processing a hit for a thread for a site, so let it be the
     // one to manage setting the location hit count once and only once.
     friend class StopInfoBreakpoint;
+    // The unit tests make sites without a process or an owner.
+    friend class BreakpointSiteListTest;
 
     void
     BumpHitCounts();
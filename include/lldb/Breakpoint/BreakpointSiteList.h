@@ -12,8 +12,9 @@
 
 // C Includes
 // C++ Includes
-#include <map>
 #include <functional>
+#include <memory>
+#include <vector>
 // Other libraries and framework includes
 // Project includes
 #include "lldb/Breakpoint/BreakpointSite.h"
@@ -24,6 +25,12 @@ namespace lldb_private {
 //----------------------------------------------------------------------
 /// @class BreakpointSiteList BreakpointSiteList.h "lldb/Breakpoint/BreakpointSiteList.h"
 /// @brief Class that manages lists of BreakpointSite shared pointers.
+///
+/// Sites are kept in an array sorted by load address so that lookups by
+/// address are a binary search and lookups by ID scan contiguous memory.
+/// Readers take a reference to the current array under the mutex and
+/// search it without holding the lock; writers never modify an array in
+/// place, they make a modified copy and swap it in.
 //----------------------------------------------------------------------
 class BreakpointSiteList
 {
@@ -132,9 +139,26 @@ public:
     bool
     BreakpointSiteContainsBreakpoint (lldb::break_id_t bp_site_id, lldb::break_id_t bp_id);
 
+    //------------------------------------------------------------------
+    /// Call \a callback on each site in the list, in address order.
+    /// The callback may add or remove sites; the sites it visits are the
+    /// ones that were in the list when ForEach was called.
+    //------------------------------------------------------------------
     void
     ForEach (std::function <void(BreakpointSite *)> const &callback);
 
+    //------------------------------------------------------------------
+    /// Call \a callback, in address order, on each site whose bytes
+    /// overlap the range [\a lower_bound, \a upper_bound).
+    ///
+    /// @return
+    ///     The number of sites the callback was called on.
+    //------------------------------------------------------------------
+    size_t
+    ForEachInRange (lldb::addr_t lower_bound,
+                    lldb::addr_t upper_bound,
+                    std::function <void(BreakpointSite *)> const &callback) const;
+
     //------------------------------------------------------------------
     /// Removes the breakpoint site given by \b breakID from this list.
     ///
@@ -190,26 +214,47 @@ public:
     GetSize() const
     {
         Mutex::Locker locker(m_mutex);
-        return m_bp_site_list.size();
+        return m_bp_site_list->size();
     }
 
     bool
     IsEmpty() const
     {
         Mutex::Locker locker(m_mutex);
-        return m_bp_site_list.empty();
+        return m_bp_site_list->empty();
     }
 protected:
-    typedef std::map<lldb::addr_t, lldb::BreakpointSiteSP> collection;
+    // The address and ID are copied out of the site so that searches don't
+    // have to touch the BreakpointSite objects themselves.
+    struct SiteEntry
+    {
+        lldb::addr_t load_addr;
+        lldb::break_id_t id;
+        lldb::BreakpointSiteSP site_sp;
+    };
+
+    typedef std::vector<SiteEntry> collection;
+    typedef std::shared_ptr<const collection> CollectionSnapshot;
+
+    CollectionSnapshot
+    GetSnapshot () const;
+
+    // Must be called with m_mutex held.  Returns a copy of the current
+    // array for the caller to modify and store back in m_bp_site_list.
+    std::shared_ptr<collection>
+    CopyCollection () const;
+
+    static collection::const_iterator
+    LowerBound (const collection &sites, lldb::addr_t addr);
 
-    collection::iterator
-    GetIDIterator(lldb::break_id_t breakID);
+    static collection::const_iterator
+    FindAddressIterator (const collection &sites, lldb::addr_t addr);
 
-    collection::const_iterator
-    GetIDConstIterator(lldb::break_id_t breakID) const;
+    static collection::const_iterator
+    FindIDIterator (const collection &sites, lldb::break_id_t break_id);
 
     mutable Mutex m_mutex;
-    collection m_bp_site_list;  // The breakpoint site list.
+    CollectionSnapshot m_bp_site_list;  // The breakpoint site list, sorted by load address.
 };
 
 } // namespace lldb_private
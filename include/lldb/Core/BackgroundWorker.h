@@ -0,0 +1,165 @@
+//===-- BackgroundWorker.h --------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_BackgroundWorker_h_
+#define liblldb_BackgroundWorker_h_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "lldb/lldb-private.h"
+#include "lldb/Host/Condition.h"
+#include "lldb/Host/HostThread.h"
+#include "lldb/Host/Mutex.h"
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class BackgroundWorker BackgroundWorker.h "lldb/Core/BackgroundWorker.h"
+/// @brief A single thread that runs jobs one at a time.
+///
+/// Jobs run in the order they were dispatched and never at the same time
+/// as each other, so work that uses objects which aren't thread safe (a
+/// thread's register context or frame list) can be handed to the worker
+/// as long as the thread that posts it leaves those objects alone while
+/// IsBusy() returns true.
+///
+/// Jobs are posted first and only start running once Dispatch() is
+/// called. This lets a caller post work from several places and keep
+/// using the objects the work touches until it is done with them.
+//----------------------------------------------------------------------
+class BackgroundWorker
+{
+public:
+    typedef std::function<void (const std::atomic<bool> &cancel)> Work;
+
+    class Job
+    {
+    public:
+        //------------------------------------------------------------------
+        /// @return
+        ///     \b true once the job has run or was cancelled, \b false
+        ///     while it is posted, queued or running.
+        //------------------------------------------------------------------
+        bool
+        IsDone () const
+        {
+            return m_done;
+        }
+
+        bool
+        WasCancelled () const
+        {
+            return m_cancel;
+        }
+
+    protected:
+        friend class BackgroundWorker;
+
+        Job (const Work &work) :
+            m_work (work),
+            m_cancel (false),
+            m_done (false)
+        {
+        }
+
+        Work m_work;
+        std::atomic<bool> m_cancel;
+        std::atomic<bool> m_done;
+
+    private:
+        DISALLOW_COPY_AND_ASSIGN (Job);
+    };
+
+    typedef std::shared_ptr<Job> JobSP;
+
+    BackgroundWorker (const char *thread_name);
+
+    ~BackgroundWorker ();
+
+    //------------------------------------------------------------------
+    /// Add a job that will run after the next call to Dispatch(). The
+    /// worker thread is launched the first time a job is posted; if it
+    /// can't be launched, an empty JobSP is returned and the caller
+    /// should do the work itself.
+    //------------------------------------------------------------------
+    JobSP
+    Post (const Work &work);
+
+    //------------------------------------------------------------------
+    /// Let the worker run every job posted so far.
+    //------------------------------------------------------------------
+    void
+    Dispatch ();
+
+    //------------------------------------------------------------------
+    /// @return
+    ///     \b true while a dispatched job is waiting or running.
+    //------------------------------------------------------------------
+    bool
+    IsBusy () const
+    {
+        return m_num_dispatched > 0;
+    }
+
+    //------------------------------------------------------------------
+    /// Cancel a job. A job that hasn't started won't run, a running job
+    /// sees its cancel flag set. This doesn't wait for a running job.
+    //------------------------------------------------------------------
+    void
+    Cancel (const JobSP &job_sp);
+
+    //------------------------------------------------------------------
+    /// Cancel every job and wait for the running one, if any, to return.
+    /// The job only has to reach its next check of the cancel flag.
+    /// Must not be called from a job.
+    //------------------------------------------------------------------
+    void
+    CancelAll ();
+
+    //------------------------------------------------------------------
+    /// @return
+    ///     The number of dispatched jobs that have run or were
+    ///     cancelled. Polling this tells when to pick up results.
+    //------------------------------------------------------------------
+    uint32_t
+    GetFinishedCount () const
+    {
+        return m_num_finished;
+    }
+
+protected:
+    static lldb::thread_result_t
+    WorkerThread (lldb::thread_arg_t arg);
+
+    // Must be called with m_mutex locked
+    void
+    FinishJob (const JobSP &job_sp);
+
+    const char *m_thread_name;
+    Mutex m_mutex;
+    Condition m_queued_condition;       // Signaled when jobs are dispatched or the worker should stop
+    Condition m_finished_condition;     // Signaled when a job finishes
+    std::deque<JobSP> m_posted;         // Protected by m_mutex
+    std::deque<JobSP> m_queue;          // Protected by m_mutex
+    JobSP m_running_job_sp;             // Protected by m_mutex
+    bool m_stop;                        // Protected by m_mutex
+    std::atomic<uint32_t> m_num_dispatched;
+    std::atomic<uint32_t> m_num_finished;
+    HostThread m_thread;
+
+private:
+    DISALLOW_COPY_AND_ASSIGN (BackgroundWorker);
+};
+
+} // namespace lldb_private
+
+#endif  // liblldb_BackgroundWorker_h_
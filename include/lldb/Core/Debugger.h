@@ -333,6 +333,9 @@ public:
     
     bool
     GetEscapeNonPrintables () const;
+
+    bool
+    GetScriptLightweightCallbacks () const;
     
     bool
     GetNotifyVoid () const;
@@ -432,7 +435,12 @@ protected:
     std::unique_ptr<CommandInterpreter> m_command_interpreter_ap;
 
     IOHandlerStack m_input_reader_stack;
-    typedef std::map<std::string, lldb::StreamWP> LogStreamMap;
+    struct LogStreamInfo
+    {
+        lldb::StreamWP stream_wp;
+        uint32_t buffer_options;    // LLDB_LOG_OPTION_ASYNC or LLDB_LOG_OPTION_RING_BUFFER if stream_wp is a StreamLogBuffer
+    };
+    typedef std::map<std::string, LogStreamInfo> LogStreamMap;
     LogStreamMap m_log_streams;
     lldb::StreamSP m_log_callback_stream_sp;
     ConstString m_instance_name;
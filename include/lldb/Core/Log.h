@@ -48,6 +48,8 @@
 #define LLDB_LOG_OPTION_PREPEND_THREAD_NAME     (1U << 6)
 #define LLDB_LOG_OPTION_BACKTRACE               (1U << 7)
 #define LLDB_LOG_OPTION_APPEND                  (1U << 8)
+#define LLDB_LOG_OPTION_ASYNC                   (1U << 9)   // Write the log through a StreamLogBuffer in eModeAsynchronous
+#define LLDB_LOG_OPTION_RING_BUFFER             (1U << 10)  // Write the log through a StreamLogBuffer in eModeRingBuffer
 
 //----------------------------------------------------------------------
 // Logging Functions
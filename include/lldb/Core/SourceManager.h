@@ -12,6 +12,8 @@
 
 // C Includes
 // C++ Includes
+#include <atomic>
+#include <list>
 #include <map>
 #include <vector>
 
@@ -19,6 +21,8 @@
 // Project includes
 #include "lldb/lldb-private.h"
 #include "lldb/Host/FileSpec.h"
+#include "lldb/Host/HostThread.h"
+#include "lldb/Host/Mutex.h"
 
 namespace lldb_private {
 
@@ -101,18 +105,46 @@ public:
 
    // The SourceFileCache class separates the source manager from the cache of source files, so the 
    // cache can be stored in the Debugger, but the source managers can be per target.     
+    // The cache holds at most a fixed number of files and evicts the least recently used one
+    // when it is full. It can be shared between threads.
     class SourceFileCache
     {
     public:
-        SourceFileCache () {}
-        ~SourceFileCache() {}
+        SourceFileCache ();
+        ~SourceFileCache();
         
         void AddSourceFile (const FileSP &file_sp);
-        FileSP FindSourceFile (const FileSpec &file_spec) const;
+        FileSP FindSourceFile (const FileSpec &file_spec);
+
+        //------------------------------------------------------------------
+        /// Load and index the source files in \a file_specs that aren't
+        /// already cached on a background thread, so displaying them later
+        /// doesn't have to wait on the file system.
+        ///
+        /// Only files that exist at their own path are loaded; the ones
+        /// that have to be found through a target are left to GetFile.
+        /// If a previous prefetch is still running this request is
+        /// dropped rather than waiting for it.
+        //------------------------------------------------------------------
+        void PrefetchSourceFiles (const std::vector<FileSpec> &file_specs);
+
+        //------------------------------------------------------------------
+        /// Wait for the prefetch started by PrefetchSourceFiles, if any.
+        //------------------------------------------------------------------
+        void WaitForPrefetch ();
         
     protected:
-        typedef std::map <FileSpec, FileSP> FileCache;
+        static lldb::thread_result_t
+        PrefetchThread (lldb::thread_arg_t arg);
+
+        typedef std::list<FileSP> FileList; // Most recently used file first
+        typedef std::map <FileSpec, FileList::iterator> FileCache;
+        FileList m_files;
         FileCache m_file_cache;
+        Mutex m_mutex;
+        HostThread m_prefetch_thread;
+        std::atomic<bool> m_prefetching;
+        std::vector<FileSpec> m_prefetch_file_specs;
     };
 #endif
 
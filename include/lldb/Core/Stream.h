@@ -90,6 +90,22 @@ public:
     virtual size_t
     Write (const void *src, size_t src_len) = 0;
 
+    //------------------------------------------------------------------
+    /// Called by Log after a complete log record was written with
+    /// Write().
+    ///
+    /// Streams that buffer log records override this to decide for
+    /// themselves when the records need to be written out.
+    ///
+    /// @param[in] log_flags
+    ///     The LLDB_LOG_FLAG_XXX flags the record was logged with.
+    //------------------------------------------------------------------
+    virtual void
+    FlushLogRecord (uint32_t log_flags)
+    {
+        Flush ();
+    }
+
     //------------------------------------------------------------------
     // Member functions
     //------------------------------------------------------------------
@@ -0,0 +1,151 @@
+//===-- StreamLogBuffer.h ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_StreamLogBuffer_h_
+#define liblldb_StreamLogBuffer_h_
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+#include "lldb/Core/Stream.h"
+#include "lldb/Host/Condition.h"
+#include "lldb/Host/HostThread.h"
+#include "lldb/Host/Mutex.h"
+
+namespace lldb_private {
+
+//----------------------------------------------------------------------
+/// @class StreamLogBuffer StreamLogBuffer.h "lldb/Core/StreamLogBuffer.h"
+/// @brief A stream that buffers log records in front of another stream.
+///
+/// Every Write() call is treated as one complete log record, so records
+/// from different threads are never interleaved.
+///
+/// In eModeAsynchronous the records are handed to a background thread
+/// through a lock-free queue, and the thread that logs never blocks on
+/// the destination stream.
+///
+/// In eModeRingBuffer only the most recent records, up to a fixed number
+/// of bytes, are kept in memory. They are written to the destination
+/// stream only when DumpRingBuffer() is called, which happens when an
+/// error is logged.
+///
+/// Records still queued by asynchronous buffers are written out when the
+/// process calls exit().
+//----------------------------------------------------------------------
+class StreamLogBuffer : public Stream
+{
+public:
+    enum Mode
+    {
+        eModeAsynchronous,
+        eModeRingBuffer
+    };
+
+    static const size_t DefaultRingBufferSize = 4 * 1024 * 1024;
+
+    StreamLogBuffer (const lldb::StreamSP &stream_sp,
+                     Mode mode,
+                     size_t ring_buffer_size = DefaultRingBufferSize);
+
+    virtual
+    ~StreamLogBuffer ();
+
+    //------------------------------------------------------------------
+    /// In eModeAsynchronous, wait until every record written so far has
+    /// reached the destination stream. Does nothing in eModeRingBuffer.
+    //------------------------------------------------------------------
+    virtual void
+    Flush ();
+
+    virtual size_t
+    Write (const void *src, size_t src_len);
+
+    //------------------------------------------------------------------
+    /// Dump the ring buffer when an error is logged, and wait for the
+    /// writer thread when a fatal error is logged.
+    //------------------------------------------------------------------
+    virtual void
+    FlushLogRecord (uint32_t log_flags);
+
+    //------------------------------------------------------------------
+    /// Write the records kept in the ring buffer to the destination
+    /// stream and empty the ring buffer.
+    //------------------------------------------------------------------
+    void
+    DumpRingBuffer ();
+
+    Mode
+    GetMode () const
+    {
+        return m_mode;
+    }
+
+    const lldb::StreamSP &
+    GetStream () const
+    {
+        return m_stream_sp;
+    }
+
+    //------------------------------------------------------------------
+    /// Flush every StreamLogBuffer in eModeAsynchronous. This is
+    /// registered with atexit() so queued records aren't lost when the
+    /// process exits.
+    //------------------------------------------------------------------
+    static void
+    FlushAll ();
+
+protected:
+    struct Record
+    {
+        std::atomic<Record *> next;
+        std::string data;
+    };
+
+    void
+    Enqueue (Record *record);
+
+    Record *
+    Dequeue ();
+
+    static lldb::thread_result_t
+    WriterThread (lldb::thread_arg_t arg);
+
+    lldb::StreamSP m_stream_sp;
+    Mode m_mode;
+
+    // eModeAsynchronous: a multiple producer, single consumer queue. Writers
+    // push onto m_queue_head and only the writer thread touches m_queue_tail.
+    std::atomic<Record *> m_queue_head;
+    Record *m_queue_tail;
+    Record m_queue_stub;
+    std::atomic<uint64_t> m_enqueued_count;
+    std::atomic<bool> m_writer_idle;
+    uint64_t m_written_count;           // Protected by m_writer_mutex
+    bool m_stop_writer;                 // Protected by m_writer_mutex
+    Mutex m_writer_mutex;
+    Condition m_writer_condition;       // Signaled when records are queued
+    Condition m_written_condition;      // Signaled when m_written_count changes
+    HostThread m_writer_thread;
+
+    // eModeRingBuffer
+    Mutex m_ring_mutex;
+    std::deque<std::string> m_ring;
+    size_t m_ring_size;
+    size_t m_ring_max_size;
+    uint64_t m_ring_dropped_count;
+
+private:
+    DISALLOW_COPY_AND_ASSIGN (StreamLogBuffer);
+};
+
+} // namespace lldb_private
+
+#endif  // liblldb_StreamLogBuffer_h_
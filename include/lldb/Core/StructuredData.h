@@ -709,6 +709,14 @@ public:
     static ObjectSP
     ParseJSON (std::string json_text);
 
+    //------------------------------------------------------------------
+    /// Write \a len bytes of \a str as a quoted JSON string. Quotes,
+    /// backslashes and control characters, including NUL bytes, are
+    /// escaped; everything else is written as is.
+    //------------------------------------------------------------------
+    static void
+    DumpJSONString (Stream &s, const char *str, size_t len);
+
 };  // class StructuredData
 
 
@@ -34,6 +34,10 @@ namespace lldb_private {
 class Timer
 {
 public:
+    // Timer state for a single thread. Each thread only updates its
+    // own ThreadTimers, and they are merged when the timers are dumped.
+    struct ThreadTimers;
+
     static void
     Initialize ();
 
@@ -59,6 +63,21 @@ public:
     static void
     DumpCategoryTimes (Stream *s);
 
+    //--------------------------------------------------------------
+    /// Dump the timers of all threads as a call tree with the
+    /// inclusive time, exclusive time and number of calls of each
+    /// nested timer.
+    //--------------------------------------------------------------
+    static void
+    DumpCallTree (Stream *s);
+
+    //--------------------------------------------------------------
+    /// Dump every timer that completed as a Chrome trace event
+    /// ("about:tracing") JSON object.
+    //--------------------------------------------------------------
+    static void
+    DumpTraceEvents (Stream *s);
+
     static void
     ResetCategoryTimes ();
 
@@ -84,7 +103,7 @@ protected:
     TimeValue m_timer_start;
     uint64_t m_total_ticks; // Total running time for this timer including when other timers below this are running
     uint64_t m_timer_ticks; // Ticks for this timer that do not include when other timers below this one are running
-    static uint32_t g_depth;
+    ThreadTimers *m_thread_timers; // NULL if timers were disabled when this timer was created
     static uint32_t g_display_depth;
     static FILE * g_file;
 private:
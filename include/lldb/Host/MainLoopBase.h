@@ -0,0 +1,152 @@
+//===-- MainLoopBase.h ------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef lldb_Host_MainLoopBase_h_
+#define lldb_Host_MainLoopBase_h_
+
+#include <functional>
+#include <memory>
+
+#include "lldb/Core/Error.h"
+#include "lldb/Host/IOObject.h"
+#include "lldb/lldb-defines.h"
+#include "lldb/lldb-forward.h"
+
+namespace lldb_private
+{
+
+//----------------------------------------------------------------------
+/// @class MainLoopBase MainLoopBase.h "lldb/Host/MainLoopBase.h"
+/// @brief An event loop that runs all of its callbacks on one thread.
+///
+/// Readable file descriptors, signals and callbacks posted from other
+/// threads are all dispatched on the thread that calls Run(), one at a
+/// time, so the code they run needs no locking against each other.
+/// Registrations are undone when the handle returned for them is
+/// destroyed.
+///
+/// This class has no event source of its own: every registration fails
+/// and Run() returns an error.  Hosts that support an event loop derive
+/// from it, and MainLoop (see MainLoop.h) names the implementation for
+/// the current host.
+//----------------------------------------------------------------------
+class MainLoopBase
+{
+  private:
+    class ReadHandle;
+    class SignalHandle;
+
+  public:
+    typedef std::unique_ptr<ReadHandle> ReadHandleUP;
+    typedef std::unique_ptr<SignalHandle> SignalHandleUP;
+
+    typedef std::function<void(MainLoopBase &)> Callback;
+
+    MainLoopBase() {}
+    virtual ~MainLoopBase() {}
+
+    //------------------------------------------------------------------
+    /// Call @a callback whenever @a object_sp has data to read.
+    ///
+    /// @return
+    ///     A handle that keeps the callback registered, or nullptr with
+    ///     @a error set if the object could not be watched.
+    //------------------------------------------------------------------
+    virtual ReadHandleUP RegisterReadObject(const lldb::IOObjectSP &object_sp, const Callback &callback, Error &error);
+
+    //------------------------------------------------------------------
+    /// Call @a callback whenever @a signo is delivered to the process.
+    ///
+    /// The signal is blocked on the calling thread while the handle is
+    /// alive.  Threads that already exist and do not block it may still
+    /// take the signal before the loop sees it, so callers should block
+    /// it early, before any threads are started.
+    //------------------------------------------------------------------
+    virtual SignalHandleUP RegisterSignal(int signo, const Callback &callback, Error &error);
+
+    //------------------------------------------------------------------
+    /// Run @a callback on the loop thread at the next iteration.  This is
+    /// the only method that may be called from other threads.
+    //------------------------------------------------------------------
+    virtual void AddPendingCallback(const Callback &callback);
+
+    //------------------------------------------------------------------
+    /// Dispatch events until RequestTermination() is called.
+    //------------------------------------------------------------------
+    virtual Error Run();
+
+    //------------------------------------------------------------------
+    /// Make Run() return once the current callback finishes.
+    //------------------------------------------------------------------
+    virtual void RequestTermination();
+
+  protected:
+    ReadHandleUP
+    CreateReadHandle(IOObject::WaitableHandle handle)
+    {
+        return ReadHandleUP(new ReadHandle(*this, handle));
+    }
+
+    SignalHandleUP
+    CreateSignalHandle(int signo)
+    {
+        return SignalHandleUP(new SignalHandle(*this, signo));
+    }
+
+    virtual void UnregisterReadObject(IOObject::WaitableHandle handle);
+
+    virtual void UnregisterSignal(int signo);
+
+  private:
+    class ReadHandle
+    {
+      public:
+        ~ReadHandle() { m_mainloop.UnregisterReadObject(m_handle); }
+
+      private:
+        friend class MainLoopBase;
+
+        ReadHandle(MainLoopBase &mainloop, IOObject::WaitableHandle handle)
+            : m_mainloop(mainloop)
+            , m_handle(handle)
+        {
+        }
+
+        MainLoopBase &m_mainloop;
+        IOObject::WaitableHandle m_handle;
+
+        DISALLOW_COPY_AND_ASSIGN(ReadHandle);
+    };
+
+    class SignalHandle
+    {
+      public:
+        ~SignalHandle() { m_mainloop.UnregisterSignal(m_signo); }
+
+      private:
+        friend class MainLoopBase;
+
+        SignalHandle(MainLoopBase &mainloop, int signo)
+            : m_mainloop(mainloop)
+            , m_signo(signo)
+        {
+        }
+
+        MainLoopBase &m_mainloop;
+        int m_signo;
+
+        DISALLOW_COPY_AND_ASSIGN(SignalHandle);
+    };
+
+    DISALLOW_COPY_AND_ASSIGN(MainLoopBase);
+};
+
+} // namespace lldb_private
+
+#endif
@@ -17,6 +17,7 @@
 
 #include <functional>
 #include <map>
+#include <vector>
 
 namespace lldb_private
 {
@@ -25,14 +26,44 @@ namespace lldb_private
     public:
         typedef std::function<Error (lldb::addr_t addr, size_t size_hint, bool hardware, NativeBreakpointSP &breakpoint_sp)> CreateBreakpointFunc;
 
+        // Creates breakpoints at several addresses at once.  Fills in one
+        // breakpoint and one error per address.
+        typedef std::function<void (const std::vector<lldb::addr_t> &addrs,
+                                    const std::vector<uint32_t> &size_hints,
+                                    bool hardware,
+                                    std::vector<NativeBreakpointSP> &breakpoints,
+                                    std::vector<Error> &errors)> CreateBreakpointsFunc;
+
+        // Disables several enabled breakpoints at once.  Fills in one
+        // error per breakpoint.
+        typedef std::function<void (const std::vector<NativeBreakpointSP> &breakpoints,
+                                    std::vector<Error> &errors)> DisableBreakpointsFunc;
+
         NativeBreakpointList ();
 
         Error
         AddRef (lldb::addr_t addr, size_t size_hint, bool hardware, CreateBreakpointFunc create_func);
 
+        // Like AddRef() for each address, except that the breakpoints that
+        // don't exist yet are all created by one call to create_func.
+        void
+        AddRefs (const std::vector<lldb::addr_t> &addrs,
+                 const std::vector<uint32_t> &size_hints,
+                 bool hardware,
+                 CreateBreakpointsFunc create_func,
+                 std::vector<Error> &errors);
+
         Error
         DecRef (lldb::addr_t addr);
 
+        // Like DecRef() for each address, except that the breakpoints that
+        // lose their last reference are all disabled by one call to
+        // disable_func.
+        void
+        DecRefs (const std::vector<lldb::addr_t> &addrs,
+                 DisableBreakpointsFunc disable_func,
+                 std::vector<Error> &errors);
+
         Error
         EnableBreakpoint (lldb::addr_t addr);
 
@@ -119,9 +119,36 @@ namespace lldb_private
         virtual Error
         SetBreakpoint (lldb::addr_t addr, uint32_t size, bool hardware) = 0;
 
+        //------------------------------------------------------------------
+        /// Set a breakpoint at each address in \a addrs, passing the
+        /// matching entry of \a size_hints as the size hint.
+        ///
+        /// The default implementation calls SetBreakpoint() for each
+        /// address.
+        ///
+        /// @param[out] errors
+        ///     Receives one error per address, in the order of \a addrs.
+        //------------------------------------------------------------------
+        virtual void
+        SetBreakpoints (const std::vector<lldb::addr_t> &addrs,
+                        const std::vector<uint32_t> &size_hints,
+                        bool hardware,
+                        std::vector<Error> &errors);
+
         virtual Error
         RemoveBreakpoint (lldb::addr_t addr);
 
+        //------------------------------------------------------------------
+        /// Remove one reference to the breakpoint at each address in
+        /// \a addrs.  Software breakpoints that lose their last reference
+        /// have their original opcodes restored together.
+        ///
+        /// @param[out] errors
+        ///     Receives one error per address, in the order of \a addrs.
+        //------------------------------------------------------------------
+        virtual void
+        RemoveBreakpoints (const std::vector<lldb::addr_t> &addrs, std::vector<Error> &errors);
+
         virtual Error
         EnableBreakpoint (lldb::addr_t addr);
 
@@ -331,9 +358,32 @@ namespace lldb_private
         Error
         SetSoftwareBreakpoint (lldb::addr_t addr, uint32_t size_hint);
 
+        void
+        SetSoftwareBreakpoints (const std::vector<lldb::addr_t> &addrs, const std::vector<uint32_t> &size_hints, std::vector<Error> &errors);
+
         virtual Error
         GetSoftwareBreakpointTrapOpcode (size_t trap_opcode_size_hint, size_t &actual_opcode_size, const uint8_t *&trap_opcode_bytes) = 0;
 
+        // One piece of a scattered memory transfer: \a size bytes at
+        // \a addr in the inferior, read into or written from \a buf.
+        struct MemoryBlock
+        {
+            lldb::addr_t addr;
+            uint8_t *buf;
+            size_t size;
+            Error error;
+        };
+
+        // Transfer every block in \a blocks, setting each block's error.
+        // A block only succeeds if all of its bytes were transferred.  The
+        // default implementations call ReadMemory() or WriteMemory() once
+        // per block; derived classes may move them in fewer system calls.
+        virtual void
+        ReadMemoryBlocks (std::vector<MemoryBlock> &blocks);
+
+        virtual void
+        WriteMemoryBlocks (std::vector<MemoryBlock> &blocks);
+
         // -----------------------------------------------------------
         /// Notify the delegate that an exec occurred.
         ///
@@ -33,15 +33,20 @@ public:
     virtual
     ~NativeRegisterContext ();
 
-    // void
-    // InvalidateIfNeeded (bool force);
+    //------------------------------------------------------------------
+    // Register caching.  Subclasses that cache register sets while the
+    // thread is stopped override these; the thread calls them right before
+    // it resumes.
+    //------------------------------------------------------------------
+    virtual Error
+    WriteDirtyRegisters ();
+
+    virtual void
+    InvalidateAllRegisters ();
 
     //------------------------------------------------------------------
     // Subclasses must override these functions
     //------------------------------------------------------------------
-    // virtual void
-    // InvalidateAllRegisters () = 0;
-
     virtual uint32_t
     GetRegisterCount () const = 0;
 
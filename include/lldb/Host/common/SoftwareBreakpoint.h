@@ -10,6 +10,8 @@
 #ifndef liblldb_SoftwareBreakpoint_h_
 #define liblldb_SoftwareBreakpoint_h_
 
+#include <vector>
+
 #include "lldb/lldb-private-forward.h"
 #include "NativeBreakpoint.h"
 
@@ -21,6 +23,24 @@ namespace lldb_private
         static Error
         CreateSoftwareBreakpoint (NativeProcessProtocol &process, lldb::addr_t addr, size_t size_hint, NativeBreakpointSP &breakpoint_spn);
 
+        // Creates a breakpoint at each of addrs.  The original opcodes are
+        // read, the traps written and the result verified with one batched
+        // memory access each, rather than three accesses per breakpoint.
+        static void
+        CreateSoftwareBreakpoints (NativeProcessProtocol &process,
+                                   const std::vector<lldb::addr_t> &addrs,
+                                   const std::vector<uint32_t> &size_hints,
+                                   std::vector<NativeBreakpointSP> &breakpoints,
+                                   std::vector<Error> &errors);
+
+        // Restores the original opcodes of breakpoints, which must all be
+        // enabled software breakpoints of process, with batched memory
+        // accesses.  Does not change their enabled state.
+        static void
+        DisableSoftwareBreakpoints (NativeProcessProtocol &process,
+                                    const std::vector<NativeBreakpointSP> &breakpoints,
+                                    std::vector<Error> &errors);
+
         SoftwareBreakpoint (NativeProcessProtocol &process, lldb::addr_t addr, const uint8_t *saved_opcodes, const uint8_t *trap_opcodes, size_t opcode_size);
 
     protected:
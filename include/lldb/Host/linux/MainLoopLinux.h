@@ -0,0 +1,80 @@
+//===-- MainLoopLinux.h -----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef lldb_Host_linux_MainLoopLinux_h_
+#define lldb_Host_linux_MainLoopLinux_h_
+
+#include <signal.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "lldb/Host/MainLoopBase.h"
+
+namespace lldb_private
+{
+
+//----------------------------------------------------------------------
+/// @class MainLoopLinux MainLoopLinux.h "lldb/Host/linux/MainLoopLinux.h"
+/// @brief A MainLoopBase built on epoll.
+///
+/// Read objects are added to the epoll set directly.  Each registered
+/// signal gets a signalfd, and AddPendingCallback() wakes the loop
+/// through an eventfd.  The loop thread waits for all of them with a
+/// single epoll_wait().
+//----------------------------------------------------------------------
+class MainLoopLinux : public MainLoopBase
+{
+  public:
+    MainLoopLinux();
+    ~MainLoopLinux() override;
+
+    ReadHandleUP RegisterReadObject(const lldb::IOObjectSP &object_sp, const Callback &callback,
+                                    Error &error) override;
+
+    SignalHandleUP RegisterSignal(int signo, const Callback &callback, Error &error) override;
+
+    void AddPendingCallback(const Callback &callback) override;
+
+    Error Run() override;
+
+    void RequestTermination() override;
+
+  protected:
+    void UnregisterReadObject(IOObject::WaitableHandle handle) override;
+
+    void UnregisterSignal(int signo) override;
+
+  private:
+    struct SignalInfo
+    {
+        Callback callback;
+        int fd;
+        bool was_blocked;
+    };
+
+    void ProcessEvent(int fd);
+
+    void ProcessPendingCallbacks();
+
+    int m_epoll_fd;
+    int m_event_fd;
+    std::map<IOObject::WaitableHandle, Callback> m_read_fds;
+    std::map<int, SignalInfo> m_signals;
+    std::mutex m_pending_mutex;
+    std::vector<Callback> m_pending_callbacks;
+    bool m_terminate_request;
+
+    DISALLOW_COPY_AND_ASSIGN(MainLoopLinux);
+};
+
+} // namespace lldb_private
+
+#endif
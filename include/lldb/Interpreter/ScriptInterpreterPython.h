@@ -418,6 +418,10 @@ protected:
                   FILE *out,
                   FILE *err);
     
+    bool
+    EnterLightweightSession (FILE *out,
+                             FILE *err);
+
     void
     LeaveSession ();
     
@@ -449,7 +453,8 @@ public:
             AcquireLock         = 0x0001,
             InitSession         = 0x0002,
             InitGlobals         = 0x0004,
-            NoSTDIN             = 0x0008
+            NoSTDIN             = 0x0008,
+            LightweightSession  = 0x0010     // reuse the session bindings between calls if the debugger allows it
         };
         
         enum OnLeave
@@ -532,6 +537,10 @@ protected:
     PythonObject m_saved_stdin;
     PythonObject m_saved_stdout;
     PythonObject m_saved_stderr;
+    PythonObject m_lightweight_stdout;  // File objects kept across lightweight sessions
+    PythonObject m_lightweight_stderr;
+    FILE *m_lightweight_stdout_file;
+    FILE *m_lightweight_stderr_file;
     PythonObject m_main_module;
     PythonObject m_lldb_module;
     PythonDictionary m_session_dict;
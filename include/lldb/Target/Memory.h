@@ -48,6 +48,13 @@ namespace lldb_private {
               void *dst, 
               size_t dst_len,
               Error &error);
+
+        // Fill the cache lines covering [addr, addr + size) with a single
+        // read from the inferior.  Returns the number of bytes now cached.
+        size_t
+        Prefetch (lldb::addr_t addr,
+                  size_t size,
+                  Error &error);
         
         uint32_t
         GetMemoryCacheLineSize() const
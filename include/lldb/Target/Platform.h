@@ -54,6 +54,11 @@ class ModuleCache;
         GetModuleCacheDirectory () const;
         bool
         SetModuleCacheDirectory (const FileSpec& dir_spec);
+
+        uint64_t
+        GetModuleCacheMaxSize () const;
+        bool
+        SetModuleCacheMaxSize (uint64_t max_size);
     };
 
     typedef std::shared_ptr<PlatformProperties> PlatformPropertiesSP;
@@ -944,6 +949,11 @@ class ModuleCache;
         ///     inferior.  Must outlive the NativeProcessProtocol
         ///     instance.
         ///
+        /// @param[in] mainloop
+        ///     The main loop that will deliver the inferior's state
+        ///     changes and run its operations.  Must outlive the
+        ///     NativeProcessProtocol instance.
+        ///
         /// @param[out] process_sp
         ///     On successful return from the method, this parameter
         ///     contains the shared pointer to the
@@ -958,6 +968,7 @@ class ModuleCache;
         LaunchNativeProcess (
             ProcessLaunchInfo &launch_info,
             lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+            MainLoopBase &mainloop,
             NativeProcessProtocolSP &process_sp);
 
         //------------------------------------------------------------------
@@ -974,6 +985,11 @@ class ModuleCache;
         ///     inferior.  Must outlive the NativeProcessProtocol
         ///     instance.
         ///
+        /// @param[in] mainloop
+        ///     The main loop that will deliver the inferior's state
+        ///     changes and run its operations.  Must outlive the
+        ///     NativeProcessProtocol instance.
+        ///
         /// @param[out] process_sp
         ///     On successful return from the method, this parameter
         ///     contains the shared pointer to the
@@ -987,6 +1003,7 @@ class ModuleCache;
         virtual Error
         AttachNativeProcess (lldb::pid_t pid,
                              lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+                             MainLoopBase &mainloop,
                              NativeProcessProtocolSP &process_sp);
 
     protected:
@@ -17,6 +17,7 @@
 
 // C++ Includes
 #include <list>
+#include <map>
 #include <iosfwd>
 #include <vector>
 
@@ -29,6 +30,7 @@
 #include "lldb/Core/Error.h"
 #include "lldb/Core/Event.h"
 #include "lldb/Core/ThreadSafeValue.h"
+#include "lldb/Core/StructuredData.h"
 #include "lldb/Core/PluginInterface.h"
 #include "lldb/Core/UserSettingsController.h"
 #include "lldb/Breakpoint/BreakpointSiteList.h"
@@ -1121,6 +1123,35 @@ public:
     virtual const lldb::DataBufferSP
     GetAuxvData();
 
+    //------------------------------------------------------------------
+    // Returns statistics about the packets exchanged with a remote
+    // debug server, grouped by packet type.
+    //
+    // The default action is to return an empty object, for processes
+    // that don't talk to a remote debug server.
+    //------------------------------------------------------------------
+    virtual StructuredData::ObjectSP
+    GetPacketStatistics ()
+    {
+        return StructuredData::ObjectSP();
+    }
+
+    virtual void
+    ResetPacketStatistics ()
+    {
+    }
+
+    //------------------------------------------------------------------
+    // Returns true if the process plug-in can step a thread through an
+    // address range and only stop once the pc leaves it (see
+    // ThreadPlan::GetStepRange).
+    //------------------------------------------------------------------
+    virtual bool
+    SupportsRangeStepping ()
+    {
+        return false;
+    }
+
 protected:
     virtual JITLoaderList &
     GetJITLoaders ();
@@ -2117,6 +2148,19 @@ public:
                             void *buf, 
                             size_t size,
                             Error &error);
+
+    //------------------------------------------------------------------
+    /// Pull a range of memory into the memory cache with one read, so
+    /// that the many small reads that follow are served from the cache.
+    /// Does nothing if the memory cache is disabled.
+    ///
+    /// @return
+    ///     The number of bytes that were cached.
+    //------------------------------------------------------------------
+    size_t
+    PrefetchMemory (lldb::addr_t vm_addr,
+                    size_t size,
+                    Error &error);
     
     //------------------------------------------------------------------
     /// Reads an unsigned integer of the specified byte size from 
@@ -2579,6 +2623,58 @@ public:
         return error;
     }
 
+    //------------------------------------------------------------------
+    /// Enable several breakpoint sites at once.
+    ///
+    /// The default implementation calls EnableBreakpointSite() for each
+    /// site.  Plug-ins that can insert many breakpoints in one request
+    /// to the target should override it.
+    ///
+    /// @param[in] bp_sites
+    ///     The sites to enable.
+    ///
+    /// @param[out] errors
+    ///     Receives one error per site, in the order of \a bp_sites.
+    //------------------------------------------------------------------
+    virtual void
+    EnableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors);
+
+    //------------------------------------------------------------------
+    /// Disable several breakpoint sites at once.  The default
+    /// implementation calls DisableBreakpointSite() for each site.
+    //------------------------------------------------------------------
+    virtual void
+    DisableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors);
+
+    //------------------------------------------------------------------
+    /// @class BreakpointSiteBatch Process.h "lldb/Target/Process.h"
+    /// @brief Groups breakpoint site changes so they reach the process
+    /// together.
+    ///
+    /// While a batch is alive, breakpoint sites created by
+    /// CreateBreakpointSite() and sites that lose their last owner are
+    /// queued rather than written to the process.  When the outermost
+    /// batch is destroyed the queued sites are disabled with one call to
+    /// DisableBreakpointSites(), then the new ones are enabled with one
+    /// call to EnableBreakpointSites().
+    ///
+    /// A batch holds a lock from construction to destruction, so batches
+    /// on other threads and their breakpoint site changes wait until the
+    /// queued sites have been applied.
+    //------------------------------------------------------------------
+    class BreakpointSiteBatch
+    {
+    public:
+        BreakpointSiteBatch (const lldb::ProcessSP &process_sp);
+
+        ~BreakpointSiteBatch ();
+
+    private:
+        lldb::ProcessSP m_process_sp;
+
+        DISALLOW_COPY_AND_ASSIGN (BreakpointSiteBatch);
+    };
+
 
     // This is implemented completely using the lldb::Process API. Subclasses
     // don't need to implement this function unless the standard flow of
@@ -2810,6 +2906,19 @@ public:
     RestoreProcessEvents ();
 
 private:
+    //------------------------------------------------------------------
+    // Used by BreakpointSiteBatch.  The queued breakpoint site changes
+    // are applied when the depth drops back to zero.
+    //------------------------------------------------------------------
+    void
+    BeginBreakpointSiteBatch ();
+
+    void
+    EndBreakpointSiteBatch ();
+
+    void
+    ApplyBreakpointSiteBatch ();
+
     //------------------------------------------------------------------
     /// This is the part of the event handling that for a process event.
     /// It decides what to do with the event and returns true if the
@@ -3142,6 +3251,10 @@ protected:
     std::vector<lldb::addr_t>   m_image_tokens;
     Listener                    &m_listener;
     BreakpointSiteList          m_breakpoint_site_list; ///< This is the list of breakpoint locations we intend to insert in the target.
+    Mutex                       m_breakpoint_site_batch_mutex; ///< Held by the thread with open BreakpointSiteBatch objects, and while creating or removing breakpoint sites.
+    uint32_t                    m_breakpoint_site_batch_depth; ///< The number of live BreakpointSiteBatch objects.
+    std::map<lldb::addr_t, lldb::BreakpointSiteSP> m_pending_enable_sites;  ///< Sites created in a batch, not yet enabled or added to m_breakpoint_site_list.
+    std::vector<lldb::BreakpointSiteSP> m_pending_disable_sites; ///< Sites that lost their last owner in a batch.
     lldb::DynamicLoaderUP       m_dyld_ap;
     lldb::JITLoaderListUP       m_jit_loaders_ap;
     lldb::DynamicCheckerFunctionsUP m_dynamic_checkers_ap; ///< The functions used by the expression parser to validate data that expressions use.
@@ -461,6 +461,27 @@ public:
     {
         return false;
     }
+
+    //------------------------------------------------------------------
+    /// When this plan is about to single step, it can ask the process
+    /// plug-in to keep stepping while the pc stays in an address range
+    /// and only stop once it leaves it. Plans that would stop after any
+    /// instruction in the range should return false.
+    ///
+    /// @param[out] range_start
+    ///     The first load address of the range.
+    ///
+    /// @param[out] range_end
+    ///     The load address just past the end of the range.
+    ///
+    /// @return
+    ///     True if the range was filled in.
+    //------------------------------------------------------------------
+    virtual bool
+    GetStepRange (lldb::addr_t &range_start, lldb::addr_t &range_end)
+    {
+        return false;
+    }
     
     bool
     PlanSucceeded ()
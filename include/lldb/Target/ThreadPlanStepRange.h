@@ -45,6 +45,7 @@ public:
     virtual bool MischiefManaged ();
     virtual void DidPush ();
     virtual bool IsPlanStale ();
+    virtual bool GetStepRange (lldb::addr_t &range_start, lldb::addr_t &range_end);
 
 
     void AddRange(const AddressRange &new_range);
@@ -0,0 +1,70 @@
+//===-- HexCodec.h ----------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLDB_UTILITY_HEXCODEC_H
+#define LLDB_UTILITY_HEXCODEC_H
+
+#include <stddef.h>
+
+namespace lldb_private
+{
+//----------------------------------------------------------------------
+// Bulk conversions for gdb-remote packet payloads. Where SSE2 is
+// available these process 16 bytes at a time, with a scalar loop for
+// other targets and for the tail of each buffer.
+//----------------------------------------------------------------------
+
+//----------------------------------------------------------------------
+/// Encode bytes as lowercase ASCII hex.
+///
+/// @param[in] dst
+///     A buffer with room for at least 2 * \a src_len characters. No
+///     NULL terminator is written.
+///
+/// @return
+///     The number of characters written to \a dst.
+//----------------------------------------------------------------------
+size_t
+EncodeHexBytes (const void *src, size_t src_len, char *dst);
+
+//----------------------------------------------------------------------
+/// Decode pairs of ASCII hex characters into bytes.
+///
+/// Decoding stops after \a dst_len bytes, when fewer than two
+/// characters of \a src remain, or at the first pair that contains a
+/// character that isn't a hex digit.
+///
+/// @return
+///     The number of bytes written to \a dst. Each one consumed two
+///     characters of \a src.
+//----------------------------------------------------------------------
+size_t
+DecodeHexBytes (const char *src, size_t src_len, void *dst, size_t dst_len);
+
+//----------------------------------------------------------------------
+/// Find the first byte that must be escaped in a gdb-remote binary
+/// payload: '#', '$', '}' or '*'.
+///
+/// @return
+///     The index of the byte, or \a src_len if there is none.
+//----------------------------------------------------------------------
+size_t
+FindGDBRemoteEscapeChar (const void *src, size_t src_len);
+
+//----------------------------------------------------------------------
+/// Find the first escape ('}') or run-length encoding ('*') character
+/// in the contents of a received gdb-remote packet.
+///
+/// @return
+///     The index of the character, or \a src_len if there is none.
+//----------------------------------------------------------------------
+size_t
+FindGDBRemoteDecodeChar (const char *src, size_t src_len);
+}
+
+#endif
@@ -19,6 +19,7 @@ namespace lldb_private
     // ---------------------------------------------------------------
     // Class forward decls.
     // ---------------------------------------------------------------
+    class MainLoopBase;
     class NativeBreakpoint;
     class NativeBreakpointList;
     class NativeProcessProtocol;
@@ -200,6 +200,18 @@ public:
 
     lldb::SBValueList
     GetVariables (const lldb::SBVariablesOptions& options);
+
+    %feature("autodoc", "
+    Snapshots the variables selected by options, and their children down to
+    max_depth levels with at most max_children children each, into the
+    SBStream as a JSON array of dictionaries with name, type, value, summary,
+    error, num_children and children keys.
+    ") GetVariablesAsJSON;
+    bool
+    GetVariablesAsJSON (const lldb::SBVariablesOptions& options,
+                        uint32_t max_depth,
+                        uint32_t max_children,
+                        lldb::SBStream &stream);
              
     lldb::SBValueList
     GetRegisters ();
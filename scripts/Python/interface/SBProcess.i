@@ -395,6 +395,16 @@ public:
     bool
     IsInstrumentationRuntimePresent(lldb::InstrumentationRuntimeType type);
 
+    %feature("autodoc", "
+    Writes statistics about the packets exchanged with the remote debug server
+    to the stream as JSON. Returns false if the process keeps no statistics.
+    ") GetPacketStatisticsAsJSON;
+    bool
+    GetPacketStatisticsAsJSON (lldb::SBStream &stream);
+
+    void
+    ResetPacketStatistics ();
+
     %pythoncode %{
         def __get_is_alive__(self):
             '''Returns "True" if the process is currently alive, "False" otherwise'''
@@ -19,6 +19,7 @@
 #include "lldb/Core/Log.h"
 #include "lldb/Core/Stream.h"
 #include "lldb/Core/StreamFile.h"
+#include "lldb/Core/StructuredData.h"
 #include "lldb/Core/ValueObjectRegister.h"
 #include "lldb/Core/ValueObjectVariable.h"
 #include "lldb/Expression/ClangPersistentVariables.h"
@@ -1110,6 +1111,66 @@ SBFrame::GetVariables (bool arguments,
     return GetVariables(options);
 }
 
+// Collect the value objects for the variables of "frame" that "options"
+// selects, without dynamic types applied.
+static void
+GetFrameVariableValues (StackFrame *frame,
+                        const lldb::SBVariablesOptions& options,
+                        std::vector<ValueObjectSP> &valobjs)
+{
+    const bool statics = options.GetIncludeStatics();
+    const bool arguments = options.GetIncludeArguments();
+    const bool locals = options.GetIncludeLocals();
+    const bool in_scope_only = options.GetInScopeOnly();
+    const bool include_runtime_support_values = options.GetIncludeRuntimeSupportValues();
+
+    VariableList *variable_list = frame->GetVariableList(true);
+    if (!variable_list)
+        return;
+
+    const size_t num_variables = variable_list->GetSize();
+    for (size_t i = 0; i < num_variables; ++i)
+    {
+        VariableSP variable_sp (variable_list->GetVariableAtIndex(i));
+        if (!variable_sp)
+            continue;
+
+        bool add_variable = false;
+        switch (variable_sp->GetScope())
+        {
+        case eValueTypeVariableGlobal:
+        case eValueTypeVariableStatic:
+            add_variable = statics;
+            break;
+
+        case eValueTypeVariableArgument:
+            add_variable = arguments;
+            break;
+
+        case eValueTypeVariableLocal:
+            add_variable = locals;
+            break;
+
+        default:
+            break;
+        }
+        if (!add_variable)
+            continue;
+
+        if (in_scope_only && !variable_sp->IsInScope(frame))
+            continue;
+
+        ValueObjectSP valobj_sp(frame->GetValueObjectForFrameVariable (variable_sp, eNoDynamicValues));
+
+        if (false == include_runtime_support_values &&
+            valobj_sp &&
+            true == valobj_sp->IsRuntimeSupportValue())
+            continue;
+
+        valobjs.push_back (valobj_sp);
+    }
+}
+
 SBValueList
 SBFrame::GetVariables (const lldb::SBVariablesOptions& options)
 {
@@ -1144,57 +1205,13 @@ SBFrame::GetVariables (const lldb::SBVariablesOptions& options)
             frame = exe_ctx.GetFramePtr();
             if (frame)
             {
-                size_t i;
-                VariableList *variable_list = NULL;
-                variable_list = frame->GetVariableList(true);
-                if (variable_list)
+                std::vector<ValueObjectSP> valobjs;
+                GetFrameVariableValues (frame, options, valobjs);
+                for (const ValueObjectSP &valobj_sp : valobjs)
                 {
-                    const size_t num_variables = variable_list->GetSize();
-                    if (num_variables)
-                    {
-                        for (i = 0; i < num_variables; ++i)
-                        {
-                            VariableSP variable_sp (variable_list->GetVariableAtIndex(i));
-                            if (variable_sp)
-                            {
-                                bool add_variable = false;
-                                switch (variable_sp->GetScope())
-                                {
-                                case eValueTypeVariableGlobal:
-                                case eValueTypeVariableStatic:
-                                    add_variable = statics;
-                                    break;
-
-                                case eValueTypeVariableArgument:
-                                    add_variable = arguments;
-                                    break;
-
-                                case eValueTypeVariableLocal:
-                                    add_variable = locals;
-                                    break;
-
-                                default:
-                                    break;
-                                }
-                                if (add_variable)
-                                {
-                                    if (in_scope_only && !variable_sp->IsInScope(frame))
-                                        continue;
-
-                                    ValueObjectSP valobj_sp(frame->GetValueObjectForFrameVariable (variable_sp, eNoDynamicValues));
-                                    
-                                    if (false == include_runtime_support_values &&
-                                        valobj_sp &&
-                                        true == valobj_sp->IsRuntimeSupportValue())
-                                        continue;
-                                    
-                                    SBValue value_sb;
-                                    value_sb.SetSP(valobj_sp,use_dynamic);
-                                    value_list.Append(value_sb);
-                                }
-                            }
-                        }
-                    }
+                    SBValue value_sb;
+                    value_sb.SetSP(valobj_sp,use_dynamic);
+                    value_list.Append(value_sb);
                 }
             }
             else
@@ -1218,6 +1235,129 @@ SBFrame::GetVariables (const lldb::SBVariablesOptions& options)
     return value_list;
 }
 
+// Add a dictionary describing "valobj_sp", and its children down to
+// "depth_left" more levels, to "array".
+static void
+AppendValueSnapshot (const ValueObjectSP &valobj_sp,
+                     lldb::DynamicValueType use_dynamic,
+                     uint32_t depth_left,
+                     uint32_t max_children,
+                     StructuredData::Array &array)
+{
+    ValueObjectSP value_sp (valobj_sp);
+    if (value_sp->GetDynamicValue(use_dynamic))
+        value_sp = value_sp->GetDynamicValue(use_dynamic);
+    if (value_sp->GetSyntheticValue(true))
+        value_sp = value_sp->GetSyntheticValue(true);
+
+    StructuredData::DictionarySP dict_sp (new StructuredData::Dictionary());
+    const char *name = value_sp->GetName().GetCString();
+    dict_sp->AddStringItem ("name", name ? name : "");
+    const char *type_name = value_sp->GetQualifiedTypeName().GetCString();
+    dict_sp->AddStringItem ("type", type_name ? type_name : "");
+
+    const char *value_cstr = value_sp->GetValueAsCString();
+    if (value_cstr)
+        dict_sp->AddStringItem ("value", value_cstr);
+    const char *summary_cstr = value_sp->GetSummaryAsCString();
+    if (summary_cstr)
+        dict_sp->AddStringItem ("summary", summary_cstr);
+    if (value_sp->GetError().Fail())
+    {
+        const char *error_cstr = value_sp->GetError().AsCString();
+        dict_sp->AddStringItem ("error", error_cstr ? error_cstr : "unknown error");
+    }
+
+    const size_t num_children = value_sp->GetNumChildren();
+    dict_sp->AddIntegerItem ("num_children", num_children);
+    if (depth_left > 0 && num_children > 0)
+    {
+        StructuredData::ArraySP children_sp (new StructuredData::Array());
+        const size_t num_to_add = std::min<size_t> (num_children, max_children);
+        for (size_t i = 0; i < num_to_add; ++i)
+        {
+            ValueObjectSP child_sp (value_sp->GetChildAtIndex (i, true));
+            if (child_sp)
+                AppendValueSnapshot (child_sp, use_dynamic, depth_left - 1, max_children, *children_sp);
+        }
+        dict_sp->AddItem ("children", children_sp);
+    }
+
+    array.AddItem (dict_sp);
+}
+
+bool
+SBFrame::GetVariablesAsJSON (const lldb::SBVariablesOptions& options,
+                             uint32_t max_depth,
+                             uint32_t max_children,
+                             lldb::SBStream &stream)
+{
+    Log *log(GetLogIfAllCategoriesSet (LIBLLDB_LOG_API));
+
+    Mutex::Locker api_locker;
+    ExecutionContext exe_ctx (m_opaque_sp.get(), api_locker);
+
+    StackFrame *frame = NULL;
+    Target *target = exe_ctx.GetTargetPtr();
+    Process *process = exe_ctx.GetProcessPtr();
+    bool success = false;
+    if (target && process)
+    {
+        Process::StopLocker stop_locker;
+        if (stop_locker.TryLock(&process->GetRunLock()))
+        {
+            frame = exe_ctx.GetFramePtr();
+            if (frame)
+            {
+                // Most of the values will live between the stack pointer and
+                // the CFA, plus arguments just above it, so read all of that
+                // into the memory cache with one request.
+                static const addr_t k_max_prefetch_size = 64 * 1024;
+                static const addr_t k_stack_args_size = 256;
+                RegisterContextSP reg_ctx_sp (frame->GetRegisterContext());
+                const addr_t cfa = frame->GetStackID().GetCallFrameAddress();
+                if (reg_ctx_sp && cfa != LLDB_INVALID_ADDRESS)
+                {
+                    const addr_t sp = reg_ctx_sp->GetSP();
+                    if (sp != LLDB_INVALID_ADDRESS && sp < cfa && cfa - sp <= k_max_prefetch_size)
+                    {
+                        Error prefetch_error;
+                        process->PrefetchMemory (sp, cfa - sp + k_stack_args_size, prefetch_error);
+                    }
+                }
+
+                std::vector<ValueObjectSP> valobjs;
+                GetFrameVariableValues (frame, options, valobjs);
+
+                StructuredData::Array array;
+                for (const ValueObjectSP &valobj_sp : valobjs)
+                {
+                    if (valobj_sp)
+                        AppendValueSnapshot (valobj_sp, options.GetUseDynamic(), max_depth, max_children, array);
+                }
+                array.Dump (stream.ref());
+                success = true;
+            }
+            else
+            {
+                if (log)
+                    log->Printf ("SBFrame::GetVariablesAsJSON () => error: could not reconstruct frame object for this SBFrame.");
+            }
+        }
+        else
+        {
+            if (log)
+                log->Printf ("SBFrame::GetVariablesAsJSON () => error: process is running");
+        }
+    }
+
+    if (log)
+        log->Printf ("SBFrame(%p)::GetVariablesAsJSON (max_depth=%u, max_children=%u) => %i",
+                     static_cast<void*>(frame), max_depth, max_children, success);
+
+    return success;
+}
+
 SBValueList
 SBFrame::GetRegisters ()
 {
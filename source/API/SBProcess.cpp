@@ -1401,3 +1401,26 @@ SBProcess::IsInstrumentationRuntimePresent(InstrumentationRuntimeType type)
     
     return runtime_sp->IsActive();
 }
+
+bool
+SBProcess::GetPacketStatisticsAsJSON (lldb::SBStream &stream)
+{
+    ProcessSP process_sp(GetSP());
+    if (! process_sp)
+        return false;
+
+    StructuredData::ObjectSP stats = process_sp->GetPacketStatistics();
+    if (! stats)
+        return false;
+
+    stats->Dump(stream.ref());
+    return true;
+}
+
+void
+SBProcess::ResetPacketStatistics ()
+{
+    ProcessSP process_sp(GetSP());
+    if (process_sp)
+        process_sp->ResetPacketStatistics();
+}
@@ -29,6 +29,7 @@
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/Function.h"
 #include "lldb/Symbol/SymbolContext.h"
+#include "lldb/Target/Process.h"
 #include "lldb/Target/Target.h"
 #include "lldb/Target/ThreadSpec.h"
 #include "llvm/Support/Casting.h"
@@ -150,10 +151,13 @@ Breakpoint::SetEnabled (bool enable)
         return;
 
     m_options.SetEnabled(enable);
-    if (enable)
-        m_locations.ResolveAllBreakpointSites();
-    else
-        m_locations.ClearAllBreakpointSites();
+    {
+        Process::BreakpointSiteBatch batch (m_target.GetProcessSP());
+        if (enable)
+            m_locations.ResolveAllBreakpointSites();
+        else
+            m_locations.ClearAllBreakpointSites();
+    }
         
     SendBreakpointChangedEvent (enable ? eBreakpointEventTypeEnabled : eBreakpointEventTypeDisabled);
 
@@ -355,7 +359,10 @@ void
 Breakpoint::ResolveBreakpoint ()
 {
     if (m_resolver_sp)
+    {
+        Process::BreakpointSiteBatch batch (m_target.GetProcessSP());
         m_resolver_sp->ResolveBreakpoint(*m_filter_sp);
+    }
 }
 
 void
@@ -363,7 +370,10 @@ Breakpoint::ResolveBreakpointInModules (ModuleList &module_list, BreakpointLocat
 {
     m_locations.StartRecordingNewLocations(new_locations);
     
-    m_resolver_sp->ResolveBreakpointInModules(*m_filter_sp, module_list);
+    {
+        Process::BreakpointSiteBatch batch (m_target.GetProcessSP());
+        m_resolver_sp->ResolveBreakpointInModules(*m_filter_sp, module_list);
+    }
 
     m_locations.StopRecordingNewLocations();
 }
@@ -391,6 +401,7 @@ Breakpoint::ResolveBreakpointInModules (ModuleList &module_list, bool send_event
         }
         else
         {
+            Process::BreakpointSiteBatch batch (m_target.GetProcessSP());
             m_resolver_sp->ResolveBreakpointInModules(*m_filter_sp, module_list);
         }
     }
@@ -415,6 +426,10 @@ Breakpoint::ModulesChanged (ModuleList &module_list, bool load, bool delete_loca
                      module_list.GetSize(), load, delete_locations);
     
     Mutex::Locker modules_mutex(module_list.GetMutex());
+
+    // Set or clear the breakpoint sites for all the modules at once.
+    Process::BreakpointSiteBatch batch (m_target.GetProcessSP());
+
     if (load)
     {
         // The logic for handling new modules is:
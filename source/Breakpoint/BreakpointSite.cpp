@@ -38,7 +38,8 @@ BreakpointSite::BreakpointSite
     m_owners(),
     m_owners_mutex(Mutex::eMutexTypeRecursive)
 {
-    m_owners.Add(owner);
+    if (owner)
+        m_owners.Add(owner);
 }
 
 BreakpointSite::~BreakpointSite()
@@ -21,7 +21,7 @@ using namespace lldb_private;
 
 BreakpointSiteList::BreakpointSiteList() :
     m_mutex (Mutex::eMutexTypeRecursive),
-    m_bp_site_list()
+    m_bp_site_list(new collection())
 {
 }
 
@@ -29,6 +29,52 @@ BreakpointSiteList::~BreakpointSiteList()
 {
 }
 
+BreakpointSiteList::CollectionSnapshot
+BreakpointSiteList::GetSnapshot () const
+{
+    Mutex::Locker locker(m_mutex);
+    return m_bp_site_list;
+}
+
+std::shared_ptr<BreakpointSiteList::collection>
+BreakpointSiteList::CopyCollection () const
+{
+    // Always copy, even if nobody else holds the current array: a reader
+    // that just dropped its snapshot may still be ordered before us, and
+    // shared_ptr::use_count () doesn't tell us otherwise.
+    return std::shared_ptr<collection> (new collection (*m_bp_site_list));
+}
+
+BreakpointSiteList::collection::const_iterator
+BreakpointSiteList::LowerBound (const collection &sites, lldb::addr_t addr)
+{
+    return std::lower_bound (sites.begin(),
+                             sites.end(),
+                             addr,
+                             [](const SiteEntry &entry, lldb::addr_t addr) -> bool {
+                                 return entry.load_addr < addr;
+                             });
+}
+
+BreakpointSiteList::collection::const_iterator
+BreakpointSiteList::FindAddressIterator (const collection &sites, lldb::addr_t addr)
+{
+    collection::const_iterator pos = LowerBound (sites, addr);
+    if (pos != sites.end() && pos->load_addr == addr)
+        return pos;
+    return sites.end();
+}
+
+BreakpointSiteList::collection::const_iterator
+BreakpointSiteList::FindIDIterator (const collection &sites, lldb::break_id_t break_id)
+{
+    return std::find_if (sites.begin(),
+                         sites.end(),
+                         [break_id](const SiteEntry &entry) -> bool {
+                             return entry.id == break_id;
+                         });
+}
+
 // Add breakpoint site to the list.  However, if the element already exists in the
 // list, then we don't add it, and return LLDB_INVALID_BREAK_ID.
 
@@ -37,17 +83,16 @@ BreakpointSiteList::Add(const BreakpointSiteSP &bp)
 {
     lldb::addr_t bp_site_load_addr = bp->GetLoadAddress();
     Mutex::Locker locker(m_mutex);
-    collection::iterator iter = m_bp_site_list.find (bp_site_load_addr);
-
-    if (iter == m_bp_site_list.end())
-    {
-        m_bp_site_list.insert (iter, collection::value_type (bp_site_load_addr, bp));
-        return bp->GetID();
-    }
-    else
-    {
+    collection::const_iterator pos = LowerBound (*m_bp_site_list, bp_site_load_addr);
+    if (pos != m_bp_site_list->cend() && pos->load_addr == bp_site_load_addr)
         return LLDB_INVALID_BREAK_ID;
-    }
+
+    const size_t index = pos - m_bp_site_list->cbegin();
+    std::shared_ptr<collection> sites (CopyCollection());
+    SiteEntry entry = { bp_site_load_addr, bp->GetID(), bp };
+    sites->insert (sites->begin() + index, entry);
+    m_bp_site_list = sites;
+    return bp->GetID();
 }
 
 bool
@@ -68,13 +113,10 @@ BreakpointSiteList::ShouldStop (StoppointCallbackContext *context, lldb::break_i
 lldb::break_id_t
 BreakpointSiteList::FindIDByAddress (lldb::addr_t addr)
 {
-    BreakpointSiteSP bp = FindByAddress (addr);
-    if (bp)
-    {
-        //DBLogIf(PD_LOG_BREAKPOINTS, "BreakpointSiteList::%s ( addr = 0x%8.8" PRIx64 " ) => %u", __FUNCTION__, (uint64_t)addr, bp->GetID());
-        return bp.get()->GetID();
-    }
-    //DBLogIf(PD_LOG_BREAKPOINTS, "BreakpointSiteList::%s ( addr = 0x%8.8" PRIx64 " ) => NONE", __FUNCTION__, (uint64_t)addr);
+    CollectionSnapshot sites (GetSnapshot());
+    collection::const_iterator pos = FindAddressIterator (*sites, addr);
+    if (pos != sites->end())
+        return pos->id;
     return LLDB_INVALID_BREAK_ID;
 }
 
@@ -82,10 +124,13 @@ bool
 BreakpointSiteList::Remove (lldb::break_id_t break_id)
 {
     Mutex::Locker locker(m_mutex);
-    collection::iterator pos = GetIDIterator(break_id);    // Predicate
-    if (pos != m_bp_site_list.end())
+    collection::const_iterator pos = FindIDIterator (*m_bp_site_list, break_id);
+    if (pos != m_bp_site_list->cend())
     {
-        m_bp_site_list.erase(pos);
+        const size_t index = pos - m_bp_site_list->cbegin();
+        std::shared_ptr<collection> sites (CopyCollection());
+        sites->erase (sites->begin() + index);
+        m_bp_site_list = sites;
         return true;
     }
     return false;
@@ -95,56 +140,26 @@ bool
 BreakpointSiteList::RemoveByAddress (lldb::addr_t address)
 {
     Mutex::Locker locker(m_mutex);
-    collection::iterator pos =  m_bp_site_list.find(address);
-    if (pos != m_bp_site_list.end())
+    collection::const_iterator pos = FindAddressIterator (*m_bp_site_list, address);
+    if (pos != m_bp_site_list->cend())
     {
-        m_bp_site_list.erase(pos);
+        const size_t index = pos - m_bp_site_list->cbegin();
+        std::shared_ptr<collection> sites (CopyCollection());
+        sites->erase (sites->begin() + index);
+        m_bp_site_list = sites;
         return true;
     }
     return false;
 }
 
-class BreakpointSiteIDMatches
-{
-public:
-    BreakpointSiteIDMatches (lldb::break_id_t break_id) :
-        m_break_id(break_id)
-    {
-    }
-
-    bool operator() (std::pair <lldb::addr_t, BreakpointSiteSP> val_pair) const
-    {
-        return m_break_id == val_pair.second.get()->GetID();
-    }
-
-private:
-   const lldb::break_id_t m_break_id;
-};
-
-BreakpointSiteList::collection::iterator
-BreakpointSiteList::GetIDIterator (lldb::break_id_t break_id)
-{
-    Mutex::Locker locker(m_mutex);
-    return std::find_if(m_bp_site_list.begin(), m_bp_site_list.end(),   // Search full range
-                        BreakpointSiteIDMatches(break_id));             // Predicate
-}
-
-BreakpointSiteList::collection::const_iterator
-BreakpointSiteList::GetIDConstIterator (lldb::break_id_t break_id) const
-{
-    Mutex::Locker locker(m_mutex);
-    return std::find_if(m_bp_site_list.begin(), m_bp_site_list.end(),   // Search full range
-                        BreakpointSiteIDMatches(break_id));             // Predicate
-}
-
 BreakpointSiteSP
 BreakpointSiteList::FindByID (lldb::break_id_t break_id)
 {
-    Mutex::Locker locker(m_mutex);
+    CollectionSnapshot sites (GetSnapshot());
     BreakpointSiteSP stop_sp;
-    collection::iterator pos = GetIDIterator(break_id);
-    if (pos != m_bp_site_list.end())
-        stop_sp = pos->second;
+    collection::const_iterator pos = FindIDIterator (*sites, break_id);
+    if (pos != sites->end())
+        stop_sp = pos->site_sp;
 
     return stop_sp;
 }
@@ -152,11 +167,11 @@ BreakpointSiteList::FindByID (lldb::break_id_t break_id)
 const BreakpointSiteSP
 BreakpointSiteList::FindByID (lldb::break_id_t break_id) const
 {
-    Mutex::Locker locker(m_mutex);
+    CollectionSnapshot sites (GetSnapshot());
     BreakpointSiteSP stop_sp;
-    collection::const_iterator pos = GetIDConstIterator(break_id);
-    if (pos != m_bp_site_list.end())
-        stop_sp = pos->second;
+    collection::const_iterator pos = FindIDIterator (*sites, break_id);
+    if (pos != sites->end())
+        stop_sp = pos->site_sp;
 
     return stop_sp;
 }
@@ -164,21 +179,21 @@ BreakpointSiteList::FindByID (lldb::break_id_t break_id) const
 BreakpointSiteSP
 BreakpointSiteList::FindByAddress (lldb::addr_t addr)
 {
+    CollectionSnapshot sites (GetSnapshot());
     BreakpointSiteSP found_sp;
-    Mutex::Locker locker(m_mutex);
-    collection::iterator iter =  m_bp_site_list.find(addr);
-    if (iter != m_bp_site_list.end())
-        found_sp = iter->second;
+    collection::const_iterator pos = FindAddressIterator (*sites, addr);
+    if (pos != sites->end())
+        found_sp = pos->site_sp;
     return found_sp;
 }
 
 bool
 BreakpointSiteList::BreakpointSiteContainsBreakpoint (lldb::break_id_t bp_site_id, lldb::break_id_t bp_id)
 {
-    Mutex::Locker locker(m_mutex);
-    collection::const_iterator pos = GetIDConstIterator(bp_site_id);
-    if (pos != m_bp_site_list.end())
-        return pos->second->IsBreakpointAtThisSite (bp_id);
+    CollectionSnapshot sites (GetSnapshot());
+    collection::const_iterator pos = FindIDIterator (*sites, bp_site_id);
+    if (pos != sites->end())
+        return pos->site_sp->IsBreakpointAtThisSite (bp_id);
 
     return false;
 }
@@ -186,55 +201,63 @@ BreakpointSiteList::BreakpointSiteContainsBreakpoint (lldb::break_id_t bp_site_i
 void
 BreakpointSiteList::Dump (Stream *s) const
 {
+    CollectionSnapshot sites (GetSnapshot());
     s->Printf("%p: ", static_cast<const void*>(this));
     //s->Indent();
-    s->Printf("BreakpointSiteList with %u BreakpointSites:\n", (uint32_t)m_bp_site_list.size());
+    s->Printf("BreakpointSiteList with %u BreakpointSites:\n", (uint32_t)sites->size());
     s->IndentMore();
-    collection::const_iterator pos;
-    collection::const_iterator end = m_bp_site_list.end();
-    for (pos = m_bp_site_list.begin(); pos != end; ++pos)
-        pos->second.get()->Dump(s);
+    for (const SiteEntry &entry : *sites)
+        entry.site_sp->Dump(s);
     s->IndentLess();
 }
 
 void
 BreakpointSiteList::ForEach (std::function <void(BreakpointSite *)> const &callback)
 {
+    // The snapshot keeps the sites we are visiting alive even if the
+    // callback removes them from the list.
     Mutex::Locker locker(m_mutex);
-    for (auto pair : m_bp_site_list)
-        callback (pair.second.get());
+    CollectionSnapshot sites (m_bp_site_list);
+    for (const SiteEntry &entry : *sites)
+        callback (entry.site_sp.get());
 }
 
-bool
-BreakpointSiteList::FindInRange (lldb::addr_t lower_bound, lldb::addr_t upper_bound, BreakpointSiteList &bp_site_list) const
+size_t
+BreakpointSiteList::ForEachInRange (lldb::addr_t lower_bound,
+                                    lldb::addr_t upper_bound,
+                                    std::function <void(BreakpointSite *)> const &callback) const
 {
-    if (lower_bound > upper_bound)
-        return false;
-    
-    Mutex::Locker locker(m_mutex);
-    collection::const_iterator lower, upper, pos;
-    lower = m_bp_site_list.lower_bound(lower_bound);
-    if (lower == m_bp_site_list.end()
-            || (*lower).first >= upper_bound)
-        return false;
-    
+    if (lower_bound >= upper_bound)
+        return 0;
+
+    CollectionSnapshot sites (GetSnapshot());
+    collection::const_iterator pos = LowerBound (*sites, lower_bound);
+
     // This is one tricky bit.  The breakpoint might overlap the bottom end of the range.  So we grab the
     // breakpoint prior to the lower bound, and check that that + its byte size isn't in our range.
-    if (lower != m_bp_site_list.begin())
+    if (pos != sites->begin())
     {
-        collection::const_iterator prev_pos = lower;
-        prev_pos--;
-        const BreakpointSiteSP &prev_bp = (*prev_pos).second;
-        if (prev_bp->GetLoadAddress() + prev_bp->GetByteSize() > lower_bound)
-            bp_site_list.Add (prev_bp);
-        
+        collection::const_iterator prev_pos = pos - 1;
+        if (prev_pos->load_addr + prev_pos->site_sp->GetByteSize() > lower_bound)
+            pos = prev_pos;
     }
-    
-    upper = m_bp_site_list.upper_bound(upper_bound);
-        
-    for (pos = lower; pos != upper; pos++)
+
+    size_t num_visited = 0;
+    for (collection::const_iterator end = sites->end(); pos != end && pos->load_addr < upper_bound; ++pos)
     {
-        bp_site_list.Add ((*pos).second);
+        callback (pos->site_sp.get());
+        ++num_visited;
     }
-    return true;
+    return num_visited;
+}
+
+bool
+BreakpointSiteList::FindInRange (lldb::addr_t lower_bound, lldb::addr_t upper_bound, BreakpointSiteList &bp_site_list) const
+{
+    const size_t num_found = ForEachInRange (lower_bound,
+                                             upper_bound,
+                                             [&bp_site_list](BreakpointSite *bp_site) -> void {
+                                                 bp_site_list.Add (bp_site->shared_from_this());
+                                             });
+    return num_found > 0;
 }
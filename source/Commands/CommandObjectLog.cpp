@@ -147,6 +147,8 @@ public:
             case 'n':  log_options |= LLDB_LOG_OPTION_PREPEND_THREAD_NAME;    break;
             case 'S':  log_options |= LLDB_LOG_OPTION_BACKTRACE;              break;
             case 'a':  log_options |= LLDB_LOG_OPTION_APPEND;                 break;
+            case 'A':  log_options |= LLDB_LOG_OPTION_ASYNC;                  break;
+            case 'r':  log_options |= LLDB_LOG_OPTION_RING_BUFFER;            break;
             default:
                 error.SetErrorStringWithFormat ("unrecognized option '%c'", short_option);
                 break;
@@ -225,6 +227,8 @@ CommandObjectLogEnable::CommandOptions::g_option_table[] =
 { LLDB_OPT_SET_1, false, "thread-name",'n', OptionParser::eNoArgument,       NULL, NULL, 0, eArgTypeNone,       "Prepend all log lines with the thread name for the thread that generates the log line." },
 { LLDB_OPT_SET_1, false, "stack",      'S', OptionParser::eNoArgument,       NULL, NULL, 0, eArgTypeNone,       "Append a stack backtrace to each log line." },
 { LLDB_OPT_SET_1, false, "append",     'a', OptionParser::eNoArgument,       NULL, NULL, 0, eArgTypeNone,       "Append to the log file instead of overwriting." },
+{ LLDB_OPT_SET_1, false, "async",      'A', OptionParser::eNoArgument,       NULL, NULL, 0, eArgTypeNone,       "Write log lines from a background thread so logging threads never wait for the log file." },
+{ LLDB_OPT_SET_1, false, "ring-buffer",'r', OptionParser::eNoArgument,       NULL, NULL, 0, eArgTypeNone,       "Keep only the most recent log lines in memory and write them out when an error is logged." },
 { 0, false, NULL,                       0,  0,                 NULL, NULL, 0, eArgTypeNone,       NULL }
 };
 
@@ -394,7 +398,7 @@ public:
         CommandObjectParsed (interpreter,
                            "log timers",
                            "Enable, disable, dump, and reset LLDB internal performance timers.",
-                           "log timers < enable <depth> | disable | dump | increment <bool> | reset >")
+                           "log timers < enable <depth> | disable | dump | tree | export <file> | increment <bool> | reset >")
     {
     }
 
@@ -431,6 +435,11 @@ protected:
                 Timer::DumpCategoryTimes (&result.GetOutputStream());
                 result.SetStatus(eReturnStatusSuccessFinishResult);
             }
+            else if (strcasecmp(sub_command, "tree") == 0)
+            {
+                Timer::DumpCallTree (&result.GetOutputStream());
+                result.SetStatus(eReturnStatusSuccessFinishResult);
+            }
             else if (strcasecmp(sub_command, "reset") == 0)
             {
                 Timer::ResetCategoryTimes ();
@@ -454,7 +463,7 @@ protected:
                 else
                     result.AppendError("Could not convert enable depth to an unsigned integer.");
             }
-            if (strcasecmp(sub_command, "increment") == 0)
+            else if (strcasecmp(sub_command, "increment") == 0)
             {
                 bool success;
                 bool increment = Args::StringToBoolean(args.GetArgumentAtIndex(1), false, &success);
@@ -466,6 +475,22 @@ protected:
                 else
                     result.AppendError("Could not convert increment value to boolean.");
             }
+            else if (strcasecmp(sub_command, "export") == 0)
+            {
+                // Write the timers in the Chrome trace event format
+                const char *path = args.GetArgumentAtIndex(1);
+                StreamFile trace_stream (path,
+                                         File::eOpenOptionWrite | File::eOpenOptionCanCreate | File::eOpenOptionTruncate | File::eOpenOptionCloseOnExec,
+                                         lldb::eFilePermissionsFileDefault);
+                if (trace_stream.GetFile().IsValid())
+                {
+                    Timer::DumpTraceEvents (&trace_stream);
+                    result.AppendMessageWithFormat ("Wrote timer trace events to '%s'.\n", path);
+                    result.SetStatus(eReturnStatusSuccessFinishResult);
+                }
+                else
+                    result.AppendErrorWithFormat("Unable to open '%s' for writing.", path);
+            }
         }
         
         if (!result.Succeeded())
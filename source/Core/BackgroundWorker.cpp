@@ -0,0 +1,170 @@
+//===-- BackgroundWorker.cpp ------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Core/BackgroundWorker.h"
+
+#include <algorithm>
+
+#include "lldb/Host/ThreadLauncher.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+BackgroundWorker::BackgroundWorker (const char *thread_name) :
+    m_thread_name (thread_name),
+    m_mutex (Mutex::eMutexTypeNormal),
+    m_queued_condition (),
+    m_finished_condition (),
+    m_posted (),
+    m_queue (),
+    m_running_job_sp (),
+    m_stop (false),
+    m_num_dispatched (0),
+    m_num_finished (0),
+    m_thread ()
+{
+}
+
+BackgroundWorker::~BackgroundWorker ()
+{
+    CancelAll ();
+    if (m_thread.IsJoinable())
+    {
+        {
+            Mutex::Locker locker (m_mutex);
+            m_stop = true;
+            m_queued_condition.Signal();
+        }
+        m_thread.Join (NULL);
+    }
+}
+
+BackgroundWorker::JobSP
+BackgroundWorker::Post (const Work &work)
+{
+    if (!work)
+        return JobSP();
+
+    Mutex::Locker locker (m_mutex);
+    if (!m_thread.IsJoinable())
+    {
+        m_thread = ThreadLauncher::LaunchThread (m_thread_name, WorkerThread, this, NULL);
+        if (!m_thread.IsJoinable())
+            return JobSP();
+    }
+    JobSP job_sp (new Job (work));
+    m_posted.push_back (job_sp);
+    return job_sp;
+}
+
+void
+BackgroundWorker::Dispatch ()
+{
+    Mutex::Locker locker (m_mutex);
+    if (m_posted.empty())
+        return;
+    m_num_dispatched += m_posted.size();
+    m_queue.insert (m_queue.end(), m_posted.begin(), m_posted.end());
+    m_posted.clear();
+    m_queued_condition.Signal();
+}
+
+void
+BackgroundWorker::FinishJob (const JobSP &job_sp)
+{
+    job_sp->m_work = Work();
+    job_sp->m_done = true;
+    --m_num_dispatched;
+    ++m_num_finished;
+    m_finished_condition.Broadcast();
+}
+
+void
+BackgroundWorker::Cancel (const JobSP &job_sp)
+{
+    if (!job_sp)
+        return;
+
+    Mutex::Locker locker (m_mutex);
+    job_sp->m_cancel = true;
+    if (job_sp->m_done || job_sp == m_running_job_sp)
+        return;
+
+    std::deque<JobSP>::iterator pos = std::find (m_posted.begin(), m_posted.end(), job_sp);
+    if (pos != m_posted.end())
+    {
+        // Never dispatched, so it doesn't count as finished
+        m_posted.erase (pos);
+        job_sp->m_work = Work();
+        job_sp->m_done = true;
+        return;
+    }
+
+    pos = std::find (m_queue.begin(), m_queue.end(), job_sp);
+    if (pos != m_queue.end())
+    {
+        m_queue.erase (pos);
+        FinishJob (job_sp);
+    }
+}
+
+void
+BackgroundWorker::CancelAll ()
+{
+    Mutex::Locker locker (m_mutex);
+    for (const JobSP &job_sp : m_posted)
+    {
+        job_sp->m_cancel = true;
+        job_sp->m_work = Work();
+        job_sp->m_done = true;
+    }
+    m_posted.clear();
+
+    for (const JobSP &job_sp : m_queue)
+    {
+        job_sp->m_cancel = true;
+        FinishJob (job_sp);
+    }
+    m_queue.clear();
+
+    if (m_running_job_sp)
+        m_running_job_sp->m_cancel = true;
+    while (m_running_job_sp)
+        m_finished_condition.Wait (m_mutex);
+}
+
+lldb::thread_result_t
+BackgroundWorker::WorkerThread (lldb::thread_arg_t arg)
+{
+    BackgroundWorker *worker = (BackgroundWorker *)arg;
+
+    while (true)
+    {
+        JobSP job_sp;
+        {
+            Mutex::Locker locker (worker->m_mutex);
+            while (worker->m_queue.empty() && !worker->m_stop)
+                worker->m_queued_condition.Wait (worker->m_mutex);
+            if (worker->m_stop)
+                break;
+            job_sp = worker->m_queue.front();
+            worker->m_queue.pop_front();
+            worker->m_running_job_sp = job_sp;
+        }
+
+        // Run the job without the lock so it can be cancelled
+        if (!job_sp->m_cancel)
+            job_sp->m_work (job_sp->m_cancel);
+
+        Mutex::Locker locker (worker->m_mutex);
+        worker->m_running_job_sp.reset();
+        worker->FinishJob (job_sp);
+    }
+    return NULL;
+}
@@ -11,6 +11,7 @@
 
 #include "lldb/Core/Debugger.h"
 
+#include <algorithm>
 #include <map>
 
 #include "clang/AST/DeclCXX.h"
@@ -26,6 +27,7 @@
 #include "lldb/Core/StreamAsynchronousIO.h"
 #include "lldb/Core/StreamCallback.h"
 #include "lldb/Core/StreamFile.h"
+#include "lldb/Core/StreamLogBuffer.h"
 #include "lldb/Core/StreamString.h"
 #include "lldb/Core/StructuredData.h"
 #include "lldb/Core/Timer.h"
@@ -53,6 +55,7 @@
 #include "lldb/Target/Process.h"
 #include "lldb/Target/RegisterContext.h"
 #include "lldb/Target/SectionLoadList.h"
+#include "lldb/Target/StackFrame.h"
 #include "lldb/Target/StopInfo.h"
 #include "lldb/Target/Target.h"
 #include "lldb/Target/Thread.h"
@@ -161,6 +164,7 @@ g_properties[] =
 {   "use-color",                OptionValue::eTypeBoolean     , true, true , NULL, NULL, "Whether to use Ansi color codes or not." },
 {   "auto-one-line-summaries",  OptionValue::eTypeBoolean     , true, true, NULL, NULL, "If true, LLDB will automatically display small structs in one-liner format (default: true)." },
 {   "escape-non-printables",    OptionValue::eTypeBoolean     , true, true, NULL, NULL, "If true, LLDB will automatically escape non-printable and escape characters when formatting strings." },
+{   "script-lightweight-callbacks", OptionValue::eTypeBoolean , true, false, NULL, NULL, "If true, breakpoint and watchpoint callbacks and data formatter scripts keep the script session bound between calls instead of setting it up and tearing it down each time (default: false)." },
 {   NULL,                       OptionValue::eTypeInvalid     , true, 0    , NULL, NULL, NULL }
 };
 
@@ -181,7 +185,8 @@ enum
     ePropertyUseExternalEditor,
     ePropertyUseColor,
     ePropertyAutoOneLineSummaries,
-    ePropertyEscapeNonPrintables
+    ePropertyEscapeNonPrintables,
+    ePropertyScriptLightweightCallbacks
 };
 
 LoadPluginCallbackType Debugger::g_load_plugin_callback = NULL;
@@ -396,6 +401,13 @@ Debugger::GetEscapeNonPrintables () const
     return m_collection_sp->GetPropertyAtIndexAsBoolean (NULL, idx, true);
 }
 
+bool
+Debugger::GetScriptLightweightCallbacks () const
+{
+    const uint32_t idx = ePropertyScriptLightweightCallbacks;
+    return m_collection_sp->GetPropertyAtIndexAsBoolean (NULL, idx, false);
+}
+
 #pragma mark Debugger
 
 //const DebuggerPropertiesSP &
@@ -1295,27 +1307,53 @@ Debugger::SetLoggingCallback (lldb::LogOutputCallback log_callback, void *baton)
     m_log_callback_stream_sp.reset (new StreamCallback (log_callback, baton));
 }
 
+// Put a StreamLogBuffer in front of stream_sp if buffer_options asks for one
+static StreamSP
+CreateLogBuffer (const StreamSP &stream_sp, uint32_t buffer_options)
+{
+    if (buffer_options & LLDB_LOG_OPTION_RING_BUFFER)
+        return StreamSP (new StreamLogBuffer (stream_sp, StreamLogBuffer::eModeRingBuffer));
+    if (buffer_options & LLDB_LOG_OPTION_ASYNC)
+        return StreamSP (new StreamLogBuffer (stream_sp, StreamLogBuffer::eModeAsynchronous));
+    return stream_sp;
+}
+
 bool
 Debugger::EnableLog (const char *channel, const char **categories, const char *log_file, uint32_t log_options, Stream &error_stream)
 {
     Log::Callbacks log_callbacks;
 
+    // The ring buffer option wins if both buffering options are set
+    uint32_t buffer_options = log_options & (LLDB_LOG_OPTION_ASYNC | LLDB_LOG_OPTION_RING_BUFFER);
+    if (buffer_options & LLDB_LOG_OPTION_RING_BUFFER)
+        buffer_options = LLDB_LOG_OPTION_RING_BUFFER;
+
     StreamSP log_stream_sp;
     if (m_log_callback_stream_sp)
     {
-        log_stream_sp = m_log_callback_stream_sp;
+        log_stream_sp = CreateLogBuffer (m_log_callback_stream_sp, buffer_options);
         // For now when using the callback mode you always get thread & timestamp.
         log_options |= LLDB_LOG_OPTION_PREPEND_TIMESTAMP | LLDB_LOG_OPTION_PREPEND_THREAD_NAME;
     }
     else if (log_file == NULL || *log_file == '\0')
     {
-        log_stream_sp = GetOutputFile();
+        log_stream_sp = CreateLogBuffer (GetOutputFile(), buffer_options);
     }
     else
     {
+        // All channels that log to the same file share one stream, and with
+        // it one StreamLogBuffer, so a single writer writes their records
+        // in the order they were logged.
         LogStreamMap::iterator pos = m_log_streams.find(log_file);
         if (pos != m_log_streams.end())
-            log_stream_sp = pos->second.lock();
+        {
+            log_stream_sp = pos->second.stream_wp.lock();
+            if (log_stream_sp && pos->second.buffer_options != buffer_options)
+            {
+                error_stream.Printf ("warning: log file '%s' is already in use, keeping the buffering it was first enabled with.\n", log_file);
+                buffer_options = pos->second.buffer_options;
+            }
+        }
         if (!log_stream_sp)
         {
             uint32_t options = File::eOpenOptionWrite | File::eOpenOptionCanCreate
@@ -1324,10 +1362,14 @@ Debugger::EnableLog (const char *channel, const char **categories, const char *l
                 options |= File::eOpenOptionTruncate;
 
             log_stream_sp.reset (new StreamFile (log_file, options));
-            m_log_streams[log_file] = log_stream_sp;
+            log_stream_sp = CreateLogBuffer (log_stream_sp, buffer_options);
+            LogStreamInfo &log_stream_info = m_log_streams[log_file];
+            log_stream_info.stream_wp = log_stream_sp;
+            log_stream_info.buffer_options = buffer_options;
         }
     }
     assert (log_stream_sp.get());
+    log_options = (log_options & ~(LLDB_LOG_OPTION_ASYNC | LLDB_LOG_OPTION_RING_BUFFER)) | buffer_options;
     
     if (log_options == 0)
         log_options = LLDB_LOG_OPTION_PREPEND_THREAD_NAME | LLDB_LOG_OPTION_THREADSAFE;
@@ -1494,6 +1536,33 @@ Debugger::HandleProcessEvent (const EventSP &event_sp)
     StreamString error_stream;
     const bool gui_enabled = IsForwardingEvents();
 
+    if ((event_type & Process::eBroadcastBitStateChanged) && process_sp &&
+        Process::ProcessEventData::GetStateFromEvent (event_sp.get()) == eStateStopped &&
+        !Process::ProcessEventData::GetRestartedFromEvent (event_sp.get()))
+    {
+        // Start loading the source files for the threads that stopped on a
+        // background thread so showing them doesn't wait on the file system.
+        // Only threads with a stop reason are used, since unwinding every
+        // thread here would slow down each stop.
+        std::vector<FileSpec> file_specs;
+        ThreadList &thread_list = process_sp->GetThreadList();
+        ThreadSP selected_thread_sp (thread_list.GetSelectedThread());
+        const uint32_t num_threads = thread_list.GetSize();
+        for (uint32_t thread_idx = 0; thread_idx < num_threads; ++thread_idx)
+        {
+            ThreadSP thread_sp (thread_list.GetThreadAtIndex (thread_idx));
+            if (!thread_sp || (thread_sp != selected_thread_sp && !thread_sp->GetStopInfo()))
+                continue;
+            StackFrameSP frame_sp (thread_sp->GetStackFrameAtIndex (0));
+            if (!frame_sp)
+                continue;
+            const SymbolContext &sc = frame_sp->GetSymbolContext (eSymbolContextLineEntry);
+            if (sc.line_entry.file && std::find (file_specs.begin(), file_specs.end(), sc.line_entry.file) == file_specs.end())
+                file_specs.push_back (sc.line_entry.file);
+        }
+        m_source_file_cache.PrefetchSourceFiles (file_specs);
+    }
+
     if (!gui_enabled)
     {
         bool pop_process_io_handler = false;
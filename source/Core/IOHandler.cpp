@@ -10,7 +10,10 @@
 
 #include "lldb/lldb-python.h"
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include "lldb/Breakpoint/BreakpointLocation.h"
 #include "lldb/Core/IOHandler.h"
@@ -808,6 +811,7 @@ IOHandlerEditline::GotEOF()
 // for instance, windows
 #ifndef LLDB_DISABLE_CURSES
 
+#include "lldb/Core/BackgroundWorker.h"
 #include "lldb/Core/ValueObject.h"
 #include "lldb/Symbol/VariableList.h"
 #include "lldb/Target/Target.h"
@@ -1154,6 +1158,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
             m_prev_active_window_idx (UINT32_MAX),
             m_delete (false),
             m_needs_update (true),
+            m_drawn_active (false),
             m_can_activate (true),
             m_is_subwin (false)
         {
@@ -1170,6 +1175,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
             m_prev_active_window_idx (UINT32_MAX),
             m_delete (del),
             m_needs_update (true),
+            m_drawn_active (false),
             m_can_activate (true),
             m_is_subwin (false)
         {
@@ -1187,6 +1193,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
             m_prev_active_window_idx (UINT32_MAX),
             m_delete (true),
             m_needs_update (true),
+            m_drawn_active (false),
             m_can_activate (true),
             m_is_subwin (false)
         {
@@ -1223,6 +1230,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
                 m_panel = ::new_panel (m_window);
                 m_delete = del;
             }
+            m_needs_update = true;
         }
         
         void    AttributeOn (attr_t attr)   { ::wattron (m_window, attr); }
@@ -1308,6 +1316,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
                     MoveWindow(bounds.origin);
                 Resize (bounds.size);
             }
+            m_needs_update = true;
         }
 
         void
@@ -1483,6 +1492,16 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
         virtual void
         Draw (bool force)
         {
+            // A window is damaged if it was created, resized or handled a key
+            // since it was last drawn, or if it gained or lost focus (the title
+            // box is bold when active). Subwindows share memory with their
+            // parent, so a damaged window forces its subwindows to redraw too.
+            const bool is_active = IsActive();
+            if (m_needs_update || is_active != m_drawn_active)
+                force = true;
+            m_needs_update = false;
+            m_drawn_active = is_active;
+
             if (m_delegate_sp && m_delegate_sp->WindowDelegateDraw (*this, force))
                 return;
 
@@ -1563,7 +1582,10 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
             {
                 result = m_delegate_sp->WindowDelegateHandleChar (*this, key);
                 if (result != eKeyNotHandled)
+                {
+                    m_needs_update = true;
                     return result;
+                }
             }
 
             // Then check for any windows that want any keys
@@ -1751,6 +1773,7 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
         uint32_t m_prev_active_window_idx;
         bool m_delete;
         bool m_needs_update;
+        bool m_drawn_active;
         bool m_can_activate;
         bool m_is_subwin;
         
@@ -2334,6 +2357,191 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
         return result;
     }
 
+    //----------------------------------------------------------------------
+    /// @class DisplayGeneration
+    ///
+    /// Remembers what the data a window last displayed was derived from:
+    /// the process stop and memory IDs, the selected thread and frame and
+    /// the window size. Windows whose contents are expensive to compute
+    /// check this before redrawing and leave their previous contents on
+    /// screen when nothing they depend on has changed.
+    //----------------------------------------------------------------------
+    class DisplayGeneration
+    {
+    public:
+        DisplayGeneration () :
+            m_values (),
+            m_valid (false)
+        {
+        }
+
+        //------------------------------------------------------------------
+        /// Record the current generation.
+        ///
+        /// @return
+        ///     \b true if the generation differs from the one recorded by
+        ///     the previous call, \b false otherwise.
+        //------------------------------------------------------------------
+        bool
+        Update (const ExecutionContext &exe_ctx, Window &window)
+        {
+            std::vector<uint64_t> values;
+            values.push_back (window.GetWidth());
+            values.push_back (window.GetHeight());
+
+            Process *process = exe_ctx.GetProcessPtr();
+            values.push_back (process ? process->GetID() : LLDB_INVALID_PROCESS_ID);
+            values.push_back (process ? process->GetState() : eStateInvalid);
+            values.push_back (process ? process->GetModID().GetStopID() : 0);
+            values.push_back (process ? process->GetModID().GetMemoryID() : 0);
+
+            Thread *thread = exe_ctx.GetThreadPtr();
+            values.push_back (thread ? thread->GetID() : LLDB_INVALID_THREAD_ID);
+
+            StackFrame *frame = exe_ctx.GetFramePtr();
+            values.push_back (frame ? frame->GetFrameIndex() : UINT32_MAX);
+            values.push_back (frame ? frame->GetStackID().GetPC() : LLDB_INVALID_ADDRESS);
+            values.push_back (frame ? frame->GetStackID().GetCallFrameAddress() : LLDB_INVALID_ADDRESS);
+
+            if (m_valid && values == m_values)
+                return false;
+            m_values.swap (values);
+            m_valid = true;
+            return true;
+        }
+
+    protected:
+        std::vector<uint64_t> m_values;
+        bool m_valid;
+    };
+
+    //----------------------------------------------------------------------
+    /// @class BackgroundFill
+    ///
+    /// Runs the expensive part of populating a window (reading variable
+    /// values, unwinding stacks) as a job on a background worker so the UI
+    /// stays responsive.
+    ///
+    /// All fills share one worker thread that runs them one at a time, since
+    /// the threads, frame lists and register contexts they use aren't safe
+    /// to use from several threads at once. For the same reason the UI thread
+    /// leaves the target alone while the worker is busy: the main loop only
+    /// draws when IsWorkerBusy() is false, and cancels the fills and waits
+    /// for the running one before it dispatches a key. Windows post their
+    /// fills while drawing, and the main loop dispatches them once all
+    /// windows are drawn. Each fill holds the process run lock while it runs
+    /// so the process can't resume underneath it.
+    //----------------------------------------------------------------------
+    class BackgroundFill
+    {
+    public:
+        typedef BackgroundWorker::Work Work;
+
+        BackgroundFill () :
+            m_job_sp (),
+            m_started (false)
+        {
+        }
+
+        ~BackgroundFill ()
+        {
+            Cancel ();
+        }
+
+        bool
+        Start (const ProcessSP &process_sp, const Work &work)
+        {
+            Cancel ();
+            Reap ();
+            if (!process_sp || !work)
+                return false;
+
+            ProcessWP process_wp (process_sp);
+            m_job_sp = GetWorker().Post ([process_wp, work](const std::atomic<bool> &cancel)
+            {
+                ProcessSP process_sp (process_wp.lock());
+                if (!process_sp)
+                    return;
+                Process::StopLocker stop_locker;
+                if (stop_locker.TryLock (&process_sp->GetRunLock()))
+                    work (cancel);
+            });
+            // If the worker can't be started the caller does the work
+            // synchronously
+            m_started = (bool)m_job_sp;
+            return m_started;
+        }
+
+        bool
+        IsRunning () const
+        {
+            return m_job_sp && !m_job_sp->IsDone();
+        }
+
+        //------------------------------------------------------------------
+        /// @return
+        ///     \b true once after a fill started with Start() has stopped,
+        ///     either because its work completed or it was cancelled.
+        //------------------------------------------------------------------
+        bool
+        Reap ()
+        {
+            if (!m_started || IsRunning())
+                return false;
+            m_job_sp.reset();
+            m_started = false;
+            return true;
+        }
+
+        //------------------------------------------------------------------
+        /// Cancel the fill without waiting for it. The objects it uses must
+        /// not be touched until IsWorkerBusy() returns false.
+        //------------------------------------------------------------------
+        void
+        Cancel ()
+        {
+            if (m_job_sp)
+                GetWorker().Cancel (m_job_sp);
+        }
+
+        static void
+        CancelAll ()
+        {
+            GetWorker().CancelAll ();
+        }
+
+        static void
+        DispatchAll ()
+        {
+            GetWorker().Dispatch ();
+        }
+
+        static bool
+        IsWorkerBusy ()
+        {
+            return GetWorker().IsBusy ();
+        }
+
+        static uint32_t
+        GetFinishedCount ()
+        {
+            return GetWorker().GetFinishedCount ();
+        }
+
+    protected:
+        static BackgroundWorker &
+        GetWorker ()
+        {
+            static BackgroundWorker g_worker ("<lldb.gui.background-fill>");
+            return g_worker;
+        }
+
+        BackgroundWorker::JobSP m_job_sp;
+        bool m_started;
+
+    private:
+        DISALLOW_COPY_AND_ASSIGN(BackgroundFill);
+    };
 
     class Application
     {
@@ -2402,14 +2610,25 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
             debugger.EnableForwardEvents (listener_sp);
 
             bool update = true;
+            bool update_exe_ctx = false;
+            uint32_t background_fill_finished_count = BackgroundFill::GetFinishedCount();
 #if defined(__APPLE__)
             std::deque<int> escape_chars;
 #endif
             
             while (!done)
             {
-                if (update)
+                // Drawing reads from the target, which the background fills
+                // are using while the worker is busy. The windows that wait
+                // on fills show a placeholder until then.
+                if (update && !BackgroundFill::IsWorkerBusy())
                 {
+                    if (update_exe_ctx)
+                    {
+                        debugger.GetCommandInterpreter().UpdateExecutionContext(NULL);
+                        update_exe_ctx = false;
+                    }
+
                     m_window_sp->Draw(false);
                     // All windows should be calling Window::DeferredRefresh() instead
                     // of Window::Refresh() so we can do a single update and avoid
@@ -2421,6 +2640,9 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
 
                     doupdate();
                     update = false;
+
+                    // Start the fills the windows posted while drawing
+                    BackgroundFill::DispatchAll();
                 }
                 
 #if defined(__APPLE__)
@@ -2483,17 +2705,34 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
                                     ConstString broadcaster_class (broadcaster->GetBroadcasterClass());
                                     if (broadcaster_class == broadcaster_class_process)
                                     {
-                                        debugger.GetCommandInterpreter().UpdateExecutionContext(NULL);
+                                        update_exe_ctx = true;
                                         update = true;
                                         continue; // Don't get any key, just update our view
                                     }
                                 }
                             }
                         }
+
+                        // Redraw the windows whose background fills have finished
+                        if (background_fill_finished_count != BackgroundFill::GetFinishedCount())
+                        {
+                            background_fill_finished_count = BackgroundFill::GetFinishedCount();
+                            update = true;
+                        }
                     }
                 }
                 else
                 {
+                    // Handling the key uses the target and might resume the
+                    // process, neither of which can happen while a background
+                    // fill is running. Fills only stop at cancellation points
+                    // between values and frames, so this waits briefly at most.
+                    BackgroundFill::CancelAll();
+                    if (update_exe_ctx)
+                    {
+                        debugger.GetCommandInterpreter().UpdateExecutionContext(NULL);
+                        update_exe_ctx = false;
+                    }
                     HandleCharResult key_result = m_window_sp->HandleChar(ch);
                     switch (key_result)
                     {
@@ -2510,6 +2749,8 @@ type summary add -s "${var.origin%S} ${var.size%S}" curses::Rect
                 }
             }
             
+            // Don't leave fills holding the process after the GUI is gone
+            BackgroundFill::CancelAll();
             debugger.CancelForwardEvents (listener_sp);
 
         }
@@ -2680,6 +2921,10 @@ public:
     virtual void TreeDelegateDrawTreeItem (TreeItem &item, Window &window) = 0;
     virtual void TreeDelegateGenerateChildren (TreeItem &item) = 0;
     virtual bool TreeDelegateItemSelected (TreeItem &item) = 0; // Return true if we need to update views
+    // Work to warm the caches "item" and its children are drawn from. This
+    // is called on the UI thread but the work runs on a background thread
+    // so it must not touch any TreeItem.
+    virtual BackgroundFill::Work TreeDelegateGetBackgroundWork (TreeItem &item) { return BackgroundFill::Work(); }
 };
 typedef std::shared_ptr<TreeDelegate> TreeDelegateSP;
 
@@ -2987,6 +3232,8 @@ public:
     TreeWindowDelegate (Debugger &debugger, const TreeDelegateSP &delegate_sp) :
         m_debugger (debugger),
         m_delegate_sp (delegate_sp),
+        m_generation (),
+        m_fill (),
         m_root (NULL, *delegate_sp, true),
         m_selected_item (NULL),
         m_num_rows (0),
@@ -3026,6 +3273,14 @@ public:
             }
         }
 
+        const bool changed = m_generation.Update (exe_ctx, window);
+        if (changed)
+            m_fill.Cancel();
+        if (m_fill.Reap())
+            force = true; // Replace the placeholder drawn while filling
+        if (!changed && !force)
+            return true; // Nothing we display has changed since the last draw
+
         m_min_x = 2;
         m_min_y = 1;
         m_max_x = window.GetWidth() - 1;
@@ -3034,7 +3289,18 @@ public:
         window.Erase();
         window.DrawTitleBox (window.GetName());
 
-        if (display_content)
+        // Unwinding every thread can be slow, so do it in the background
+        // when the process stops and show a placeholder until it is done
+        if (display_content && changed)
+            m_fill.Start (exe_ctx.GetProcessSP(), m_delegate_sp->TreeDelegateGetBackgroundWork (m_root));
+
+        if (m_fill.IsRunning())
+        {
+            window.MoveCursor (2, 1);
+            window.PutCStringTruncated ("Updating...", 1);
+            m_selected_item = NULL;
+        }
+        else if (display_content)
         {
             const int num_visible_rows = NumVisibleRows();
             m_num_rows = 0;
@@ -3199,6 +3465,8 @@ public:
 protected:
     Debugger &m_debugger;
     TreeDelegateSP m_delegate_sp;
+    DisplayGeneration m_generation;
+    BackgroundFill m_fill;
     TreeItem m_root;
     TreeItem *m_selected_item;
     int m_num_rows;
@@ -3473,6 +3741,46 @@ public:
     {
         return false;
     }
+
+    virtual BackgroundFill::Work
+    TreeDelegateGetBackgroundWork (TreeItem &item)
+    {
+        ProcessSP process_sp = GetProcess ();
+        if (!process_sp || !process_sp->IsAlive())
+            return BackgroundFill::Work();
+
+        // Only expanded threads have their frames drawn, so only unwind those
+        std::vector<lldb::tid_t> expanded_tids;
+        const size_t num_threads = item.GetNumChildren();
+        for (size_t i=0; i<num_threads; ++i)
+        {
+            if (item[i].IsExpanded())
+                expanded_tids.push_back (item[i].GetIdentifier());
+        }
+
+        return [process_sp, expanded_tids](const std::atomic<bool> &cancel)
+        {
+            ThreadList &threads = process_sp->GetThreadList();
+            const uint32_t num_threads = threads.GetSize();
+            for (uint32_t thread_idx = 0; thread_idx < num_threads && !cancel; ++thread_idx)
+            {
+                ThreadSP thread_sp = threads.GetThreadAtIndex (thread_idx);
+                if (!thread_sp)
+                    continue;
+                // Every thread row shows its stop reason
+                thread_sp->GetStopInfo();
+                if (std::find (expanded_tids.begin(), expanded_tids.end(), thread_sp->GetID()) == expanded_tids.end())
+                    continue;
+                const uint32_t num_frames = thread_sp->GetStackFrameCount();
+                for (uint32_t frame_idx = 0; frame_idx < num_frames && !cancel; ++frame_idx)
+                {
+                    StackFrameSP frame_sp = thread_sp->GetStackFrameAtIndex (frame_idx);
+                    if (frame_sp)
+                        frame_sp->GetSymbolContext (eSymbolContextEverything);
+                }
+            }
+        };
+    }
     
 protected:
     std::shared_ptr<ThreadTreeDelegate> m_thread_delegate_sp;
@@ -3493,7 +3801,9 @@ public:
         m_first_visible_row (0),
         m_num_rows (0),
         m_max_x (0),
-        m_max_y (0)
+        m_max_y (0),
+        m_generation (),
+        m_fill ()
     {
     }
     
@@ -3505,7 +3815,9 @@ public:
         m_first_visible_row (0),
         m_num_rows (0),
         m_max_x (0),
-        m_max_y (0)
+        m_max_y (0),
+        m_generation (),
+        m_fill ()
     {
         SetValues (valobj_list);
     }
@@ -3721,6 +4033,54 @@ protected:
     int m_min_y;
     int m_max_x;
     int m_max_y;
+    DisplayGeneration m_generation;
+    BackgroundFill m_fill;
+
+    bool
+    DrawFillPlaceholder (Window &window)
+    {
+        window.Erase();
+        window.DrawTitleBox (window.GetName());
+        window.MoveCursor (2, 1);
+        window.PutCStringTruncated ("Updating...", 1);
+        window.DeferredRefresh();
+        return true; // Drawing handled
+    }
+
+    static void
+    CollectVisibleValues (std::vector<Row> &rows, std::vector<ValueObjectSP> &valobjs)
+    {
+        for (auto &row : rows)
+        {
+            if (row.valobj)
+                valobjs.push_back (row.valobj);
+            if (row.expanded)
+                CollectVisibleValues (row.children, valobjs);
+        }
+    }
+
+    // Update the values of all rows that can be displayed in the background.
+    // Expanding a row creates its children on the UI thread, so this only
+    // warms the caches DisplayRows reads from.
+    bool
+    StartFill (const ProcessSP &process_sp)
+    {
+        std::vector<ValueObjectSP> valobjs;
+        CollectVisibleValues (m_rows, valobjs);
+        if (valobjs.empty())
+            return false;
+        return m_fill.Start (process_sp, [valobjs](const std::atomic<bool> &cancel)
+        {
+            for (const auto &valobj_sp : valobjs)
+            {
+                if (cancel)
+                    return;
+                valobj_sp->GetTypeName();
+                valobj_sp->GetValueAsCString();
+                valobj_sp->GetSummaryAsCString();
+            }
+        });
+    }
 
     static Format
     FormatForChar (int c)
@@ -3944,7 +4304,17 @@ public:
                 return true; // Don't do any updating when we are running
             }
         }
-        
+
+        const bool changed = m_generation.Update (exe_ctx, window);
+        if (changed)
+            m_fill.Cancel();
+        if (m_fill.Reap())
+            force = true; // Replace the placeholder drawn while filling
+        if (!changed && !force)
+            return true; // Nothing we display has changed since the last draw
+        if (m_fill.IsRunning())
+            return DrawFillPlaceholder (window);
+
         ValueObjectList local_values;
         if (frame_block)
         {
@@ -3971,7 +4341,12 @@ public:
             // Update the values with an empty list if there is no frame
             SetValues(local_values);
         }
-        
+
+        // Reading the variable values can be slow, so do it in the
+        // background and show a placeholder until it is done
+        if (frame && changed && StartFill (exe_ctx.GetProcessSP()))
+            return DrawFillPlaceholder (window);
+
         return ValueObjectListDelegate::WindowDelegateDraw (window, force);
 
     }
@@ -4007,7 +4382,17 @@ public:
     {
         ExecutionContext exe_ctx (m_debugger.GetCommandInterpreter().GetExecutionContext());
         StackFrame *frame = exe_ctx.GetFramePtr();
-        
+
+        const bool changed = m_generation.Update (exe_ctx, window);
+        if (changed)
+            m_fill.Cancel();
+        if (m_fill.Reap())
+            force = true; // Replace the placeholder drawn while filling
+        if (!changed && !force)
+            return true; // Nothing we display has changed since the last draw
+        if (m_fill.IsRunning())
+            return DrawFillPlaceholder (window);
+
         ValueObjectList value_list;
         if (frame)
         {
@@ -4038,6 +4423,10 @@ public:
                 SetValues(value_list);
             }
         }
+
+        if (frame && changed && StartFill (exe_ctx.GetProcessSP()))
+            return DrawFillPlaceholder (window);
+
         return ValueObjectListDelegate::WindowDelegateDraw (window, force);
     }
     
@@ -4719,7 +5108,8 @@ public:
         m_min_x (0),
         m_min_y (0),
         m_max_x (0),
-        m_max_y (0)
+        m_max_y (0),
+        m_generation ()
     {
     }
 
@@ -4780,6 +5170,11 @@ public:
         Process *process = exe_ctx.GetProcessPtr();
         Thread *thread = NULL;
 
+        // Our keys that change what we show (scrolling, toggling breakpoints)
+        // mark the window as needing an update, which forces the redraw
+        if (!m_generation.Update (exe_ctx, window) && !force)
+            return true;
+
         bool update_location = false;
         if (process)
         {
@@ -5469,6 +5864,7 @@ protected:
     int m_min_y;
     int m_max_x;
     int m_max_y;
+    DisplayGeneration m_generation;
 
 };
 
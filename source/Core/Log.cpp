@@ -13,6 +13,7 @@
 #include <stdlib.h>
 
 // C++ Includes
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -91,27 +92,26 @@ Log::PrintfWithFlagsVarArg (uint32_t flags, const char *format, va_list args)
     StreamSP stream_sp(m_stream_sp);
     if (stream_sp)
     {
-        static uint32_t g_sequence_id = 0;
-        StreamString header;
-		// Enabling the thread safe logging actually deadlocks right now.
-		// Need to fix this at some point.
-//        static Mutex g_LogThreadedMutex(Mutex::eMutexTypeRecursive);
-//        Mutex::Locker locker (g_LogThreadedMutex);
+        static std::atomic<uint32_t> g_sequence_id(0);
+        // The whole record is formatted in this thread and handed to the
+        // stream with a single write, so lines from different threads
+        // don't get interleaved.
+        StreamString record;
 
         // Add a sequence ID if requested
         if (m_options.Test (LLDB_LOG_OPTION_PREPEND_SEQUENCE))
-            header.Printf ("%u ", ++g_sequence_id);
+            record.Printf ("%u ", ++g_sequence_id);
 
         // Timestamp if requested
         if (m_options.Test (LLDB_LOG_OPTION_PREPEND_TIMESTAMP))
         {
             TimeValue now = TimeValue::Now();
-            header.Printf ("%9d.%6.6d ", now.seconds(), now.nanoseconds());
+            record.Printf ("%9d.%6.6d ", now.seconds(), now.nanoseconds());
         }
 
         // Add the process and thread if requested
         if (m_options.Test (LLDB_LOG_OPTION_PREPEND_PROC_AND_THREAD))
-            header.Printf ("[%4.4x/%4.4" PRIx64 "]: ", getpid(), Host::GetCurrentThreadID());
+            record.Printf ("[%4.4x/%4.4" PRIx64 "]: ", getpid(), Host::GetCurrentThreadID());
 
         // Add the thread name if requested
         if (m_options.Test (LLDB_LOG_OPTION_PREPEND_THREAD_NAME))
@@ -119,20 +119,22 @@ Log::PrintfWithFlagsVarArg (uint32_t flags, const char *format, va_list args)
             llvm::SmallString<32> thread_name;
             ThisThread::GetName(thread_name);
             if (!thread_name.empty())
-                header.Printf ("%s ", thread_name.c_str());
+                record.Printf ("%s ", thread_name.c_str());
         }
 
-        header.PrintfVarArg (format, args);
-        stream_sp->Printf("%s\n", header.GetData());
-        
+        record.PrintfVarArg (format, args);
+        record.EOL();
+
         if (m_options.Test(LLDB_LOG_OPTION_BACKTRACE)) 
         {
             std::string back_trace;
             llvm::raw_string_ostream stream(back_trace);
             llvm::sys::PrintStackTrace(stream);
-            stream_sp->PutCString(back_trace.c_str());
+            record.PutCString(stream.str().c_str());
         }
-        stream_sp->Flush();
+
+        stream_sp->Write (record.GetData(), record.GetSize());
+        stream_sp->FlushLogRecord (flags);
     }
 }
 
@@ -12,6 +12,8 @@
 #include "lldb/Core/SourceManager.h"
 
 // C Includes
+#include <string.h>
+
 // C++ Includes
 // Other libraries and framework includes
 // Project includes
@@ -20,6 +22,7 @@
 #include "lldb/Core/Module.h"
 #include "lldb/Core/RegularExpression.h"
 #include "lldb/Core/Stream.h"
+#include "lldb/Host/ThreadLauncher.h"
 #include "lldb/Symbol/ClangNamespaceDecl.h"
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/Function.h"
@@ -35,6 +38,9 @@ static inline bool is_newline_char(char ch)
     return ch == '\n' || ch == '\r';
 }
 
+// The maximum number of source files kept in a SourceFileCache
+static const size_t g_max_cached_source_files = 128;
+
 
 //----------------------------------------------------------------------
 // SourceManager constructor
@@ -619,21 +625,34 @@ SourceManager::File::CalculateLineOffsets (uint32_t line)
                 // Push a 1 at index zero to indicate the file has been completely indexed.
                 m_offsets.push_back(UINT32_MAX);
                 const char *s;
-                for (s = start; s < end; ++s)
+                if (::memchr (start, '\r', end - start) == NULL)
                 {
-                    char curr_ch = *s;
-                    if (is_newline_char (curr_ch))
+                    // Most source files only use '\n' line endings, so let
+                    // memchr, which is vectorized, find them.
+                    for (s = start; (s = (const char *)::memchr (s, '\n', end - s)) != NULL; )
                     {
-                        if (s + 1 < end)
+                        ++s;
+                        m_offsets.push_back(s - start);
+                    }
+                }
+                else
+                {
+                    for (s = start; s < end; ++s)
+                    {
+                        char curr_ch = *s;
+                        if (is_newline_char (curr_ch))
                         {
-                            char next_ch = s[1];
-                            if (is_newline_char (next_ch))
+                            if (s + 1 < end)
                             {
-                                if (curr_ch != next_ch)
-                                    ++s;
+                                char next_ch = s[1];
+                                if (is_newline_char (next_ch))
+                                {
+                                    if (curr_ch != next_ch)
+                                        ++s;
+                                }
                             }
+                            m_offsets.push_back(s + 1 - start);
                         }
-                        m_offsets.push_back(s + 1 - start);
                     }
                 }
                 if (!m_offsets.empty())
@@ -676,27 +695,111 @@ SourceManager::File::GetLine (uint32_t line_no, std::string &buffer)
     return true;
 }
 
+SourceManager::SourceFileCache::SourceFileCache () :
+    m_files (),
+    m_file_cache (),
+    m_mutex (),
+    m_prefetch_thread (),
+    m_prefetching (false),
+    m_prefetch_file_specs ()
+{
+}
+
+SourceManager::SourceFileCache::~SourceFileCache ()
+{
+    WaitForPrefetch ();
+}
+
 void 
 SourceManager::SourceFileCache::AddSourceFile (const FileSP &file_sp)
 {
-    FileSpec file_spec;
+    if (!file_sp)
+        return;
+
+    Mutex::Locker locker (m_mutex);
+    const FileSpec &file_spec = file_sp->GetFileSpec();
     FileCache::iterator pos = m_file_cache.find(file_spec);
-    if (pos == m_file_cache.end())
-        m_file_cache[file_spec] = file_sp;
-    else
+    if (pos != m_file_cache.end())
+    {
+        m_files.erase(pos->second);
+        m_file_cache.erase(pos);
+    }
+    m_files.push_front(file_sp);
+    m_file_cache[file_spec] = m_files.begin();
+
+    while (m_files.size() > g_max_cached_source_files)
     {
-        if (file_sp != pos->second)
-            m_file_cache[file_spec] = file_sp;
+        m_file_cache.erase(m_files.back()->GetFileSpec());
+        m_files.pop_back();
     }
 }
 
 SourceManager::FileSP 
-SourceManager::SourceFileCache::FindSourceFile (const FileSpec &file_spec) const
+SourceManager::SourceFileCache::FindSourceFile (const FileSpec &file_spec)
 {
+    Mutex::Locker locker (m_mutex);
     FileSP file_sp;
-    FileCache::const_iterator pos = m_file_cache.find(file_spec);
+    FileCache::iterator pos = m_file_cache.find(file_spec);
     if (pos != m_file_cache.end())
-        file_sp = pos->second;
+    {
+        // Move the file to the front of the list so it is evicted last
+        m_files.splice(m_files.begin(), m_files, pos->second);
+        file_sp = *pos->second;
+    }
     return file_sp;
 }
 
+void
+SourceManager::SourceFileCache::PrefetchSourceFiles (const std::vector<FileSpec> &file_specs)
+{
+    if (file_specs.empty() || m_prefetching)
+        return;
+
+    if (m_prefetch_thread.IsJoinable())
+        m_prefetch_thread.Join(NULL);
+
+    m_prefetch_file_specs = file_specs;
+    m_prefetching = true;
+    m_prefetch_thread = ThreadLauncher::LaunchThread ("<lldb.debugger.source-prefetch>",
+                                                      SourceFileCache::PrefetchThread,
+                                                      this,
+                                                      NULL);
+    if (!m_prefetch_thread.IsJoinable())
+    {
+        m_prefetch_file_specs.clear();
+        m_prefetching = false;
+    }
+}
+
+void
+SourceManager::SourceFileCache::WaitForPrefetch ()
+{
+    if (m_prefetch_thread.IsJoinable())
+        m_prefetch_thread.Join(NULL);
+}
+
+lldb::thread_result_t
+SourceManager::SourceFileCache::PrefetchThread (lldb::thread_arg_t arg)
+{
+    SourceFileCache *cache = (SourceFileCache *)arg;
+    for (const FileSpec &file_spec : cache->m_prefetch_file_specs)
+    {
+        if (cache->FindSourceFile (file_spec))
+            continue;
+
+        // Files that don't exist at their own path are found through the
+        // target's images and source map, which must not be used from this
+        // thread. They are loaded when they are first displayed instead.
+        if (!file_spec.GetModificationTime().IsValid())
+            continue;
+
+        // Build the file and its line index before adding it to the cache
+        // so other threads never see a partially initialized file
+        FileSP file_sp (new File (file_spec, NULL));
+        if (file_sp->GetNumLines() > 0)
+            cache->AddSourceFile (file_sp);
+    }
+    cache->m_prefetch_file_specs.clear();
+    cache->m_prefetching = false;
+    return NULL;
+}
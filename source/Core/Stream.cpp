@@ -9,6 +9,7 @@
 
 #include "lldb/Core/Stream.h"
 #include "lldb/Host/Endian.h"
+#include "lldb/Utility/HexCodec.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -16,6 +17,8 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+
 using namespace lldb;
 using namespace lldb_private;
 
@@ -703,20 +706,23 @@ Stream::PutBytesAsRawHex8 (const void *s, size_t src_len, ByteOrder src_byte_ord
 
     size_t bytes_written = 0;
     const uint8_t *src = (const uint8_t *)s;
-    bool binary_is_set = m_flags.Test(eBinary);
-    m_flags.Clear(eBinary);
-    if (src_byte_order == dst_byte_order)
+    // Encode in chunks so we can make one Write() call per chunk
+    uint8_t swapped[256];
+    char hex[2 * sizeof(swapped)];
+    for (size_t offset = 0; offset < src_len; )
     {
-        for (size_t i = 0; i < src_len; ++i)
-            bytes_written += _PutHex8 (src[i], false);
-    }
-    else
-    {
-        for (size_t i = src_len-1; i < src_len; --i)
-            bytes_written += _PutHex8 (src[i], false);
+        const size_t chunk_len = std::min<size_t> (src_len - offset, sizeof(swapped));
+        if (src_byte_order == dst_byte_order)
+            EncodeHexBytes (src + offset, chunk_len, hex);
+        else
+        {
+            for (size_t i = 0; i < chunk_len; ++i)
+                swapped[i] = src[src_len - 1 - offset - i];
+            EncodeHexBytes (swapped, chunk_len, hex);
+        }
+        bytes_written += Write (hex, 2 * chunk_len);
+        offset += chunk_len;
     }
-    if (binary_is_set)
-        m_flags.Set(eBinary);
 
     return bytes_written;
 }
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "lldb/Core/StreamGDBRemote.h"
+#include "lldb/Utility/HexCodec.h"
 #include <stdio.h>
 
 using namespace lldb;
@@ -34,21 +35,23 @@ StreamGDBRemote::PutEscapedBytes (const void* s,
 {
     int bytes_written = 0;
     const uint8_t *src = (const uint8_t *)s;
-    bool binary_is_set = m_flags.Test(eBinary);
-    m_flags.Clear(eBinary);
     while (src_len)
     {
-        uint8_t byte = *src;
-        src++; src_len--;
-        if (byte == 0x23 || byte == 0x24 || byte == 0x7d || byte == 0x2a)
+        // Write everything up to the next byte that needs escaping at once
+        const size_t run_length = FindGDBRemoteEscapeChar (src, src_len);
+        if (run_length > 0)
         {
-            bytes_written += PutChar(0x7d);
-            byte ^= 0x20;
+            bytes_written += Write (src, run_length);
+            src += run_length;
+            src_len -= run_length;
         }
-        bytes_written += PutChar(byte);
-    };
-    if (binary_is_set)
-        m_flags.Set(eBinary);
+        if (src_len)
+        {
+            const char escaped[2] = { 0x7d, (char)(*src ^ 0x20) };
+            bytes_written += Write (escaped, sizeof(escaped));
+            src++; src_len--;
+        }
+    }
     return bytes_written;
 }
 
@@ -0,0 +1,322 @@
+//===-- StreamLogBuffer.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Core/StreamLogBuffer.h"
+
+#include <stdlib.h>
+
+#include <set>
+
+#include "lldb/Core/Log.h"
+#include "lldb/Host/ThreadLauncher.h"
+#include "lldb/Host/TimeValue.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    typedef std::set<StreamLogBuffer *> LogBufferSet;
+
+    Mutex &
+    GetLogBuffersMutex ()
+    {
+        static Mutex g_mutex (Mutex::eMutexTypeNormal);
+        return g_mutex;
+    }
+
+    // All asynchronous log buffers, so they can be flushed when the
+    // process exits. Guarded by GetLogBuffersMutex().
+    LogBufferSet &
+    GetLogBuffers ()
+    {
+        static LogBufferSet g_log_buffers;
+        return g_log_buffers;
+    }
+
+    void
+    RegisterLogBuffer (StreamLogBuffer *log_buffer)
+    {
+        static bool g_registered_atexit = false;
+        Mutex::Locker locker (GetLogBuffersMutex ());
+        GetLogBuffers ().insert (log_buffer);
+        // The statics above are constructed by now, so they are destroyed
+        // only after our atexit handler ran.
+        if (!g_registered_atexit)
+        {
+            ::atexit (StreamLogBuffer::FlushAll);
+            g_registered_atexit = true;
+        }
+    }
+
+    void
+    UnregisterLogBuffer (StreamLogBuffer *log_buffer)
+    {
+        Mutex::Locker locker (GetLogBuffersMutex ());
+        GetLogBuffers ().erase (log_buffer);
+    }
+}
+
+StreamLogBuffer::StreamLogBuffer (const StreamSP &stream_sp, Mode mode, size_t ring_buffer_size) :
+    Stream (),
+    m_stream_sp (stream_sp),
+    m_mode (mode),
+    m_queue_head (&m_queue_stub),
+    m_queue_tail (&m_queue_stub),
+    m_queue_stub (),
+    m_enqueued_count (0),
+    m_writer_idle (false),
+    m_written_count (0),
+    m_stop_writer (false),
+    m_writer_mutex (Mutex::eMutexTypeNormal),
+    m_writer_condition (),
+    m_written_condition (),
+    m_writer_thread (),
+    m_ring_mutex (Mutex::eMutexTypeNormal),
+    m_ring (),
+    m_ring_size (0),
+    m_ring_max_size (ring_buffer_size),
+    m_ring_dropped_count (0)
+{
+    m_queue_stub.next.store (NULL);
+    if (m_mode == eModeAsynchronous)
+    {
+        // If the thread can't be launched, Write() falls back to writing
+        // the records synchronously.
+        m_writer_thread = ThreadLauncher::LaunchThread ("<lldb.log.writer>", WriterThread, this, NULL);
+        if (m_writer_thread.IsJoinable())
+            RegisterLogBuffer (this);
+    }
+}
+
+StreamLogBuffer::~StreamLogBuffer ()
+{
+    if (m_mode == eModeAsynchronous)
+        UnregisterLogBuffer (this);
+
+    if (m_writer_thread.IsJoinable())
+    {
+        {
+            Mutex::Locker locker (m_writer_mutex);
+            m_stop_writer = true;
+            m_writer_condition.Signal();
+        }
+        m_writer_thread.Join (NULL);
+    }
+
+    // Write out anything the writer thread didn't get to
+    bool wrote_records = false;
+    while (Record *record = Dequeue())
+    {
+        m_stream_sp->Write (record->data.data(), record->data.size());
+        delete record;
+        wrote_records = true;
+    }
+    if (wrote_records)
+        m_stream_sp->Flush();
+}
+
+//----------------------------------------------------------------------
+// Push a record onto the queue. This is safe to call from any number of
+// threads and never blocks.
+//----------------------------------------------------------------------
+void
+StreamLogBuffer::Enqueue (Record *record)
+{
+    record->next.store (NULL, std::memory_order_relaxed);
+    Record *prev = m_queue_head.exchange (record);
+    prev->next.store (record, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------
+// Pop the oldest record off the queue. Only one thread may call this at
+// a time. Returns NULL if the queue is empty, or if the next record is
+// still being pushed by another thread.
+//----------------------------------------------------------------------
+StreamLogBuffer::Record *
+StreamLogBuffer::Dequeue ()
+{
+    Record *tail = m_queue_tail;
+    Record *next = tail->next.load (std::memory_order_acquire);
+    if (tail == &m_queue_stub)
+    {
+        if (next == NULL)
+            return NULL;
+        m_queue_tail = next;
+        tail = next;
+        next = next->next.load (std::memory_order_acquire);
+    }
+    if (next)
+    {
+        m_queue_tail = next;
+        return tail;
+    }
+    if (tail != m_queue_head.load())
+        return NULL;
+    // "tail" is the last record, put the stub behind it so it can be
+    // handed out.
+    Enqueue (&m_queue_stub);
+    next = tail->next.load (std::memory_order_acquire);
+    if (next)
+    {
+        m_queue_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+lldb::thread_result_t
+StreamLogBuffer::WriterThread (lldb::thread_arg_t arg)
+{
+    StreamLogBuffer *log_buffer = (StreamLogBuffer *)arg;
+    Stream &stream = *log_buffer->m_stream_sp;
+
+    while (true)
+    {
+        uint64_t written_count = 0;
+        while (Record *record = log_buffer->Dequeue())
+        {
+            stream.Write (record->data.data(), record->data.size());
+            delete record;
+            ++written_count;
+        }
+
+        if (written_count > 0)
+        {
+            stream.Flush();
+            Mutex::Locker locker (log_buffer->m_writer_mutex);
+            log_buffer->m_written_count += written_count;
+            log_buffer->m_written_condition.Broadcast();
+            continue;
+        }
+
+        Mutex::Locker locker (log_buffer->m_writer_mutex);
+        if (log_buffer->m_stop_writer)
+            break;
+
+        // Let writers know they need to wake us up, then check the queue
+        // once more in case a record was pushed before they could see it.
+        log_buffer->m_writer_idle.exchange (true);
+        Record *record = log_buffer->Dequeue();
+        if (record)
+        {
+            log_buffer->m_writer_idle.store (false);
+            locker.Unlock();
+            stream.Write (record->data.data(), record->data.size());
+            delete record;
+            stream.Flush();
+            locker.Lock (log_buffer->m_writer_mutex);
+            ++log_buffer->m_written_count;
+            log_buffer->m_written_condition.Broadcast();
+            continue;
+        }
+
+        while (log_buffer->m_writer_idle.load() && !log_buffer->m_stop_writer)
+        {
+            TimeValue timeout = TimeValue::Now();
+            timeout.OffsetWithMicroSeconds (100000);
+            log_buffer->m_writer_condition.Wait (log_buffer->m_writer_mutex, &timeout);
+        }
+    }
+    return NULL;
+}
+
+void
+StreamLogBuffer::Flush ()
+{
+    if (m_mode != eModeAsynchronous || !m_writer_thread.IsJoinable())
+        return;
+
+    const uint64_t enqueued_count = m_enqueued_count.load();
+    Mutex::Locker locker (m_writer_mutex);
+    m_writer_idle.store (false);
+    m_writer_condition.Signal();
+    while (m_written_count < enqueued_count && !m_stop_writer)
+        m_written_condition.Wait (m_writer_mutex);
+}
+
+size_t
+StreamLogBuffer::Write (const void *src, size_t src_len)
+{
+    if (src_len == 0)
+        return 0;
+
+    if (m_mode == eModeRingBuffer)
+    {
+        Mutex::Locker locker (m_ring_mutex);
+        m_ring.push_back (std::string ((const char *)src, src_len));
+        m_ring_size += src_len;
+        // Always keep the newest record, even if it is bigger than the ring
+        while (m_ring_size > m_ring_max_size && m_ring.size() > 1)
+        {
+            m_ring_size -= m_ring.front().size();
+            m_ring.pop_front();
+            ++m_ring_dropped_count;
+        }
+        return src_len;
+    }
+
+    if (!m_writer_thread.IsJoinable())
+        return m_stream_sp->Write (src, src_len);
+
+    Record *record = new Record;
+    record->data.assign ((const char *)src, src_len);
+    Enqueue (record);
+    ++m_enqueued_count;
+
+    // Only take the lock if the writer thread is waiting for records
+    if (m_writer_idle.exchange (false))
+    {
+        Mutex::Locker locker (m_writer_mutex);
+        m_writer_condition.Signal();
+    }
+    return src_len;
+}
+
+void
+StreamLogBuffer::FlushLogRecord (uint32_t log_flags)
+{
+    // Buffered records are only pushed out when something went wrong, so
+    // the records leading up to the error make it to the log.
+    if (m_mode == eModeRingBuffer)
+    {
+        if (log_flags & (LLDB_LOG_FLAG_ERROR | LLDB_LOG_FLAG_FATAL))
+            DumpRingBuffer();
+    }
+    else if (log_flags & LLDB_LOG_FLAG_FATAL)
+        Flush();
+}
+
+void
+StreamLogBuffer::FlushAll ()
+{
+    Mutex::Locker locker (GetLogBuffersMutex ());
+    for (StreamLogBuffer *log_buffer : GetLogBuffers ())
+        log_buffer->Flush();
+}
+
+void
+StreamLogBuffer::DumpRingBuffer ()
+{
+    std::deque<std::string> ring;
+    uint64_t dropped_count;
+    {
+        Mutex::Locker locker (m_ring_mutex);
+        ring.swap (m_ring);
+        m_ring_size = 0;
+        dropped_count = m_ring_dropped_count;
+        m_ring_dropped_count = 0;
+    }
+
+    if (dropped_count > 0)
+        m_stream_sp->Printf ("<%" PRIu64 " older log records were discarded>\n", dropped_count);
+    for (size_t i = 0; i < ring.size(); ++i)
+        m_stream_sp->Write (ring[i].data(), ring[i].size());
+    m_stream_sp->Flush();
+}
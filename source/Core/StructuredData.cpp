@@ -12,6 +12,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <stdio.h>
 
 #include "lldb/Core/StreamString.h"
 
@@ -397,18 +398,44 @@ StructuredData::Boolean::Dump (Stream &s) const
 
 
 void
-StructuredData::String::Dump (Stream &s) const
+StructuredData::DumpJSONString (Stream &s, const char *str, size_t len)
 {
     std::string quoted;
-    const size_t strsize = m_value.size();
-    for (size_t i = 0; i < strsize ; ++i)
+    quoted.reserve (len + 2);
+    quoted.push_back ('"');
+    for (size_t i = 0; i < len; ++i)
     {
-        char ch = m_value[i];
-        if (ch == '"')
-            quoted.push_back ('\\');
-        quoted.push_back (ch);
+        const unsigned char ch = str[i];
+        switch (ch)
+        {
+            case '"':   quoted.append ("\\\""); break;
+            case '\\':  quoted.append ("\\\\"); break;
+            case '\b':  quoted.append ("\\b"); break;
+            case '\f':  quoted.append ("\\f"); break;
+            case '\n':  quoted.append ("\\n"); break;
+            case '\r':  quoted.append ("\\r"); break;
+            case '\t':  quoted.append ("\\t"); break;
+            default:
+                if (ch < 0x20 || ch == 0x7f)
+                {
+                    char escaped[8];
+                    snprintf (escaped, sizeof(escaped), "\\u%4.4x", ch);
+                    quoted.append (escaped);
+                }
+                else
+                    quoted.push_back (ch);
+                break;
+        }
     }
-    s.Printf ("\"%s\"", quoted.c_str());
+    quoted.push_back ('"');
+    // Not Printf: the string may have had NUL bytes in it
+    s.Write (quoted.data(), quoted.size());
+}
+
+void
+StructuredData::String::Dump (Stream &s) const
+{
+    DumpJSONString (s, m_value.data(), m_value.size());
 }
 
 void
@@ -426,7 +453,8 @@ StructuredData::Dictionary::Dump (Stream &s) const
         {
             s << ",";
         }
-        s << "\"" << iter->first.AsCString() << "\":";
+        DumpJSONString (s, iter->first.GetCString(), iter->first.GetLength());
+        s << ":";
         iter->second->Dump(s);
     }
     s << "}";
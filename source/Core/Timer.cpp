@@ -13,53 +13,214 @@
 #include <algorithm>
 
 #include "lldb/Core/Stream.h"
+#include "lldb/Core/StructuredData.h"
 #include "lldb/Host/Mutex.h"
 #include "lldb/Host/Host.h"
 
 #include <stdio.h>
+#include <string.h>
 
 using namespace lldb_private;
 
 #define TIMER_INDENT_AMOUNT 2
 static bool g_quiet = true;
-uint32_t Timer::g_depth = 0;
 uint32_t Timer::g_display_depth = 0;
 FILE * Timer::g_file = NULL;
 typedef std::vector<Timer *> TimerStack;
 typedef std::map<const char *, uint64_t> TimerCategoryMap;
 static lldb::thread_key_t g_key;
 
+// Each thread keeps at most this many completed timers for DumpTraceEvents(),
+// later ones are counted but dropped.
+static const size_t g_max_trace_events_per_thread = 256 * 1024;
+
+namespace {
+
+    //------------------------------------------------------------------
+    // A node in a timer call tree. Children are found by their category
+    // which is a constant string (usually __PRETTY_FUNCTION__), so
+    // pointer equality is all that is needed.
+    //------------------------------------------------------------------
+    struct TimerNode
+    {
+        TimerNode (const char *c, uint32_t p) :
+            category (c),
+            parent (p),
+            count (0),
+            inclusive_nsec (0),
+            exclusive_nsec (0),
+            children ()
+        {
+        }
+
+        const char *category;
+        uint32_t parent;
+        uint64_t count;
+        uint64_t inclusive_nsec;
+        uint64_t exclusive_nsec;
+        std::vector<uint32_t> children;
+    };
+
+    typedef std::vector<TimerNode> TimerTree;
+
+    struct TimerTraceEvent
+    {
+        const char *category;
+        uint64_t start_nsec;
+        uint64_t duration_nsec;
+    };
+
+    typedef std::vector<TimerTraceEvent> TimerTraceEvents;
+
+    uint32_t
+    FindOrCreateChild (TimerTree &tree, uint32_t parent_idx, const char *category)
+    {
+        const std::vector<uint32_t> &children = tree[parent_idx].children;
+        for (size_t i = 0; i < children.size(); ++i)
+        {
+            if (tree[children[i]].category == category)
+                return children[i];
+        }
+        const uint32_t child_idx = tree.size();
+        tree.push_back (TimerNode (category, parent_idx));
+        tree[parent_idx].children.push_back (child_idx);
+        return child_idx;
+    }
+
+    // Add the statistics of "src_tree[src_idx]" and its children to "dst_tree[dst_idx]"
+    void
+    MergeTimerTree (const TimerTree &src_tree, uint32_t src_idx, TimerTree &dst_tree, uint32_t dst_idx)
+    {
+        dst_tree[dst_idx].count += src_tree[src_idx].count;
+        dst_tree[dst_idx].inclusive_nsec += src_tree[src_idx].inclusive_nsec;
+        dst_tree[dst_idx].exclusive_nsec += src_tree[src_idx].exclusive_nsec;
+        const std::vector<uint32_t> &children = src_tree[src_idx].children;
+        for (size_t i = 0; i < children.size(); ++i)
+        {
+            const uint32_t dst_child_idx = FindOrCreateChild (dst_tree, dst_idx, src_tree[children[i]].category);
+            MergeTimerTree (src_tree, children[i], dst_tree, dst_child_idx);
+        }
+    }
+
+    void
+    ResetTimerTree (TimerTree &tree)
+    {
+        // Timers that are still running refer to their nodes by index, so
+        // only the statistics are cleared.
+        for (size_t i = 0; i < tree.size(); ++i)
+        {
+            tree[i].count = 0;
+            tree[i].inclusive_nsec = 0;
+            tree[i].exclusive_nsec = 0;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// The timer state for a single thread. Only the owning thread modifies
+// it while timers run, so its mutex is only ever contended while the
+// timers are being dumped or reset.
+//----------------------------------------------------------------------
+struct Timer::ThreadTimers
+{
+    ThreadTimers () :
+        mutex (Mutex::eMutexTypeNormal),
+        tid (Host::GetCurrentThreadID()),
+        stack (),
+        depth (0),
+        tree (1, TimerNode (NULL, UINT32_MAX)),
+        current_node (0),
+        events (),
+        dropped_events (0)
+    {
+    }
+
+    Mutex mutex;
+    lldb::tid_t tid;
+    TimerStack stack;
+    uint32_t depth;
+    TimerTree tree;             // tree[0] is the root and has no category
+    uint32_t current_node;
+    TimerTraceEvents events;
+    uint64_t dropped_events;
+};
+
+typedef std::vector<Timer::ThreadTimers *> ThreadTimersCollection;
+
+// Timer state for threads that have exited, so their results still get dumped
+struct RetiredTimers
+{
+    RetiredTimers () :
+        tree (1, TimerNode (NULL, UINT32_MAX)),
+        events (),
+        dropped_events (0)
+    {
+    }
+
+    TimerTree tree;
+    std::vector<std::pair<lldb::tid_t, TimerTraceEvents> > events;
+    uint64_t dropped_events;
+};
+
+// Protects the list of ThreadTimers objects, and the retired timers
 static Mutex &
-GetCategoryMutex()
+GetThreadTimersMutex()
 {
-    static Mutex g_category_mutex(Mutex::eMutexTypeNormal);
-    return g_category_mutex;
+    static Mutex g_thread_timers_mutex(Mutex::eMutexTypeNormal);
+    return g_thread_timers_mutex;
 }
 
-static TimerCategoryMap &
-GetCategoryMap()
+static ThreadTimersCollection &
+GetAllThreadTimers()
 {
-    static TimerCategoryMap g_category_map;
-    return g_category_map;
+    static ThreadTimersCollection g_thread_timers;
+    return g_thread_timers;
 }
 
+static RetiredTimers &
+GetRetiredTimers()
+{
+    static RetiredTimers g_retired_timers;
+    return g_retired_timers;
+}
 
-static TimerStack *
-GetTimerStackForCurrentThread ()
+static Timer::ThreadTimers *
+GetThreadTimersForCurrentThread ()
 {
-    void *timer_stack = Host::ThreadLocalStorageGet(g_key);
-    if (timer_stack == NULL)
+    void *thread_timers = Host::ThreadLocalStorageGet(g_key);
+    if (thread_timers == NULL)
     {
-        Host::ThreadLocalStorageSet(g_key, new TimerStack);
-        timer_stack = Host::ThreadLocalStorageGet(g_key);
+        Timer::ThreadTimers *new_thread_timers = new Timer::ThreadTimers;
+        {
+            Mutex::Locker locker (GetThreadTimersMutex());
+            GetAllThreadTimers().push_back (new_thread_timers);
+        }
+        Host::ThreadLocalStorageSet(g_key, new_thread_timers);
+        thread_timers = Host::ThreadLocalStorageGet(g_key);
     }
-    return (TimerStack *)timer_stack;
+    return (Timer::ThreadTimers *)thread_timers;
 }
 
 void
 ThreadSpecificCleanup (void *p)
 {
-    delete (TimerStack *)p;
+    Timer::ThreadTimers *thread_timers = (Timer::ThreadTimers *)p;
+    {
+        Mutex::Locker locker (GetThreadTimersMutex());
+        ThreadTimersCollection &all_thread_timers = GetAllThreadTimers();
+        all_thread_timers.erase (std::remove (all_thread_timers.begin(), all_thread_timers.end(), thread_timers),
+                                 all_thread_timers.end());
+
+        RetiredTimers &retired_timers = GetRetiredTimers();
+        MergeTimerTree (thread_timers->tree, 0, retired_timers.tree, 0);
+        if (!thread_timers->events.empty())
+        {
+            retired_timers.events.push_back (std::make_pair (thread_timers->tid, TimerTraceEvents()));
+            retired_timers.events.back().second.swap (thread_timers->events);
+        }
+        retired_timers.dropped_events += thread_timers->dropped_events;
+    }
+    delete thread_timers;
 }
 
 void
@@ -80,14 +241,20 @@ Timer::Timer (const char *category, const char *format, ...) :
     m_total_start (),
     m_timer_start (),
     m_total_ticks (0),
-    m_timer_ticks (0)
+    m_timer_ticks (0),
+    m_thread_timers (NULL)
 {
-    if (g_depth++ < g_display_depth)
+    // Don't touch any per thread state unless timers are enabled
+    if (g_display_depth == 0)
+        return;
+
+    m_thread_timers = GetThreadTimersForCurrentThread ();
+    if (m_thread_timers->depth++ < g_display_depth)
     {
         if (g_quiet == false)
         {
             // Indent
-            ::fprintf (g_file, "%*s", g_depth * TIMER_INDENT_AMOUNT, "");
+            ::fprintf (g_file, "%*s", m_thread_timers->depth * TIMER_INDENT_AMOUNT, "");
             // Print formatted string
             va_list args;
             va_start (args, format);
@@ -100,21 +267,25 @@ Timer::Timer (const char *category, const char *format, ...) :
         TimeValue start_time(TimeValue::Now());
         m_total_start = start_time;
         m_timer_start = start_time;
-        TimerStack *stack = GetTimerStackForCurrentThread ();
-        if (stack)
-        {
-            if (stack->empty() == false)
-                stack->back()->ChildStarted (start_time);
-            stack->push_back(this);
-        }
+
+        Mutex::Locker locker (m_thread_timers->mutex);
+        TimerStack &stack = m_thread_timers->stack;
+        if (stack.empty() == false)
+            stack.back()->ChildStarted (start_time);
+        stack.push_back(this);
+        m_thread_timers->current_node = FindOrCreateChild (m_thread_timers->tree, m_thread_timers->current_node, m_category);
     }
 }
 
 
 Timer::~Timer()
 {
+    if (m_thread_timers == NULL)
+        return;
+
     if (m_total_start.IsValid())
     {
+        const uint64_t start_nsec = m_total_start.GetAsNanoSecondsSinceJan1_1970();
         TimeValue stop_time = TimeValue::Now();
         if (m_total_start.IsValid())
         {
@@ -127,15 +298,6 @@ Timer::~Timer()
             m_timer_start.Clear();
         }
 
-        TimerStack *stack = GetTimerStackForCurrentThread ();
-        if (stack)
-        {
-            assert (stack->back() == this);
-            stack->pop_back();
-            if (stack->empty() == false)
-                stack->back()->ChildStopped(stop_time);
-        }
-
         const uint64_t total_nsec_uint = GetTotalElapsedNanoSeconds();
         const uint64_t timer_nsec_uint = GetTimerElapsedNanoSeconds();
         const double total_nsec = total_nsec_uint;
@@ -146,18 +308,35 @@ Timer::~Timer()
 
             ::fprintf (g_file,
                        "%*s%.9f sec (%.9f sec)\n",
-                       (g_depth - 1) *TIMER_INDENT_AMOUNT, "",
+                       (m_thread_timers->depth - 1) *TIMER_INDENT_AMOUNT, "",
                        total_nsec / 1000000000.0,
                        timer_nsec / 1000000000.0);
         }
 
-        // Keep total results for each category so we can dump results.
-        Mutex::Locker locker (GetCategoryMutex());
-        TimerCategoryMap &category_map = GetCategoryMap();
-        category_map[m_category] += timer_nsec_uint;
+        // Keep total results for each call path so we can dump results.
+        Mutex::Locker locker (m_thread_timers->mutex);
+        TimerStack &stack = m_thread_timers->stack;
+        assert (stack.back() == this);
+        stack.pop_back();
+        if (stack.empty() == false)
+            stack.back()->ChildStopped(stop_time);
+
+        TimerNode &node = m_thread_timers->tree[m_thread_timers->current_node];
+        ++node.count;
+        node.inclusive_nsec += total_nsec_uint;
+        node.exclusive_nsec += timer_nsec_uint;
+        m_thread_timers->current_node = node.parent;
+
+        if (m_thread_timers->events.size() < g_max_trace_events_per_thread)
+        {
+            TimerTraceEvent event = { m_category, start_nsec, total_nsec_uint };
+            m_thread_timers->events.push_back (event);
+        }
+        else
+            ++m_thread_timers->dropped_events;
     }
-    if (g_depth > 0)
-        --g_depth;
+    if (m_thread_timers->depth > 0)
+        --m_thread_timers->depth;
 }
 
 uint64_t
@@ -209,6 +388,22 @@ Timer::SetDisplayDepth (uint32_t depth)
     g_display_depth = depth;
 }
 
+// Merge the call trees of all threads, dead or alive, into "tree"
+static void
+GetMergedTimerTree (TimerTree &tree)
+{
+    tree.assign (1, TimerNode (NULL, UINT32_MAX));
+
+    Mutex::Locker locker (GetThreadTimersMutex());
+    MergeTimerTree (GetRetiredTimers().tree, 0, tree, 0);
+    ThreadTimersCollection &all_thread_timers = GetAllThreadTimers();
+    for (size_t i = 0; i < all_thread_timers.size(); ++i)
+    {
+        Mutex::Locker thread_locker (all_thread_timers[i]->mutex);
+        MergeTimerTree (all_thread_timers[i]->tree, 0, tree, 0);
+    }
+}
+
 
 /* binary function predicate:
  * - returns whether a person is less than another person
@@ -223,16 +418,38 @@ CategoryMapIteratorSortCriterion (const TimerCategoryMap::const_iterator& lhs, c
 void
 Timer::ResetCategoryTimes ()
 {
-    Mutex::Locker locker (GetCategoryMutex());
-    TimerCategoryMap &category_map = GetCategoryMap();
-    category_map.clear();
+    Mutex::Locker locker (GetThreadTimersMutex());
+    RetiredTimers &retired_timers = GetRetiredTimers();
+    retired_timers.tree.assign (1, TimerNode (NULL, UINT32_MAX));
+    retired_timers.events.clear();
+    retired_timers.dropped_events = 0;
+
+    ThreadTimersCollection &all_thread_timers = GetAllThreadTimers();
+    for (size_t i = 0; i < all_thread_timers.size(); ++i)
+    {
+        Mutex::Locker thread_locker (all_thread_timers[i]->mutex);
+        ResetTimerTree (all_thread_timers[i]->tree);
+        all_thread_timers[i]->events.clear();
+        all_thread_timers[i]->dropped_events = 0;
+    }
 }
 
 void
 Timer::DumpCategoryTimes (Stream *s)
 {
-    Mutex::Locker locker (GetCategoryMutex());
-    TimerCategoryMap &category_map = GetCategoryMap();
+    TimerTree tree;
+    GetMergedTimerTree (tree);
+
+    // The time for a category doesn't include the time spent in any
+    // nested timers, so it is the sum of the exclusive time of all of
+    // the nodes for that category.
+    TimerCategoryMap category_map;
+    for (size_t i = 1; i < tree.size(); ++i)
+    {
+        if (tree[i].count > 0)
+            category_map[tree[i].category] += tree[i].exclusive_nsec;
+    }
+
     std::vector<TimerCategoryMap::const_iterator> sorted_iterators;
     TimerCategoryMap::const_iterator pos, end = category_map.end();
     for (pos = category_map.begin(); pos != end; ++pos)
@@ -248,3 +465,98 @@ Timer::DumpCategoryTimes (Stream *s)
         s->Printf("%.9f sec for %s\n", timer_nsec / 1000000000.0, sorted_iterators[i]->first);
     }
 }
+
+namespace {
+
+    struct TimerNodeInclusiveTimeGreater
+    {
+        TimerNodeInclusiveTimeGreater (const TimerTree &tree) :
+            m_tree (tree)
+        {
+        }
+
+        bool
+        operator() (uint32_t lhs, uint32_t rhs) const
+        {
+            return m_tree[lhs].inclusive_nsec > m_tree[rhs].inclusive_nsec;
+        }
+
+        const TimerTree &m_tree;
+    };
+
+    void
+    DumpTimerNode (Stream *s, const TimerTree &tree, uint32_t node_idx, uint32_t depth)
+    {
+        const TimerNode &node = tree[node_idx];
+        if (node_idx != 0)
+        {
+            if (node.count == 0)
+                return;
+            s->Printf ("%*s%.9f sec (%.9f sec exclusive, %" PRIu64 " calls) for %s\n",
+                       depth * TIMER_INDENT_AMOUNT, "",
+                       (double)node.inclusive_nsec / 1000000000.0,
+                       (double)node.exclusive_nsec / 1000000000.0,
+                       node.count,
+                       node.category);
+            ++depth;
+        }
+        std::vector<uint32_t> children (node.children);
+        std::sort (children.begin(), children.end(), TimerNodeInclusiveTimeGreater (tree));
+        for (size_t i = 0; i < children.size(); ++i)
+            DumpTimerNode (s, tree, children[i], depth);
+    }
+
+    void
+    DumpTraceEventList (Stream *s, lldb::pid_t pid, lldb::tid_t tid, const TimerTraceEvents &events, bool &first)
+    {
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const TimerTraceEvent &event = events[i];
+            s->PutCString (first ? "\n" : ",\n");
+            first = false;
+            // Trace event times are in microseconds
+            s->PutCString ("{\"name\":");
+            const char *category = event.category ? event.category : "";
+            StructuredData::DumpJSONString (*s, category, strlen (category));
+            s->Printf (",\"cat\":\"lldb\",\"ph\":\"X\",\"ts\":%" PRIu64 ".%3.3" PRIu64 ",\"dur\":%" PRIu64 ".%3.3" PRIu64 ",\"pid\":%" PRIu64 ",\"tid\":%" PRIu64 "}",
+                       event.start_nsec / 1000, event.start_nsec % 1000,
+                       event.duration_nsec / 1000, event.duration_nsec % 1000,
+                       (uint64_t)pid,
+                       (uint64_t)tid);
+        }
+    }
+}
+
+void
+Timer::DumpCallTree (Stream *s)
+{
+    TimerTree tree;
+    GetMergedTimerTree (tree);
+    DumpTimerNode (s, tree, 0, 0);
+}
+
+void
+Timer::DumpTraceEvents (Stream *s)
+{
+    const lldb::pid_t pid = Host::GetCurrentProcessID();
+    bool first = true;
+    uint64_t dropped_events = 0;
+
+    s->PutCString ("{\"traceEvents\":[");
+
+    Mutex::Locker locker (GetThreadTimersMutex());
+    RetiredTimers &retired_timers = GetRetiredTimers();
+    for (size_t i = 0; i < retired_timers.events.size(); ++i)
+        DumpTraceEventList (s, pid, retired_timers.events[i].first, retired_timers.events[i].second, first);
+    dropped_events += retired_timers.dropped_events;
+
+    ThreadTimersCollection &all_thread_timers = GetAllThreadTimers();
+    for (size_t i = 0; i < all_thread_timers.size(); ++i)
+    {
+        Mutex::Locker thread_locker (all_thread_timers[i]->mutex);
+        DumpTraceEventList (s, pid, all_thread_timers[i]->tid, all_thread_timers[i]->events, first);
+        dropped_events += all_thread_timers[i]->dropped_events;
+    }
+
+    s->Printf ("\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%" PRIu64 "}}\n", dropped_events);
+}
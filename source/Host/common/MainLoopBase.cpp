@@ -0,0 +1,53 @@
+//===-- MainLoopBase.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Host/MainLoopBase.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+MainLoopBase::ReadHandleUP
+MainLoopBase::RegisterReadObject(const IOObjectSP &, const Callback &, Error &error)
+{
+    error.SetErrorString("main loop not supported on this host");
+    return nullptr;
+}
+
+MainLoopBase::SignalHandleUP
+MainLoopBase::RegisterSignal(int, const Callback &, Error &error)
+{
+    error.SetErrorString("main loop not supported on this host");
+    return nullptr;
+}
+
+void
+MainLoopBase::AddPendingCallback(const Callback &)
+{
+}
+
+Error
+MainLoopBase::Run()
+{
+    return Error("main loop not supported on this host");
+}
+
+void
+MainLoopBase::RequestTermination()
+{
+}
+
+void
+MainLoopBase::UnregisterReadObject(IOObject::WaitableHandle)
+{
+}
+
+void
+MainLoopBase::UnregisterSignal(int)
+{
+}
@@ -62,6 +62,88 @@ NativeBreakpointList::AddRef (lldb::addr_t addr, size_t size_hint, bool hardware
     return error;
 }
 
+void
+NativeBreakpointList::AddRefs (const std::vector<lldb::addr_t> &addrs,
+                               const std::vector<uint32_t> &size_hints,
+                               bool hardware,
+                               CreateBreakpointsFunc create_func,
+                               std::vector<Error> &errors)
+{
+    assert (addrs.size () == size_hints.size () && "one size hint is needed per address");
+
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("NativeBreakpointList::%s %zu addresses, hardware = %s", __FUNCTION__, addrs.size (), hardware ? "true" : "false");
+
+    Mutex::Locker locker (m_mutex);
+
+    errors.assign (addrs.size (), Error ());
+
+    // Bump the ref count of the breakpoints that are already set and
+    // collect the addresses that need a new one.  An address that is listed
+    // more than once is only created once.
+    std::vector<lldb::addr_t> new_addrs;
+    std::vector<uint32_t> new_size_hints;
+    std::map<lldb::addr_t, size_t> new_addr_indexes;
+    std::vector<size_t> pending_indexes;
+    for (size_t i = 0; i < addrs.size (); ++i)
+    {
+        auto iter = m_breakpoints.find (addrs[i]);
+        if (iter != m_breakpoints.end ())
+        {
+            iter->second->AddRef ();
+            continue;
+        }
+
+        if (new_addr_indexes.insert (std::make_pair (addrs[i], new_addrs.size ())).second)
+        {
+            new_addrs.push_back (addrs[i]);
+            new_size_hints.push_back (size_hints[i]);
+        }
+        pending_indexes.push_back (i);
+    }
+
+    if (new_addrs.empty ())
+        return;
+
+    if (log)
+        log->Printf ("NativeBreakpointList::%s creating %zu breakpoints", __FUNCTION__, new_addrs.size ());
+
+    std::vector<NativeBreakpointSP> breakpoints;
+    std::vector<Error> create_errors;
+    create_func (new_addrs, new_size_hints, hardware, breakpoints, create_errors);
+    assert (breakpoints.size () == new_addrs.size () && create_errors.size () == new_addrs.size () &&
+            "NativeBreakpoint create function must return one breakpoint and one error per address");
+
+    // Remember the breakpoints that were created.
+    for (size_t i = 0; i < new_addrs.size (); ++i)
+    {
+        if (create_errors[i].Fail ())
+        {
+            if (log)
+                log->Printf ("NativeBreakpointList::%s creating breakpoint for addr = 0x%" PRIx64 " -- FAILED: %s", __FUNCTION__, new_addrs[i], create_errors[i].AsCString ());
+            continue;
+        }
+
+        assert (breakpoints[i] && "NativeBreakpoint create function succeeded but returned NULL breakpoint");
+        m_breakpoints.insert (BreakpointMap::value_type (new_addrs[i], breakpoints[i]));
+    }
+
+    // A new breakpoint starts out with the reference of the first entry that
+    // asked for it; repeated entries take a reference of their own.
+    std::vector<bool> referenced (new_addrs.size (), false);
+    for (size_t index : pending_indexes)
+    {
+        const size_t new_index = new_addr_indexes[addrs[index]];
+        if (create_errors[new_index].Fail ())
+            errors[index] = create_errors[new_index];
+        else if (referenced[new_index])
+            breakpoints[new_index]->AddRef ();
+        else
+            referenced[new_index] = true;
+    }
+}
+
 Error
 NativeBreakpointList::DecRef (lldb::addr_t addr)
 {
@@ -128,6 +210,72 @@ NativeBreakpointList::DecRef (lldb::addr_t addr)
     return error;
 }
 
+void
+NativeBreakpointList::DecRefs (const std::vector<lldb::addr_t> &addrs,
+                               DisableBreakpointsFunc disable_func,
+                               std::vector<Error> &errors)
+{
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("NativeBreakpointList::%s %zu addresses", __FUNCTION__, addrs.size ());
+
+    Mutex::Locker locker (m_mutex);
+
+    errors.assign (addrs.size (), Error ());
+
+    // Drop the references and take the breakpoints that have no more out of
+    // the list, remembering which of them still need to be disabled.
+    std::vector<NativeBreakpointSP> enabled_breakpoints;
+    std::vector<size_t> enabled_indexes;
+    for (size_t i = 0; i < addrs.size (); ++i)
+    {
+        auto iter = m_breakpoints.find (addrs[i]);
+        if (iter == m_breakpoints.end ())
+        {
+            if (log)
+                log->Printf ("NativeBreakpointList::%s addr = 0x%" PRIx64 " -- NOT FOUND", __FUNCTION__, addrs[i]);
+            errors[i].SetErrorString ("breakpoint not found");
+            continue;
+        }
+
+        const int32_t new_ref_count = iter->second->DecRef ();
+        assert (new_ref_count >= 0 && "NativeBreakpoint ref count went negative");
+        if (new_ref_count > 0)
+            continue;
+
+        if (iter->second->IsEnabled ())
+        {
+            enabled_breakpoints.push_back (iter->second);
+            enabled_indexes.push_back (i);
+        }
+        m_breakpoints.erase (iter);
+    }
+
+    if (enabled_breakpoints.empty ())
+        return;
+
+    if (log)
+        log->Printf ("NativeBreakpointList::%s disabling %zu breakpoints", __FUNCTION__, enabled_breakpoints.size ());
+
+    std::vector<Error> disable_errors;
+    disable_func (enabled_breakpoints, disable_errors);
+    assert (disable_errors.size () == enabled_breakpoints.size () &&
+            "NativeBreakpoint disable function must return one error per breakpoint");
+
+    for (size_t i = 0; i < enabled_breakpoints.size (); ++i)
+    {
+        if (disable_errors[i].Success ())
+        {
+            enabled_breakpoints[i]->m_enabled = false;
+            continue;
+        }
+
+        if (log)
+            log->Printf ("NativeBreakpointList::%s addr = 0x%" PRIx64 " -- removal FAILED: %s", __FUNCTION__, enabled_breakpoints[i]->GetAddress (), disable_errors[i].AsCString ());
+        errors[enabled_indexes[i]] = disable_errors[i];
+    }
+}
+
 Error
 NativeBreakpointList::EnableBreakpoint (lldb::addr_t addr)
 {
@@ -373,12 +373,70 @@ NativeProcessProtocol::SetSoftwareBreakpoint (lldb::addr_t addr, uint32_t size_h
             { return SoftwareBreakpoint::CreateSoftwareBreakpoint (*this, addr, size_hint, breakpoint_sp); });
 }
 
+void
+NativeProcessProtocol::SetSoftwareBreakpoints (const std::vector<lldb::addr_t> &addrs, const std::vector<uint32_t> &size_hints, std::vector<Error> &errors)
+{
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("NativeProcessProtocol::%s %zu addresses", __FUNCTION__, addrs.size ());
+
+    m_breakpoint_list.AddRefs (addrs, size_hints, false,
+            [this] (const std::vector<lldb::addr_t> &addrs, const std::vector<uint32_t> &size_hints, bool /* hardware */,
+                    std::vector<NativeBreakpointSP> &breakpoints, std::vector<Error> &errors)
+            { SoftwareBreakpoint::CreateSoftwareBreakpoints (*this, addrs, size_hints, breakpoints, errors); },
+            errors);
+}
+
+void
+NativeProcessProtocol::SetBreakpoints (const std::vector<lldb::addr_t> &addrs,
+                                       const std::vector<uint32_t> &size_hints,
+                                       bool hardware,
+                                       std::vector<Error> &errors)
+{
+    assert (addrs.size () == size_hints.size () && "one size hint is needed per address");
+
+    errors.clear ();
+    errors.reserve (addrs.size ());
+    for (size_t i = 0; i < addrs.size (); ++i)
+        errors.push_back (SetBreakpoint (addrs[i], size_hints[i], hardware));
+}
+
 Error
 NativeProcessProtocol::RemoveBreakpoint (lldb::addr_t addr)
 {
     return m_breakpoint_list.DecRef (addr);
 }
 
+void
+NativeProcessProtocol::RemoveBreakpoints (const std::vector<lldb::addr_t> &addrs, std::vector<Error> &errors)
+{
+    m_breakpoint_list.DecRefs (addrs,
+            [this] (const std::vector<NativeBreakpointSP> &breakpoints, std::vector<Error> &errors)
+            {
+                // Restore the software breakpoints with batched memory
+                // accesses, and anything else one at a time.
+                std::vector<NativeBreakpointSP> software_breakpoints;
+                std::vector<size_t> software_indexes;
+                errors.assign (breakpoints.size (), Error ());
+                for (size_t i = 0; i < breakpoints.size (); ++i)
+                {
+                    if (breakpoints[i]->IsSoftwareBreakpoint ())
+                    {
+                        software_breakpoints.push_back (breakpoints[i]);
+                        software_indexes.push_back (i);
+                    }
+                    else
+                        errors[i] = breakpoints[i]->Disable ();
+                }
+
+                std::vector<Error> software_errors;
+                SoftwareBreakpoint::DisableSoftwareBreakpoints (*this, software_breakpoints, software_errors);
+                for (size_t i = 0; i < software_indexes.size (); ++i)
+                    errors[software_indexes[i]] = software_errors[i];
+            },
+            errors);
+}
+
 Error
 NativeProcessProtocol::EnableBreakpoint (lldb::addr_t addr)
 {
@@ -391,6 +449,30 @@ NativeProcessProtocol::DisableBreakpoint (lldb::addr_t addr)
     return m_breakpoint_list.DisableBreakpoint (addr);
 }
 
+void
+NativeProcessProtocol::ReadMemoryBlocks (std::vector<MemoryBlock> &blocks)
+{
+    for (MemoryBlock &block : blocks)
+    {
+        lldb::addr_t bytes_read = 0;
+        block.error = ReadMemory (block.addr, block.buf, block.size, bytes_read);
+        if (block.error.Success () && bytes_read != block.size)
+            block.error.SetErrorStringWithFormat ("read %" PRIu64 " of %zu bytes at 0x%" PRIx64, bytes_read, block.size, block.addr);
+    }
+}
+
+void
+NativeProcessProtocol::WriteMemoryBlocks (std::vector<MemoryBlock> &blocks)
+{
+    for (MemoryBlock &block : blocks)
+    {
+        lldb::addr_t bytes_written = 0;
+        block.error = WriteMemory (block.addr, block.buf, block.size, bytes_written);
+        if (block.error.Success () && bytes_written != block.size)
+            block.error.SetErrorStringWithFormat ("wrote %" PRIu64 " of %zu bytes at 0x%" PRIx64, bytes_written, block.size, block.addr);
+    }
+}
+
 lldb::StateType
 NativeProcessProtocol::GetState () const
 {
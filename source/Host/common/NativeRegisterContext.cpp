@@ -31,33 +31,21 @@ NativeRegisterContext::~NativeRegisterContext()
 {
 }
 
-// FIXME revisit invalidation, process stop ids, etc.  Right now we don't
-// support caching in NativeRegisterContext.  We can do this later by
-// utilizing NativeProcessProtocol::GetStopID () and adding a stop id to
-// NativeRegisterContext.
-
-// void
-// NativeRegisterContext::InvalidateIfNeeded (bool force)
-// {
-//     ProcessSP process_sp (m_thread.GetProcess());
-//     bool invalidate = force;
-//     uint32_t process_stop_id = UINT32_MAX;
-
-//     if (process_sp)
-//         process_stop_id = process_sp->GetStopID();
-//     else
-//         invalidate = true;
-
-//     if (!invalidate)
-//         invalidate = process_stop_id != GetStopID();
-
-//     if (invalidate)
-//     {
-//         InvalidateAllRegisters ();
-//         SetStopID (process_stop_id);
-//     }
-// }
+// Register values are only valid while the thread is stopped.  Rather than
+// tracking process stop ids, the owning thread tells us when it is about to
+// run again by calling WriteDirtyRegisters () followed by
+// InvalidateAllRegisters ().
 
+Error
+NativeRegisterContext::WriteDirtyRegisters ()
+{
+    return Error ();
+}
+
+void
+NativeRegisterContext::InvalidateAllRegisters ()
+{
+}
 
 const RegisterInfo *
 NativeRegisterContext::GetRegisterInfoByName (const char *reg_name, uint32_t start_idx)
@@ -179,6 +179,221 @@ SoftwareBreakpoint::EnableSoftwareBreakpoint (NativeProcessProtocol &process, ll
     return Error ();
 }
 
+void
+SoftwareBreakpoint::CreateSoftwareBreakpoints (NativeProcessProtocol &process,
+                                               const std::vector<lldb::addr_t> &addrs,
+                                               const std::vector<uint32_t> &size_hints,
+                                               std::vector<NativeBreakpointSP> &breakpoints,
+                                               std::vector<Error> &errors)
+{
+    assert (addrs.size () == size_hints.size () && "one size hint is needed per address");
+
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("SoftwareBreakpoint::%s %zu addresses", __FUNCTION__, addrs.size ());
+
+    breakpoints.assign (addrs.size (), NativeBreakpointSP ());
+    errors.assign (addrs.size (), Error ());
+
+    struct PendingBreakpoint
+    {
+        size_t index;
+        size_t opcode_size;
+        uint8_t trap_opcodes [MAX_TRAP_OPCODE_SIZE];
+        uint8_t saved_opcodes [MAX_TRAP_OPCODE_SIZE];
+        uint8_t verify_opcodes [MAX_TRAP_OPCODE_SIZE];
+    };
+
+    // Ask the NativeProcessProtocol subclass for the trap opcode of each
+    // breakpoint site.
+    std::vector<PendingBreakpoint> pending;
+    pending.reserve (addrs.size ());
+    for (size_t i = 0; i < addrs.size (); ++i)
+    {
+        if (addrs[i] == LLDB_INVALID_ADDRESS)
+        {
+            errors[i].SetErrorStringWithFormat ("SoftwareBreakpoint::%s invalid load address specified.", __FUNCTION__);
+            continue;
+        }
+
+        size_t bp_opcode_size = 0;
+        const uint8_t *bp_opcode_bytes = NULL;
+        errors[i] = process.GetSoftwareBreakpointTrapOpcode (size_hints[i], bp_opcode_size, bp_opcode_bytes);
+        if (errors[i].Fail ())
+            continue;
+
+        if (bp_opcode_size == 0 || bp_opcode_size > MAX_TRAP_OPCODE_SIZE || !bp_opcode_bytes)
+        {
+            errors[i].SetErrorStringWithFormat ("SoftwareBreakpoint::%s unable to get a usable breakpoint trap for address 0x%" PRIx64, __FUNCTION__, addrs[i]);
+            continue;
+        }
+
+        PendingBreakpoint entry;
+        entry.index = i;
+        entry.opcode_size = bp_opcode_size;
+        ::memcpy (entry.trap_opcodes, bp_opcode_bytes, bp_opcode_size);
+        pending.push_back (entry);
+    }
+
+    // Move the opcode bytes of every breakpoint that hasn't failed yet in a
+    // single batch.
+    std::vector<NativeProcessProtocol::MemoryBlock> blocks;
+    std::vector<const PendingBreakpoint *> block_entries;
+    auto transfer = [&] (bool write, uint8_t *(*get_buffer) (PendingBreakpoint &), const char *action)
+    {
+        blocks.clear ();
+        block_entries.clear ();
+        for (PendingBreakpoint &entry : pending)
+        {
+            if (errors[entry.index].Fail ())
+                continue;
+            NativeProcessProtocol::MemoryBlock block;
+            block.addr = addrs[entry.index];
+            block.buf = get_buffer (entry);
+            block.size = entry.opcode_size;
+            blocks.push_back (block);
+            block_entries.push_back (&entry);
+        }
+
+        if (write)
+            process.WriteMemoryBlocks (blocks);
+        else
+            process.ReadMemoryBlocks (blocks);
+
+        for (size_t i = 0; i < blocks.size (); ++i)
+        {
+            if (blocks[i].error.Success ())
+                continue;
+            errors[block_entries[i]->index].SetErrorStringWithFormat ("SoftwareBreakpoint::CreateSoftwareBreakpoints failed to %s memory while attempting to set breakpoint at 0x%" PRIx64 ": %s",
+                                                                      action, blocks[i].addr, blocks[i].error.AsCString ());
+        }
+    };
+
+    // Save the original opcodes so we can restore them later, write the
+    // traps in their place, then read the traps back.
+    transfer (false, [] (PendingBreakpoint &entry) -> uint8_t * { return entry.saved_opcodes; }, "read");
+    transfer (true, [] (PendingBreakpoint &entry) -> uint8_t * { return entry.trap_opcodes; }, "write");
+    transfer (false, [] (PendingBreakpoint &entry) -> uint8_t * { return entry.verify_opcodes; }, "verify");
+
+    size_t num_created = 0;
+    for (const PendingBreakpoint &entry : pending)
+    {
+        Error &error = errors[entry.index];
+        if (error.Fail ())
+            continue;
+
+        const lldb::addr_t addr = addrs[entry.index];
+        if (::memcmp (entry.trap_opcodes, entry.verify_opcodes, entry.opcode_size) != 0)
+        {
+            error.SetErrorStringWithFormat ("SoftwareBreakpoint::%s: verification of software breakpoint writing failed - trap opcodes not successfully read back after writing when setting breakpoint at 0x%" PRIx64, __FUNCTION__, addr);
+            continue;
+        }
+
+        breakpoints[entry.index].reset (new SoftwareBreakpoint (process, addr, entry.saved_opcodes, entry.trap_opcodes, entry.opcode_size));
+        ++num_created;
+    }
+
+    if (log)
+        log->Printf ("SoftwareBreakpoint::%s created %zu of %zu breakpoints", __FUNCTION__, num_created, addrs.size ());
+}
+
+void
+SoftwareBreakpoint::DisableSoftwareBreakpoints (NativeProcessProtocol &process,
+                                                const std::vector<NativeBreakpointSP> &breakpoints,
+                                                std::vector<Error> &errors)
+{
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("SoftwareBreakpoint::%s %zu breakpoints", __FUNCTION__, breakpoints.size ());
+
+    errors.assign (breakpoints.size (), Error ());
+
+    struct PendingRestore
+    {
+        SoftwareBreakpoint *breakpoint;
+        bool break_op_found;
+        uint8_t current_opcodes [MAX_TRAP_OPCODE_SIZE];
+        uint8_t verify_opcodes [MAX_TRAP_OPCODE_SIZE];
+    };
+
+    std::vector<PendingRestore> pending (breakpoints.size ());
+    for (size_t i = 0; i < breakpoints.size (); ++i)
+    {
+        assert (breakpoints[i]->IsSoftwareBreakpoint () && "only software breakpoints can be restored in a batch");
+        pending[i].breakpoint = static_cast<SoftwareBreakpoint *> (breakpoints[i].get ());
+        pending[i].break_op_found = false;
+    }
+
+    std::vector<NativeProcessProtocol::MemoryBlock> blocks;
+    std::vector<size_t> block_indexes;
+    auto add_block = [&] (size_t index, uint8_t *buf)
+    {
+        NativeProcessProtocol::MemoryBlock block;
+        block.addr = pending[index].breakpoint->m_addr;
+        block.buf = buf;
+        block.size = pending[index].breakpoint->m_opcode_size;
+        blocks.push_back (block);
+        block_indexes.push_back (index);
+    };
+    auto record_errors = [&] (const char *action)
+    {
+        for (size_t i = 0; i < blocks.size (); ++i)
+        {
+            if (blocks[i].error.Fail ())
+                errors[block_indexes[i]].SetErrorStringWithFormat ("SoftwareBreakpoint::DisableSoftwareBreakpoints addr=0x%" PRIx64 ": failed to %s memory: %s",
+                                                                   blocks[i].addr, action, blocks[i].error.AsCString ());
+        }
+        blocks.clear ();
+        block_indexes.clear ();
+    };
+
+    // Read what is at each breakpoint now.
+    for (size_t i = 0; i < pending.size (); ++i)
+        add_block (i, pending[i].current_opcodes);
+    process.ReadMemoryBlocks (blocks);
+    record_errors ("read");
+
+    // Restore the saved opcodes wherever our trap is still in place.  If it
+    // isn't, the original opcodes may already have been put back, which the
+    // verification below will tell us.
+    for (size_t i = 0; i < pending.size (); ++i)
+    {
+        SoftwareBreakpoint *bp = pending[i].breakpoint;
+        if (errors[i].Fail ())
+            continue;
+        if (::memcmp (pending[i].current_opcodes, bp->m_trap_opcodes, bp->m_opcode_size) != 0)
+            continue;
+        pending[i].break_op_found = true;
+        add_block (i, bp->m_saved_opcodes);
+    }
+    process.WriteMemoryBlocks (blocks);
+    record_errors ("write");
+
+    // Verify that our original opcodes made it back to the inferior.
+    for (size_t i = 0; i < pending.size (); ++i)
+    {
+        if (errors[i].Success ())
+            add_block (i, pending[i].verify_opcodes);
+    }
+    process.ReadMemoryBlocks (blocks);
+    record_errors ("verify");
+
+    for (size_t i = 0; i < pending.size (); ++i)
+    {
+        SoftwareBreakpoint *bp = pending[i].breakpoint;
+        if (errors[i].Success () && ::memcmp (bp->m_saved_opcodes, pending[i].verify_opcodes, bp->m_opcode_size) != 0)
+        {
+            if (pending[i].break_op_found)
+                errors[i].SetErrorString ("Failed to restore original opcode.");
+            else
+                errors[i].SetErrorString ("Original breakpoint trap is no longer in memory.");
+        }
+
+        if (log && errors[i].Fail ())
+            log->Printf ("SoftwareBreakpoint::%s addr = 0x%" PRIx64 " -- FAILED: %s", __FUNCTION__, bp->m_addr, errors[i].AsCString ());
+    }
+}
+
 // -------------------------------------------------------------------
 // instance-level members
 // -------------------------------------------------------------------
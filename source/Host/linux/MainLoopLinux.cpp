@@ -0,0 +1,288 @@
+//===-- MainLoopLinux.cpp ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Host/linux/MainLoopLinux.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include "llvm/ADT/STLExtras.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+MainLoopLinux::MainLoopLinux()
+    : m_epoll_fd(::epoll_create1(EPOLL_CLOEXEC))
+    , m_event_fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , m_terminate_request(false)
+{
+    if (m_epoll_fd == -1 || m_event_fd == -1)
+        return;
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = m_event_fd;
+    if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &event) == -1)
+    {
+        ::close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+}
+
+MainLoopLinux::~MainLoopLinux()
+{
+    assert(m_read_fds.empty() && "read handles outlived the main loop");
+    assert(m_signals.empty() && "signal handles outlived the main loop");
+
+    if (m_event_fd != -1)
+        ::close(m_event_fd);
+    if (m_epoll_fd != -1)
+        ::close(m_epoll_fd);
+}
+
+MainLoopLinux::ReadHandleUP
+MainLoopLinux::RegisterReadObject(const IOObjectSP &object_sp, const Callback &callback, Error &error)
+{
+    if (m_epoll_fd == -1)
+    {
+        error.SetErrorString("main loop failed to initialize");
+        return nullptr;
+    }
+    if (!object_sp || !object_sp->IsValid())
+    {
+        error.SetErrorString("IO object is not valid");
+        return nullptr;
+    }
+
+    const IOObject::WaitableHandle handle = object_sp->GetWaitableHandle();
+    if (m_read_fds.find(handle) != m_read_fds.end())
+    {
+        error.SetErrorStringWithFormat("file descriptor %d already monitored", handle);
+        return nullptr;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = handle;
+    if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, handle, &event) == -1)
+    {
+        error.SetErrorToErrno();
+        return nullptr;
+    }
+
+    m_read_fds.insert(std::make_pair(handle, callback));
+    return CreateReadHandle(handle);
+}
+
+MainLoopLinux::SignalHandleUP
+MainLoopLinux::RegisterSignal(int signo, const Callback &callback, Error &error)
+{
+    if (m_epoll_fd == -1)
+    {
+        error.SetErrorString("main loop failed to initialize");
+        return nullptr;
+    }
+    if (m_signals.find(signo) != m_signals.end())
+    {
+        error.SetErrorStringWithFormat("signal %d already monitored", signo);
+        return nullptr;
+    }
+
+    // The signal has to stay pending for the signalfd to see it, so block
+    // normal delivery for as long as we are watching it.
+    sigset_t mask;
+    sigset_t old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, signo);
+    int ret = ::pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+    if (ret != 0)
+    {
+        error.SetError(ret, eErrorTypePOSIX);
+        return nullptr;
+    }
+
+    SignalInfo info;
+    info.callback = callback;
+    info.was_blocked = sigismember(&old_mask, signo);
+    info.fd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (info.fd == -1)
+    {
+        error.SetErrorToErrno();
+        if (!info.was_blocked)
+            ::pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+        return nullptr;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = info.fd;
+    if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, info.fd, &event) == -1)
+    {
+        error.SetErrorToErrno();
+        ::close(info.fd);
+        if (!info.was_blocked)
+            ::pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+        return nullptr;
+    }
+
+    m_signals.insert(std::make_pair(signo, info));
+    return CreateSignalHandle(signo);
+}
+
+void
+MainLoopLinux::AddPendingCallback(const Callback &callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending_callbacks.push_back(callback);
+    }
+
+    const uint64_t count = 1;
+    ssize_t bytes_written;
+    do
+        bytes_written = ::write(m_event_fd, &count, sizeof(count));
+    while (bytes_written == -1 && errno == EINTR);
+}
+
+void
+MainLoopLinux::UnregisterReadObject(IOObject::WaitableHandle handle)
+{
+    auto it = m_read_fds.find(handle);
+    assert(it != m_read_fds.end() && "unregistering an unknown read object");
+    if (it == m_read_fds.end())
+        return;
+
+    ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, handle, nullptr);
+    m_read_fds.erase(it);
+}
+
+void
+MainLoopLinux::UnregisterSignal(int signo)
+{
+    auto it = m_signals.find(signo);
+    assert(it != m_signals.end() && "unregistering an unknown signal");
+    if (it == m_signals.end())
+        return;
+
+    ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+
+    if (!it->second.was_blocked)
+    {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, signo);
+        ::pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+    }
+
+    m_signals.erase(it);
+}
+
+Error
+MainLoopLinux::Run()
+{
+    Error error;
+    if (m_epoll_fd == -1)
+    {
+        error.SetErrorString("main loop failed to initialize");
+        return error;
+    }
+
+    m_terminate_request = false;
+
+    struct epoll_event events[16];
+    while (!m_terminate_request)
+    {
+        const int num_events = ::epoll_wait(m_epoll_fd, events, llvm::array_lengthof(events), -1);
+        if (num_events == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            error.SetErrorToErrno();
+            return error;
+        }
+
+        for (int i = 0; i < num_events && !m_terminate_request; ++i)
+            ProcessEvent(events[i].data.fd);
+    }
+    return error;
+}
+
+void
+MainLoopLinux::RequestTermination()
+{
+    m_terminate_request = true;
+}
+
+void
+MainLoopLinux::ProcessEvent(int fd)
+{
+    // Callbacks are copied before they are invoked because they are free to
+    // unregister themselves, which destroys the stored copy.
+    if (fd == m_event_fd)
+    {
+        uint64_t count;
+        while (::read(m_event_fd, &count, sizeof(count)) == sizeof(count))
+            ;
+        ProcessPendingCallbacks();
+        return;
+    }
+
+    auto read_it = m_read_fds.find(fd);
+    if (read_it != m_read_fds.end())
+    {
+        Callback callback = read_it->second;
+        callback(*this);
+        return;
+    }
+
+    for (auto &entry : m_signals)
+    {
+        if (entry.second.fd != fd)
+            continue;
+
+        // Run the callback once for every delivery read from the signalfd,
+        // so a handler that counts signals sees all of them.  The callback
+        // may unregister the signal, which closes the descriptor.
+        const int signo = entry.first;
+        struct signalfd_siginfo info;
+        for (;;)
+        {
+            auto signal_it = m_signals.find(signo);
+            if (signal_it == m_signals.end() || signal_it->second.fd != fd)
+                return;
+            if (::read(fd, &info, sizeof(info)) != sizeof(info))
+                return;
+
+            Callback callback = signal_it->second.callback;
+            callback(*this);
+        }
+    }
+
+    // An earlier callback in this batch may have unregistered the object.
+}
+
+void
+MainLoopLinux::ProcessPendingCallbacks()
+{
+    std::vector<Callback> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        callbacks.swap(m_pending_callbacks);
+    }
+
+    for (const Callback &callback : callbacks)
+        callback(*this);
+}
@@ -77,6 +77,11 @@ static ScriptInterpreterPython::SWIGPythonCallThreadPlan g_swig_call_thread_plan
 
 static bool g_initialized = false;
 
+// The debugger that "lldb.debugger" was last bound to.  The lldb module is
+// shared by every debugger in the process, so a lightweight session can only
+// skip rebinding it if nobody else has been in since.
+static lldb::user_id_t g_session_debugger_id = LLDB_INVALID_UID;
+
 static std::string
 ReadPythonBacktrace (PyObject* py_backtrace);
 
@@ -161,6 +166,10 @@ ScriptInterpreterPython::ScriptInterpreterPython (CommandInterpreter &interprete
     m_saved_stdin (),
     m_saved_stdout (),
     m_saved_stderr (),
+    m_lightweight_stdout (),
+    m_lightweight_stderr (),
+    m_lightweight_stdout_file (nullptr),
+    m_lightweight_stderr_file (nullptr),
     m_main_module (),
     m_lldb_module (),
     m_session_dict (false),     // Don't create an empty dictionary, leave it invalid
@@ -404,6 +413,12 @@ ScriptInterpreterPython::EnterSession (uint16_t on_entry_flags,
 
     m_session_is_active = true;
 
+    if ((on_entry_flags & Locker::LightweightSession) &&
+        (on_entry_flags & Locker::InitGlobals) == 0 &&
+        (on_entry_flags & Locker::NoSTDIN) &&
+        GetCommandInterpreter().GetDebugger().GetScriptLightweightCallbacks())
+        return EnterLightweightSession (out, err);
+
     StreamString run_string;
 
     if (on_entry_flags & Locker::InitGlobals)
@@ -426,6 +441,7 @@ ScriptInterpreterPython::EnterSession (uint16_t on_entry_flags,
 
     PyRun_SimpleString (run_string.GetData());
     run_string.Clear();
+    g_session_debugger_id = GetCommandInterpreter().GetDebugger().GetID();
 
     PythonDictionary &sys_module_dict = GetSysModuleDictionary ();
     if (sys_module_dict)
@@ -486,6 +502,74 @@ ScriptInterpreterPython::EnterSession (uint16_t on_entry_flags,
     return true;
 }
 
+// Point sys.<name> at a file object for "file" and remember what it was
+// pointing at.  The file object is reused until "file" changes.
+static void
+SwapInCachedFile (PythonDictionary &sys_module_dict,
+                  const char *name,
+                  FILE *file,
+                  PythonObject &saved,
+                  PythonObject &cached,
+                  FILE *&cached_file)
+{
+    saved.Reset();
+    if (!file)
+        return;
+
+    if (!cached || cached_file != file)
+    {
+        PyObject *new_file = PyFile_FromFile (file, (char *) "", (char *) "w", nullptr);
+        cached.Reset (new_file);
+        Py_XDECREF (new_file);
+        cached_file = file;
+    }
+    saved.Reset (sys_module_dict.GetItemForKey (name));
+    sys_module_dict.SetItemForKey (name, cached);
+}
+
+bool
+ScriptInterpreterPython::EnterLightweightSession (FILE *out, FILE *err)
+{
+    // Callbacks get their frame and location as arguments, so all a session
+    // needs is lldb.debugger and the output files.  Only rebind the former
+    // when it doesn't already point at us and reuse the latter, which leaves
+    // a couple of dictionary stores per call.
+    Debugger &debugger = GetCommandInterpreter().GetDebugger();
+    if (g_session_debugger_id != debugger.GetID())
+    {
+        StreamString run_string;
+        run_string.Printf (    "run_one_line (%s, 'lldb.debugger_unique_id = %" PRIu64, m_dictionary_name.c_str(), debugger.GetID());
+        run_string.Printf (    "; lldb.debugger = lldb.SBDebugger.FindDebuggerWithID (%" PRIu64 ")", debugger.GetID());
+        run_string.PutCString ("')");
+        PyRun_SimpleString (run_string.GetData());
+        g_session_debugger_id = debugger.GetID();
+    }
+
+    m_saved_stdin.Reset();
+
+    PythonDictionary &sys_module_dict = GetSysModuleDictionary ();
+    if (sys_module_dict)
+    {
+        lldb::StreamFileSP in_sp;
+        lldb::StreamFileSP out_sp;
+        lldb::StreamFileSP err_sp;
+        if (out == nullptr || err == nullptr)
+            debugger.AdoptTopIOHandlerFilesIfInvalid (in_sp, out_sp, err_sp);
+        if (out == nullptr && out_sp)
+            out = out_sp->GetFile().GetStream();
+        if (err == nullptr && err_sp)
+            err = err_sp->GetFile().GetStream();
+
+        SwapInCachedFile (sys_module_dict, "stdout", out, m_saved_stdout, m_lightweight_stdout, m_lightweight_stdout_file);
+        SwapInCachedFile (sys_module_dict, "stderr", err, m_saved_stderr, m_lightweight_stderr, m_lightweight_stderr_file);
+    }
+
+    if (PyErr_Occurred())
+        PyErr_Clear ();
+
+    return true;
+}
+
 PythonObject &
 ScriptInterpreterPython::GetMainModule ()
 {
@@ -1921,7 +2005,7 @@ ScriptInterpreterPython::GetScriptedSummary(const char *python_function_name, ll
     if (python_function_name && *python_function_name)
     {
         {
-            Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+            Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
             {
                 TypeSummaryOptionsSP options_sp(new TypeSummaryOptions(options));
                 
@@ -1960,6 +2044,9 @@ ScriptInterpreterPython::Clear ()
     // order and we can't guarantee that we can access these.
     if (Py_IsInitialized())
         PyRun_SimpleString("lldb.debugger = None; lldb.target = None; lldb.process = None; lldb.thread = None; lldb.frame = None");
+
+    // lldb.debugger is bound to nothing now, whichever debugger had it.
+    g_session_debugger_id = LLDB_INVALID_UID;
 }
 
 bool
@@ -2002,7 +2089,7 @@ ScriptInterpreterPython::BreakpointCallbackFunction
             {
                 bool ret_val = true;
                 {
-                    Locker py_lock(python_interpreter, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+                    Locker py_lock(python_interpreter, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
                     ret_val = g_swig_breakpoint_callback (python_function_name,
                                                           python_interpreter->m_dictionary_name.c_str(),
                                                           stop_frame_sp, 
@@ -2054,7 +2141,7 @@ ScriptInterpreterPython::WatchpointCallbackFunction
             {
                 bool ret_val = true;
                 {
-                    Locker py_lock(python_interpreter, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+                    Locker py_lock(python_interpreter, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
                     ret_val = g_swig_watchpoint_callback (python_function_name,
                                                           python_interpreter->m_dictionary_name.c_str(),
                                                           stop_frame_sp, 
@@ -2087,7 +2174,7 @@ ScriptInterpreterPython::CalculateNumChildren(const StructuredData::ObjectSP &im
     size_t ret_val = 0;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         ret_val = g_swig_calc_children (implementor);
     }
     
@@ -2113,7 +2200,7 @@ ScriptInterpreterPython::GetChildAtIndex(const StructuredData::ObjectSP &impleme
     lldb::ValueObjectSP ret_val;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         void* child_ptr = g_swig_get_child_index (implementor,idx);
         if (child_ptr != nullptr && child_ptr != Py_None)
         {
@@ -2151,7 +2238,7 @@ ScriptInterpreterPython::GetIndexOfChildWithName(const StructuredData::ObjectSP
     int ret_val = UINT32_MAX;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         ret_val = g_swig_get_index_child (implementor, child_name);
     }
     
@@ -2177,7 +2264,7 @@ ScriptInterpreterPython::UpdateSynthProviderInstance(const StructuredData::Objec
         return ret_val;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         ret_val = g_swig_update_provider (implementor);
     }
     
@@ -2203,7 +2290,7 @@ ScriptInterpreterPython::MightHaveChildrenSynthProviderInstance(const Structured
         return ret_val;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         ret_val = g_swig_mighthavechildren_provider (implementor);
     }
     
@@ -2229,7 +2316,7 @@ ScriptInterpreterPython::GetSyntheticValue(const StructuredData::ObjectSP &imple
         return ret_val;
     
     {
-        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN);
+        Locker py_lock(this, Locker::AcquireLock | Locker::InitSession | Locker::NoSTDIN | Locker::LightweightSession);
         void* child_ptr = g_swig_getvalue_provider (implementor);
         if (child_ptr != nullptr && child_ptr != Py_None)
         {
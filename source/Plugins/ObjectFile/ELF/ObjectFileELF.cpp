@@ -1756,6 +1756,9 @@ ObjectFileELF::ParseSymbols (Symtab *symtab,
                              const DataExtractor &symtab_data,
                              const DataExtractor &strtab_data)
 {
+    Timer scoped_timer (__PRETTY_FUNCTION__,
+                        "ObjectFileELF::ParseSymbols (num_symbols = %" PRIu64 ")",
+                        (uint64_t)num_symbols);
     ELFSymbol symbol;
     lldb::offset_t offset = 0;
 
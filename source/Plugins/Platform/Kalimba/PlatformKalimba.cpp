@@ -329,6 +329,7 @@ Error
 PlatformKalimba::LaunchNativeProcess (
     ProcessLaunchInfo &,
     lldb_private::NativeProcessProtocol::NativeDelegate &,
+    MainLoopBase &,
     NativeProcessProtocolSP &)
 {
     return Error();
@@ -337,6 +338,7 @@ PlatformKalimba::LaunchNativeProcess (
 Error
 PlatformKalimba::AttachNativeProcess (lldb::pid_t,
                                     lldb_private::NativeProcessProtocol::NativeDelegate &,
+                                    MainLoopBase &,
                                     NativeProcessProtocolSP &)
 {
     return Error();
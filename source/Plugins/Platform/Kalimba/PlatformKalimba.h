@@ -106,11 +106,13 @@ namespace lldb_private {
         LaunchNativeProcess (
             ProcessLaunchInfo &launch_info,
             lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+            MainLoopBase &mainloop,
             NativeProcessProtocolSP &process_sp) override;
 
         Error
         AttachNativeProcess (lldb::pid_t pid,
                              lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+                             MainLoopBase &mainloop,
                              NativeProcessProtocolSP &process_sp) override;
 
     protected:
@@ -857,6 +857,7 @@ PlatformLinux::CalculateTrapHandlerSymbolNames ()
 Error
 PlatformLinux::LaunchNativeProcess (ProcessLaunchInfo &launch_info,
                                     NativeProcessProtocol::NativeDelegate &native_delegate,
+                                    MainLoopBase &mainloop,
                                     NativeProcessProtocolSP &process_sp)
 {
 #if !defined(__linux__)
@@ -885,6 +886,7 @@ PlatformLinux::LaunchNativeProcess (ProcessLaunchInfo &launch_info,
         exe_module_sp.get (),
         launch_info,
         native_delegate,
+        mainloop,
         process_sp);
 
     return error;
@@ -894,6 +896,7 @@ PlatformLinux::LaunchNativeProcess (ProcessLaunchInfo &launch_info,
 Error
 PlatformLinux::AttachNativeProcess (lldb::pid_t pid,
                                     NativeProcessProtocol::NativeDelegate &native_delegate,
+                                    MainLoopBase &mainloop,
                                     NativeProcessProtocolSP &process_sp)
 {
 #if !defined(__linux__)
@@ -903,6 +906,6 @@ PlatformLinux::AttachNativeProcess (lldb::pid_t pid,
         return Error("PlatformLinux::%s (): cannot attach to a debug process when not the host", __FUNCTION__);
 
     // Launch it for debugging
-    return process_linux::NativeProcessLinux::AttachToProcess (pid, native_delegate, process_sp);
+    return process_linux::NativeProcessLinux::AttachToProcess (pid, native_delegate, mainloop, process_sp);
 #endif
 }
@@ -112,11 +112,13 @@ namespace platform_linux {
         LaunchNativeProcess (
             ProcessLaunchInfo &launch_info,
             NativeProcessProtocol::NativeDelegate &native_delegate,
+            MainLoopBase &mainloop,
             NativeProcessProtocolSP &process_sp) override;
 
         Error
         AttachNativeProcess (lldb::pid_t pid,
                              NativeProcessProtocol::NativeDelegate &native_delegate,
+                             MainLoopBase &mainloop,
                              NativeProcessProtocolSP &process_sp) override;
 
         static bool
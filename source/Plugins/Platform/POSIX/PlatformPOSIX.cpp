@@ -450,7 +450,9 @@ PlatformPOSIX::GetFile (const lldb_private::FileSpec& source /* remote file path
 
         if (error.Success())
         {
-            lldb::DataBufferSP buffer_sp(new DataBufferHeap(1024, 0));
+            // Use a large buffer so the remote platform can pipeline the
+            // vFile:pread packets for each block.
+            lldb::DataBufferSP buffer_sp(new DataBufferHeap(1024 * 1024, 0));
             uint64_t offset = 0;
             error.Clear();
             while (error.Success())
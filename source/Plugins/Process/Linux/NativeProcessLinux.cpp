@@ -13,6 +13,7 @@
 
 // C Includes
 #include <errno.h>
+#include <limits.h>
 #include <poll.h>
 #include <string.h>
 #include <stdint.h>
@@ -20,6 +21,7 @@
 
 // C++ Includes
 #include <fstream>
+#include <set>
 #include <string>
 
 // Other libraries and framework includes
@@ -35,7 +37,6 @@
 #include "lldb/Host/Host.h"
 #include "lldb/Host/HostInfo.h"
 #include "lldb/Host/HostNativeThread.h"
-#include "lldb/Host/ThreadLauncher.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Target/Process.h"
 #include "lldb/Target/ProcessLaunchInfo.h"
@@ -53,6 +54,7 @@
 // System includes - They have to be included after framework includes because they define some
 // macros which collide with variable names in other modules
 #include <linux/unistd.h>
+#include <sys/mman.h>
 #include <sys/personality.h>
 #include <sys/ptrace.h>
 #include <sys/socket.h>
@@ -144,8 +146,6 @@ using namespace llvm;
 // Private bits we only need internally.
 namespace
 {
-    static void * const EXIT_OPERATION = nullptr;
-
     const UnixSignals&
     GetUnixSignals ()
     {
@@ -164,6 +164,26 @@ namespace
         };
     }
 
+    lldb::addr_t
+    GetPageSize ()
+    {
+        static const lldb::addr_t g_page_size = ::sysconf (_SC_PAGESIZE);
+        return g_page_size;
+    }
+
+    int
+    GetProtectionFlags (const MemoryRegionInfo &region_info)
+    {
+        int prot = PROT_NONE;
+        if (region_info.GetReadable () == MemoryRegionInfo::eYes)
+            prot |= PROT_READ;
+        if (region_info.GetWritable () == MemoryRegionInfo::eYes)
+            prot |= PROT_WRITE;
+        if (region_info.GetExecutable () == MemoryRegionInfo::eYes)
+            prot |= PROT_EXEC;
+        return prot;
+    }
+
     void
     CoordinatorErrorHandler (const std::string &error_message)
     {
@@ -1097,12 +1117,10 @@ EnsureFDFlags(int fd, int flags, Error &error)
 NativeProcessLinux::OperationArgs::OperationArgs(NativeProcessLinux *monitor)
     : m_monitor(monitor)
 {
-    sem_init(&m_semaphore, 0, 0);
 }
 
 NativeProcessLinux::OperationArgs::~OperationArgs()
 {
-    sem_destroy(&m_semaphore);
 }
 
 NativeProcessLinux::LaunchArgs::LaunchArgs(NativeProcessLinux *monitor,
@@ -1145,6 +1163,7 @@ NativeProcessLinux::LaunchProcess (
     Module *exe_module,
     ProcessLaunchInfo &launch_info,
     NativeProcessProtocol::NativeDelegate &native_delegate,
+    MainLoopBase &mainloop,
     NativeProcessProtocolSP &native_process_sp)
 {
     Log *log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_PROCESS));
@@ -1201,7 +1220,7 @@ NativeProcessLinux::LaunchProcess (
     }
 
     // Create the NativeProcessLinux in launch mode.
-    native_process_sp.reset (new NativeProcessLinux ());
+    native_process_sp.reset (new NativeProcessLinux (mainloop));
 
     if (log)
     {
@@ -1248,6 +1267,7 @@ Error
 NativeProcessLinux::AttachToProcess (
     lldb::pid_t pid,
     NativeProcessProtocol::NativeDelegate &native_delegate,
+    MainLoopBase &mainloop,
     NativeProcessProtocolSP &native_process_sp)
 {
     Log *log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_PROCESS));
@@ -1266,7 +1286,7 @@ NativeProcessLinux::AttachToProcess (
     if (!error.Success ())
         return error;
 
-    std::shared_ptr<NativeProcessLinux> native_process_linux_sp (new NativeProcessLinux ());
+    std::shared_ptr<NativeProcessLinux> native_process_linux_sp (new NativeProcessLinux (mainloop));
 
     if (!native_process_linux_sp->RegisterNativeDelegate (native_delegate))
     {
@@ -1286,35 +1306,31 @@ NativeProcessLinux::AttachToProcess (
 // Public Instance Methods
 // -----------------------------------------------------------------------------
 
-NativeProcessLinux::NativeProcessLinux () :
+NativeProcessLinux::NativeProcessLinux (MainLoopBase &mainloop) :
     NativeProcessProtocol (LLDB_INVALID_PROCESS_ID),
     m_arch (),
-    m_operation_thread (),
-    m_monitor_thread (),
-    m_operation (nullptr),
-    m_operation_mutex (),
-    m_operation_pending (),
-    m_operation_done (),
+    m_mainloop (mainloop),
+    m_sigchld_handle (),
+    m_inferior_pgid (0),
     m_supports_mem_region (eLazyBoolCalculate),
     m_mem_region_cache (),
     m_mem_region_cache_mutex (),
     m_coordinator_up (new ThreadStateCoordinator (GetThreadLoggerFunction ())),
-    m_coordinator_thread ()
+    m_coordinator_events_scheduled (false),
+    m_syscall_addr (LLDB_INVALID_ADDRESS)
 {
 }
 
 //------------------------------------------------------------------------------
-/// The basic design of the NativeProcessLinux is built around two threads.
-///
-/// One thread (@see SignalThread) simply blocks on a call to waitpid() looking
-/// for changes in the debugee state.  When a change is detected a
-/// ProcessMessage is sent to the associated ProcessLinux instance.  This thread
-/// "drives" state changes in the debugger.
+/// The NativeProcessLinux does all of its work on the thread that runs the
+/// main loop it was created with.
 ///
-/// The second thread (@see OperationThread) is responsible for two things 1)
-/// launching or attaching to the inferior process, and then 2) servicing
-/// operations such as register reads/writes, stepping, etc.  See the comments
-/// on the Operation class for more info as to why this is needed.
+/// That thread launches or attaches to the inferior, which makes it the one
+/// thread ptrace accepts requests from, so operations such as register
+/// reads/writes and stepping run inline without being handed to another
+/// thread.  Changes in the debugee state arrive as SIGCHLD on the same loop
+/// (@see SigchldHandler), and the ThreadStateCoordinator's events are
+/// processed there as well (@see ScheduleCoordinatorEvents).
 void
 NativeProcessLinux::LaunchInferior (
     Module *module,
@@ -1338,48 +1354,20 @@ NativeProcessLinux::LaunchInferior (
             stdin_path, stdout_path, stderr_path,
             working_dir, launch_info));
 
-    sem_init (&m_operation_pending, 0, 0);
-    sem_init (&m_operation_done, 0, 0);
-
-    StartLaunchOpThread (args.get(), error);
-    if (!error.Success ())
-        return;
-
-    error = StartCoordinatorThread ();
+    error = StartMonitor ();
     if (!error.Success ())
         return;
 
-WAIT_AGAIN:
-    // Wait for the operation thread to initialize.
-    if (sem_wait(&args->m_semaphore))
-    {
-        if (errno == EINTR)
-            goto WAIT_AGAIN;
-        else
-        {
-            error.SetErrorToErrno();
-            return;
-        }
-    }
-
-    // Check that the launch was a success.
-    if (!args->m_error.Success())
+    // Launch from this thread so that it becomes the tracer of the inferior.
+    if (!Launch (args.get ()))
     {
-        StopOpThread();
-        StopCoordinatorThread ();
+        StopMonitor ();
         error = args->m_error;
         return;
     }
 
-    // Finally, start monitoring the child process for change in state.
-    m_monitor_thread = Host::StartMonitoringChildProcess(
-        NativeProcessLinux::MonitorCallback, this, GetID(), true);
-    if (!m_monitor_thread.IsJoinable())
-    {
-        error.SetErrorToGenericError();
-        error.SetErrorString ("Process attach failed to create monitor thread for NativeProcessLinux::MonitorCallback.");
-        return;
-    }
+    // The child put itself in its own process group before the exec.
+    m_inferior_pgid = getpgid (GetID ());
 }
 
 void
@@ -1426,50 +1414,21 @@ NativeProcessLinux::AttachToInferior (lldb::pid_t pid, Error &error)
     m_pid = pid;
     SetState(eStateAttaching);
 
-    sem_init (&m_operation_pending, 0, 0);
-    sem_init (&m_operation_done, 0, 0);
-
     std::unique_ptr<AttachArgs> args (new AttachArgs (this, pid));
 
-    StartAttachOpThread(args.get (), error);
+    error = StartMonitor ();
     if (!error.Success ())
         return;
 
-    error = StartCoordinatorThread ();
-    if (!error.Success ())
-        return;
-
-WAIT_AGAIN:
-    // Wait for the operation thread to initialize.
-    if (sem_wait (&args->m_semaphore))
-    {
-        if (errno == EINTR)
-            goto WAIT_AGAIN;
-        else
-        {
-            error.SetErrorToErrno ();
-            return;
-        }
-    }
-
-    // Check that the attach was a success.
-    if (!args->m_error.Success ())
+    // Attach from this thread so that it becomes the tracer of the inferior.
+    if (!Attach (args.get ()))
     {
-        StopOpThread ();
-        StopCoordinatorThread ();
+        StopMonitor ();
         error = args->m_error;
         return;
     }
 
-    // Finally, start monitoring the child process for change in state.
-    m_monitor_thread = Host::StartMonitoringChildProcess (
-        NativeProcessLinux::MonitorCallback, this, GetID (), true);
-    if (!m_monitor_thread.IsJoinable())
-    {
-        error.SetErrorToGenericError ();
-        error.SetErrorString ("Process attach failed to create monitor thread for NativeProcessLinux::MonitorCallback.");
-        return;
-    }
+    m_inferior_pgid = getpgid (GetID ());
 }
 
 void
@@ -1478,34 +1437,6 @@ NativeProcessLinux::Terminate ()
     StopMonitor();
 }
 
-//------------------------------------------------------------------------------
-// Thread setup and tear down.
-
-void
-NativeProcessLinux::StartLaunchOpThread(LaunchArgs *args, Error &error)
-{
-    static const char *g_thread_name = "lldb.process.nativelinux.operation";
-
-    if (m_operation_thread.IsJoinable())
-        return;
-
-    m_operation_thread = ThreadLauncher::LaunchThread(g_thread_name, LaunchOpThread, args, &error);
-}
-
-void *
-NativeProcessLinux::LaunchOpThread(void *arg)
-{
-    LaunchArgs *args = static_cast<LaunchArgs*>(arg);
-
-    if (!Launch(args)) {
-        sem_post(&args->m_semaphore);
-        return NULL;
-    }
-
-    ServeOperation(args);
-    return NULL;
-}
-
 bool
 NativeProcessLinux::Launch(LaunchArgs *args)
 {
@@ -1561,6 +1492,12 @@ NativeProcessLinux::Launch(LaunchArgs *args)
         if (args->m_error.Fail())
             exit(ePtraceFailed);
 
+        // Don't pass on the signals the main loop keeps blocked so that it
+        // can receive them through a signalfd.
+        sigset_t empty_set;
+        sigemptyset(&empty_set);
+        sigprocmask(SIG_SETMASK, &empty_set, nullptr);
+
         // terminal has already dupped the tty descriptors to stdin/out/err.
         // This closes original fd from which they were copied (and avoids
         // leaking descriptors to the debugged process.
@@ -1763,31 +1700,6 @@ NativeProcessLinux::Launch(LaunchArgs *args)
     return args->m_error.Success();
 }
 
-void
-NativeProcessLinux::StartAttachOpThread(AttachArgs *args, Error &error)
-{
-    static const char *g_thread_name = "lldb.process.linux.operation";
-
-    if (m_operation_thread.IsJoinable())
-        return;
-
-    m_operation_thread = ThreadLauncher::LaunchThread(g_thread_name, AttachOpThread, args, &error);
-}
-
-void *
-NativeProcessLinux::AttachOpThread(void *arg)
-{
-    AttachArgs *args = static_cast<AttachArgs*>(arg);
-
-    if (!Attach(args)) {
-        sem_post(&args->m_semaphore);
-        return nullptr;
-    }
-
-    ServeOperation(args);
-    return nullptr;
-}
-
 bool
 NativeProcessLinux::Attach(AttachArgs *args)
 {
@@ -1902,9 +1814,13 @@ NativeProcessLinux::SetDefaultPtraceOpts(lldb::pid_t pid)
 
     // Have the tracer trace threads which spawn in the inferior process.
     // TODO: if we want to support tracing the inferiors' child, add the
-    // appropriate ptrace flags here (PTRACE_O_TRACEFORK, PTRACE_O_TRACEVFORK)
+    // appropriate ptrace flags here (PTRACE_O_TRACEVFORK)
     ptrace_opts |= PTRACE_O_TRACECLONE;
 
+    // Forked children are only followed long enough to undo the page
+    // protections of page watchpoints, see DetachForkedChild.
+    ptrace_opts |= PTRACE_O_TRACEFORK;
+
     // Have the tracer notify us before execve returns
     // (needed to disable legacy SIGTRAP generation)
     ptrace_opts |= PTRACE_O_TRACEEXEC;
@@ -2079,6 +1995,75 @@ NativeProcessLinux::MonitorCallback(void *callback_baton,
     return stop_monitoring;
 }
 
+void
+NativeProcessLinux::SigchldHandler ()
+{
+    Log *log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_PROCESS));
+
+    // SIGCHLD does not queue, so one notification can stand for several
+    // children.  Keep reaping until waitpid has nothing more to report.
+    while (m_sigchld_handle)
+    {
+        int status = -1;
+        const ::pid_t wait_pid = waitpid (-m_inferior_pgid, &status, __WALL | WNOHANG);
+        if (wait_pid == 0)
+            break;
+
+        if (wait_pid == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (log)
+                log->Printf ("NativeProcessLinux::%s waitpid (pgid = %" PRIi32 ") failed: %s", __FUNCTION__, m_inferior_pgid, strerror (errno));
+            break;
+        }
+
+        MonitorWaitStatus (wait_pid, status);
+    }
+}
+
+void
+NativeProcessLinux::MonitorWaitStatus (::pid_t wait_pid, int status)
+{
+    Log *log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_PROCESS));
+
+    bool exited = false;
+    int signal = 0;
+    int exit_status = 0;
+    if (WIFSTOPPED (status))
+        signal = WSTOPSIG (status);
+    else if (WIFEXITED (status))
+    {
+        exit_status = WEXITSTATUS (status);
+        exited = true;
+    }
+    else if (WIFSIGNALED (status))
+    {
+        signal = WTERMSIG (status);
+        if (wait_pid == m_inferior_pgid)
+        {
+            exited = true;
+            exit_status = -1;
+        }
+    }
+
+    if (log)
+        log->Printf ("NativeProcessLinux::%s waitpid (pgid = %" PRIi32 ") => pid = %" PRIi32 ", status = 0x%8.8x, signal = %i, exit_status = %i",
+                     __FUNCTION__, m_inferior_pgid, wait_pid, status, signal, exit_status);
+
+    if (!exited && signal == 0)
+        return;
+
+    const bool stop_monitoring = MonitorCallback (this, wait_pid, exited, signal, exit_status);
+    if (stop_monitoring || (exited && wait_pid == m_inferior_pgid))
+    {
+        if (log)
+            log->Printf ("NativeProcessLinux::%s pid %" PRIu64 " no longer monitored", __FUNCTION__, GetID ());
+        m_sigchld_handle.reset ();
+    }
+}
+
 void
 NativeProcessLinux::MonitorSIGTRAP(const siginfo_t *info, lldb::pid_t pid)
 {
@@ -2101,10 +2086,37 @@ NativeProcessLinux::MonitorSIGTRAP(const siginfo_t *info, lldb::pid_t pid)
 
     switch (info->si_code)
     {
-    // TODO: these two cases are required if we want to support tracing of the inferiors' children.  We'd need this to debug a monitor.
-    // case (SIGTRAP | (PTRACE_EVENT_FORK << 8)):
+    // TODO: this case is required if we want to support tracing of the inferiors' children.  We'd need this to debug a monitor.
     // case (SIGTRAP | (PTRACE_EVENT_VFORK << 8)):
 
+    case (SIGTRAP | (PTRACE_EVENT_FORK << 8)):
+    {
+        // The forking thread is stopped here.
+        if (thread_sp)
+            std::static_pointer_cast<NativeThreadLinux> (thread_sp)->SetStoppedBySignal (SIGTRAP);
+        NotifyThreadStop (pid);
+
+        unsigned long event_message = 0;
+        if (GetEventMessage (pid, &event_message).Success())
+        {
+            if (log)
+                log->Printf ("NativeProcessLinux::%s() pid %" PRIu64 " forked child %lu, detaching from it", __FUNCTION__, pid, event_message);
+            DetachForkedChild (static_cast<lldb::pid_t> (event_message));
+        }
+        else if (log)
+            log->Printf ("NativeProcessLinux::%s() pid %" PRIu64 " received fork event but GetEventMessage failed so we don't know the child pid", __FUNCTION__, pid);
+
+        m_coordinator_up->RequestThreadResume (pid,
+                                               [=](lldb::tid_t tid_to_resume, bool supress_signal)
+                                               {
+                                                   std::static_pointer_cast<NativeThreadLinux> (thread_sp)->SetRunning ();
+                                                   return Resume (tid_to_resume, LLDB_INVALID_SIGNAL_NUMBER);
+                                               },
+                                               CoordinatorErrorHandler);
+        break;
+    }
+
+
     case (SIGTRAP | (PTRACE_EVENT_CLONE << 8)):
     {
         lldb::tid_t tid = LLDB_INVALID_THREAD_ID;
@@ -2175,6 +2187,11 @@ NativeProcessLinux::MonitorSIGTRAP(const siginfo_t *info, lldb::pid_t pid)
         // The thread state coordinator needs to reset due to the exec.
         m_coordinator_up->ResetForExec ();
 
+        // The pages we had write-protected went away with the old image.
+        m_page_watchpoints.clear ();
+        m_protected_pages.clear ();
+        m_syscall_addr = LLDB_INVALID_ADDRESS;
+
         // Remove all but the main thread here.  Linux fork creates a new process which only copies the main thread.  Mutexes are in undefined state.
         if (log)
             log->Printf ("NativeProcessLinux::%s exec received, stop tracking all but main thread", __FUNCTION__);
@@ -2337,7 +2354,20 @@ NativeProcessLinux::MonitorTrace(lldb::pid_t pid, NativeThreadProtocolSP thread_
                 __FUNCTION__, pid);
 
     if (thread_sp)
-        std::static_pointer_cast<NativeThreadLinux>(thread_sp)->SetStoppedByTrace();
+    {
+        // While range stepping, the thread is stepped again right here and
+        // neither the thread state coordinator nor the client hear about it.
+        std::shared_ptr<NativeThreadLinux> linux_thread_sp = std::static_pointer_cast<NativeThreadLinux>(thread_sp);
+        bool at_breakpoint = false;
+        if (StepAgainInRange(linux_thread_sp, at_breakpoint))
+            return;
+        // The breakpoint instruction hasn't run yet, but the client must
+        // see the breakpoint hit or it would step right over it.
+        if (at_breakpoint)
+            linux_thread_sp->SetStoppedByBreakpoint();
+        else
+            linux_thread_sp->SetStoppedByTrace();
+    }
 
     // This thread is currently stopped.
     NotifyThreadStop(pid);
@@ -2355,6 +2385,43 @@ NativeProcessLinux::MonitorTrace(lldb::pid_t pid, NativeThreadProtocolSP thread_
                                 });
 }
 
+bool
+NativeProcessLinux::StepAgainInRange(const std::shared_ptr<NativeThreadLinux> &thread_sp, bool &at_breakpoint)
+{
+    Log *log(GetLogIfAllCategoriesSet(LIBLLDB_LOG_STEP));
+    at_breakpoint = false;
+
+    NativeRegisterContextSP reg_ctx_sp = thread_sp->GetRegisterContext();
+    if (!reg_ctx_sp)
+        return false;
+
+    const lldb::addr_t pc = reg_ctx_sp->GetPC(LLDB_INVALID_ADDRESS);
+    if (pc == LLDB_INVALID_ADDRESS || !thread_sp->IsSteppingInRange(pc))
+        return false;
+
+    // Stop on a software breakpoint inside the range so the client gets to
+    // decide what to do with it.
+    NativeBreakpointSP breakpoint_sp;
+    if (m_breakpoint_list.GetBreakpoint(pc, breakpoint_sp).Success() && breakpoint_sp && breakpoint_sp->IsEnabled())
+    {
+        at_breakpoint = true;
+        return false;
+    }
+
+    // The registers read for this stop are stale once the thread steps.
+    thread_sp->FlushRegisterCache();
+
+    const Error error = SingleStep(thread_sp->GetID(), LLDB_INVALID_SIGNAL_NUMBER);
+    if (error.Fail())
+    {
+        if (log)
+            log->Printf("NativeProcessLinux::%s() tid %" PRIu64 " failed to step again at pc 0x%" PRIx64 ": %s",
+                    __FUNCTION__, thread_sp->GetID(), pc, error.AsCString());
+        return false;
+    }
+    return true;
+}
+
 void
 NativeProcessLinux::MonitorBreakpoint(lldb::pid_t pid, NativeThreadProtocolSP thread_sp)
 {
@@ -2562,6 +2629,15 @@ NativeProcessLinux::MonitorSignal(const siginfo_t *info, lldb::pid_t pid, bool e
         return;
     }
 
+    // Write faults on pages protected for a page watchpoint are handled
+    // here and never reach the inferior.
+    if (signo == SIGSEGV && info->si_code == SEGV_ACCERR && thread_sp && !m_protected_pages.empty ())
+    {
+        const lldb::addr_t fault_addr = reinterpret_cast<lldb::addr_t> (info->si_addr);
+        if (MonitorPageWatchpointFault (std::static_pointer_cast<NativeThreadLinux> (thread_sp), fault_addr))
+            return;
+    }
+
     if (log)
         log->Printf ("NativeProcessLinux::%s() received signal %s", __FUNCTION__, GetUnixSignals ().GetSignalAsCString (signo));
 
@@ -2675,10 +2751,12 @@ NativeProcessLinux::Resume (const ResumeActionList &resume_actions)
         {
             // Request the step.
             const int signo = action->signal;
+            const lldb::addr_t step_range_start = action->step_range_start;
+            const lldb::addr_t step_range_end = action->step_range_end;
             m_coordinator_up->RequestThreadResume (thread_sp->GetID (),
                                                    [=](lldb::tid_t tid_to_step, bool supress_signal)
                                                    {
-                                                       std::static_pointer_cast<NativeThreadLinux> (thread_sp)->SetStepping ();
+                                                       std::static_pointer_cast<NativeThreadLinux> (thread_sp)->SetStepping (step_range_start, step_range_end);
                                                        const auto step_result = SingleStep (tid_to_step,(signo > 0 && !supress_signal) ? signo : LLDB_INVALID_SIGNAL_NUMBER);
                                                        assert (step_result.Success() && "SingleStep() failed");
                                                        if (step_result.Success())
@@ -2746,6 +2824,13 @@ NativeProcessLinux::Detach ()
 {
     Error error;
 
+    // Don't lose register writes that haven't made it to the threads yet.
+    {
+        Mutex::Locker locker (m_threads_mutex);
+        for (auto thread_sp : m_threads)
+            std::static_pointer_cast<NativeThreadLinux> (thread_sp)->FlushRegisterCache ();
+    }
+
     // Tell ptrace to detach from the process.
     if (GetID () != LLDB_INVALID_PROCESS_ID)
         error = Detach (GetID ());
@@ -3222,96 +3307,463 @@ NativeProcessLinux::SetBreakpoint (lldb::addr_t addr, uint32_t size, bool hardwa
         return SetSoftwareBreakpoint (addr, size);
 }
 
+void
+NativeProcessLinux::SetBreakpoints (const std::vector<lldb::addr_t> &addrs,
+                                    const std::vector<uint32_t> &size_hints,
+                                    bool hardware,
+                                    std::vector<Error> &errors)
+{
+    if (hardware)
+        errors.assign (addrs.size (), Error ("NativeProcessLinux does not support hardware breakpoints"));
+    else
+        SetSoftwareBreakpoints (addrs, size_hints, errors);
+}
+
 Error
-NativeProcessLinux::GetSoftwareBreakpointTrapOpcode (size_t trap_opcode_size_hint, size_t &actual_opcode_size, const uint8_t *&trap_opcode_bytes)
+NativeProcessLinux::SetWatchpoint (lldb::addr_t addr, size_t size, uint32_t watch_flags, bool hardware)
 {
-    // FIXME put this behind a breakpoint protocol class that can be
-    // set per architecture.  Need ARM, MIPS support here.
-    static const uint8_t g_aarch64_opcode[] = { 0x00, 0x00, 0x20, 0xd4 };
-    static const uint8_t g_i386_opcode [] = { 0xCC };
-    static const uint8_t g_mips64_opcode[] = { 0x00, 0x00, 0x00, 0x0d };
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_WATCHPOINTS));
 
-    switch (m_arch.GetMachine ())
+    if (hardware)
     {
-    case llvm::Triple::aarch64:
-        trap_opcode_bytes = g_aarch64_opcode;
-        actual_opcode_size = sizeof(g_aarch64_opcode);
-        return Error ();
+        const Error error = NativeProcessProtocol::SetWatchpoint (addr, size, watch_flags, hardware);
+        if (error.Success ())
+            return error;
 
-    case llvm::Triple::x86:
-    case llvm::Triple::x86_64:
-        trap_opcode_bytes = g_i386_opcode;
-        actual_opcode_size = sizeof(g_i386_opcode);
-        return Error ();
+        if (log)
+            log->Printf ("NativeProcessLinux::%s addr = 0x%" PRIx64 ", size = %zu: no hardware watchpoint (%s), trying page protection",
+                         __FUNCTION__, addr, size, error.AsCString ());
+    }
 
-    case llvm::Triple::mips64:
-    case llvm::Triple::mips64el:
-        trap_opcode_bytes = g_mips64_opcode;
-        actual_opcode_size = sizeof(g_mips64_opcode);
-        return Error ();
+    return SetPageWatchpoint (addr, size, watch_flags);
+}
 
-    default:
-        assert(false && "CPU type not supported!");
-        return Error ("CPU type not supported");
-    }
+Error
+NativeProcessLinux::RemoveWatchpoint (lldb::addr_t addr)
+{
+    if (m_page_watchpoints.find (addr) != m_page_watchpoints.end ())
+        return RemovePageWatchpoint (addr);
+    return NativeProcessProtocol::RemoveWatchpoint (addr);
 }
 
-#if 0
-ProcessMessage::CrashReason
-NativeProcessLinux::GetCrashReasonForSIGSEGV(const siginfo_t *info)
+Error
+NativeProcessLinux::SetPageWatchpoint (lldb::addr_t addr, size_t size, uint32_t watch_flags)
 {
-    ProcessMessage::CrashReason reason;
-    assert(info->si_signo == SIGSEGV);
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_WATCHPOINTS));
+
+    // A protection fault doesn't tell a read from a write, and reads can't
+    // be trapped without also trapping writes, so only writes are watched.
+    if (watch_flags != 0x1)
+        return Error ("page-protection watchpoints only watch for writes");
+    if (size == 0)
+        return Error ("cannot watch an empty range");
+    if (m_page_watchpoints.find (addr) != m_page_watchpoints.end ())
+        return Error ("a watchpoint is already set at 0x%" PRIx64, addr);
+
+    NativeThreadProtocolSP thread_sp = GetThreadForInferiorCall ();
+    if (!thread_sp)
+        return Error ("no stopped thread to change page protections with");
 
-    reason = ProcessMessage::eInvalidCrashReason;
+    const lldb::addr_t page_size = GetPageSize ();
+    const lldb::addr_t first_page = addr & ~(page_size - 1);
+    const lldb::addr_t num_pages = (((addr + size - 1) & ~(page_size - 1)) - first_page) / page_size + 1;
+    const lldb::addr_t end_page = first_page + num_pages * page_size;
 
-    switch (info->si_code)
+    // The kernel can't push a signal frame onto a write-protected stack and
+    // kills the thread instead, so refuse to protect any thread's stack.
     {
-    default:
-        assert(false && "unexpected si_code for SIGSEGV");
-        break;
-    case SI_KERNEL:
-        // Linux will occasionally send spurious SI_KERNEL codes.
-        // (this is poorly documented in sigaction)
-        // One way to get this is via unaligned SIMD loads.
-        reason = ProcessMessage::eInvalidAddress; // for lack of anything better
-        break;
-    case SEGV_MAPERR:
-        reason = ProcessMessage::eInvalidAddress;
-        break;
-    case SEGV_ACCERR:
-        reason = ProcessMessage::ePrivilegedAddress;
-        break;
+        Mutex::Locker locker (m_threads_mutex);
+        for (auto stack_thread_sp : m_threads)
+        {
+            NativeRegisterContextSP reg_ctx_sp = stack_thread_sp ? stack_thread_sp->GetRegisterContext () : NativeRegisterContextSP ();
+            const lldb::addr_t sp = reg_ctx_sp ? reg_ctx_sp->GetSP () : LLDB_INVALID_ADDRESS;
+            MemoryRegionInfo stack_info;
+            if (sp == LLDB_INVALID_ADDRESS || GetMemoryRegionInfo (sp, stack_info).Fail ())
+                continue;
+
+            if (stack_info.GetRange ().GetRangeBase () < end_page && first_page < stack_info.GetRange ().GetRangeEnd ())
+                return Error ("0x%" PRIx64 "-0x%" PRIx64 " is on the stack of thread %" PRIu64 ", which can't be write-protected",
+                              addr, addr + size, stack_thread_sp->GetID ());
+        }
     }
 
-    return reason;
-}
-#endif
+    // Remember how the pages we are about to protect were mapped.
 
+    Error error;
+    std::vector<lldb::addr_t> new_pages;
+    for (lldb::addr_t i = 0; i < num_pages && error.Success (); ++i)
+    {
+        const lldb::addr_t page = first_page + i * page_size;
+        if (m_protected_pages.find (page) != m_protected_pages.end ())
+            continue;
 
-#if 0
-ProcessMessage::CrashReason
-NativeProcessLinux::GetCrashReasonForSIGILL(const siginfo_t *info)
-{
-    ProcessMessage::CrashReason reason;
-    assert(info->si_signo == SIGILL);
+        MemoryRegionInfo region_info;
+        error = GetMemoryRegionInfo (page, region_info);
+        if (error.Success () && region_info.GetWritable () != MemoryRegionInfo::eYes)
+            error.SetErrorStringWithFormat ("memory at 0x%" PRIx64 " is not writable", page);
+        if (error.Fail ())
+            break;
 
-    reason = ProcessMessage::eInvalidCrashReason;
+        ProtectedPage &protected_page = m_protected_pages[page];
+        protected_page.original_prot = GetProtectionFlags (region_info);
+        protected_page.ref_count = 0;
+        new_pages.push_back (page);
+    }
 
-    switch (info->si_code)
+    if (error.Success ())
     {
-    default:
-        assert(false && "unexpected si_code for SIGILL");
-        break;
-    case ILL_ILLOPC:
-        reason = ProcessMessage::eIllegalOpcode;
-        break;
-    case ILL_ILLOPN:
-        reason = ProcessMessage::eIllegalOperand;
-        break;
-    case ILL_ILLADR:
-        reason = ProcessMessage::eIllegalAddressingMode;
-        break;
+        error = ApplyPageProtection (thread_sp->GetID (), new_pages, true);
+        // Don't leave a partially applied protection behind.
+        if (error.Fail ())
+            ApplyPageProtection (thread_sp->GetID (), new_pages, false);
+    }
+
+    if (error.Fail ())
+    {
+        for (lldb::addr_t page : new_pages)
+            m_protected_pages.erase (page);
+        return error;
+    }
+
+    for (lldb::addr_t i = 0; i < num_pages; ++i)
+        ++m_protected_pages[first_page + i * page_size].ref_count;
+    m_page_watchpoints[addr] = size;
+
+    if (log)
+        log->Printf ("NativeProcessLinux::%s watching 0x%" PRIx64 "-0x%" PRIx64 " by write-protecting %" PRIu64 " new page(s)",
+                     __FUNCTION__, addr, addr + size, static_cast<uint64_t> (new_pages.size ()));
+    return error;
+}
+
+Error
+NativeProcessLinux::RemovePageWatchpoint (lldb::addr_t addr)
+{
+    auto wp_it = m_page_watchpoints.find (addr);
+    if (wp_it == m_page_watchpoints.end ())
+        return Error ("no page watchpoint at 0x%" PRIx64, addr);
+
+    const lldb::addr_t page_size = GetPageSize ();
+    const lldb::addr_t first_page = addr & ~(page_size - 1);
+    const lldb::addr_t num_pages = (((addr + wp_it->second - 1) & ~(page_size - 1)) - first_page) / page_size + 1;
+    m_page_watchpoints.erase (wp_it);
+
+    std::vector<lldb::addr_t> released_pages;
+    for (lldb::addr_t i = 0; i < num_pages; ++i)
+    {
+        const lldb::addr_t page = first_page + i * page_size;
+        auto page_it = m_protected_pages.find (page);
+        assert (page_it != m_protected_pages.end () && "watched page is not protected");
+        if (page_it != m_protected_pages.end () && --page_it->second.ref_count == 0)
+            released_pages.push_back (page);
+    }
+
+    Error error;
+    if (!released_pages.empty ())
+    {
+        NativeThreadProtocolSP thread_sp = GetThreadForInferiorCall ();
+        if (thread_sp)
+            error = ApplyPageProtection (thread_sp->GetID (), released_pages, false);
+        else
+            error.SetErrorString ("no stopped thread to change page protections with");
+    }
+
+    for (lldb::addr_t page : released_pages)
+        m_protected_pages.erase (page);
+    return error;
+}
+
+std::vector<std::vector<uint64_t>>
+NativeProcessLinux::GetPageProtectionArgs (const std::vector<lldb::addr_t> &pages, bool write_protect)
+{
+    const lldb::addr_t page_size = GetPageSize ();
+    auto get_prot = [&] (lldb::addr_t page)
+    {
+        const int original_prot = m_protected_pages[page].original_prot;
+        return write_protect ? (original_prot & ~PROT_WRITE) : original_prot;
+    };
+
+    // Adjacent pages that get the same protection share one mprotect, so a
+    // large watched region doesn't cost a system call per page.
+    std::vector<std::vector<uint64_t>> args_list;
+    size_t run_start = 0;
+    while (run_start < pages.size ())
+    {
+        const int prot = get_prot (pages[run_start]);
+        size_t run_end = run_start + 1;
+        while (run_end < pages.size () &&
+               pages[run_end] == pages[run_end - 1] + page_size &&
+               get_prot (pages[run_end]) == prot)
+            ++run_end;
+
+        args_list.push_back ({ pages[run_start], (run_end - run_start) * page_size, static_cast<uint64_t> (prot) });
+        run_start = run_end;
+    }
+    return args_list;
+}
+
+Error
+NativeProcessLinux::ApplyPageProtection (lldb::tid_t tid, const std::vector<lldb::addr_t> &pages, bool write_protect)
+{
+    for (const std::vector<uint64_t> &args : GetPageProtectionArgs (pages, write_protect))
+    {
+        uint64_t result = 0;
+        const Error error = InferiorSyscall (tid, SYS_mprotect, args, result);
+        if (error.Fail ())
+            return error;
+    }
+    return Error ();
+}
+
+NativeThreadProtocolSP
+NativeProcessLinux::GetThreadForInferiorCall ()
+{
+    Mutex::Locker locker (m_threads_mutex);
+
+    NativeThreadProtocolSP thread_sp = GetThreadByID (GetCurrentThreadID ());
+    if (thread_sp && StateIsStoppedState (thread_sp->GetState (), false))
+        return thread_sp;
+
+    for (auto candidate_sp : m_threads)
+    {
+        if (candidate_sp && StateIsStoppedState (candidate_sp->GetState (), false))
+            return candidate_sp;
+    }
+    return NativeThreadProtocolSP ();
+}
+
+bool
+NativeProcessLinux::MonitorPageWatchpointFault (const std::shared_ptr<NativeThreadLinux> &thread_sp, lldb::addr_t fault_addr)
+{
+    const lldb::addr_t page_size = GetPageSize ();
+    const lldb::addr_t page = fault_addr & ~(page_size - 1);
+    if (m_protected_pages.find (page) == m_protected_pages.end ())
+        return false;
+
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_WATCHPOINTS));
+    const lldb::tid_t tid = thread_sp->GetID ();
+
+    // An unaligned store can run into the next page.  Lift the protection on
+    // both so that one step completes it.
+    std::vector<lldb::addr_t> pages (1, page);
+    if (m_protected_pages.find (page + page_size) != m_protected_pages.end ())
+        pages.push_back (page + page_size);
+
+    // si_addr is where the access starts, or the page boundary it crossed,
+    // so a store that begins just below a watched range faults outside of
+    // it.  Such a store writes the first byte of the nearest range above
+    // the fault address, so a debug register watching that byte tells if
+    // it reached the range, whatever value it stored.
+    const lldb::addr_t max_access_size = 64;
+    lldb::addr_t hit_addr = LLDB_INVALID_ADDRESS;
+    lldb::addr_t next_wp_addr = LLDB_INVALID_ADDRESS;
+    for (const auto &wp : m_page_watchpoints)
+    {
+        if (wp.first <= fault_addr && fault_addr < wp.first + wp.second)
+        {
+            hit_addr = wp.first;
+            break;
+        }
+        if (fault_addr < wp.first && wp.first < fault_addr + max_access_size &&
+            (next_wp_addr == LLDB_INVALID_ADDRESS || wp.first < next_wp_addr))
+            next_wp_addr = wp.first;
+    }
+
+    NativeRegisterContextSP reg_ctx_sp = thread_sp->GetRegisterContext ();
+    uint32_t next_wp_index = LLDB_INVALID_INDEX32;
+    std::vector<uint8_t> next_wp_bytes;
+    if (hit_addr == LLDB_INVALID_ADDRESS && next_wp_addr != LLDB_INVALID_ADDRESS)
+    {
+        if (reg_ctx_sp)
+            next_wp_index = reg_ctx_sp->SetHardwareWatchpoint (next_wp_addr, 1, 0x1);
+
+        // Without a free debug register, fall back to comparing the bytes
+        // the store could reach.  That misses a store of the same value.
+        if (next_wp_index == LLDB_INVALID_INDEX32)
+        {
+            if (log)
+                log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " no free debug register for 0x%" PRIx64 ", comparing memory instead",
+                             __FUNCTION__, tid, next_wp_addr);
+            const lldb::addr_t next_wp_end = next_wp_addr + m_page_watchpoints[next_wp_addr];
+            next_wp_bytes.resize (std::min (next_wp_end, fault_addr + max_access_size) - next_wp_addr);
+            lldb::addr_t bytes_read = 0;
+            if (ReadMemory (next_wp_addr, next_wp_bytes.data (), next_wp_bytes.size (), bytes_read).Fail () ||
+                bytes_read != next_wp_bytes.size ())
+                next_wp_bytes.clear ();
+        }
+    }
+
+    // The registers read for this stop are stale once the thread steps.
+    thread_sp->FlushRegisterCache ();
+
+    // Let the store through.  Other running threads can write to the pages
+    // unnoticed for the duration of this one step.
+    Error error = ApplyPageProtection (tid, pages, false);
+    if (error.Fail ())
+    {
+        if (log)
+            log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " failed to unprotect 0x%" PRIx64 ", reporting the fault: %s",
+                         __FUNCTION__, tid, page, error.AsCString ());
+        return false;
+    }
+
+    const Error step_error = SingleStepAndWait (tid);
+
+    bool next_wp_hit = false;
+    if (next_wp_index != LLDB_INVALID_INDEX32)
+    {
+        if (step_error.Success ())
+            reg_ctx_sp->IsWatchpointHit (next_wp_index, next_wp_hit);
+        reg_ctx_sp->ClearHardwareWatchpoint (next_wp_index);
+    }
+
+    error = ApplyPageProtection (tid, pages, true);
+    if (error.Fail () && log)
+        log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " failed to protect 0x%" PRIx64 " again: %s",
+                     __FUNCTION__, tid, page, error.AsCString ());
+
+    if (step_error.Fail ())
+    {
+        // Whatever interrupted the step has been passed on to the regular
+        // monitoring path.
+        if (log)
+            log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " failed to step over the store at 0x%" PRIx64 ": %s",
+                         __FUNCTION__, tid, fault_addr, step_error.AsCString ());
+        return true;
+    }
+
+    if (next_wp_hit)
+        hit_addr = next_wp_addr;
+    else if (!next_wp_bytes.empty ())
+    {
+        std::vector<uint8_t> bytes (next_wp_bytes.size ());
+        lldb::addr_t bytes_read = 0;
+        if (ReadMemory (next_wp_addr, bytes.data (), bytes.size (), bytes_read).Success () &&
+            bytes_read == bytes.size () && bytes != next_wp_bytes)
+            hit_addr = next_wp_addr;
+    }
+
+    if (hit_addr == LLDB_INVALID_ADDRESS)
+    {
+        // A store elsewhere on a watched page.  The inferior carries on as
+        // if nothing happened, unless it was being stepped.
+        if (thread_sp->GetState () == StateType::eStateStepping)
+        {
+            MonitorTrace (tid, thread_sp);
+            return true;
+        }
+
+        error = Resume (tid, LLDB_INVALID_SIGNAL_NUMBER);
+        if (error.Fail () && log)
+            log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " failed to resume: %s", __FUNCTION__, tid, error.AsCString ());
+        return true;
+    }
+
+    if (log)
+        log->Printf ("NativeProcessLinux::%s tid %" PRIu64 " hit page watchpoint 0x%" PRIx64 " with a store at 0x%" PRIx64,
+                     __FUNCTION__, tid, hit_addr, fault_addr);
+
+    // Like the debug registers, report the hit after the store.
+    NotifyThreadStop (tid);
+    thread_sp->SetStoppedByWatchpointAddress (hit_addr);
+    CallAfterRunningThreadsStop (tid,
+                                 [=] (lldb::tid_t deferred_notification_tid)
+                                 {
+                                     SetCurrentThreadID (deferred_notification_tid);
+                                     SetState (StateType::eStateStopped, true);
+                                 });
+    return true;
+}
+
+Error
+NativeProcessLinux::GetSoftwareBreakpointTrapOpcode (size_t trap_opcode_size_hint, size_t &actual_opcode_size, const uint8_t *&trap_opcode_bytes)
+{
+    // FIXME put this behind a breakpoint protocol class that can be
+    // set per architecture.  Need ARM, MIPS support here.
+    static const uint8_t g_aarch64_opcode[] = { 0x00, 0x00, 0x20, 0xd4 };
+    static const uint8_t g_i386_opcode [] = { 0xCC };
+    static const uint8_t g_mips64_opcode[] = { 0x00, 0x00, 0x00, 0x0d };
+
+    switch (m_arch.GetMachine ())
+    {
+    case llvm::Triple::aarch64:
+        trap_opcode_bytes = g_aarch64_opcode;
+        actual_opcode_size = sizeof(g_aarch64_opcode);
+        return Error ();
+
+    case llvm::Triple::x86:
+    case llvm::Triple::x86_64:
+        trap_opcode_bytes = g_i386_opcode;
+        actual_opcode_size = sizeof(g_i386_opcode);
+        return Error ();
+
+    case llvm::Triple::mips64:
+    case llvm::Triple::mips64el:
+        trap_opcode_bytes = g_mips64_opcode;
+        actual_opcode_size = sizeof(g_mips64_opcode);
+        return Error ();
+
+    default:
+        assert(false && "CPU type not supported!");
+        return Error ("CPU type not supported");
+    }
+}
+
+#if 0
+ProcessMessage::CrashReason
+NativeProcessLinux::GetCrashReasonForSIGSEGV(const siginfo_t *info)
+{
+    ProcessMessage::CrashReason reason;
+    assert(info->si_signo == SIGSEGV);
+
+    reason = ProcessMessage::eInvalidCrashReason;
+
+    switch (info->si_code)
+    {
+    default:
+        assert(false && "unexpected si_code for SIGSEGV");
+        break;
+    case SI_KERNEL:
+        // Linux will occasionally send spurious SI_KERNEL codes.
+        // (this is poorly documented in sigaction)
+        // One way to get this is via unaligned SIMD loads.
+        reason = ProcessMessage::eInvalidAddress; // for lack of anything better
+        break;
+    case SEGV_MAPERR:
+        reason = ProcessMessage::eInvalidAddress;
+        break;
+    case SEGV_ACCERR:
+        reason = ProcessMessage::ePrivilegedAddress;
+        break;
+    }
+
+    return reason;
+}
+#endif
+
+
+#if 0
+ProcessMessage::CrashReason
+NativeProcessLinux::GetCrashReasonForSIGILL(const siginfo_t *info)
+{
+    ProcessMessage::CrashReason reason;
+    assert(info->si_signo == SIGILL);
+
+    reason = ProcessMessage::eInvalidCrashReason;
+
+    switch (info->si_code)
+    {
+    default:
+        assert(false && "unexpected si_code for SIGILL");
+        break;
+    case ILL_ILLOPC:
+        reason = ProcessMessage::eIllegalOpcode;
+        break;
+    case ILL_ILLOPN:
+        reason = ProcessMessage::eIllegalOperand;
+        break;
+    case ILL_ILLADR:
+        reason = ProcessMessage::eIllegalAddressingMode;
+        break;
     case ILL_ILLTRP:
         reason = ProcessMessage::eIllegalTrap;
         break;
@@ -3406,60 +3858,13 @@ NativeProcessLinux::GetCrashReasonForSIGBUS(const siginfo_t *info)
 }
 #endif
 
-void
-NativeProcessLinux::ServeOperation(OperationArgs *args)
-{
-    NativeProcessLinux *monitor = args->m_monitor;
-
-    // We are finised with the arguments and are ready to go.  Sync with the
-    // parent thread and start serving operations on the inferior.
-    sem_post(&args->m_semaphore);
-
-    for(;;)
-    {
-        // wait for next pending operation
-        if (sem_wait(&monitor->m_operation_pending))
-        {
-            if (errno == EINTR)
-                continue;
-            assert(false && "Unexpected errno from sem_wait");
-        }
-
-        // EXIT_OPERATION used to stop the operation thread because Cancel() isn't supported on
-        // android. We don't have to send a post to the m_operation_done semaphore because in this
-        // case the synchronization is achieved by a Join() call
-        if (monitor->m_operation == EXIT_OPERATION)
-            break;
-
-        static_cast<Operation*>(monitor->m_operation)->Execute(monitor);
-
-        // notify calling thread that operation is complete
-        sem_post(&monitor->m_operation_done);
-    }
-}
-
 void
 NativeProcessLinux::DoOperation(void *op)
 {
-    Mutex::Locker lock(m_operation_mutex);
-
-    m_operation = op;
-
-    // notify operation thread that an operation is ready to be processed
-    sem_post(&m_operation_pending);
-
-    // Don't wait for the operation to complete in case of an exit operation. The operation thread
-    // will exit without posting to the semaphore
-    if (m_operation == EXIT_OPERATION)
-        return;
-
-    // wait for operation to complete
-    while (sem_wait(&m_operation_done))
-    {
-        if (errno == EINTR)
-            continue;
-        assert(false && "Unexpected errno from sem_wait");
-    }
+    // Every caller is on the main loop thread, which is the thread that
+    // launched or attached to the inferior, so ptrace accepts the request
+    // from here directly.
+    static_cast<Operation*>(op)->Execute(this);
 }
 
 Error
@@ -3478,6 +3883,110 @@ NativeProcessLinux::WriteMemory (lldb::addr_t addr, const void *buf, lldb::addr_
     return op.GetError ();
 }
 
+void
+NativeProcessLinux::ReadMemoryBlocks (std::vector<MemoryBlock> &blocks)
+{
+    TransferMemoryBlocks (blocks, false);
+}
+
+void
+NativeProcessLinux::WriteMemoryBlocks (std::vector<MemoryBlock> &blocks)
+{
+    TransferMemoryBlocks (blocks, true);
+}
+
+void
+NativeProcessLinux::TransferMemoryBlocks (std::vector<MemoryBlock> &blocks, bool write)
+{
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PROCESS));
+
+    // process_vm_writev honours page protections, so it can't write to
+    // read-only text the way PTRACE_POKEDATA can.  Writes to pages that
+    // aren't writable go straight to ptrace, and so do blocks on pages the
+    // process_vm calls have failed on.
+    const lldb::addr_t page_mask = ~(GetPageSize () - 1);
+    std::set<lldb::addr_t> ptrace_pages;
+    MemoryRegionInfo region_info;
+    bool have_region_info = false;
+    auto needs_ptrace = [&] (const MemoryBlock &block)
+    {
+        if (ptrace_pages.find (block.addr & page_mask) != ptrace_pages.end ())
+            return true;
+        if (!write)
+            return false;
+        // Blocks are mostly sorted, so one lookup covers a run of them.
+        if (!have_region_info || !region_info.GetRange ().Contains (block.addr))
+            have_region_info = GetMemoryRegionInfo (block.addr, region_info).Success ();
+        return have_region_info && region_info.GetWritable () != MemoryRegionInfo::eYes;
+    };
+    bool use_vm_calls = true;
+    size_t num_vm_calls = 0;
+    size_t num_ptrace_blocks = 0;
+
+    std::vector<struct iovec> local_iov;
+    std::vector<struct iovec> remote_iov;
+    size_t index = 0;
+    while (index < blocks.size ())
+    {
+        // Gather the run of blocks that can go in one system call.
+        local_iov.clear ();
+        remote_iov.clear ();
+        size_t end = index;
+        while (use_vm_calls &&
+               end < blocks.size () &&
+               local_iov.size () < IOV_MAX &&
+               !needs_ptrace (blocks[end]))
+        {
+            struct iovec local = { blocks[end].buf, blocks[end].size };
+            struct iovec remote = { reinterpret_cast<void *> (blocks[end].addr), blocks[end].size };
+            local_iov.push_back (local);
+            remote_iov.push_back (remote);
+            ++end;
+        }
+
+        size_t bytes_transferred = 0;
+        if (!local_iov.empty ())
+        {
+            ++num_vm_calls;
+            const ssize_t result = write
+                ? ::process_vm_writev (GetID (), local_iov.data (), local_iov.size (), remote_iov.data (), remote_iov.size (), 0)
+                : ::process_vm_readv (GetID (), local_iov.data (), local_iov.size (), remote_iov.data (), remote_iov.size (), 0);
+            if (result >= 0)
+                bytes_transferred = result;
+            else if (errno == ENOSYS || errno == EPERM)
+                use_vm_calls = false;
+        }
+
+        // The system call stops at the first block it can't transfer
+        // completely; everything before that is done.
+        while (index < end && bytes_transferred >= blocks[index].size)
+        {
+            bytes_transferred -= blocks[index].size;
+            blocks[index].error.Clear ();
+            ++index;
+        }
+        if (index == blocks.size ())
+            break;
+
+        // Move the next block with ptrace instead.
+        MemoryBlock &block = blocks[index];
+        if (index < end)
+            ptrace_pages.insert (block.addr & page_mask);
+        lldb::addr_t bytes = 0;
+        block.error = write
+            ? WriteMemory (block.addr, block.buf, block.size, bytes)
+            : ReadMemory (block.addr, block.buf, block.size, bytes);
+        if (block.error.Success () && bytes != block.size)
+            block.error.SetErrorStringWithFormat ("transferred %" PRIu64 " of %zu bytes at 0x%" PRIx64, bytes, block.size, block.addr);
+        ++num_ptrace_blocks;
+        ++index;
+    }
+
+    if (log)
+        log->Printf ("NativeProcessLinux::%s %s %zu blocks: %zu process_vm calls, %zu blocks through ptrace",
+                     __FUNCTION__, write ? "wrote" : "read", blocks.size (), num_vm_calls, num_ptrace_blocks);
+}
+
 Error
 NativeProcessLinux::ReadRegisterValue(lldb::tid_t tid, uint32_t offset, const char* reg_name,
                                       uint32_t size, RegisterValue &value)
@@ -3567,6 +4076,303 @@ NativeProcessLinux::SingleStep(lldb::tid_t tid, uint32_t signo)
     return op.GetError();
 }
 
+Error
+NativeProcessLinux::SingleStepAndWait(lldb::tid_t tid)
+{
+    std::vector<int> deferred_signals;
+    Error error;
+    while (true)
+    {
+        error = SingleStep(tid, LLDB_INVALID_SIGNAL_NUMBER);
+        if (error.Fail())
+            break;
+
+        int status = 0;
+        ::pid_t wait_pid;
+        do
+            wait_pid = ::waitpid(static_cast< ::pid_t>(tid), &status, __WALL);
+        while (wait_pid == -1 && errno == EINTR);
+
+        if (wait_pid == -1)
+        {
+            error.SetErrorToErrno();
+            break;
+        }
+
+        // A plain SIGTRAP (no ptrace event in the high bits) ends the step.
+        if (WIFSTOPPED(status) && WSTOPSIG(status) == SIGTRAP && (status >> 16) == 0)
+            break;
+
+        // A signal arrived before the instruction ran.  Hold it back and
+        // step again.
+        if (WIFSTOPPED(status) && WSTOPSIG(status) != SIGTRAP)
+        {
+            deferred_signals.push_back(WSTOPSIG(status));
+            continue;
+        }
+
+        // The thread exited or hit a ptrace event.  That is for the regular
+        // monitoring path to deal with, once the current callback is done.
+        std::weak_ptr<NativeProcessProtocol> process_wp = shared_from_this();
+        m_mainloop.AddPendingCallback([process_wp, wait_pid, status] (MainLoopBase &)
+        {
+            NativeProcessProtocolSP process_sp = process_wp.lock();
+            if (process_sp)
+                static_cast<NativeProcessLinux*>(process_sp.get())->MonitorWaitStatus(wait_pid, status);
+        });
+        error.SetErrorStringWithFormat("thread %" PRIu64 " stopped with status 0x%x while stepping", tid, status);
+        break;
+    }
+
+    // Re-send the held back signals; they come back through SIGCHLD.
+    for (int signo : deferred_signals)
+        tgkill(GetID(), tid, signo);
+
+    return error;
+}
+
+Error
+NativeProcessLinux::FindSyscallInstruction(lldb::addr_t &syscall_addr)
+{
+    static const uint8_t g_syscall_opcode[] = { 0x0f, 0x05 };
+
+    // The code may have been unmapped since, or had a breakpoint set on it.
+    if (m_syscall_addr != LLDB_INVALID_ADDRESS)
+    {
+        uint8_t code[sizeof(g_syscall_opcode)];
+        lldb::addr_t bytes_read = 0;
+        if (ReadMemory(m_syscall_addr, code, sizeof(code), bytes_read).Success() &&
+            bytes_read == sizeof(code) && memcmp(code, g_syscall_opcode, sizeof(code)) == 0)
+        {
+            syscall_addr = m_syscall_addr;
+            return Error();
+        }
+        m_syscall_addr = LLDB_INVALID_ADDRESS;
+    }
+
+    // The vDSO is small and stays mapped for the life of the process, so
+    // look there first, then in the rest of the executable memory.
+    std::vector<MemoryRegionInfo> regions;
+    Error error = ProcFileReader::ProcessLineByLine(GetID(), "maps",
+        [&] (const std::string &line) -> bool
+        {
+            MemoryRegionInfo info;
+            if (ParseMemoryRegionInfoFromProcMapsLine(line, info).Success() &&
+                info.GetReadable() == MemoryRegionInfo::OptionalBool::eYes &&
+                info.GetExecutable() == MemoryRegionInfo::OptionalBool::eYes)
+            {
+                if (line.find("[vdso]") != std::string::npos)
+                    regions.insert(regions.begin(), info);
+                else
+                    regions.push_back(info);
+            }
+            return true;
+        });
+    if (error.Fail())
+        return error;
+
+    // The thread jumps straight to the opcode, so it doesn't matter which
+    // instruction the two bytes belong to.
+    std::vector<uint8_t> code(GetPageSize());
+    for (const MemoryRegionInfo &region : regions)
+    {
+        lldb::addr_t addr = region.GetRange().GetRangeBase();
+        const lldb::addr_t end = region.GetRange().GetRangeEnd();
+        while (end - addr >= sizeof(g_syscall_opcode))
+        {
+            lldb::addr_t bytes_read = 0;
+            if (ReadMemory(addr, code.data(), std::min<lldb::addr_t>(code.size(), end - addr), bytes_read).Fail() ||
+                bytes_read < sizeof(g_syscall_opcode))
+                break;
+
+            for (lldb::addr_t i = 0; i + 1 < bytes_read; ++i)
+            {
+                if (code[i] == g_syscall_opcode[0] && code[i + 1] == g_syscall_opcode[1])
+                {
+                    m_syscall_addr = addr + i;
+                    syscall_addr = m_syscall_addr;
+                    return Error();
+                }
+            }
+
+            // Read the last byte again in case the opcode straddles two reads.
+            addr += bytes_read - 1;
+        }
+    }
+    return Error("no syscall instruction found in process %" PRIu64, GetID());
+}
+
+Error
+NativeProcessLinux::InferiorSyscall(lldb::tid_t tid, long number, const std::vector<uint64_t> &args, uint64_t &result)
+{
+#if defined (__x86_64__)
+    if (m_arch.GetMachine() != llvm::Triple::x86_64)
+        return Error("inferior system calls are only supported in x86_64 processes");
+    if (args.size() > 6)
+        return Error("a system call takes at most 6 arguments");
+
+    struct user_regs_struct saved_regs;
+    Error error = ReadGPR(tid, &saved_regs, sizeof(saved_regs));
+    if (error.Fail())
+        return error;
+
+    // Writing a syscall instruction at the pc would change the code under
+    // the other threads, which keep running meanwhile.
+    lldb::addr_t syscall_addr = LLDB_INVALID_ADDRESS;
+    error = FindSyscallInstruction(syscall_addr);
+    if (error.Fail())
+        return error;
+
+    uint64_t arg_values[6] = { 0, 0, 0, 0, 0, 0 };
+    std::copy(args.begin(), args.end(), arg_values);
+
+    struct user_regs_struct regs = saved_regs;
+    regs.rip = syscall_addr;
+    // Keep the kernel from restarting a system call the thread was stopped in.
+    regs.orig_rax = static_cast<uint64_t>(-1);
+    regs.rax = number;
+    regs.rdi = arg_values[0];
+    regs.rsi = arg_values[1];
+    regs.rdx = arg_values[2];
+    regs.r10 = arg_values[3];
+    regs.r8 = arg_values[4];
+    regs.r9 = arg_values[5];
+
+    error = WriteGPR(tid, &regs, sizeof(regs));
+    if (error.Success())
+        error = SingleStepAndWait(tid);
+    if (error.Success())
+        error = ReadGPR(tid, &regs, sizeof(regs));
+
+    // Put the registers back no matter how far we got.
+    Error restore_error = WriteGPR(tid, &saved_regs, sizeof(saved_regs));
+    if (error.Success())
+        error = restore_error;
+    if (error.Fail())
+        return error;
+
+    result = regs.rax;
+    const int64_t signed_result = static_cast<int64_t>(result);
+    if (signed_result < 0 && signed_result >= -4095)
+        error.SetError(static_cast<Error::ValueType>(-signed_result), eErrorTypePOSIX);
+    return error;
+#else
+    return Error("inferior system calls are not supported on this architecture");
+#endif
+}
+
+void
+NativeProcessLinux::DetachForkedChild (lldb::pid_t child_pid)
+{
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PROCESS | LIBLLDB_LOG_WATCHPOINTS));
+
+    // The child starts out stopped by a SIGSTOP.  If the SIGCHLD handler saw
+    // that stop before the fork event, it took the child for a new thread.
+    if (!StopTrackingThread (child_pid))
+    {
+        int status = 0;
+        ::pid_t wait_pid;
+        do
+            wait_pid = ::waitpid (static_cast< ::pid_t> (child_pid), &status, __WALL);
+        while (wait_pid == -1 && errno == EINTR);
+
+        if (wait_pid == -1 || !WIFSTOPPED (status))
+        {
+            if (log)
+                log->Printf ("NativeProcessLinux::%s child %" PRIu64 " did not stop (status 0x%x)", __FUNCTION__, child_pid, status);
+            return;
+        }
+    }
+
+    std::vector<int> deferred_signals;
+    if (!m_protected_pages.empty ())
+    {
+        const Error error = RestorePageProtectionInChild (child_pid, deferred_signals);
+        if (error.Fail () && log)
+            log->Printf ("NativeProcessLinux::%s failed to restore page protections in child %" PRIu64 ": %s",
+                         __FUNCTION__, child_pid, error.AsCString ());
+    }
+
+    const Error error = Detach (child_pid);
+    if (error.Fail () && log)
+        log->Printf ("NativeProcessLinux::%s failed to detach from child %" PRIu64 ": %s", __FUNCTION__, child_pid, error.AsCString ());
+
+    for (int signo : deferred_signals)
+        ::kill (static_cast< ::pid_t> (child_pid), signo);
+}
+
+Error
+NativeProcessLinux::RestorePageProtectionInChild (lldb::pid_t child_pid, std::vector<int> &deferred_signals)
+{
+#if defined (__x86_64__)
+    if (m_arch.GetMachine() != llvm::Triple::x86_64)
+        return Error("inferior system calls are only supported in x86_64 processes");
+
+    struct user_regs_struct saved_regs;
+    Error error = ReadGPR(child_pid, &saved_regs, sizeof(saved_regs));
+    if (error.Fail())
+        return error;
+
+    // The child stopped right after the system call that forked it.  Run
+    // mprotect with that syscall instruction; InferiorSyscall can't be used
+    // because ReadMemory and SingleStepAndWait only reach the parent.
+    static const uint16_t g_syscall_opcode = 0x050f;
+    const lldb::addr_t syscall_addr = saved_regs.rip - 2;
+    const long code = PTRACE(PTRACE_PEEKTEXT, child_pid, (void*)syscall_addr, nullptr, 0, error);
+    if (error.Fail())
+        return error;
+    if ((code & 0xffff) != g_syscall_opcode)
+        return Error("child %" PRIu64 " did not stop after a syscall instruction", child_pid);
+
+    std::vector<lldb::addr_t> pages;
+    for (const auto &protected_page : m_protected_pages)
+        pages.push_back(protected_page.first);
+
+    for (const std::vector<uint64_t> &args : GetPageProtectionArgs(pages, false))
+    {
+        struct user_regs_struct regs = saved_regs;
+        regs.rip = syscall_addr;
+        regs.orig_rax = static_cast<uint64_t>(-1);
+        regs.rax = SYS_mprotect;
+        regs.rdi = args[0];
+        regs.rsi = args[1];
+        regs.rdx = args[2];
+        error = WriteGPR(child_pid, &regs, sizeof(regs));
+
+        while (error.Success())
+        {
+            error = SingleStep(child_pid, LLDB_INVALID_SIGNAL_NUMBER);
+            if (error.Fail())
+                break;
+
+            int status = 0;
+            ::pid_t wait_pid;
+            do
+                wait_pid = ::waitpid(static_cast< ::pid_t>(child_pid), &status, __WALL);
+            while (wait_pid == -1 && errno == EINTR);
+
+            if (wait_pid == -1)
+                error.SetErrorToErrno();
+            else if (WIFSTOPPED(status) && WSTOPSIG(status) == SIGTRAP)
+                break;
+            else if (WIFSTOPPED(status))
+                deferred_signals.push_back(WSTOPSIG(status));
+            else
+                error.SetErrorStringWithFormat("child %" PRIu64 " exited while changing page protections", child_pid);
+        }
+        if (error.Fail())
+            break;
+    }
+
+    Error restore_error = WriteGPR(child_pid, &saved_regs, sizeof(saved_regs));
+    if (error.Success())
+        error = restore_error;
+    return error;
+#else
+    return Error("inferior system calls are not supported on this architecture");
+#endif
+}
+
 Error
 NativeProcessLinux::GetSignalInfo(lldb::tid_t tid, void *siginfo)
 {
@@ -3608,24 +4414,27 @@ NativeProcessLinux::DupDescriptor(const char *path, int fd, int flags)
     return (close(target_fd) == -1) ? false : true;
 }
 
-void
-NativeProcessLinux::StopMonitorThread()
+Error
+NativeProcessLinux::StartMonitor()
 {
-    if (m_monitor_thread.IsJoinable())
-    {
-        ::pthread_kill(m_monitor_thread.GetNativeThread().GetSystemHandle(), SIGUSR1);
-        m_monitor_thread.Join(nullptr);
-    }
+    Log *const log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_THREAD));
+
+    // Enable verbose logging if lldb thread logging is enabled.
+    m_coordinator_up->LogEnableEventProcessing (log != nullptr);
+    m_coordinator_up->SetEventQueuedFunction ([this] () { ScheduleCoordinatorEvents (); });
+
+    Error error;
+    m_sigchld_handle = m_mainloop.RegisterSignal (SIGCHLD,
+                                                  [this] (MainLoopBase &) { SigchldHandler (); },
+                                                  error);
+    return error;
 }
 
 void
 NativeProcessLinux::StopMonitor()
 {
-    StopMonitorThread();
-    StopCoordinatorThread ();
-    StopOpThread();
-    sem_destroy(&m_operation_pending);
-    sem_destroy(&m_operation_done);
+    m_sigchld_handle.reset ();
+    m_coordinator_up->SetEventQueuedFunction (ThreadStateCoordinator::EventQueuedFunction ());
 
     // TODO: validate whether this still holds, fix up comment.
     // Note: ProcessPOSIX passes the m_terminal_fd file descriptor to
@@ -3635,77 +4444,24 @@ NativeProcessLinux::StopMonitor()
 }
 
 void
-NativeProcessLinux::StopOpThread()
+NativeProcessLinux::ScheduleCoordinatorEvents ()
 {
-    if (!m_operation_thread.IsJoinable())
+    // One pending callback drains everything queued before it runs.
+    if (m_coordinator_events_scheduled.exchange (true))
         return;
 
-    DoOperation(EXIT_OPERATION);
-    m_operation_thread.Join(nullptr);
-}
-
-Error
-NativeProcessLinux::StartCoordinatorThread ()
-{
-    Error error;
-    static const char *g_thread_name = "lldb.process.linux.ts_coordinator";
-    Log *const log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_THREAD));
-
-    // Skip if thread is already running
-    if (m_coordinator_thread.IsJoinable())
+    // The callback may outlive us if the process is torn down first.
+    std::weak_ptr<NativeProcessProtocol> process_wp = shared_from_this ();
+    m_mainloop.AddPendingCallback ([process_wp] (MainLoopBase &)
     {
-        error.SetErrorString ("ThreadStateCoordinator's run loop is already running");
-        if (log)
-            log->Printf ("NativeProcessLinux::%s %s", __FUNCTION__, error.AsCString ());
-        return error;
-    }
-
-    // Enable verbose logging if lldb thread logging is enabled.
-    m_coordinator_up->LogEnableEventProcessing (log != nullptr);
-
-    if (log)
-        log->Printf ("NativeProcessLinux::%s launching ThreadStateCoordinator thread for pid %" PRIu64, __FUNCTION__, GetID ());
-    m_coordinator_thread = ThreadLauncher::LaunchThread(g_thread_name, CoordinatorThread, this, &error);
-    return error;
-}
-
-void *
-NativeProcessLinux::CoordinatorThread (void *arg)
-{
-    Log *const log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_THREAD));
-
-    NativeProcessLinux *const process = static_cast<NativeProcessLinux*> (arg);
-    assert (process && "null process passed to CoordinatorThread");
-    if (!process)
-    {
-        if (log)
-            log->Printf ("NativeProcessLinux::%s null process, exiting ThreadStateCoordinator processing loop", __FUNCTION__);
-        return nullptr;
-    }
-
-    // Run the thread state coordinator loop until it is done.  This call uses
-    // efficient waiting for an event to be ready.
-    while (process->m_coordinator_up->ProcessNextEvent () == ThreadStateCoordinator::eventLoopResultContinue)
-    {
-    }
-
-    if (log)
-        log->Printf ("NativeProcessLinux::%s pid %" PRIu64 " exiting ThreadStateCoordinator processing loop due to coordinator indicating completion", __FUNCTION__, process->GetID ());
-
-    return nullptr;
-}
-
-void
-NativeProcessLinux::StopCoordinatorThread()
-{
-    Log *const log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_THREAD));
-    if (log)
-        log->Printf ("NativeProcessLinux::%s requesting ThreadStateCoordinator stop for pid %" PRIu64, __FUNCTION__, GetID ());
+        NativeProcessProtocolSP process_sp = process_wp.lock ();
+        if (!process_sp)
+            return;
 
-    // Tell the coordinator we're done.  This will cause the coordinator
-    // run loop thread to exit when the processing queue hits this message.
-    m_coordinator_up->StopCoordinator ();
-    m_coordinator_thread.Join (nullptr);
+        NativeProcessLinux *const process = static_cast<NativeProcessLinux*> (process_sp.get ());
+        process->m_coordinator_events_scheduled = false;
+        process->m_coordinator_up->ProcessPendingEvents ();
+    });
 }
 
 bool
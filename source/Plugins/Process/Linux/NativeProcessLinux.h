@@ -11,17 +11,19 @@
 #define liblldb_NativeProcessLinux_H_
 
 // C Includes
-#include <semaphore.h>
 #include <signal.h>
 
 // C++ Includes
+#include <atomic>
+#include <map>
 #include <unordered_set>
+#include <vector>
 
 // Other libraries and framework includes
 #include "lldb/Core/ArchSpec.h"
 #include "lldb/lldb-types.h"
 #include "lldb/Host/Debug.h"
-#include "lldb/Host/HostThread.h"
+#include "lldb/Host/MainLoopBase.h"
 #include "lldb/Host/Mutex.h"
 #include "lldb/Target/MemoryRegionInfo.h"
 
@@ -34,6 +36,7 @@ namespace lldb_private {
 
 namespace process_linux {
     class ThreadStateCoordinator;
+    class NativeThreadLinux;
 
     /// @class NativeProcessLinux
     /// @brief Manages communication with the inferior (debugee) process.
@@ -51,12 +54,14 @@ namespace process_linux {
             Module *exe_module,
             ProcessLaunchInfo &launch_info,
             NativeProcessProtocol::NativeDelegate &native_delegate,
+            MainLoopBase &mainloop,
             NativeProcessProtocolSP &native_process_sp);
 
         static Error
         AttachToProcess (
             lldb::pid_t pid,
             NativeProcessProtocol::NativeDelegate &native_delegate,
+            MainLoopBase &mainloop,
             NativeProcessProtocolSP &native_process_sp);
 
         // ---------------------------------------------------------------------
@@ -107,6 +112,18 @@ namespace process_linux {
         Error
         SetBreakpoint (lldb::addr_t addr, uint32_t size, bool hardware) override;
 
+        void
+        SetBreakpoints (const std::vector<lldb::addr_t> &addrs,
+                        const std::vector<uint32_t> &size_hints,
+                        bool hardware,
+                        std::vector<Error> &errors) override;
+
+        Error
+        SetWatchpoint (lldb::addr_t addr, size_t size, uint32_t watch_flags, bool hardware) override;
+
+        Error
+        RemoveWatchpoint (lldb::addr_t addr) override;
+
         void
         DoStopIDBumped (uint32_t newBumpId) override;
 
@@ -169,28 +186,48 @@ namespace process_linux {
         Error
         GetSoftwareBreakpointTrapOpcode (size_t trap_opcode_size_hint, size_t &actual_opcode_size, const uint8_t *&trap_opcode_bytes) override;
 
-    private:
+        void
+        ReadMemoryBlocks (std::vector<MemoryBlock> &blocks) override;
 
-        ArchSpec m_arch;
+        void
+        WriteMemoryBlocks (std::vector<MemoryBlock> &blocks) override;
 
-        HostThread m_operation_thread;
-        HostThread m_monitor_thread;
+    private:
 
-        // current operation which must be executed on the priviliged thread
-        void *m_operation;
-        Mutex m_operation_mutex;
+        ArchSpec m_arch;
 
-        // semaphores notified when Operation is ready to be processed and when
-        // the operation is complete.
-        sem_t m_operation_pending;
-        sem_t m_operation_done;
+        // The loop that delivers waitpid notifications and runs every ptrace
+        // operation.  Its thread is the one that launched or attached to the
+        // inferior.
+        MainLoopBase &m_mainloop;
+        MainLoopBase::SignalHandleUP m_sigchld_handle;
+        ::pid_t m_inferior_pgid;
 
         LazyBool m_supports_mem_region;
         std::vector<MemoryRegionInfo> m_mem_region_cache;
         Mutex m_mem_region_cache_mutex;
 
         std::unique_ptr<ThreadStateCoordinator> m_coordinator_up;
-        HostThread m_coordinator_thread;
+        std::atomic<bool> m_coordinator_events_scheduled;
+
+        // Write watchpoints that don't fit in the debug registers are
+        // emulated by write-protecting the pages that hold them.  Maps the
+        // watched address to its size.
+        std::map<lldb::addr_t, size_t> m_page_watchpoints;
+
+        struct ProtectedPage
+        {
+            int original_prot;  // PROT_* flags of the page before we touched it.
+            uint32_t ref_count; // Number of page watchpoints on the page.
+        };
+
+        // Pages currently write-protected on behalf of m_page_watchpoints,
+        // keyed by page address.
+        std::map<lldb::addr_t, ProtectedPage> m_protected_pages;
+
+        // A syscall instruction that InferiorSyscall runs system calls with,
+        // LLDB_INVALID_ADDRESS until one has been looked for.
+        lldb::addr_t m_syscall_addr;
 
         struct OperationArgs
         {
@@ -199,7 +236,6 @@ namespace process_linux {
             ~OperationArgs();
 
             NativeProcessLinux *m_monitor;      // The monitor performing the attach.
-            sem_t m_semaphore;              // Posted to once operation complete.
             Error m_error;    // Set if process operation failed.
         };
 
@@ -244,7 +280,7 @@ namespace process_linux {
         // ---------------------------------------------------------------------
         // Private Instance Methods
         // ---------------------------------------------------------------------
-        NativeProcessLinux ();
+        NativeProcessLinux (MainLoopBase &mainloop);
 
         /// Launches an inferior process ready for debugging.  Forms the
         /// implementation of Process::DoLaunch.
@@ -265,30 +301,15 @@ namespace process_linux {
         void
         AttachToInferior (lldb::pid_t pid, Error &error);
 
-        void
-        StartLaunchOpThread(LaunchArgs *args, Error &error);
-
-        static void *
-        LaunchOpThread(void *arg);
-
         static bool
         Launch(LaunchArgs *args);
 
-        void
-        StartAttachOpThread(AttachArgs *args, Error &error);
-
-        static void *
-        AttachOpThread(void *args);
-
         static bool
         Attach(AttachArgs *args);
 
         static Error
         SetDefaultPtraceOpts(const lldb::pid_t);
 
-        static void
-        ServeOperation(OperationArgs *args);
-
         static bool
         DupDescriptor(const char *path, int fd, int flags);
 
@@ -296,12 +317,35 @@ namespace process_linux {
         MonitorCallback(void *callback_baton,
                 lldb::pid_t pid, bool exited, int signal, int status);
 
+        /// Reaps every pending waitpid() result for the inferior's process
+        /// group and hands each one to MonitorCallback.  Runs on the main
+        /// loop whenever SIGCHLD arrives.
+        void
+        SigchldHandler ();
+
+        /// Decodes one waitpid() status and hands it to MonitorCallback.
+        /// Stops monitoring if the inferior is gone.
+        void
+        MonitorWaitStatus (::pid_t wait_pid, int status);
+
+        // Moves blocks with process_vm_readv/process_vm_writev, a batch per
+        // system call, falling back to ptrace for blocks those can't reach.
+        void
+        TransferMemoryBlocks (std::vector<MemoryBlock> &blocks, bool write);
+
         void
         MonitorSIGTRAP(const siginfo_t *info, lldb::pid_t pid);
 
         void
         MonitorTrace(lldb::pid_t pid, NativeThreadProtocolSP thread_sp);
 
+        /// If the thread is range stepping and is still inside the range,
+        /// single step it again and return true. The stop isn't reported.
+        /// Sets at_breakpoint when the range step ends because the thread
+        /// reached an enabled software breakpoint inside the range.
+        bool
+        StepAgainInRange(const std::shared_ptr<NativeThreadLinux> &thread_sp, bool &at_breakpoint);
+
         void
         MonitorBreakpoint(lldb::pid_t pid, NativeThreadProtocolSP thread_sp);
 
@@ -311,6 +355,16 @@ namespace process_linux {
         void
         MonitorSignal(const siginfo_t *info, lldb::pid_t pid, bool exited);
 
+        /// Handles a SIGSEGV at @p fault_addr that may come from a page
+        /// write-protected for a page watchpoint.  Lets the faulting store
+        /// complete and then either reports the watchpoint hit or resumes
+        /// the thread.
+        ///
+        /// @return
+        ///     false if the fault is not ours and must reach the inferior.
+        bool
+        MonitorPageWatchpointFault(const std::shared_ptr<NativeThreadLinux> &thread_sp, lldb::addr_t fault_addr);
+
 #if 0
         static ::ProcessMessage::CrashReason
         GetCrashReasonForSIGSEGV(const siginfo_t *info);
@@ -328,26 +382,19 @@ namespace process_linux {
         void
         DoOperation(void *op);
 
-        /// Stops the child monitor thread.
-        void
-        StopMonitorThread();
-
-        /// Stops the operation thread used to attach/launch a process.
-        void
-        StopOpThread();
-
+        /// Starts receiving SIGCHLD and ThreadStateCoordinator work on the
+        /// main loop.
         Error
-        StartCoordinatorThread ();
-
-        static void*
-        CoordinatorThread (void *arg);
+        StartMonitor();
 
+        /// Stops monitoring the child process.
         void
-        StopCoordinatorThread ();
+        StopMonitor();
 
-        /// Stops monitoring the child process thread.
+        /// Has the ThreadStateCoordinator's queued events processed on the
+        /// main loop once the current callback returns.
         void
-        StopMonitor();
+        ScheduleCoordinatorEvents ();
 
         bool
         HasThreadNoLock (lldb::tid_t thread_id);
@@ -391,6 +438,65 @@ namespace process_linux {
         Error
         SingleStep(lldb::tid_t tid, uint32_t signo);
 
+        /// Single steps the given thread and waits for the step to finish
+        /// without going through the main loop.  Signals that arrive in the
+        /// meantime are sent to the thread again afterwards.
+        Error
+        SingleStepAndWait(lldb::tid_t tid);
+
+        /// Finds a syscall instruction in the inferior's executable memory,
+        /// preferably in the vDSO, and remembers it in m_syscall_addr.
+        Error
+        FindSyscallInstruction(lldb::addr_t &syscall_addr);
+
+        /// Makes the stopped thread @p tid execute system call @p number with
+        /// @p args, then restores its registers.  The thread jumps to a
+        /// syscall instruction already in the inferior, so the code other
+        /// threads may be running is never modified.
+        Error
+        InferiorSyscall(lldb::tid_t tid, long number, const std::vector<uint64_t> &args, uint64_t &result);
+
+        /// Watches writes to @p addr by write-protecting the pages that hold
+        /// it.  The kernel doesn't fault on these pages, it fails instead:
+        /// a system call that writes to a watched page (e.g. read() into a
+        /// watched buffer) returns EFAULT in the inferior, so only watch
+        /// memory the inferior doesn't hand to the kernel.  Thread stacks,
+        /// where signal frames go, are refused.  vfork children share the
+        /// protections and die of a store to a watched page.
+        Error
+        SetPageWatchpoint (lldb::addr_t addr, size_t size, uint32_t watch_flags);
+
+        Error
+        RemovePageWatchpoint (lldb::addr_t addr);
+
+        /// Groups the sorted @p pages into runs of adjacent pages that get
+        /// the same protection, as (address, length, protection) arguments
+        /// for mprotect.
+        std::vector<std::vector<uint64_t>>
+        GetPageProtectionArgs (const std::vector<lldb::addr_t> &pages, bool write_protect);
+
+        /// Write-protects @p pages, or gives them back their original
+        /// protection, by running mprotect in the inferior on thread @p tid.
+        /// The pages must be sorted and present in m_protected_pages.
+        Error
+        ApplyPageProtection (lldb::tid_t tid, const std::vector<lldb::addr_t> &pages, bool write_protect);
+
+        /// Gives the pages in m_protected_pages back their original
+        /// protection in the just forked, stopped child @p child_pid, which
+        /// would otherwise die on its first store to a watched page.
+        /// Signals that stop the child meanwhile are added to
+        /// @p deferred_signals.
+        Error
+        RestorePageProtectionInChild (lldb::pid_t child_pid, std::vector<int> &deferred_signals);
+
+        /// Lets go of a forked child; only the inferior itself is debugged.
+        void
+        DetachForkedChild (lldb::pid_t child_pid);
+
+        /// Returns a thread stopped in the tracer that can run code for us.
+        NativeThreadProtocolSP
+        GetThreadForInferiorCall ();
+
         // ThreadStateCoordinator helper methods.
         void
         NotifyThreadCreateStopped (lldb::tid_t tid);
@@ -337,7 +337,11 @@ NativeRegisterContextLinux_x86_64::NativeRegisterContextLinux_x86_64 (NativeThre
     m_iovec (),
     m_ymm_set (),
     m_reg_info (),
-    m_gpr_x86_64 ()
+    m_gpr_x86_64 (),
+    m_gpr_valid (false),
+    m_gpr_dirty (false),
+    m_fpr_valid (false),
+    m_fpr_dirty (false)
 {
     // Set up data about ranges of valid registers.
     switch (reg_info_interface_p->GetTargetArchitecture ().GetMachine ())
@@ -496,6 +500,19 @@ NativeRegisterContextLinux_x86_64::ReadRegister (const RegisterInfo *reg_info, R
             return error;
         }
     }
+    else if (IsGPR(reg))
+    {
+        // Slice the register out of the cached GPR set; this also covers
+        // sub-registers such as eax or ah, which live at an offset inside
+        // their full register.
+        if (!ReadGPR())
+        {
+            error.SetErrorString ("failed to read general purpose registers");
+            return error;
+        }
+
+        return ReadRegisterFromGPR (reg_info, m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize (), GetByteOrder (), reg_value);
+    }
     else
     {
         uint32_t full_reg = reg;
@@ -662,10 +679,23 @@ NativeRegisterContextLinux_x86_64::WriteRegister (const RegisterInfo *reg_info,
         return Error ("no lldb regnum for %s", reg_info && reg_info->name ? reg_info->name : "<unknown register>");
 
     if (IsGPR(reg_index))
-        return WriteRegister(reg_index, reg_value);
+    {
+        // Update the cached GPR set; it gets written back before the thread resumes.
+        if (!ReadGPR())
+            return Error ("failed to read general purpose registers");
+
+        Error error = WriteRegisterToGPR (reg_info, reg_value, m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize (), GetByteOrder ());
+        if (error.Success ())
+            m_gpr_dirty = true;
+        return error;
+    }
 
     if (IsFPR(reg_index, GetFPRType()))
     {
+        // Make sure the rest of the set is current before modifying part of it.
+        if (!ReadFPR())
+            return Error ("failed to read floating point registers");
+
         if (reg_info->encoding == lldb::eEncodingVector)
         {
             if (reg_index >= m_reg_info.first_st && reg_index <= m_reg_info.last_st)
@@ -710,15 +740,8 @@ NativeRegisterContextLinux_x86_64::WriteRegister (const RegisterInfo *reg_info,
             }
         }
 
-        if (WriteFPR())
-        {
-            if (IsAVX(reg_index))
-            {
-                if (!CopyYMMtoXSTATE(reg_index, GetByteOrder()))
-                    return Error ("CopyYMMtoXSTATE() failed");
-            }
-            return Error ();
-        }
+        m_fpr_dirty = true;
+        return Error ();
     }
     return Error ("failed - register wasn't recognized to be a GPR or an FPR, write strategy unknown");
 }
@@ -846,6 +869,56 @@ NativeRegisterContextLinux_x86_64::WriteAllRegisterValues (const lldb::DataBuffe
     return error;
 }
 
+Error
+NativeRegisterContextLinux_x86_64::WriteDirtyRegisters ()
+{
+    if (m_gpr_dirty && !WriteGPR ())
+        return Error ("failed to write back general purpose registers");
+
+    if (m_fpr_dirty && !WriteFPR ())
+        return Error ("failed to write back floating point registers");
+
+    return Error ();
+}
+
+void
+NativeRegisterContextLinux_x86_64::InvalidateAllRegisters ()
+{
+    m_gpr_valid = false;
+    m_gpr_dirty = false;
+    m_fpr_valid = false;
+    m_fpr_dirty = false;
+}
+
+Error
+NativeRegisterContextLinux_x86_64::ReadRegisterFromGPR (const RegisterInfo *reg_info, const void *gpr, size_t gpr_size, lldb::ByteOrder byte_order, RegisterValue &reg_value)
+{
+    Error error;
+    if (reg_info->byte_offset + reg_info->byte_size > gpr_size)
+    {
+        error.SetErrorStringWithFormat ("register \"%s\" lies outside of the general purpose register set", reg_info->name);
+        return error;
+    }
+
+    // Sub-registers such as eax or ah live at an offset inside their full register.
+    const uint8_t *src = static_cast<const uint8_t *> (gpr) + reg_info->byte_offset;
+    reg_value.SetFromMemoryData (reg_info, src, reg_info->byte_size, byte_order, error);
+    return error;
+}
+
+Error
+NativeRegisterContextLinux_x86_64::WriteRegisterToGPR (const RegisterInfo *reg_info, const RegisterValue &reg_value, void *gpr, size_t gpr_size, lldb::ByteOrder byte_order)
+{
+    if (reg_info->byte_offset + reg_info->byte_size > gpr_size)
+        return Error ("register \"%s\" lies outside of the general purpose register set", reg_info->name);
+
+    Error error;
+    uint8_t *dst = static_cast<uint8_t *> (gpr) + reg_info->byte_offset;
+    if (reg_value.GetAsMemoryData (reg_info, dst, reg_info->byte_size, byte_order, error) != reg_info->byte_size)
+        return error.Fail () ? error : Error ("failed to copy value of register \"%s\"", reg_info->name);
+    return Error ();
+}
+
 bool
 NativeRegisterContextLinux_x86_64::IsRegisterSetAvailable (uint32_t set_index) const
 {
@@ -928,12 +1001,18 @@ NativeRegisterContextLinux_x86_64::WriteFPR()
         return false;
     NativeProcessLinux *const process_p = reinterpret_cast<NativeProcessLinux*> (process_sp.get ());
 
+    bool success = false;
     if (GetFPRType() == eFPRTypeFXSAVE)
-        return process_p->WriteFPR (m_thread.GetID (), &m_fpr.xstate.fxsave, sizeof (m_fpr.xstate.fxsave)).Success();
-
-    if (GetFPRType() == eFPRTypeXSAVE)
-        return process_p->WriteRegisterSet (m_thread.GetID (), &m_iovec, sizeof (m_fpr.xstate.xsave), NT_X86_XSTATE).Success();
-    return false;
+        success = process_p->WriteFPR (m_thread.GetID (), &m_fpr.xstate.fxsave, sizeof (m_fpr.xstate.fxsave)).Success();
+    else if (GetFPRType() == eFPRTypeXSAVE)
+        success = process_p->WriteRegisterSet (m_thread.GetID (), &m_iovec, sizeof (m_fpr.xstate.xsave), NT_X86_XSTATE).Success();
+
+    // On success what we just wrote is what the thread has now, otherwise
+    // we no longer know.
+    m_fpr_valid = success;
+    if (success)
+        m_fpr_dirty = false;
+    return success;
 }
 
 bool
@@ -1006,6 +1085,9 @@ NativeRegisterContextLinux_x86_64::CopyYMMtoXSTATE(uint32_t reg, lldb::ByteOrder
 bool
 NativeRegisterContextLinux_x86_64::ReadFPR ()
 {
+    if (m_fpr_valid)
+        return true;
+
     NativeProcessProtocolSP process_sp (m_thread.GetProcess ());
     if (!process_sp)
         return false;
@@ -1015,25 +1097,32 @@ NativeRegisterContextLinux_x86_64::ReadFPR ()
     switch (fpr_type)
     {
     case FPRType::eFPRTypeFXSAVE:
-        return process_p->ReadFPR (m_thread.GetID (), &m_fpr.xstate.fxsave, sizeof (m_fpr.xstate.fxsave)).Success();
+        m_fpr_valid = process_p->ReadFPR (m_thread.GetID (), &m_fpr.xstate.fxsave, sizeof (m_fpr.xstate.fxsave)).Success();
+        break;
 
     case FPRType::eFPRTypeXSAVE:
-        return process_p->ReadRegisterSet (m_thread.GetID (), &m_iovec, sizeof (m_fpr.xstate.xsave), NT_X86_XSTATE).Success();
+        m_fpr_valid = process_p->ReadRegisterSet (m_thread.GetID (), &m_iovec, sizeof (m_fpr.xstate.xsave), NT_X86_XSTATE).Success();
+        break;
 
     default:
         return false;
     }
+    return m_fpr_valid;
 }
 
 bool
 NativeRegisterContextLinux_x86_64::ReadGPR()
 {
+    if (m_gpr_valid)
+        return true;
+
     NativeProcessProtocolSP process_sp (m_thread.GetProcess ());
     if (!process_sp)
         return false;
     NativeProcessLinux *const process_p = reinterpret_cast<NativeProcessLinux*> (process_sp.get ());
 
-    return process_p->ReadGPR (m_thread.GetID (), &m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize ()).Success();
+    m_gpr_valid = process_p->ReadGPR (m_thread.GetID (), &m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize ()).Success();
+    return m_gpr_valid;
 }
 
 bool
@@ -1044,7 +1133,17 @@ NativeRegisterContextLinux_x86_64::WriteGPR()
         return false;
     NativeProcessLinux *const process_p = reinterpret_cast<NativeProcessLinux*> (process_sp.get ());
 
-    return process_p->WriteGPR (m_thread.GetID (), &m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize ()).Success();
+    if (!process_p->WriteGPR (m_thread.GetID (), &m_gpr_x86_64, GetRegisterInfoInterface ().GetGPRSize ()).Success())
+    {
+        // We no longer know what the thread has.
+        m_gpr_valid = false;
+        return false;
+    }
+
+    // What we just wrote is what the thread has now.
+    m_gpr_valid = true;
+    m_gpr_dirty = false;
+    return true;
 }
 
 Error
@@ -46,6 +46,12 @@ namespace process_linux {
         Error
         WriteAllRegisterValues (const lldb::DataBufferSP &data_sp) override;
 
+        Error
+        WriteDirtyRegisters () override;
+
+        void
+        InvalidateAllRegisters () override;
+
         Error
         IsWatchpointHit(uint32_t wp_index, bool &is_hit) override;
 
@@ -75,6 +81,18 @@ namespace process_linux {
         uint32_t
         NumSupportedHardwareWatchpoints() override;
 
+        //------------------------------------------------------------------
+        // Copy a general purpose register, or one of its sub-registers,
+        // out of or into a GPR set in the layout PTRACE_GETREGS uses.  For
+        // i386 inferiors the register infos carry x86_64 offsets, since a
+        // 64-bit lldb-server always gets the x86_64 layout.
+        //------------------------------------------------------------------
+        static Error
+        ReadRegisterFromGPR (const RegisterInfo *reg_info, const void *gpr, size_t gpr_size, lldb::ByteOrder byte_order, RegisterValue &reg_value);
+
+        static Error
+        WriteRegisterToGPR (const RegisterInfo *reg_info, const RegisterValue &reg_value, void *gpr, size_t gpr_size, lldb::ByteOrder byte_order);
+
     private:
 
         // Private member types.
@@ -118,6 +136,14 @@ namespace process_linux {
         RegInfo m_reg_info;
         uint64_t m_gpr_x86_64[k_num_gpr_registers_x86_64];
 
+        // The GPR and FPR sets are read with one ptrace call each and cached
+        // until the thread resumes.  Writes only touch the cache; dirty sets
+        // are written back by WriteDirtyRegisters ().
+        bool m_gpr_valid;
+        bool m_gpr_dirty;
+        bool m_fpr_valid;
+        bool m_fpr_dirty;
+
         // Private member methods.
         Error
         WriteRegister(const uint32_t reg, const RegisterValue &value);
@@ -86,7 +86,10 @@ NativeThreadLinux::NativeThreadLinux (NativeProcessLinux *process, lldb::tid_t t
     m_state (StateType::eStateInvalid),
     m_stop_info (),
     m_reg_context_sp (),
-    m_stop_description ()
+    m_stop_description (),
+    m_watchpoint_index_map (),
+    m_step_range_start (0),
+    m_step_range_end (0)
 {
 }
 
@@ -311,6 +314,8 @@ NativeThreadLinux::SetRunning ()
     m_stop_info.reason = StopReason::eStopReasonNone;
     m_stop_description.clear();
 
+    FlushRegisterCache ();
+
     // If watchpoints have been set, but none on this thread,
     // then this is a new thread. So set all existing watchpoints.
     if (m_watchpoint_index_map.empty())
@@ -331,13 +336,25 @@ NativeThreadLinux::SetRunning ()
 }
 
 void
-NativeThreadLinux::SetStepping ()
+NativeThreadLinux::SetStepping (lldb::addr_t range_start, lldb::addr_t range_end)
 {
     const StateType new_state = StateType::eStateStepping;
     MaybeLogStateChange (new_state);
     m_state = new_state;
 
     m_stop_info.reason = StopReason::eStopReasonNone;
+    m_step_range_start = range_start;
+    m_step_range_end = range_end;
+
+    FlushRegisterCache ();
+}
+
+bool
+NativeThreadLinux::IsSteppingInRange (lldb::addr_t pc) const
+{
+    if (m_state != StateType::eStateStepping)
+        return false;
+    return m_step_range_start <= pc && pc < m_step_range_end;
 }
 
 void
@@ -421,6 +438,22 @@ NativeThreadLinux::SetStoppedByWatchpoint (uint32_t wp_index)
     m_stop_info.details.signal.signo = SIGTRAP;
 }
 
+void
+NativeThreadLinux::SetStoppedByWatchpointAddress (lldb::addr_t wp_addr)
+{
+    const StateType new_state = StateType::eStateStopped;
+    MaybeLogStateChange (new_state);
+    m_state = new_state;
+
+    // No index: the client only uses it to record the hardware slot.
+    std::ostringstream ostr;
+    ostr << wp_addr;
+    m_stop_description = ostr.str();
+
+    m_stop_info.reason = StopReason::eStopReasonWatchpoint;
+    m_stop_info.details.signal.signo = SIGTRAP;
+}
+
 bool
 NativeThreadLinux::IsStoppedAtBreakpoint ()
 {
@@ -481,6 +514,23 @@ NativeThreadLinux::SetExited ()
     m_stop_info.reason = StopReason::eStopReasonThreadExiting;
 }
 
+void
+NativeThreadLinux::FlushRegisterCache ()
+{
+    // Nothing is cached if nobody asked for the registers during this stop.
+    if (!m_reg_context_sp)
+        return;
+
+    const Error error = m_reg_context_sp->WriteDirtyRegisters ();
+    if (error.Fail ())
+    {
+        Log *log (GetLogIfAllCategoriesSet (LIBLLDB_LOG_THREAD));
+        if (log)
+            log->Printf ("NativeThreadLinux::%s tid %" PRIu64 " failed to write back modified registers: %s", __FUNCTION__, GetID (), error.AsCString ());
+    }
+    m_reg_context_sp->InvalidateAllRegisters ();
+}
+
 void
 NativeThreadLinux::MaybeLogStateChange (lldb::StateType new_state)
 {
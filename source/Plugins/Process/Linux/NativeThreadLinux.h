@@ -60,7 +60,12 @@ namespace process_linux {
         SetRunning ();
 
         void
-        SetStepping ();
+        SetStepping (lldb::addr_t range_start = 0, lldb::addr_t range_end = 0);
+
+        /// Return true if the thread is stepping through an address range
+        /// and pc is still inside that range.
+        bool
+        IsSteppingInRange (lldb::addr_t pc) const;
 
         void
         SetStoppedBySignal (uint32_t signo);
@@ -80,6 +85,11 @@ namespace process_linux {
         void
         SetStoppedByWatchpoint (uint32_t wp_index);
 
+        /// Stop at a watchpoint that has no hardware slot, such as one
+        /// emulated with page protections.
+        void
+        SetStoppedByWatchpointAddress (lldb::addr_t wp_addr);
+
         bool
         IsStoppedAtBreakpoint ();
 
@@ -98,6 +108,12 @@ namespace process_linux {
         void
         SetExited ();
 
+        /// Write back any register changes made while the thread was stopped
+        /// and drop the cached register sets.  Must be called before the
+        /// thread runs again.
+        void
+        FlushRegisterCache ();
+
         // ---------------------------------------------------------------------
         // Private interface
         // ---------------------------------------------------------------------
@@ -113,6 +129,8 @@ namespace process_linux {
         std::string m_stop_description;
         using WatchpointIndexMap = std::map<lldb::addr_t, uint32_t>;
         WatchpointIndexMap m_watchpoint_index_map;
+        lldb::addr_t m_step_range_start;
+        lldb::addr_t m_step_range_end;
     };
 
 } // namespace process_linux
@@ -588,6 +588,7 @@ private:
 
 ThreadStateCoordinator::ThreadStateCoordinator (const LogFunction &log_function) :
     m_log_function (log_function),
+    m_event_queued_function (),
     m_event_queue (),
     m_queue_condition (),
     m_queue_mutex (),
@@ -599,13 +600,18 @@ ThreadStateCoordinator::ThreadStateCoordinator (const LogFunction &log_function)
 void
 ThreadStateCoordinator::EnqueueEvent (EventBaseSP event_sp)
 {
-    std::lock_guard<std::mutex> lock (m_queue_mutex);
+    {
+        std::lock_guard<std::mutex> lock (m_queue_mutex);
 
-    m_event_queue.push (event_sp);
-    if (m_log_event_processing)
-        Log ("ThreadStateCoordinator::%s enqueued event: %s", __FUNCTION__, event_sp->GetDescription ().c_str ());
+        m_event_queue.push (event_sp);
+        if (m_log_event_processing)
+            Log ("ThreadStateCoordinator::%s enqueued event: %s", __FUNCTION__, event_sp->GetDescription ().c_str ());
+
+        m_queue_condition.notify_one ();
+    }
 
-    m_queue_condition.notify_one ();
+    if (m_event_queued_function)
+        m_event_queued_function ();
 }
 
 ThreadStateCoordinator::EventBaseSP
@@ -623,6 +629,19 @@ ThreadStateCoordinator::DequeueEventWithWait ()
     return event_sp;
 }
 
+ThreadStateCoordinator::EventBaseSP
+ThreadStateCoordinator::DequeueEventNoWait ()
+{
+    std::lock_guard<std::mutex> lock (m_queue_mutex);
+    if (m_event_queue.empty ())
+        return EventBaseSP ();
+
+    EventBaseSP event_sp = m_event_queue.front ();
+    m_event_queue.pop ();
+
+    return event_sp;
+}
+
 void
 ThreadStateCoordinator::SetPendingNotification (const EventBaseSP &event_sp)
 {
@@ -863,21 +882,26 @@ ThreadStateCoordinator::NotifyThreadDeath (lldb::tid_t tid,
 void
 ThreadStateCoordinator::ResetForExec ()
 {
-    std::lock_guard<std::mutex> lock (m_queue_mutex);
+    {
+        std::lock_guard<std::mutex> lock (m_queue_mutex);
+
+        // Remove everything from the queue.  This is the only
+        // state mutation that takes place outside the processing
+        // loop.
+        QueueType empty_queue;
+        m_event_queue.swap (empty_queue);
 
-    // Remove everything from the queue.  This is the only
-    // state mutation that takes place outside the processing
-    // loop.
-    QueueType empty_queue;
-    m_event_queue.swap (empty_queue);
-
-    // Do the real clear behavior on the the queue to eliminate
-    // the chance that processing of a dequeued earlier event is
-    // overlapping with the clearing of state here.  Push it
-    // directly because we need to have this happen with the lock,
-    // and so far I only have this one place that needs a no-lock
-    // variant.
-    m_event_queue.push (EventBaseSP (new EventReset ()));
+        // Do the real clear behavior on the the queue to eliminate
+        // the chance that processing of a dequeued earlier event is
+        // overlapping with the clearing of state here.  Push it
+        // directly because we need to have this happen with the lock,
+        // and so far I only have this one place that needs a no-lock
+        // variant.
+        m_event_queue.push (EventBaseSP (new EventReset ()));
+    }
+
+    if (m_event_queued_function)
+        m_event_queued_function ();
 }
 
 void
@@ -901,6 +925,32 @@ ThreadStateCoordinator::ProcessNextEvent ()
         return eventLoopResultStop;
     }
 
+    return ProcessEvent (event_sp);
+}
+
+ThreadStateCoordinator::EventLoopResult
+ThreadStateCoordinator::ProcessPendingEvents ()
+{
+    if (m_log_event_processing)
+        Log ("ThreadStateCoordinator::%s processing queued events", __FUNCTION__);
+
+    while (EventBaseSP event_sp = DequeueEventNoWait ())
+    {
+        if (ProcessEvent (event_sp) == eventLoopResultStop)
+            return eventLoopResultStop;
+    }
+    return eventLoopResultContinue;
+}
+
+void
+ThreadStateCoordinator::SetEventQueuedFunction (const EventQueuedFunction &event_queued_function)
+{
+    m_event_queued_function = event_queued_function;
+}
+
+ThreadStateCoordinator::EventLoopResult
+ThreadStateCoordinator::ProcessEvent (const EventBaseSP &event_sp)
+{
     if (m_log_event_processing)
     {
         Log ("ThreadStateCoordinator::%s about to process event: %s", __FUNCTION__, event_sp->GetDescription ().c_str ());
@@ -43,6 +43,7 @@ namespace process_linux {
         typedef std::function<void (const std::string &error_message)> ErrorFunction;
         typedef std::function<Error (lldb::tid_t tid)> StopThreadFunction;
         typedef std::function<Error (lldb::tid_t tid, bool supress_signal)> ResumeThreadFunction;
+        typedef std::function<void ()> EventQueuedFunction;
 
         // Constructors.
         ThreadStateCoordinator (const LogFunction &log_function);
@@ -144,6 +145,21 @@ namespace process_linux {
         EventLoopResult
         ProcessNextEvent ();
 
+        // Process every event that is queued, including any queued while
+        // processing them, without blocking once the queue is empty.  Returns
+        // eventLoopResultStop if one of the events stopped the coordinator.
+        // This is for owners that drive the coordinator from their own event
+        // loop instead of a dedicated thread.  The same single-thread rule as
+        // ProcessNextEvent() applies.
+        EventLoopResult
+        ProcessPendingEvents ();
+
+        // Set a function that is called, without the queue lock held, each
+        // time an event is queued.  Owners that use ProcessPendingEvents()
+        // use it to learn that the coordinator has work to do.
+        void
+        SetEventQueuedFunction (const EventQueuedFunction &event_queued_function);
+
         // Enable/disable verbose logging of event processing.
         void
         LogEnableEventProcessing (bool enabled);
@@ -188,6 +204,12 @@ namespace process_linux {
         EventBaseSP
         DequeueEventWithWait ();
 
+        EventBaseSP
+        DequeueEventNoWait ();
+
+        EventLoopResult
+        ProcessEvent (const EventBaseSP &event_sp);
+
         void
         SetPendingNotification (const EventBaseSP &event_sp);
 
@@ -214,6 +236,7 @@ namespace process_linux {
 
         // Member variables.
         LogFunction m_log_function;
+        EventQueuedFunction m_event_queued_function;
 
         QueueType m_event_queue;
         // For now we do simple read/write lock strategy with efficient wait-for-data.
@@ -11,11 +11,15 @@
 #include "GDBRemoteCommunication.h"
 
 // C Includes
+#include <ctype.h>
 #include <limits.h>
 #include <string.h>
 #include <sys/stat.h>
 
 // C++ Includes
+#include <algorithm>
+#include <vector>
+
 // Other libraries and framework includes
 #include "lldb/Core/Log.h"
 #include "lldb/Core/StreamFile.h"
@@ -30,7 +34,10 @@
 #include "lldb/Host/ThreadLauncher.h"
 #include "lldb/Host/TimeValue.h"
 #include "lldb/Target/Process.h"
+#include "lldb/Utility/HexCodec.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
 
 // Project includes
 #include "ProcessGDBRemoteLog.h"
@@ -154,6 +161,8 @@ GDBRemoteCommunication::GDBRemoteCommunication(const char *comm_name,
     m_public_is_running (false),
     m_private_is_running (false),
     m_history (512),
+    m_packet_stats_mutex (Mutex::eMutexTypeNormal),
+    m_packet_stats (),
     m_send_acks (true),
     m_listen_url ()
 {
@@ -558,8 +567,25 @@ GDBRemoteCommunication::CheckForPacket (const uint8_t *src, size_t src_len, Stri
             // run-length encoding in the process.
             // Reserve enough byte for the most common case (no RLE used)
             packet_str.reserve(m_bytes.length());
-            for (std::string::const_iterator c = m_bytes.begin() + content_start; c != m_bytes.begin() + content_end; ++c)
+            const char *content_end_ptr = m_bytes.data() + content_end;
+            for (const char *c = m_bytes.data() + content_start; c < content_end_ptr; ++c)
             {
+                // Copy everything up to the next RLE or escape character at once
+                const size_t run_length = FindGDBRemoteDecodeChar (c, content_end_ptr - c);
+                packet_str.append(c, run_length);
+                c += run_length;
+                if (c == content_end_ptr)
+                    break;
+
+                // Both RLE and escapes need a character after the '*' or
+                // '}', and RLE needs a character to repeat. A packet that
+                // ends in either or starts with '*' is malformed.
+                if (c + 1 >= content_end_ptr || (*c == '*' && packet_str.empty()))
+                {
+                    success = false;
+                    break;
+                }
+
                 if (*c == '*')
                 {
                     // '*' indicates RLE. Next character will give us the
@@ -570,23 +596,29 @@ GDBRemoteCommunication::CheckForPacket (const uint8_t *src, size_t src_len, Stri
                     int repeat_count = *++c + 3 - ' ';
                     // We have the char_to_repeat and repeat_count. Now push
                     // it in the packet.
-                    for (int i = 0; i < repeat_count; ++i)
-                        packet_str.push_back(char_to_repeat);
+                    if (repeat_count > 0)
+                        packet_str.append(repeat_count, char_to_repeat);
                 }
-                else if (*c == 0x7d)
+                else
                 {
                     // 0x7d is the escape character.  The next character is to
                     // be XOR'd with 0x20.
                     char escapee = *++c ^ 0x20;
                     packet_str.push_back(escapee);
                 }
-                else
-                {
-                    packet_str.push_back(*c);
-                }
             }
 
-            if (m_bytes[0] == '$')
+            if (!success)
+            {
+                if (log)
+                    log->Printf ("error: invalid run-length encoding or escape in packet: '%.*s'",
+                                 (int)(total_length),
+                                 m_bytes.c_str());
+                if (m_bytes[0] == '$' && GetSendAcks ())
+                    SendNack();
+                packet.Clear();
+            }
+            else if (m_bytes[0] == '$')
             {
                 assert (checksum_idx < m_bytes.size());
                 if (::isxdigit (m_bytes[checksum_idx+0]) || 
@@ -928,6 +960,198 @@ GDBRemoteCommunication::DumpHistory(Stream &strm)
     m_history.Dump (strm);
 }
 
+//----------------------------------------------------------------------
+// Group packets by the name of the packet: a single character for the
+// basic packets ("m", "Z", "vCont" is the exception) and the leading
+// letters for the "q", "Q", "v", "j" and "_" packets.
+//----------------------------------------------------------------------
+static llvm::StringRef
+GetPacketStatisticsName (const char *payload, size_t payload_length)
+{
+    llvm::StringRef packet (payload, payload_length);
+    if (packet.empty())
+        return llvm::StringRef ("<empty>");
+
+    switch (packet[0])
+    {
+        case 'q':
+        case 'Q':
+        case 'v':
+        case 'j':
+        case '_':
+            break;
+        default:
+            return packet.substr (0, 1);
+    }
+
+    // These have their argument appended without a separator
+    static const char *g_hex_suffix_packets[] = { "qRegisterInfo", "qThreadStopInfo" };
+    for (size_t i = 0; i < llvm::array_lengthof(g_hex_suffix_packets); ++i)
+    {
+        if (packet.startswith (g_hex_suffix_packets[i]))
+            return llvm::StringRef (g_hex_suffix_packets[i]);
+    }
+
+    size_t name_length = 1;
+    while (name_length < packet.size() && (isalpha (packet[name_length]) || packet[name_length] == '_'))
+        ++name_length;
+    return packet.substr (0, name_length);
+}
+
+void
+GDBRemoteCommunication::RecordPacketStatistics (const char *payload,
+                                                size_t payload_length,
+                                                size_t response_length,
+                                                const TimeValue &send_time,
+                                                PacketResult result)
+{
+    const uint64_t latency_usec = (TimeValue::Now() - send_time) / TimeValue::NanoSecPerMicroSec;
+    const size_t bucket = PacketStatistics::GetLatencyBucket (latency_usec);
+
+    Mutex::Locker locker (m_packet_stats_mutex);
+    PacketStatistics &stats = m_packet_stats[GetPacketStatisticsName (payload, payload_length).str()];
+    ++stats.count;
+    stats.bytes_sent += payload_length;
+    if (result == PacketResult::Success)
+        stats.bytes_received += response_length;
+    else
+        ++stats.errors;
+    stats.total_latency_usec += latency_usec;
+    stats.min_latency_usec = std::min (stats.min_latency_usec, latency_usec);
+    stats.max_latency_usec = std::max (stats.max_latency_usec, latency_usec);
+    ++stats.latency_histogram[bucket];
+}
+
+size_t
+GDBRemoteCommunication::PacketStatistics::GetLatencyBucket (uint64_t latency_usec)
+{
+    size_t bucket = 0;
+    for (uint64_t usec = latency_usec; usec > 0 && bucket + 1 < kNumLatencyBuckets; usec >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+void
+GDBRemoteCommunication::PacketStatistics::GetLatencyBucketRange (size_t bucket, uint64_t &min_usec, uint64_t &max_usec)
+{
+    if (bucket == 0)
+    {
+        min_usec = 0;
+        max_usec = 0;
+    }
+    else
+    {
+        min_usec = 1ull << (bucket - 1);
+        max_usec = (1ull << bucket) - 1;
+    }
+}
+
+static bool
+PacketStatisticsTotalLatencyGreater (const std::pair<std::string, uint64_t> &lhs,
+                                     const std::pair<std::string, uint64_t> &rhs)
+{
+    return lhs.second > rhs.second;
+}
+
+void
+GDBRemoteCommunication::DumpPacketStatistics (Stream &strm)
+{
+    Mutex::Locker locker (m_packet_stats_mutex);
+    if (m_packet_stats.empty())
+    {
+        strm.PutCString ("No packets have been sent.\n");
+        return;
+    }
+
+    // Show the packets that took the most time first
+    std::vector<std::pair<std::string, uint64_t> > sorted_names;
+    for (PacketStatisticsMap::const_iterator pos = m_packet_stats.begin(); pos != m_packet_stats.end(); ++pos)
+        sorted_names.push_back (std::make_pair (pos->first, pos->second.total_latency_usec));
+    std::sort (sorted_names.begin(), sorted_names.end(), PacketStatisticsTotalLatencyGreater);
+
+    strm.Printf ("%-20s %10s %8s %12s %12s %12s %10s %10s %10s\n",
+                 "packet", "count", "errors", "bytes sent", "bytes recv", "total (ms)", "avg (us)", "min (us)", "max (us)");
+    for (size_t i = 0; i < sorted_names.size(); ++i)
+    {
+        const PacketStatistics &stats = m_packet_stats[sorted_names[i].first];
+        strm.Printf ("%-20s %10" PRIu64 " %8" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12.3f %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+                     sorted_names[i].first.c_str(),
+                     stats.count,
+                     stats.errors,
+                     stats.bytes_sent,
+                     stats.bytes_received,
+                     (double)stats.total_latency_usec / 1000.0,
+                     stats.count ? stats.total_latency_usec / stats.count : 0,
+                     stats.count ? stats.min_latency_usec : 0,
+                     stats.max_latency_usec);
+
+        strm.PutCString ("    latency:");
+        for (size_t bucket = 0; bucket < PacketStatistics::kNumLatencyBuckets; ++bucket)
+        {
+            if (stats.latency_histogram[bucket] == 0)
+                continue;
+            uint64_t min_usec, max_usec;
+            PacketStatistics::GetLatencyBucketRange (bucket, min_usec, max_usec);
+            if (bucket + 1 == PacketStatistics::kNumLatencyBuckets)
+                strm.Printf (" >=%" PRIu64 "us:%" PRIu64, min_usec, stats.latency_histogram[bucket]);
+            else if (min_usec == max_usec)
+                strm.Printf (" %" PRIu64 "us:%" PRIu64, min_usec, stats.latency_histogram[bucket]);
+            else
+                strm.Printf (" %" PRIu64 "-%" PRIu64 "us:%" PRIu64, min_usec, max_usec, stats.latency_histogram[bucket]);
+        }
+        strm.EOL();
+    }
+}
+
+StructuredData::ObjectSP
+GDBRemoteCommunication::GetPacketStatistics ()
+{
+    StructuredData::Dictionary *packets = new StructuredData::Dictionary();
+    StructuredData::ObjectSP packets_sp (packets);
+
+    Mutex::Locker locker (m_packet_stats_mutex);
+    for (PacketStatisticsMap::const_iterator pos = m_packet_stats.begin(); pos != m_packet_stats.end(); ++pos)
+    {
+        const PacketStatistics &stats = pos->second;
+        StructuredData::Dictionary *packet = new StructuredData::Dictionary();
+        StructuredData::ObjectSP packet_sp (packet);
+        packet->AddIntegerItem ("count", stats.count);
+        packet->AddIntegerItem ("errors", stats.errors);
+        packet->AddIntegerItem ("bytes_sent", stats.bytes_sent);
+        packet->AddIntegerItem ("bytes_received", stats.bytes_received);
+        packet->AddIntegerItem ("total_latency_usec", stats.total_latency_usec);
+        packet->AddIntegerItem ("min_latency_usec", stats.count ? stats.min_latency_usec : 0);
+        packet->AddIntegerItem ("max_latency_usec", stats.max_latency_usec);
+
+        // Only the buckets that have packets, each as {min_usec, count}
+        StructuredData::Array *histogram = new StructuredData::Array();
+        StructuredData::ObjectSP histogram_sp (histogram);
+        for (size_t bucket = 0; bucket < PacketStatistics::kNumLatencyBuckets; ++bucket)
+        {
+            if (stats.latency_histogram[bucket] == 0)
+                continue;
+            uint64_t min_usec, max_usec;
+            PacketStatistics::GetLatencyBucketRange (bucket, min_usec, max_usec);
+            StructuredData::Dictionary *entry = new StructuredData::Dictionary();
+            StructuredData::ObjectSP entry_sp (entry);
+            entry->AddIntegerItem ("min_usec", min_usec);
+            entry->AddIntegerItem ("count", stats.latency_histogram[bucket]);
+            histogram->AddItem (entry_sp);
+        }
+        packet->AddItem ("latency_histogram", histogram_sp);
+
+        packets->AddItem (pos->first, packet_sp);
+    }
+    return packets_sp;
+}
+
+void
+GDBRemoteCommunication::ResetPacketStatistics ()
+{
+    Mutex::Locker locker (m_packet_stats_mutex);
+    m_packet_stats.clear();
+}
+
 GDBRemoteCommunication::ScopedTimeout::ScopedTimeout (GDBRemoteCommunication& gdb_comm,
                                                       uint32_t timeout) :
     m_gdb_comm (gdb_comm)
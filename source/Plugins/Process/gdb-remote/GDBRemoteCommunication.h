@@ -11,8 +11,11 @@
 #define liblldb_GDBRemoteCommunication_h_
 
 // C Includes
+#include <string.h>
+
 // C++ Includes
 #include <list>
+#include <map>
 #include <string>
 
 // Other libraries and framework includes
@@ -20,6 +23,7 @@
 #include "lldb/lldb-public.h"
 #include "lldb/Core/Communication.h"
 #include "lldb/Core/Listener.h"
+#include "lldb/Core/StructuredData.h"
 #include "lldb/Host/HostThread.h"
 #include "lldb/Host/Mutex.h"
 #include "lldb/Host/Predicate.h"
@@ -156,9 +160,69 @@ public:
 
     void
     DumpHistory(Stream &strm);
-    
+
+    //------------------------------------------------------------------
+    // Statistics about the packets sent through this object, grouped
+    // by packet type ("m", "vCont", "qXfer", ...). The latency of a
+    // packet is the time from sending it until its response arrived.
+    //------------------------------------------------------------------
+    void
+    DumpPacketStatistics (Stream &strm);
+
+    StructuredData::ObjectSP
+    GetPacketStatistics ();
+
+    void
+    ResetPacketStatistics ();
+
 protected:
 
+    struct PacketStatistics
+    {
+        // Bucket 0 counts latencies below 1us, bucket N latencies in
+        // [2^(N-1), 2^N) us and the last bucket everything above.
+        static const size_t kNumLatencyBuckets = 24;
+
+        PacketStatistics () :
+            count (0),
+            errors (0),
+            bytes_sent (0),
+            bytes_received (0),
+            total_latency_usec (0),
+            min_latency_usec (UINT64_MAX),
+            max_latency_usec (0)
+        {
+            ::memset (latency_histogram, 0, sizeof(latency_histogram));
+        }
+
+        uint64_t count;
+        uint64_t errors;        // Packets that didn't get a valid response
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+        uint64_t total_latency_usec;
+        uint64_t min_latency_usec;
+        uint64_t max_latency_usec;
+        uint64_t latency_histogram[kNumLatencyBuckets];
+
+        static size_t
+        GetLatencyBucket (uint64_t latency_usec);
+
+        // The smallest and largest latency counted in "bucket"
+        static void
+        GetLatencyBucketRange (size_t bucket, uint64_t &min_usec, uint64_t &max_usec);
+    };
+
+    typedef std::map<std::string, PacketStatistics> PacketStatisticsMap;
+
+    // Record that the packet in "payload" was sent at "send_time" and
+    // that the exchange just completed with "result".
+    void
+    RecordPacketStatistics (const char *payload,
+                            size_t payload_length,
+                            size_t response_length,
+                            const TimeValue &send_time,
+                            PacketResult result);
+
     class History
     {
     public:
@@ -291,6 +355,8 @@ protected:
     Predicate<bool> m_public_is_running;
     Predicate<bool> m_private_is_running;
     History m_history;
+    Mutex m_packet_stats_mutex;
+    PacketStatisticsMap m_packet_stats;
     bool m_send_acks;
     bool m_is_platform; // Set to true if this class represents a platform,
                         // false if this class represents a debug session for
@@ -62,6 +62,7 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient() :
     m_supports_vCont_C (eLazyBoolCalculate),
     m_supports_vCont_s (eLazyBoolCalculate),
     m_supports_vCont_S (eLazyBoolCalculate),
+    m_supports_vCont_r (eLazyBoolCalculate),
     m_qHostInfo_is_valid (eLazyBoolCalculate),
     m_curr_pid_is_valid (eLazyBoolCalculate),
     m_qProcessInfo_is_valid (eLazyBoolCalculate),
@@ -74,6 +75,7 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient() :
     m_attach_or_wait_reply(eLazyBoolCalculate),
     m_prepare_for_reg_writing_reply (eLazyBoolCalculate),
     m_supports_p (eLazyBoolCalculate),
+    m_supports_g (eLazyBoolCalculate),
     m_supports_x (eLazyBoolCalculate),
     m_avoid_g_packets (eLazyBoolCalculate),
     m_supports_QSaveRegisterState (eLazyBoolCalculate),
@@ -81,6 +83,7 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient() :
     m_supports_qXfer_libraries_read (eLazyBoolCalculate),
     m_supports_qXfer_libraries_svr4_read (eLazyBoolCalculate),
     m_supports_augmented_libraries_svr4_read (eLazyBoolCalculate),
+    m_supports_multi_breakpoint (eLazyBoolCalculate),
     m_supports_jThreadExtendedInfo (eLazyBoolCalculate),
     m_supports_qProcessInfoPID (true),
     m_supports_qfProcessInfo (true),
@@ -117,7 +120,8 @@ GDBRemoteCommunicationClient::GDBRemoteCommunicationClient() :
     m_gdb_server_name(),
     m_gdb_server_version(UINT32_MAX),
     m_default_packet_timeout (0),
-    m_max_packet_size (0)
+    m_max_packet_size (0),
+    m_max_outstanding_packets (32)
 {
 }
 
@@ -214,6 +218,16 @@ GDBRemoteCommunicationClient::GetQXferAuxvReadSupported ()
     return (m_supports_qXfer_auxv_read == eLazyBoolYes);
 }
 
+bool
+GDBRemoteCommunicationClient::GetMultiBreakpointSupported ()
+{
+    if (m_supports_multi_breakpoint == eLazyBoolCalculate)
+    {
+        GetRemoteQSupported();
+    }
+    return (m_supports_multi_breakpoint == eLazyBoolYes);
+}
+
 uint64_t
 GDBRemoteCommunicationClient::GetRemoteMaxPacketSize()
 {
@@ -320,7 +334,9 @@ GDBRemoteCommunicationClient::ResetDiscoverableSettings()
     m_supports_vCont_C = eLazyBoolCalculate;
     m_supports_vCont_s = eLazyBoolCalculate;
     m_supports_vCont_S = eLazyBoolCalculate;
+    m_supports_vCont_r = eLazyBoolCalculate;
     m_supports_p = eLazyBoolCalculate;
+    m_supports_g = eLazyBoolCalculate;
     m_supports_x = eLazyBoolCalculate;
     m_supports_QSaveRegisterState = eLazyBoolCalculate;
     m_qHostInfo_is_valid = eLazyBoolCalculate;
@@ -336,6 +352,7 @@ GDBRemoteCommunicationClient::ResetDiscoverableSettings()
     m_supports_qXfer_libraries_read = eLazyBoolCalculate;
     m_supports_qXfer_libraries_svr4_read = eLazyBoolCalculate;
     m_supports_augmented_libraries_svr4_read = eLazyBoolCalculate;
+    m_supports_multi_breakpoint = eLazyBoolCalculate;
 
     m_supports_qProcessInfoPID = true;
     m_supports_qfProcessInfo = true;
@@ -373,6 +390,7 @@ GDBRemoteCommunicationClient::GetRemoteQSupported ()
     m_supports_qXfer_libraries_read = eLazyBoolNo;
     m_supports_qXfer_libraries_svr4_read = eLazyBoolNo;
     m_supports_augmented_libraries_svr4_read = eLazyBoolNo;
+    m_supports_multi_breakpoint = eLazyBoolNo;
     m_max_packet_size = UINT64_MAX;  // It's supposed to always be there, but if not, we assume no limit
 
     StringExtractorGDBRemote response;
@@ -392,6 +410,8 @@ GDBRemoteCommunicationClient::GetRemoteQSupported ()
         }
         if (::strstr (response_cstr, "qXfer:libraries:read+"))
             m_supports_qXfer_libraries_read = eLazyBoolYes;
+        if (::strstr (response_cstr, "multi-breakpoint+"))
+            m_supports_multi_breakpoint = eLazyBoolYes;
 
         const char *packet_size_str = ::strstr (response_cstr, "PacketSize=");
         if (packet_size_str)
@@ -436,6 +456,7 @@ GDBRemoteCommunicationClient::GetVContSupported (char flavor)
         m_supports_vCont_C = eLazyBoolNo;
         m_supports_vCont_s = eLazyBoolNo;
         m_supports_vCont_S = eLazyBoolNo;
+        m_supports_vCont_r = eLazyBoolNo;
         if (SendPacketAndWaitForResponse("vCont?", response, false) == PacketResult::Success)
         {
             const char *response_cstr = response.GetStringRef().c_str();
@@ -451,6 +472,9 @@ GDBRemoteCommunicationClient::GetVContSupported (char flavor)
             if (::strstr (response_cstr, ";S"))
                 m_supports_vCont_S = eLazyBoolYes;
 
+            if (::strstr (response_cstr, ";r"))
+                m_supports_vCont_r = eLazyBoolYes;
+
             if (m_supports_vCont_c == eLazyBoolYes &&
                 m_supports_vCont_C == eLazyBoolYes &&
                 m_supports_vCont_s == eLazyBoolYes &&
@@ -477,6 +501,7 @@ GDBRemoteCommunicationClient::GetVContSupported (char flavor)
     case 'C': return m_supports_vCont_C;
     case 's': return m_supports_vCont_s;
     case 'S': return m_supports_vCont_S;
+    case 'r': return m_supports_vCont_r;
     default: break;
     }
     return false;
@@ -509,6 +534,28 @@ GDBRemoteCommunicationClient::GetpPacketSupported (lldb::tid_t tid)
     return m_supports_p;
 }
 
+bool
+GDBRemoteCommunicationClient::GetgPacketSupported (lldb::tid_t tid)
+{
+    if (m_supports_g == eLazyBoolCalculate)
+    {
+        StringExtractorGDBRemote response;
+        m_supports_g = eLazyBoolNo;
+        char packet[256];
+        if (GetThreadSuffixSupported())
+            snprintf(packet, sizeof(packet), "g;thread:%" PRIx64 ";", tid);
+        else
+            snprintf(packet, sizeof(packet), "g");
+
+        if (SendPacketAndWaitForResponse(packet, response, false) == PacketResult::Success)
+        {
+            if (response.IsNormalResponse())
+                m_supports_g = eLazyBoolYes;
+        }
+    }
+    return m_supports_g;
+}
+
 bool
 GDBRemoteCommunicationClient::GetThreadExtendedInfoSupported ()
 {
@@ -617,9 +664,11 @@ GDBRemoteCommunicationClient::SendPacketAndWaitForResponseNoLock (const char *pa
                                                                   size_t payload_length,
                                                                   StringExtractorGDBRemote &response)
 {
+    const TimeValue send_time (TimeValue::Now());
     PacketResult packet_result = SendPacketNoLock (payload, payload_length);
     if (packet_result == PacketResult::Success)
         packet_result = WaitForPacketWithTimeoutMicroSecondsNoLock (response, GetPacketTimeoutInMicroSeconds ());
+    RecordPacketStatistics (payload, payload_length, response.GetStringRef().size(), send_time, packet_result);
     return packet_result;
 }
 
@@ -729,6 +778,107 @@ GDBRemoteCommunicationClient::SendPacketAndWaitForResponse
     return packet_result;
 }
 
+GDBRemoteCommunicationClient::PacketResult
+GDBRemoteCommunicationClient::SendPacketsAndWaitForResponsesNoLock (const std::vector<std::string> &payloads,
+                                                                    std::vector<StringExtractorGDBRemote> &responses)
+{
+    responses.clear();
+    responses.reserve (payloads.size());
+
+    if (GetSendAcks ())
+    {
+        // Every packet has to be acknowledged before the next one can be
+        // sent, otherwise we can't tell an ack from the start of a response.
+        for (const std::string &payload : payloads)
+        {
+            StringExtractorGDBRemote response;
+            PacketResult packet_result = SendPacketAndWaitForResponseNoLock (payload.data(), payload.size(), response);
+            if (packet_result != PacketResult::Success)
+                return packet_result;
+            responses.push_back (response);
+        }
+        return PacketResult::Success;
+    }
+
+    Log *log (ProcessGDBRemoteLog::GetLogIfAllCategoriesSet (GDBR_LOG_PACKETS));
+    const uint32_t timeout_usec = GetPacketTimeoutInMicroSeconds ();
+    const size_t num_payloads = payloads.size();
+    size_t num_sent = 0;
+    PacketResult send_result = PacketResult::Success;
+    std::vector<TimeValue> send_times (num_payloads);
+
+    while (responses.size() < num_payloads)
+    {
+        // Keep up to m_max_outstanding_packets requests in flight
+        while (send_result == PacketResult::Success &&
+               num_sent < num_payloads &&
+               num_sent - responses.size() < m_max_outstanding_packets)
+        {
+            const std::string &payload = payloads[num_sent];
+            send_times[num_sent] = TimeValue::Now();
+            send_result = SendPacketNoLock (payload.data(), payload.size());
+            if (send_result == PacketResult::Success)
+                ++num_sent;
+            else
+                RecordPacketStatistics (payload.data(), payload.size(), 0, send_times[num_sent], send_result);
+        }
+
+        // Even if a send failed we must drain the responses to the packets
+        // that did go out so the next request doesn't pick them up.
+        if (responses.size() == num_sent)
+            break;
+
+        const size_t response_idx = responses.size();
+        responses.push_back (StringExtractorGDBRemote());
+        PacketResult packet_result = WaitForPacketWithTimeoutMicroSecondsNoLock (responses.back(), timeout_usec);
+        RecordPacketStatistics (payloads[response_idx].data(),
+                                payloads[response_idx].size(),
+                                responses.back().GetStringRef().size(),
+                                send_times[response_idx],
+                                packet_result);
+        if (packet_result != PacketResult::Success)
+        {
+            responses.pop_back();
+            if (log)
+                log->Printf ("error: failed to get response %" PRIu64 " of %" PRIu64 " pipelined packets",
+                             (uint64_t)responses.size(), (uint64_t)num_payloads);
+            return packet_result;
+        }
+    }
+    return send_result;
+}
+
+GDBRemoteCommunicationClient::PacketResult
+GDBRemoteCommunicationClient::SendPacketsAndWaitForResponses (const std::vector<std::string> &payloads,
+                                                              std::vector<StringExtractorGDBRemote> &responses,
+                                                              bool send_async)
+{
+    Mutex::Locker locker;
+    if (GetSequenceMutex (locker))
+        return SendPacketsAndWaitForResponsesNoLock (payloads, responses);
+
+    responses.clear();
+    if (!send_async)
+    {
+        Log *log (ProcessGDBRemoteLog::GetLogIfAllCategoriesSet (GDBR_LOG_PROCESS));
+        if (log)
+            log->Printf("error: failed to get packet sequence mutex, not sending %" PRIu64 " packets", (uint64_t)payloads.size());
+        return PacketResult::ErrorNoSequenceLock;
+    }
+
+    // The process is running, each packet has to interrupt it so there is
+    // nothing to gain from pipelining.
+    for (const std::string &payload : payloads)
+    {
+        StringExtractorGDBRemote response;
+        PacketResult packet_result = SendPacketAndWaitForResponse (payload.data(), payload.size(), response, send_async);
+        if (packet_result != PacketResult::Success)
+            return packet_result;
+        responses.push_back (response);
+    }
+    return PacketResult::Success;
+}
+
 static const char *end_delimiter = "--end--;";
 static const int end_delimiter_len = 8;
 
@@ -846,6 +996,8 @@ GDBRemoteCommunicationClient::SendContinuePacketAndWaitForResponse
     std::string continue_packet(payload, packet_length);
     
     bool got_async_packet = false;
+    // When the last continue packet was sent, invalid once it got its response
+    TimeValue continue_send_time;
     
     while (state == eStateRunning)
     {
@@ -853,6 +1005,7 @@ GDBRemoteCommunicationClient::SendContinuePacketAndWaitForResponse
         {
             if (log)
                 log->Printf ("GDBRemoteCommunicationClient::%s () sending continue packet: %s", __FUNCTION__, continue_packet.c_str());
+            continue_send_time = TimeValue::Now();
             if (SendPacketNoLock(continue_packet.c_str(), continue_packet.size()) != PacketResult::Success)
                 state = eStateInvalid;
             else
@@ -872,6 +1025,18 @@ GDBRemoteCommunicationClient::SendContinuePacketAndWaitForResponse
                 state = eStateInvalid;
             else
             {
+                // Console output arrives while the process runs, anything
+                // else answers the continue packet.
+                if (continue_send_time.IsValid() && response.GetStringRef()[0] != 'O')
+                {
+                    RecordPacketStatistics (continue_packet.data(),
+                                            continue_packet.size(),
+                                            response.GetStringRef().size(),
+                                            continue_send_time,
+                                            PacketResult::Success);
+                    continue_send_time.Clear();
+                }
+
                 const char stop_type = response.GetChar();
                 if (log)
                     log->Printf ("GDBRemoteCommunicationClient::%s () got packet: %s", __FUNCTION__, response.GetStringRef().c_str());
@@ -3043,6 +3208,104 @@ GDBRemoteCommunicationClient::SendGDBStoppointTypePacket (GDBStoppointType type,
     return UINT8_MAX;
 }
 
+bool
+GDBRemoteCommunicationClient::SendMultiBreakpointPacket (GDBStoppointType type,
+                                                         bool insert,
+                                                         const std::vector<addr_t> &addrs,
+                                                         const std::vector<uint32_t> &lengths,
+                                                         std::vector<uint8_t> &results)
+{
+    results.clear();
+
+    if (type != eBreakpointSoftware && type != eBreakpointHardware)
+        return false;
+    if (!SupportsGDBStoppointPacket(type) || !GetMultiBreakpointSupported())
+        return false;
+    assert (addrs.size() == lengths.size());
+
+    Log *log (GetLogIfAnyCategoriesSet (LIBLLDB_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf ("GDBRemoteCommunicationClient::%s() %s %" PRIu64 " breakpoints",
+                     __FUNCTION__, insert ? "add" : "remove", (uint64_t)addrs.size());
+
+    // Leave room for the packet framing, and don't build huge packets
+    // for stubs that don't tell us their limit.
+    uint64_t max_packet_size = GetRemoteMaxPacketSize();
+    if (max_packet_size == UINT64_MAX)
+        max_packet_size = 4096;
+    if (max_packet_size > 64)
+        max_packet_size -= 16;
+
+    size_t idx = 0;
+    while (idx < addrs.size())
+    {
+        StreamString packet;
+        packet.Printf ("_%c%i", insert ? 'Z' : 'z', type);
+        const size_t first = idx;
+        while (idx < addrs.size())
+        {
+            char entry[64];
+            const int entry_len = ::snprintf (entry, sizeof(entry), ";%" PRIx64 ",%x", addrs[idx], lengths[idx]);
+            if (idx > first && packet.GetSize() + entry_len > max_packet_size)
+                break;
+            packet.Write (entry, entry_len);
+            ++idx;
+        }
+        const size_t count = idx - first;
+
+        StringExtractorGDBRemote response;
+        if (SendPacketAndWaitForResponse(packet.GetData(), packet.GetSize(), response, true) != PacketResult::Success)
+        {
+            results.resize (addrs.size(), UINT8_MAX);
+            break;
+        }
+
+        if (response.IsUnsupportedResponse())
+        {
+            // Nothing has been sent before this if it is the first packet.
+            m_supports_multi_breakpoint = eLazyBoolNo;
+            if (first == 0)
+                return false;
+            results.resize (addrs.size(), UINT8_MAX);
+            break;
+        }
+
+        if (response.IsOKResponse())
+        {
+            results.resize (first + count, 0);
+            continue;
+        }
+
+        // Either a single error for the whole packet or one "OK" or "Exx"
+        // per address separated by semicolons.
+        const std::string &response_str = response.GetStringRef();
+        if (response.IsErrorResponse() && response_str.find(';') == std::string::npos)
+        {
+            results.resize (first + count, response.GetError());
+            continue;
+        }
+        size_t pos = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint8_t result = UINT8_MAX;
+            if (pos < response_str.size())
+            {
+                size_t end = response_str.find(';', pos);
+                if (end == std::string::npos)
+                    end = response_str.size();
+                const std::string entry = response_str.substr(pos, end - pos);
+                if (entry == "OK")
+                    result = 0;
+                else if (entry.size() == 3 && entry[0] == 'E')
+                    result = StringExtractor(entry.c_str() + 1).GetHexU8(UINT8_MAX);
+                pos = end + 1;
+            }
+            results.push_back (result);
+        }
+    }
+    return true;
+}
+
 size_t
 GDBRemoteCommunicationClient::GetCurrentThreadIDs (std::vector<lldb::tid_t> &thread_ids, 
                                                    bool &sequence_mutex_unavailable)
@@ -3330,6 +3593,93 @@ GDBRemoteCommunicationClient::GetFilePermissions(const char *path, uint32_t &fil
     return error;
 }
 
+// Largest number of file bytes moved by a single vFile:pread or
+// vFile:pwrite packet. Binary escaping can double the size of the data, so
+// this is further clamped to half of the remote packet size.
+static const uint64_t k_max_file_chunk_size = 64 * 1024;
+
+uint64_t
+GDBRemoteCommunicationClient::GetFileChunkSize ()
+{
+    const uint64_t max_packet_size = GetRemoteMaxPacketSize();
+    if (max_packet_size == UINT64_MAX || max_packet_size / 2 > k_max_file_chunk_size + 64)
+        return k_max_file_chunk_size;
+    if (max_packet_size / 2 <= 64)
+        return 1024;
+    return max_packet_size / 2 - 64;
+}
+
+static uint64_t
+DecodeReadFileResponse (StringExtractorGDBRemote &response,
+                        void *dst,
+                        uint64_t dst_len,
+                        Error &error)
+{
+    if (response.GetChar() != 'F')
+    {
+        error.SetErrorString ("read file failed");
+        return UINT32_MAX;
+    }
+    if (response.Peek() && *response.Peek() == '-')
+    {
+        // "F-1,<errno>"
+        response.GetS32(0);
+        error.SetErrorToGenericError();
+        if (response.GetChar() == ',')
+        {
+            int response_errno = response.GetS32(-1);
+            if (response_errno > 0)
+                error.SetError(response_errno, lldb::eErrorTypePOSIX);
+        }
+        return UINT32_MAX;
+    }
+    uint32_t retcode = response.GetHexMaxU32(false, UINT32_MAX);
+    if (retcode == UINT32_MAX)
+    {
+        error.SetErrorToGenericError();
+        return retcode;
+    }
+    const char next = (response.Peek() ? *response.Peek() : 0);
+    if (next == ',')
+        return 0;
+    if (next == ';')
+    {
+        response.GetChar(); // skip the semicolon
+        std::string buffer;
+        if (response.GetEscapedBinaryData(buffer))
+        {
+            const uint64_t data_to_write = std::min<uint64_t>(dst_len, buffer.size());
+            if (data_to_write > 0)
+                memcpy(dst, &buffer[0], data_to_write);
+            return data_to_write;
+        }
+    }
+    return 0;
+}
+
+static uint64_t
+DecodeWriteFileResponse (StringExtractorGDBRemote &response, Error &error)
+{
+    if (response.GetChar() != 'F')
+    {
+        error.SetErrorStringWithFormat("write file failed");
+        return 0;
+    }
+    uint64_t bytes_written = response.GetU64(UINT64_MAX);
+    if (bytes_written == UINT64_MAX)
+    {
+        error.SetErrorToGenericError();
+        if (response.GetChar() == ',')
+        {
+            int response_errno = response.GetS32(-1);
+            if (response_errno > 0)
+                error.SetError(response_errno, lldb::eErrorTypePOSIX);
+        }
+        return 0;
+    }
+    return bytes_written;
+}
+
 uint64_t
 GDBRemoteCommunicationClient::ReadFile (lldb::user_id_t fd,
                                         uint64_t offset,
@@ -3337,35 +3687,40 @@ GDBRemoteCommunicationClient::ReadFile (lldb::user_id_t fd,
                                         uint64_t dst_len,
                                         Error &error)
 {
-    lldb_private::StreamString stream;
-    stream.Printf("vFile:pread:%i,%" PRId64 ",%" PRId64, (int)fd, dst_len, offset);
-    const char* packet = stream.GetData();
-    int packet_len = stream.GetSize();
-    StringExtractorGDBRemote response;
-    if (SendPacketAndWaitForResponse(packet, packet_len, response, false) == PacketResult::Success)
+    // Large reads are split into chunks that are all requested up front so
+    // the transfer isn't bound by one round trip per chunk.
+    const uint64_t chunk_size = GetFileChunkSize();
+    std::vector<std::string> payloads;
+    for (uint64_t chunk_offset = 0; chunk_offset < dst_len; chunk_offset += chunk_size)
     {
-        if (response.GetChar() != 'F')
-            return 0;
-        uint32_t retcode = response.GetHexMaxU32(false, UINT32_MAX);
-        if (retcode == UINT32_MAX)
-            return retcode;
-        const char next = (response.Peek() ? *response.Peek() : 0);
-        if (next == ',')
-            return 0;
-        if (next == ';')
-        {
-            response.GetChar(); // skip the semicolon
-            std::string buffer;
-            if (response.GetEscapedBinaryData(buffer))
-            {
-                const uint64_t data_to_write = std::min<uint64_t>(dst_len, buffer.size());
-                if (data_to_write > 0)
-                    memcpy(dst, &buffer[0], data_to_write);
-                return data_to_write;
-            }
-        }
+        lldb_private::StreamString stream;
+        stream.Printf("vFile:pread:%i,%" PRId64 ",%" PRId64, (int)fd,
+                      std::min<uint64_t>(chunk_size, dst_len - chunk_offset), offset + chunk_offset);
+        payloads.push_back(stream.GetString());
     }
-    return 0;
+
+    std::vector<StringExtractorGDBRemote> responses;
+    const PacketResult packet_result = SendPacketsAndWaitForResponses (payloads, responses, false);
+
+    uint64_t bytes_read = 0;
+    for (StringExtractorGDBRemote &response : responses)
+    {
+        const uint64_t to_read = std::min<uint64_t>(chunk_size, dst_len - bytes_read);
+        const uint64_t n_read = DecodeReadFileResponse (response, (uint8_t *)dst + bytes_read, to_read, error);
+        if (n_read == UINT32_MAX)
+            return n_read;
+        bytes_read += n_read;
+        // A short read means we hit the end of the file, the responses to
+        // the chunks after it carry no data.
+        if (n_read < to_read)
+            return bytes_read;
+    }
+
+    // Don't pass off the chunks we did get as a read that hit the end of
+    // the file.
+    if (packet_result != PacketResult::Success)
+        error.SetErrorString ("failed to send vFile:pread packet");
+    return bytes_read;
 }
 
 uint64_t
@@ -3375,38 +3730,41 @@ GDBRemoteCommunicationClient::WriteFile (lldb::user_id_t fd,
                                          uint64_t src_len,
                                          Error &error)
 {
-    lldb_private::StreamGDBRemote stream;
-    stream.Printf("vFile:pwrite:%i,%" PRId64 ",", (int)fd, offset);
-    stream.PutEscapedBytes(src, src_len);
-    const char* packet = stream.GetData();
-    int packet_len = stream.GetSize();
-    StringExtractorGDBRemote response;
-    if (SendPacketAndWaitForResponse(packet, packet_len, response, false) == PacketResult::Success)
+    const uint64_t chunk_size = GetFileChunkSize();
+    std::vector<std::string> payloads;
+    for (uint64_t chunk_offset = 0; chunk_offset == 0 || chunk_offset < src_len; chunk_offset += chunk_size)
     {
-        if (response.GetChar() != 'F')
-        {
-            error.SetErrorStringWithFormat("write file failed");
-            return 0;
-        }
-        uint64_t bytes_written = response.GetU64(UINT64_MAX);
-        if (bytes_written == UINT64_MAX)
+        lldb_private::StreamGDBRemote stream;
+        stream.Printf("vFile:pwrite:%i,%" PRId64 ",", (int)fd, offset + chunk_offset);
+        stream.PutEscapedBytes((const uint8_t *)src + chunk_offset, std::min<uint64_t>(chunk_size, src_len - chunk_offset));
+        payloads.push_back(stream.GetString());
+    }
+
+    std::vector<StringExtractorGDBRemote> responses;
+    const PacketResult packet_result = SendPacketsAndWaitForResponses (payloads, responses, false);
+
+    // The chunks were all sent before any reply came back, so the ones after
+    // a failed chunk may have been written anyway. Only the bytes up to the
+    // first failure are reported, along with the error.
+    uint64_t bytes_written = 0;
+    for (StringExtractorGDBRemote &response : responses)
+    {
+        const uint64_t to_write = std::min<uint64_t>(chunk_size, src_len - bytes_written);
+        const uint64_t n_written = DecodeWriteFileResponse (response, error);
+        if (error.Fail())
+            return bytes_written;
+        bytes_written += n_written;
+        if (n_written != to_write)
         {
-            error.SetErrorToGenericError();
-            if (response.GetChar() == ',')
-            {
-                int response_errno = response.GetS32(-1);
-                if (response_errno > 0)
-                    error.SetError(response_errno, lldb::eErrorTypePOSIX);
-            }
-            return 0;
+            error.SetErrorStringWithFormat ("short write at offset %" PRIu64 ": %" PRIu64 " of %" PRIu64 " bytes written",
+                                            offset + bytes_written - n_written, n_written, to_write);
+            return bytes_written;
         }
-        return bytes_written;
     }
-    else
-    {
+
+    if (packet_result != PacketResult::Success || responses.size() != payloads.size())
         error.SetErrorString ("failed to send vFile:pwrite packet");
-    }
-    return 0;
+    return bytes_written;
 }
 
 Error
@@ -3600,6 +3958,37 @@ GDBRemoteCommunicationClient::ReadRegister(lldb::tid_t tid, uint32_t reg, String
 }
 
 
+bool
+GDBRemoteCommunicationClient::ReadRegisters (lldb::tid_t tid,
+                                             const std::vector<uint32_t> &reg_nums,
+                                             std::vector<StringExtractorGDBRemote> &responses)
+{
+    Mutex::Locker locker;
+    if (GetSequenceMutex (locker, "Didn't get sequence mutex for p packets."))
+    {
+        const bool thread_suffix_supported = GetThreadSuffixSupported();
+
+        if (thread_suffix_supported || SetCurrentThread(tid))
+        {
+            std::vector<std::string> payloads;
+            payloads.reserve (reg_nums.size());
+            for (uint32_t reg : reg_nums)
+            {
+                char packet[64];
+                int packet_len = 0;
+                if (thread_suffix_supported)
+                    packet_len = ::snprintf (packet, sizeof(packet), "p%x;thread:%4.4" PRIx64 ";", reg, tid);
+                else
+                    packet_len = ::snprintf (packet, sizeof(packet), "p%x", reg);
+                assert (packet_len < ((int)sizeof(packet) - 1));
+                payloads.push_back (std::string (packet, packet_len));
+            }
+            return SendPacketsAndWaitForResponsesNoLock (payloads, responses) == PacketResult::Success;
+        }
+    }
+    return false;
+}
+
 bool
 GDBRemoteCommunicationClient::ReadAllRegisters (lldb::tid_t tid, StringExtractorGDBRemote &response)
 {
@@ -73,6 +73,30 @@ public:
     SendPacketsAndConcatenateResponses (const char *send_payload_prefix,
                                         std::string &response_string);
 
+    // Send a batch of independent packets and return their responses in
+    // order. Once "QStartNoAckMode" has been negotiated the packets are
+    // pipelined: up to GetMaxOutstandingPackets() requests are written
+    // before the first response is read, so the whole batch costs about
+    // one round trip instead of one per packet. With acks enabled the
+    // packets are sent one at a time. On failure "responses" contains the
+    // responses that were received before the error.
+    PacketResult
+    SendPacketsAndWaitForResponses (const std::vector<std::string> &payloads,
+                                    std::vector<StringExtractorGDBRemote> &responses,
+                                    bool send_async);
+
+    uint32_t
+    GetMaxOutstandingPackets () const
+    {
+        return m_max_outstanding_packets;
+    }
+
+    void
+    SetMaxOutstandingPackets (uint32_t max_outstanding_packets)
+    {
+        m_max_outstanding_packets = max_outstanding_packets > 0 ? max_outstanding_packets : 1;
+    }
+
     lldb::StateType
     SendContinuePacketAndWaitForResponse (ProcessGDBRemote *process,
                                           const char *packet_payload,
@@ -304,6 +328,9 @@ public:
     bool
     GetpPacketSupported (lldb::tid_t tid);
 
+    bool
+    GetgPacketSupported (lldb::tid_t tid);
+
     bool
     GetxPacketSupported ();
 
@@ -393,6 +420,25 @@ public:
                                 lldb::addr_t addr,        // Address of breakpoint or watchpoint
                                 uint32_t length);         // Byte Size of breakpoint or watchpoint
 
+    //------------------------------------------------------------------
+    /// Insert or remove several breakpoints of the same type with as
+    /// few "_Z"/"_z" packets as possible.
+    ///
+    /// @param[out] results
+    ///     One entry per address: zero on success, otherwise the error
+    ///     code the stub returned, or UINT8_MAX for a generic failure.
+    ///
+    /// @return
+    ///     False if the stub doesn't support the packets, in which case
+    ///     \a results is left empty and nothing was changed.
+    //------------------------------------------------------------------
+    bool
+    SendMultiBreakpointPacket (GDBStoppointType type,
+                               bool insert,
+                               const std::vector<lldb::addr_t> &addrs,
+                               const std::vector<uint32_t> &lengths,
+                               std::vector<uint8_t> &results);
+
     void
     TestPacketSpeed (const uint32_t num_packets);
 
@@ -426,6 +472,9 @@ public:
     bool
     GetAugmentedLibrariesSVR4ReadSupported ();
 
+    bool
+    GetMultiBreakpointSupported ();
+
     LazyBool
     SupportsAllocDeallocMemory () // const
     {
@@ -459,6 +508,12 @@ public:
     Error
     SetFilePermissions(const char *path, uint32_t file_permissions);
 
+    // Number of file bytes read or written by a single vFile:pread or
+    // vFile:pwrite packet. ReadFile and WriteFile split larger requests
+    // into chunks of this size and pipeline them.
+    uint64_t
+    GetFileChunkSize ();
+
     uint64_t
     ReadFile (lldb::user_id_t fd,
               uint64_t offset,
@@ -506,6 +561,14 @@ public:
                  uint32_t reg_num,
                  StringExtractorGDBRemote &response);
 
+    // Read several registers from one thread with a single batch of
+    // pipelined "p" packets. "responses" is filled in the same order as
+    // "reg_nums".
+    bool
+    ReadRegisters (lldb::tid_t tid,
+                   const std::vector<uint32_t> &reg_nums,
+                   std::vector<StringExtractorGDBRemote> &responses);
+
     bool
     ReadAllRegisters (lldb::tid_t tid,
                       StringExtractorGDBRemote &response);
@@ -540,6 +603,10 @@ protected:
                                         size_t payload_length,
                                         StringExtractorGDBRemote &response);
 
+    PacketResult
+    SendPacketsAndWaitForResponsesNoLock (const std::vector<std::string> &payloads,
+                                          std::vector<StringExtractorGDBRemote> &responses);
+
     bool
     GetCurrentProcessInfo (bool allow_lazy_pid = true);
 
@@ -558,6 +625,7 @@ protected:
     LazyBool m_supports_vCont_C;
     LazyBool m_supports_vCont_s;
     LazyBool m_supports_vCont_S;
+    LazyBool m_supports_vCont_r;
     LazyBool m_qHostInfo_is_valid;
     LazyBool m_curr_pid_is_valid;
     LazyBool m_qProcessInfo_is_valid;
@@ -570,6 +638,7 @@ protected:
     LazyBool m_attach_or_wait_reply;
     LazyBool m_prepare_for_reg_writing_reply;
     LazyBool m_supports_p;
+    LazyBool m_supports_g;
     LazyBool m_supports_x;
     LazyBool m_avoid_g_packets;
     LazyBool m_supports_QSaveRegisterState;
@@ -577,6 +646,7 @@ protected:
     LazyBool m_supports_qXfer_libraries_read;
     LazyBool m_supports_qXfer_libraries_svr4_read;
     LazyBool m_supports_augmented_libraries_svr4_read;
+    LazyBool m_supports_multi_breakpoint;
     LazyBool m_supports_jThreadExtendedInfo;
 
     bool
@@ -624,6 +694,7 @@ protected:
     uint32_t m_gdb_server_version; // from reply to qGDBServerVersion, zero if qGDBServerVersion is not supported
     uint32_t m_default_packet_timeout;
     uint64_t m_max_packet_size;  // as returned by qSupported
+    uint32_t m_max_outstanding_packets; // Max number of pipelined requests in flight in SendPacketsAndWaitForResponses
     
     bool
     DecodeProcessInfoResponse (StringExtractorGDBRemote &response, 
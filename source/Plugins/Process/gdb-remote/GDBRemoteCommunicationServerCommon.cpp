@@ -908,6 +908,7 @@ GDBRemoteCommunicationServerCommon::Handle_qSupported (StringExtractorGDBRemote
     response.PutCString (";QStartNoAckMode+");
     response.PutCString (";QThreadSuffixSupported+");
     response.PutCString (";QListThreadsInStopReply+");
+    response.PutCString (";multi-breakpoint+");
 #if defined(__linux__)
     response.PutCString (";qXfer:auxv:read+");
 #endif
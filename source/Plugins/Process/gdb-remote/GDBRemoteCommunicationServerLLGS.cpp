@@ -16,6 +16,7 @@
 
 // C Includes
 // C++ Includes
+#include <algorithm>
 #include <cstring>
 #include <chrono>
 #include <thread>
@@ -76,9 +77,12 @@ namespace
 //----------------------------------------------------------------------
 GDBRemoteCommunicationServerLLGS::GDBRemoteCommunicationServerLLGS(
         const lldb::PlatformSP& platform_sp,
-        lldb::DebuggerSP &debugger_sp) :
+        lldb::DebuggerSP &debugger_sp,
+        MainLoop &mainloop) :
     GDBRemoteCommunicationServerCommon ("gdb-remote.server", "gdb-remote.server.rx_packet"),
     m_platform_sp (platform_sp),
+    m_mainloop (mainloop),
+    m_network_handle_up (),
     m_async_thread (LLDB_INVALID_HOST_THREAD),
     m_current_tid (LLDB_INVALID_THREAD_ID),
     m_continue_tid (LLDB_INVALID_THREAD_ID),
@@ -120,6 +124,10 @@ GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers()
                                   &GDBRemoteCommunicationServerLLGS::Handle_c);
     RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_D,
                                   &GDBRemoteCommunicationServerLLGS::Handle_D);
+    RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_g,
+                                  &GDBRemoteCommunicationServerLLGS::Handle_g);
+    RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_G,
+                                  &GDBRemoteCommunicationServerLLGS::Handle_G);
     RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_H,
                                   &GDBRemoteCommunicationServerLLGS::Handle_H);
     RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_I,
@@ -178,6 +186,10 @@ GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers()
                                   &GDBRemoteCommunicationServerLLGS::Handle_Z);
     RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType_z,
                                   &GDBRemoteCommunicationServerLLGS::Handle_z);
+    RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__Z,
+                                  &GDBRemoteCommunicationServerLLGS::Handle__Z);
+    RegisterMemberFunctionHandler(StringExtractorGDBRemote::eServerPacketType__z,
+                                  &GDBRemoteCommunicationServerLLGS::Handle__z);
 
     RegisterPacketHandler(StringExtractorGDBRemote::eServerPacketType_k,
                           [this](StringExtractorGDBRemote packet,
@@ -222,6 +234,7 @@ GDBRemoteCommunicationServerLLGS::LaunchProcess ()
         error = m_platform_sp->LaunchNativeProcess (
             m_process_launch_info,
             *this,
+            m_mainloop,
             m_debugged_process_sp);
     }
 
@@ -307,7 +320,7 @@ GDBRemoteCommunicationServerLLGS::AttachToProcess (lldb::pid_t pid)
         }
 
         // Try to attach.
-        error = m_platform_sp->AttachNativeProcess (pid, *this, m_debugged_process_sp);
+        error = m_platform_sp->AttachNativeProcess (pid, *this, m_mainloop, m_debugged_process_sp);
         if (!error.Success ())
         {
             fprintf (stderr, "%s: failed to attach to process %" PRIu64 ": %s", __FUNCTION__, pid, error.AsCString ());
@@ -454,6 +467,21 @@ WriteRegisterValueInHexFixedWidth (StreamString &response,
     }
 }
 
+static size_t
+GetRegisterDataByteSize (NativeRegisterContext &reg_ctx)
+{
+    // Size of the g/G packet register data: the end of the furthest user register.
+    size_t byte_size = 0;
+    const uint32_t reg_count = reg_ctx.GetUserRegisterCount ();
+    for (uint32_t reg_index = 0; reg_index < reg_count; ++reg_index)
+    {
+        const RegisterInfo *reg_info = reg_ctx.GetRegisterInfoAtIndex (reg_index);
+        if (reg_info)
+            byte_size = std::max<size_t> (byte_size, reg_info->byte_offset + reg_info->byte_size);
+    }
+    return byte_size;
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread (lldb::tid_t tid)
 {
@@ -558,6 +586,7 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread (lldb::tid_t tid)
     if (reg_ctx_sp)
     {
         // Expedite all registers in the first register set (i.e. should be GPRs) that are not contained in other registers.
+        std::vector<uint32_t> expedited_regs;
         const RegisterSet *reg_set_p;
         if (reg_ctx_sp->GetRegisterSetCount () > 0 && ((reg_set_p = reg_ctx_sp->GetRegisterSet (0)) != nullptr))
         {
@@ -565,30 +594,49 @@ GDBRemoteCommunicationServerLLGS::SendStopReplyPacketForThread (lldb::tid_t tid)
                 log->Printf ("GDBRemoteCommunicationServerLLGS::%s expediting registers from set '%s' (registers set count: %zu)", __FUNCTION__, reg_set_p->name ? reg_set_p->name : "<unnamed-set>", reg_set_p->num_registers);
 
             for (const uint32_t *reg_num_p = reg_set_p->registers; *reg_num_p != LLDB_INVALID_REGNUM; ++reg_num_p)
+                expedited_regs.push_back (*reg_num_p);
+        }
+
+        // Make sure the registers the client needs to unwind the stopped thread
+        // are expedited as well, even if they are not part of the first set.
+        static const uint32_t k_unwind_generic_regs[] = {
+            LLDB_REGNUM_GENERIC_PC,
+            LLDB_REGNUM_GENERIC_SP,
+            LLDB_REGNUM_GENERIC_FP,
+            LLDB_REGNUM_GENERIC_RA,
+            LLDB_REGNUM_GENERIC_FLAGS
+        };
+        for (const uint32_t generic_reg : k_unwind_generic_regs)
+        {
+            const uint32_t reg_num = reg_ctx_sp->ConvertRegisterKindToRegisterNumber (eRegisterKindGeneric, generic_reg);
+            if (reg_num != LLDB_INVALID_REGNUM && std::find (expedited_regs.begin (), expedited_regs.end (), reg_num) == expedited_regs.end ())
+                expedited_regs.push_back (reg_num);
+        }
+
+        for (const uint32_t reg_num : expedited_regs)
+        {
+            const RegisterInfo *const reg_info_p = reg_ctx_sp->GetRegisterInfoAtIndex (reg_num);
+            if (reg_info_p == nullptr)
             {
-                const RegisterInfo *const reg_info_p = reg_ctx_sp->GetRegisterInfoAtIndex (*reg_num_p);
-                if (reg_info_p == nullptr)
+                if (log)
+                    log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed to get register info for register index %" PRIu32, __FUNCTION__, reg_num);
+            }
+            else if (reg_info_p->value_regs == nullptr)
+            {
+                // Only expediate registers that are not contained in other registers.
+                RegisterValue reg_value;
+                Error error = reg_ctx_sp->ReadRegister (reg_info_p, reg_value);
+                if (error.Success ())
                 {
-                    if (log)
-                        log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed to get register info for register set '%s', register index %" PRIu32, __FUNCTION__, reg_set_p->name ? reg_set_p->name : "<unnamed-set>", *reg_num_p);
+                    response.Printf ("%.02x:", reg_num);
+                    WriteRegisterValueInHexFixedWidth(response, reg_ctx_sp, *reg_info_p, &reg_value);
+                    response.PutChar (';');
                 }
-                else if (reg_info_p->value_regs == nullptr)
+                else
                 {
-                    // Only expediate registers that are not contained in other registers.
-                    RegisterValue reg_value;
-                    Error error = reg_ctx_sp->ReadRegister (reg_info_p, reg_value);
-                    if (error.Success ())
-                    {
-                        response.Printf ("%.02x:", *reg_num_p);
-                        WriteRegisterValueInHexFixedWidth(response, reg_ctx_sp, *reg_info_p, &reg_value);
-                        response.PutChar (';');
-                    }
-                    else
-                    {
-                        if (log)
-                            log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed to read register '%s' index %" PRIu32 ": %s", __FUNCTION__, reg_info_p->name ? reg_info_p->name : "<unnamed-register>", *reg_num_p, error.AsCString ());
-
-                    }
+                    if (log)
+                        log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed to read register '%s' index %" PRIu32 ": %s", __FUNCTION__, reg_info_p->name ? reg_info_p->name : "<unnamed-register>", reg_num, error.AsCString ());
+
                 }
             }
         }
@@ -703,6 +751,7 @@ GDBRemoteCommunicationServerLLGS::HandleInferiorState_Exited (NativeProcessProto
 
     // We are ready to exit the debug monitor.
     m_exit_now = true;
+    m_mainloop.RequestTermination ();
 }
 
 void
@@ -883,6 +932,49 @@ GDBRemoteCommunicationServerLLGS::Handle_qC (StringExtractorGDBRemote &packet)
     return SendPacketNoLock (response.GetData(), response.GetSize());
 }
 
+void
+GDBRemoteCommunicationServerLLGS::DataAvailableCallback ()
+{
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+    bool interrupt = false;
+    bool done = false;
+    Error error;
+    while (true)
+    {
+        const PacketResult result = GetPacketAndSendResponse (0, error, interrupt, done);
+        if (result == PacketResult::ErrorReplyTimeout)
+            break; // No more packets in the queue
+
+        if (result != PacketResult::Success)
+        {
+            if (log)
+                log->Printf ("GDBRemoteCommunicationServerLLGS::%s processing a packet failed: %s",
+                             __FUNCTION__, error.AsCString ());
+            m_mainloop.RequestTermination ();
+            break;
+        }
+
+        if (interrupt || done)
+        {
+            m_mainloop.RequestTermination ();
+            break;
+        }
+    }
+}
+
+Error
+GDBRemoteCommunicationServerLLGS::InitializeConnection (std::unique_ptr<ConnectionFileDescriptor> &&connection)
+{
+    IOObjectSP read_object_sp = connection->GetReadObject ();
+    GDBRemoteCommunicationServer::SetConnection (connection.release ());
+
+    Error error;
+    m_network_handle_up = m_mainloop.RegisterReadObject (read_object_sp,
+            [this] (MainLoopBase &) { DataAvailableCallback (); }, error);
+    return error;
+}
+
 bool
 GDBRemoteCommunicationServerLLGS::DebuggedProcessReaped (lldb::pid_t pid)
 {
@@ -906,27 +998,17 @@ GDBRemoteCommunicationServerLLGS::ReapDebuggedProcess (void *callback_baton,
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_k (StringExtractorGDBRemote &packet)
 {
-    // shutdown all spawned processes
-    std::set<lldb::pid_t> spawned_pids_copy;
-
-    // copy pids
-    {
-        Mutex::Locker locker (m_spawned_pids_mutex);
-        spawned_pids_copy.insert (m_spawned_pids.begin (), m_spawned_pids.end ());
-    }
-
-    // nuke the spawned processes
-    for (auto it = spawned_pids_copy.begin (); it != spawned_pids_copy.end (); ++it)
+    // The process is reaped, and its stdio closed, by the SIGCHLD handler on
+    // the main loop once this packet has been handled.  Waiting for either
+    // here would block the only thread that can observe them.
+    Mutex::Locker locker (m_debugged_process_mutex);
+    if (m_debugged_process_sp)
     {
-        lldb::pid_t spawned_pid = *it;
-        if (!KillSpawnedProcess (spawned_pid))
-        {
-            fprintf (stderr, "%s: failed to kill spawned pid %" PRIu64 ", ignoring.\n", __FUNCTION__, spawned_pid);
-        }
+        Error error = m_debugged_process_sp->Kill ();
+        if (error.Fail ())
+            fprintf (stderr, "%s: failed to kill debugged pid %" PRIu64 ": %s, ignoring.\n", __FUNCTION__, m_debugged_process_sp->GetID (), error.AsCString ());
     }
 
-    FlushInferiorOutput ();
-
     // No OK response for kill packet.
     // return SendOKResponse ();
     return PacketResult::Success;
@@ -1107,7 +1189,7 @@ GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_vCont_actions (StringExtractorGDBRemote &packet)
 {
     StreamString response;
-    response.Printf("vCont;c;C;s;S");
+    response.Printf("vCont;c;C;s;S;r");
 
     return SendPacketNoLock(response.GetData(), response.GetSize());
 }
@@ -1162,6 +1244,8 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont (StringExtractorGDBRemote &packet
         thread_action.tid = LLDB_INVALID_THREAD_ID;
         thread_action.state = eStateInvalid;
         thread_action.signal = 0;
+        thread_action.step_range_start = 0;
+        thread_action.step_range_end = 0;
 
         const char action = packet.GetChar ();
         switch (action)
@@ -1188,6 +1272,20 @@ GDBRemoteCommunicationServerLLGS::Handle_vCont (StringExtractorGDBRemote &packet
                 thread_action.state = eStateStepping;
                 break;
 
+            case 'r':
+                // Step while the pc is in [start, end), only the stop that
+                // leaves the range is reported.
+                thread_action.step_range_start = packet.GetHexMaxU64 (false, LLDB_INVALID_ADDRESS);
+                if (packet.GetChar () != ',')
+                    return SendIllFormedResponse (packet, "Missing range end in vCont packet r action");
+                thread_action.step_range_end = packet.GetHexMaxU64 (false, LLDB_INVALID_ADDRESS);
+                if (thread_action.step_range_start == LLDB_INVALID_ADDRESS ||
+                    thread_action.step_range_end == LLDB_INVALID_ADDRESS ||
+                    thread_action.step_range_start >= thread_action.step_range_end)
+                    return SendIllFormedResponse (packet, "Invalid range in vCont packet r action");
+                thread_action.state = eStateStepping;
+                break;
+
             default:
                 return SendIllFormedResponse (packet, "Unsupported vCont action");
                 break;
@@ -1655,6 +1753,145 @@ GDBRemoteCommunicationServerLLGS::Handle_P (StringExtractorGDBRemote &packet)
     return SendOKResponse();
 }
 
+size_t
+GDBRemoteCommunicationServerLLGS::ReadGPacketRegisterData (NativeRegisterContext &reg_context, std::vector<uint8_t> &reg_data)
+{
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_THREAD));
+
+    // The g packet data is laid out using the register offsets we hand out in
+    // qRegisterInfo, which is also how the client sizes its register buffer.
+    const size_t reg_data_size = GetRegisterDataByteSize (reg_context);
+    reg_data.assign (reg_data_size, 0);
+
+    // The client takes every register the reply covers as valid, so the
+    // reply has to end before the first register we can't read.
+    size_t reply_size = reg_data_size;
+    const uint32_t reg_count = reg_context.GetUserRegisterCount ();
+    for (uint32_t reg_index = 0; reg_index < reg_count; ++reg_index)
+    {
+        const RegisterInfo *reg_info = reg_context.GetRegisterInfoAtIndex (reg_index);
+        // Registers contained in other registers get filled in by their containing register,
+        // and lldb-internal registers cannot be read directly.
+        if (!reg_info || reg_info->value_regs || reg_info->kinds[eRegisterKindLLDB] == LLDB_INVALID_REGNUM)
+            continue;
+        if (reg_info->byte_offset >= reply_size)
+            continue;
+
+        RegisterValue reg_value;
+        Error error = reg_context.ReadRegister (reg_info, reg_value);
+        const uint8_t *const data = reinterpret_cast<const uint8_t*> (reg_value.GetBytes ());
+        if (error.Fail () || !data)
+        {
+            if (log)
+                log->Printf ("GDBRemoteCommunicationServerLLGS::%s read of register %" PRIu32 " (%s) failed, leaving it out of the reply: %s", __FUNCTION__, reg_index, reg_info->name, error.Fail () ? error.AsCString () : "no data bytes");
+            reply_size = reg_info->byte_offset;
+            continue;
+        }
+
+        ::memcpy (&reg_data[reg_info->byte_offset], data, std::min<size_t> (reg_value.GetByteSize (), reg_info->byte_size));
+    }
+    return reply_size;
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_g (StringExtractorGDBRemote &packet)
+{
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_THREAD));
+
+    // Get the thread to use.
+    packet.SetFilePos (strlen("g"));
+    NativeThreadProtocolSP thread_sp = GetThreadFromSuffix (packet);
+    if (!thread_sp)
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed, no thread available", __FUNCTION__);
+        return SendErrorResponse (0x15);
+    }
+
+    // Get the thread's register context.
+    NativeRegisterContextSP reg_context_sp (thread_sp->GetRegisterContext ());
+    if (!reg_context_sp)
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64 " tid %" PRIu64 " failed, no register context available for the thread", __FUNCTION__, m_debugged_process_sp->GetID (), thread_sp->GetID ());
+        return SendErrorResponse (0x15);
+    }
+
+    std::vector<uint8_t> reg_data;
+    const size_t reply_size = ReadGPacketRegisterData (*reg_context_sp, reg_data);
+    if (reply_size == 0)
+    {
+        // An empty reply would mean 'g' isn't supported at all
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64 " tid %" PRIu64 " failed, no registers could be read", __FUNCTION__, m_debugged_process_sp->GetID (), thread_sp->GetID ());
+        return SendErrorResponse (0x15);
+    }
+
+    StreamGDBRemote response;
+    response.PutBytesAsRawHex8 (reg_data.data (), reply_size);
+    return SendPacketNoLock (response.GetData (), response.GetSize ());
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_G (StringExtractorGDBRemote &packet)
+{
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_THREAD));
+
+    // Get process architecture.
+    ArchSpec process_arch;
+    if (!m_debugged_process_sp || !m_debugged_process_sp->GetArchitecture (process_arch))
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed to retrieve inferior architecture", __FUNCTION__);
+        return SendErrorResponse (0x49);
+    }
+
+    // Parse out the register data.
+    packet.SetFilePos (strlen("G"));
+    std::vector<uint8_t> reg_data (packet.GetBytesLeft () / 2);
+    const size_t reg_data_size = packet.GetHexBytesAvail (reg_data.data (), reg_data.size ());
+
+    // Get the thread to use.
+    NativeThreadProtocolSP thread_sp = GetThreadFromSuffix (packet);
+    if (!thread_sp)
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed, no thread available", __FUNCTION__);
+        return SendErrorResponse (0x28);
+    }
+
+    // Get the thread's register context.
+    NativeRegisterContextSP reg_context_sp (thread_sp->GetRegisterContext ());
+    if (!reg_context_sp)
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64 " tid %" PRIu64 " failed, no register context available for the thread", __FUNCTION__, m_debugged_process_sp->GetID (), thread_sp->GetID ());
+        return SendErrorResponse (0x15);
+    }
+
+    if (reg_data_size != GetRegisterDataByteSize (*reg_context_sp))
+        return SendIllFormedResponse (packet, "G packet register data size is incorrect");
+
+    const uint32_t reg_count = reg_context_sp->GetUserRegisterCount ();
+    for (uint32_t reg_index = 0; reg_index < reg_count; ++reg_index)
+    {
+        const RegisterInfo *reg_info = reg_context_sp->GetRegisterInfoAtIndex (reg_index);
+        if (!reg_info || reg_info->value_regs || reg_info->kinds[eRegisterKindLLDB] == LLDB_INVALID_REGNUM)
+            continue;
+
+        RegisterValue reg_value (&reg_data[reg_info->byte_offset], reg_info->byte_size, process_arch.GetByteOrder ());
+        Error error = reg_context_sp->WriteRegister (reg_info, reg_value);
+        if (error.Fail ())
+        {
+            if (log)
+                log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed, write of register %" PRIu32 " (%s) failed: %s", __FUNCTION__, reg_index, reg_info->name, error.AsCString ());
+            return SendErrorResponse (0x32);
+        }
+    }
+
+    return SendOKResponse();
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_H (StringExtractorGDBRemote &packet)
 {
@@ -2207,6 +2444,109 @@ GDBRemoteCommunicationServerLLGS::Handle_z (StringExtractorGDBRemote &packet)
     }
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle__Z (StringExtractorGDBRemote &packet)
+{
+    return HandleMultiBreakpointPacket (packet, true);
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle__z (StringExtractorGDBRemote &packet)
+{
+    return HandleMultiBreakpointPacket (packet, false);
+}
+
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::HandleMultiBreakpointPacket (StringExtractorGDBRemote &packet, bool insert)
+{
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_BREAKPOINTS));
+
+    // Ensure we have a process.
+    if (!m_debugged_process_sp || (m_debugged_process_sp->GetID () == LLDB_INVALID_PROCESS_ID))
+    {
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s failed, no process available", __FUNCTION__);
+        return SendErrorResponse (0x15);
+    }
+
+    // Parse out software or hardware breakpoint requested.
+    packet.SetFilePos (strlen("_Z"));
+    bool want_hardware = false;
+    const GDBStoppointType stoppoint_type =
+        GDBStoppointType(packet.GetS32 (eStoppointInvalid));
+    switch (stoppoint_type)
+    {
+        case eBreakpointSoftware:
+            want_hardware = false; break;
+        case eBreakpointHardware:
+            want_hardware = true;  break;
+        default:
+            return SendIllFormedResponse(packet, "_Z/_z packets only support software and hardware breakpoints");
+    }
+
+    // Parse out the ;<addr>,<kind> pairs.
+    std::vector<lldb::addr_t> addrs;
+    std::vector<uint32_t> kinds;
+    while (packet.GetBytesLeft() > 0)
+    {
+        if (packet.GetChar () != ';')
+            return SendIllFormedResponse(packet, "Malformed _Z/_z packet, expecting semicolon before address");
+
+        if (packet.GetBytesLeft() < 1)
+            return SendIllFormedResponse(packet, "Too short _Z/_z packet, missing address");
+        addrs.push_back (packet.GetHexMaxU64(false, 0));
+
+        if ((packet.GetBytesLeft() < 1) || packet.GetChar () != ',')
+            return SendIllFormedResponse(packet, "Malformed _Z/_z packet, expecting comma after address");
+
+        const uint32_t kind = packet.GetHexMaxU32 (false, std::numeric_limits<uint32_t>::max ());
+        if (kind == std::numeric_limits<uint32_t>::max ())
+            return SendIllFormedResponse(packet, "Malformed _Z/_z packet, failed to parse kind argument");
+        kinds.push_back (kind);
+    }
+
+    if (addrs.empty ())
+        return SendIllFormedResponse(packet, "Too short _Z/_z packet, no addresses");
+
+    std::vector<Error> errors;
+    if (insert)
+        m_debugged_process_sp->SetBreakpoints (addrs, kinds, want_hardware, errors);
+    else
+        m_debugged_process_sp->RemoveBreakpoints (addrs, errors);
+
+    bool all_succeeded = true;
+    for (size_t i = 0; i < errors.size (); ++i)
+    {
+        if (errors[i].Success ())
+            continue;
+        all_succeeded = false;
+        if (log)
+            log->Printf ("GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64
+                    " failed to %s breakpoint at 0x%" PRIx64 ": %s",
+                    __FUNCTION__,
+                    m_debugged_process_sp->GetID (),
+                    insert ? "set" : "remove",
+                    addrs[i],
+                    errors[i].AsCString ());
+    }
+
+    if (all_succeeded)
+        return SendOKResponse ();
+
+    // Report the result of each address in order.
+    StreamGDBRemote response;
+    for (size_t i = 0; i < errors.size (); ++i)
+    {
+        if (i > 0)
+            response.PutChar (';');
+        if (errors[i].Success ())
+            response.PutCString ("OK");
+        else
+            response.PutCString ("E09");
+    }
+    return SendPacketNoLock (response.GetData (), response.GetSize ());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle_s (StringExtractorGDBRemote &packet)
 {
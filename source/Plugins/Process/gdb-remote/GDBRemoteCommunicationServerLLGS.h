@@ -17,6 +17,7 @@
 // Other libraries and framework includes
 #include "lldb/lldb-private-forward.h"
 #include "lldb/Core/Communication.h"
+#include "lldb/Host/MainLoop.h"
 #include "lldb/Host/Mutex.h"
 #include "lldb/Host/common/NativeProcessProtocol.h"
 
@@ -39,7 +40,8 @@ public:
     // Constructors and Destructors
     //------------------------------------------------------------------
     GDBRemoteCommunicationServerLLGS(const lldb::PlatformSP& platform_sp,
-                      lldb::DebuggerSP& debugger_sp);
+                      lldb::DebuggerSP& debugger_sp,
+                      MainLoop &mainloop);
 
     virtual
     ~GDBRemoteCommunicationServerLLGS();
@@ -112,8 +114,44 @@ public:
     void
     DidExec (NativeProcessProtocol *process) override;
 
+    //------------------------------------------------------------------
+    /// Take ownership of the client connection and serve its packets
+    /// from the main loop.
+    ///
+    /// @param[in] connection
+    ///     The connected client.
+    ///
+    /// @return
+    ///     An Error object indicating whether the connection could be
+    ///     registered with the main loop.
+    //------------------------------------------------------------------
+    Error
+    InitializeConnection (std::unique_ptr<ConnectionFileDescriptor> &&connection);
+
+    //------------------------------------------------------------------
+    /// Read the register data for a 'g' reply.
+    ///
+    /// The registers are laid out at their qRegisterInfo offsets. The
+    /// reply stops at the first register that can't be read, so the
+    /// client leaves it and everything after it invalid and reads those
+    /// with 'p' instead of taking made up values as real ones.
+    ///
+    /// @param[in] reg_context
+    ///     The register context of the thread to read.
+    ///
+    /// @param[out] reg_data
+    ///     The register data, sized to every user register.
+    ///
+    /// @return
+    ///     The number of bytes of \a reg_data to send.
+    //------------------------------------------------------------------
+    static size_t
+    ReadGPacketRegisterData (NativeRegisterContext &reg_context, std::vector<uint8_t> &reg_data);
+
 protected:
     lldb::PlatformSP m_platform_sp;
+    MainLoop &m_mainloop;
+    MainLoop::ReadHandleUP m_network_handle_up;
     lldb::thread_t m_async_thread;
     lldb::tid_t m_current_tid;
     lldb::tid_t m_continue_tid;
@@ -187,6 +225,12 @@ protected:
     PacketResult
     Handle_P (StringExtractorGDBRemote &packet);
 
+    PacketResult
+    Handle_g (StringExtractorGDBRemote &packet);
+
+    PacketResult
+    Handle_G (StringExtractorGDBRemote &packet);
+
     PacketResult
     Handle_H (StringExtractorGDBRemote &packet);
 
@@ -214,6 +258,15 @@ protected:
     PacketResult
     Handle_z (StringExtractorGDBRemote &packet);
 
+    PacketResult
+    Handle__Z (StringExtractorGDBRemote &packet);
+
+    PacketResult
+    Handle__z (StringExtractorGDBRemote &packet);
+
+    PacketResult
+    HandleMultiBreakpointPacket (StringExtractorGDBRemote &packet, bool insert);
+
     PacketResult
     Handle_s (StringExtractorGDBRemote &packet);
 
@@ -260,6 +313,9 @@ protected:
     FindModuleFile (const std::string& module_path, const ArchSpec& arch) override;
 
 private:
+    void
+    DataAvailableCallback ();
+
     bool
     DebuggedProcessReaped (lldb::pid_t pid);
 
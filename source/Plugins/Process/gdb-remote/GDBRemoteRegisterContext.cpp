@@ -49,7 +49,8 @@ GDBRemoteRegisterContext::GDBRemoteRegisterContext
     m_reg_info (reg_info),
     m_reg_valid (),
     m_reg_data (),
-    m_read_all_at_once (read_all_at_once)
+    m_read_all_at_once (read_all_at_once),
+    m_g_packet_byte_size (0)
 {
     // Resize our vector of bools to contain one bool for every register.
     // We will use these boolean values to know when a register value
@@ -60,6 +61,9 @@ GDBRemoteRegisterContext::GDBRemoteRegisterContext
     DataBufferSP reg_data_sp(new DataBufferHeap (reg_info.GetRegisterDataByteSize(), 0));
     m_reg_data.SetData (reg_data_sp);
     m_reg_data.SetByteOrder(thread.GetProcess()->GetByteOrder());
+
+    // Assume 'g' covers every register until a reply says otherwise
+    m_g_packet_byte_size = m_reg_data.GetByteSize();
 }
 
 //----------------------------------------------------------------------
@@ -162,6 +166,43 @@ GDBRemoteRegisterContext::GetPrimordialRegister(const RegisterInfo *reg_info,
     return false;
 }
 
+void
+GDBRemoteRegisterContext::SetRegisterDataFromGPacket (StringExtractorGDBRemote &response)
+{
+    // Decode into a separate buffer so that a short reply can't clobber the
+    // registers we already have, like the ones expedited in the stop reply.
+    const size_t reg_data_size = m_reg_data.GetByteSize();
+    DataBufferHeap buffer (reg_data_size, 0);
+    const size_t bytes_read = response.GetHexBytes (buffer.GetBytes(), reg_data_size, '\xcc');
+    m_g_packet_byte_size = bytes_read;
+
+    uint8_t *reg_data = const_cast<uint8_t *>(m_reg_data.GetDataStart());
+    if (bytes_read == reg_data_size)
+    {
+        ::memcpy (reg_data, buffer.GetBytes(), reg_data_size);
+        SetAllRegisterValid (true);
+        return;
+    }
+
+    Log *log (ProcessGDBRemoteLog::GetLogIfAnyCategoryIsSet (GDBR_LOG_THREAD | GDBR_LOG_PACKETS));
+    if (log)
+        log->Printf ("GDBRemoteRegisterContext::%s 'g' reply has %" PRIu64 " of %" PRIu64 " bytes of register data, using 'p' for the rest",
+                     __FUNCTION__, (uint64_t)bytes_read, (uint64_t)reg_data_size);
+
+    // Only the registers the reply covers are valid
+    const uint32_t num_regs = m_reg_valid.size();
+    for (uint32_t reg = 0; reg < num_regs; ++reg)
+    {
+        const RegisterInfo *reg_info = m_reg_info.GetRegisterInfoAtIndex (reg);
+        if (reg_info == NULL || GetRegisterIsValid (reg))
+            continue;
+        if (reg_info->byte_offset + reg_info->byte_size > bytes_read)
+            continue;
+        ::memcpy (reg_data + reg_info->byte_offset, buffer.GetBytes() + reg_info->byte_offset, reg_info->byte_size);
+        SetRegisterIsValid (reg, true);
+    }
+}
+
 bool
 GDBRemoteRegisterContext::ReadRegisterBytes (const RegisterInfo *reg_info, DataExtractor &data)
 {
@@ -180,52 +221,66 @@ GDBRemoteRegisterContext::ReadRegisterBytes (const RegisterInfo *reg_info, DataE
 
     if (!GetRegisterIsValid(reg))
     {
-        if (m_read_all_at_once)
+        // Even when 'p' is supported, prefer a single 'g' packet if the stub has
+        // one: anything beyond the expedited registers usually means several
+        // registers are about to be read, each of which would be a round trip.
+        // Registers the stub left out of its last 'g' reply go straight to 'p'.
+        const bool use_g_packet = m_read_all_at_once ||
+                                  (reg_info->byte_offset + reg_info->byte_size <= m_g_packet_byte_size &&
+                                   gdb_comm.GetgPacketSupported (m_thread.GetProtocolID()) &&
+                                   !gdb_comm.AvoidGPackets ((ProcessGDBRemote *)process));
+        if (use_g_packet)
         {
             StringExtractorGDBRemote response;
-            if (!gdb_comm.ReadAllRegisters(m_thread.GetProtocolID(), response))
+            if (gdb_comm.ReadAllRegisters(m_thread.GetProtocolID(), response))
+            {
+                if (response.IsNormalResponse())
+                    SetRegisterDataFromGPacket (response);
+            }
+            else if (m_read_all_at_once)
                 return false;
-            if (response.IsNormalResponse())
-                if (response.GetHexBytes ((void *)m_reg_data.GetDataStart(), m_reg_data.GetByteSize(), '\xcc') == m_reg_data.GetByteSize())
-                    SetAllRegisterValid (true);
         }
-        else if (reg_info->value_regs)
+
+        if (!GetRegisterIsValid(reg) && !m_read_all_at_once)
         {
-            // Process this composite register request by delegating to the constituent
-            // primordial registers.
-            
-            // Index of the primordial register.
-            bool success = true;
-            for (uint32_t idx = 0; success; ++idx)
+            if (reg_info->value_regs)
             {
-                const uint32_t prim_reg = reg_info->value_regs[idx];
-                if (prim_reg == LLDB_INVALID_REGNUM)
-                    break;
-                // We have a valid primordial register as our constituent.
-                // Grab the corresponding register info.
-                const RegisterInfo *prim_reg_info = GetRegisterInfoAtIndex(prim_reg);
-                if (prim_reg_info == NULL)
-                    success = false;
-                else
+                // Process this composite register request by delegating to the constituent
+                // primordial registers.
+            
+                // Index of the primordial register.
+                bool success = true;
+                for (uint32_t idx = 0; success; ++idx)
+                {
+                    const uint32_t prim_reg = reg_info->value_regs[idx];
+                    if (prim_reg == LLDB_INVALID_REGNUM)
+                        break;
+                    // We have a valid primordial register as our constituent.
+                    // Grab the corresponding register info.
+                    const RegisterInfo *prim_reg_info = GetRegisterInfoAtIndex(prim_reg);
+                    if (prim_reg_info == NULL)
+                        success = false;
+                    else
+                    {
+                        // Read the containing register if it hasn't already been read
+                        if (!GetRegisterIsValid(prim_reg))
+                            success = GetPrimordialRegister(prim_reg_info, gdb_comm);
+                    }
+                }
+
+                if (success)
                 {
-                    // Read the containing register if it hasn't already been read
-                    if (!GetRegisterIsValid(prim_reg))
-                        success = GetPrimordialRegister(prim_reg_info, gdb_comm);
+                    // If we reach this point, all primordial register requests have succeeded.
+                    // Validate this composite register.
+                    SetRegisterIsValid (reg_info, true);
                 }
             }
-
-            if (success)
+            else
             {
-                // If we reach this point, all primordial register requests have succeeded.
-                // Validate this composite register.
-                SetRegisterIsValid (reg_info, true);
+                // Get each register individually
+                GetPrimordialRegister(reg_info, gdb_comm);
             }
         }
-        else
-        {
-            // Get each register individually
-            GetPrimordialRegister(reg_info, gdb_comm);
-        }
 
         // Make sure we got a valid register value after reading it
         if (!GetRegisterIsValid(reg))
@@ -576,17 +631,43 @@ GDBRemoteRegisterContext::ReadAllRegisterValues (lldb::DataBufferSP &data_sp)
                 // For the use_g_packet == false case, we're going to read each register 
                 // individually and store them as binary data in a buffer instead of as ascii
                 // characters.
+                if (!gdb_comm.GetpPacketSupported (m_thread.GetProtocolID()))
+                {
+                    data_sp.reset();
+                    return false;
+                }
+
                 const RegisterInfo *reg_info;
 
                 // data_sp will take ownership of this DataBufferHeap pointer soon.
                 DataBufferSP reg_ctx(new DataBufferHeap(m_reg_info.GetRegisterDataByteSize(), 0));
 
+                InvalidateIfNeeded(false);
+
+                // Gather every primordial register we don't have yet and read
+                // them with one pipelined batch of "p" packets.
+                std::vector<uint32_t> reg_nums;
                 for (uint32_t i = 0; (reg_info = GetRegisterInfoAtIndex (i)) != NULL; i++)
                 {
                     if (reg_info->value_regs) // skip registers that are slices of real registers
                         continue;
-                    ReadRegisterBytes (reg_info, m_reg_data);
-                    // ReadRegisterBytes saves the contents of the register in to the m_reg_data buffer
+                    const uint32_t reg = reg_info->kinds[eRegisterKindLLDB];
+                    if (!GetRegisterIsValid(reg))
+                        reg_nums.push_back(reg);
+                }
+
+                std::vector<StringExtractorGDBRemote> responses;
+                if (!reg_nums.empty() && !gdb_comm.ReadRegisters (m_thread.GetProtocolID(), reg_nums, responses))
+                {
+                    data_sp.reset();
+                    return false;
+                }
+                // PrivateSetRegisterValue saves the contents of the register in to the m_reg_data buffer.
+                // Registers the stub refused to read (an "Exx" reply) are left invalid.
+                for (size_t i = 0; i < responses.size(); ++i)
+                {
+                    if (responses[i].IsNormalResponse())
+                        PrivateSetRegisterValue (reg_nums[i], responses[i]);
                 }
                 memcpy (reg_ctx->GetBytes(), m_reg_data.GetDataStart(), m_reg_info.GetRegisterDataByteSize());
 
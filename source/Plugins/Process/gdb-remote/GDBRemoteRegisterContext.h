@@ -26,6 +26,7 @@
 #include "GDBRemoteCommunicationClient.h"
 
 class StringExtractor;
+class StringExtractorGDBRemote;
 
 namespace lldb_private {
 namespace process_gdb_remote {
@@ -118,6 +119,9 @@ protected:
 
     bool
     PrivateSetRegisterValue (uint32_t reg, StringExtractor &response);
+
+    void
+    SetRegisterDataFromGPacket (StringExtractorGDBRemote &response);
     
     void
     SetAllRegisterValid (bool b);
@@ -157,6 +161,7 @@ protected:
     std::vector<bool> m_reg_valid;
     DataExtractor m_reg_data;
     bool m_read_all_at_once;
+    size_t m_g_packet_byte_size;    // How much register data the last 'g' reply had
 
 private:
     // Helper function for ReadRegisterBytes().
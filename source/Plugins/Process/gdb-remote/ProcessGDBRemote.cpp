@@ -279,6 +279,7 @@ ProcessGDBRemote::ProcessGDBRemote(Target& target, Listener &listener) :
     m_continue_C_tids (),
     m_continue_s_tids (),
     m_continue_S_tids (),
+    m_continue_r_tids (),
     m_max_memory_size (0),
     m_remote_stub_max_memory_size (0),
     m_addr_to_mmap_size (),
@@ -1296,6 +1297,7 @@ ProcessGDBRemote::WillResume ()
     m_continue_C_tids.clear();
     m_continue_s_tids.clear();
     m_continue_S_tids.clear();
+    m_continue_r_tids.clear();
     return Error();
 }
 
@@ -1322,7 +1324,8 @@ ProcessGDBRemote::DoResume ()
                 (m_continue_c_tids.empty() &&
                  m_continue_C_tids.empty() &&
                  m_continue_s_tids.empty() &&
-                 m_continue_S_tids.empty()))
+                 m_continue_S_tids.empty() &&
+                 m_continue_r_tids.empty()))
             {
                 // All threads are continuing, just send a "c" packet
                 continue_packet.PutCString ("c");
@@ -1374,6 +1377,17 @@ ProcessGDBRemote::DoResume ()
                     else
                         continue_packet_error = true;
                 }
+
+                if (!continue_packet_error && !m_continue_r_tids.empty())
+                {
+                    if (m_gdb_comm.GetVContSupported ('r'))
+                    {
+                        for (tid_range_collection::const_iterator r_pos = m_continue_r_tids.begin(), r_end = m_continue_r_tids.end(); r_pos != r_end; ++r_pos)
+                            continue_packet.Printf(";r%" PRIx64 ",%" PRIx64 ":%4.4" PRIx64, r_pos->start, r_pos->end, r_pos->tid);
+                    }
+                    else
+                        continue_packet_error = true;
+                }
                 
                 if (continue_packet_error)
                     continue_packet.GetString().clear();
@@ -1387,6 +1401,12 @@ ProcessGDBRemote::DoResume ()
             // Either no vCont support, or we tried to use part of the vCont
             // packet that wasn't supported by the remote GDB server.
             // We need to try and make a simple packet that can do our continue
+
+            // Range steps fall back to single steps, the thread plans check
+            // whether they are still in range after each one.
+            for (tid_range_collection::const_iterator r_pos = m_continue_r_tids.begin(), r_end = m_continue_r_tids.end(); r_pos != r_end; ++r_pos)
+                m_continue_s_tids.push_back (r_pos->tid);
+            m_continue_r_tids.clear();
             const size_t num_continue_c_tids = m_continue_c_tids.size();
             const size_t num_continue_C_tids = m_continue_C_tids.size();
             const size_t num_continue_s_tids = m_continue_s_tids.size();
@@ -2276,12 +2296,74 @@ ProcessGDBRemote::GetImageInfoAddress()
 //------------------------------------------------------------------
 // Process Memory
 //------------------------------------------------------------------
+static int
+MakeReadMemoryPacket (char *packet, size_t packet_size, bool binary_memory_read, addr_t addr, size_t size)
+{
+    int packet_len;
+    if (binary_memory_read)
+    {
+        packet_len = ::snprintf (packet, packet_size, "x0x%" PRIx64 ",0x%" PRIx64, (uint64_t)addr, (uint64_t)size);
+    }
+    else
+    {
+        packet_len = ::snprintf (packet, packet_size, "m%" PRIx64 ",%" PRIx64, (uint64_t)addr, (uint64_t)size);
+    }
+    assert (packet_len + 1 < (int)packet_size);
+    return packet_len;
+}
+
+static size_t
+DecodeReadMemoryResponse (StringExtractorGDBRemote &response,
+                          bool binary_memory_read,
+                          const char *packet,
+                          addr_t addr,
+                          void *buf,
+                          size_t size,
+                          Error &error)
+{
+    if (response.IsNormalResponse())
+    {
+        error.Clear();
+        if (binary_memory_read)
+        {
+            // The lower level GDBRemoteCommunication packet receive layer has already de-quoted any
+            // 0x7d character escaping that was present in the packet
+
+            size_t data_received_size = response.GetBytesLeft();
+            if (data_received_size > size)
+            {
+                // Don't write past the end of BUF if the remote debug server gave us too
+                // much data for some reason.
+                data_received_size = size;
+            }
+            memcpy (buf, response.GetStringRef().data(), data_received_size);
+            return data_received_size;
+        }
+        else
+        {
+            return response.GetHexBytes(buf, size, '\xdd');
+        }
+    }
+    else if (response.IsErrorResponse())
+        error.SetErrorStringWithFormat("memory read failed for 0x%" PRIx64, addr);
+    else if (response.IsUnsupportedResponse())
+        error.SetErrorStringWithFormat("GDB server does not support reading memory");
+    else
+        error.SetErrorStringWithFormat("unexpected response to GDB server memory read packet '%s': '%s'", packet, response.GetStringRef().c_str());
+    return 0;
+}
+
 size_t
 ProcessGDBRemote::DoReadMemory (addr_t addr, void *buf, size_t size, Error &error)
 {
     GetMaxMemorySize ();
     if (size > m_max_memory_size)
     {
+        // Without acks we can have all of the chunks of a large read in
+        // flight at once instead of paying a round trip for each one.
+        if (!m_gdb_comm.GetSendAcks())
+            return DoReadMemoryPipelined (addr, buf, size, error);
+
         // Keep memory read sizes down to a sane limit. This function will be
         // called multiple times in order to complete the task by 
         // lldb_private::Process so it is ok to do this.
@@ -2289,55 +2371,66 @@ ProcessGDBRemote::DoReadMemory (addr_t addr, void *buf, size_t size, Error &erro
     }
 
     char packet[64];
-    int packet_len;
-    bool binary_memory_read = m_gdb_comm.GetxPacketSupported();
-    if (binary_memory_read)
+    const bool binary_memory_read = m_gdb_comm.GetxPacketSupported();
+    const int packet_len = MakeReadMemoryPacket (packet, sizeof(packet), binary_memory_read, addr, size);
+    StringExtractorGDBRemote response;
+    if (m_gdb_comm.SendPacketAndWaitForResponse(packet, packet_len, response, true) == GDBRemoteCommunication::PacketResult::Success)
     {
-        packet_len = ::snprintf (packet, sizeof(packet), "x0x%" PRIx64 ",0x%" PRIx64, (uint64_t)addr, (uint64_t)size);
+        return DecodeReadMemoryResponse (response, binary_memory_read, packet, addr, buf, size, error);
     }
     else
     {
-        packet_len = ::snprintf (packet, sizeof(packet), "m%" PRIx64 ",%" PRIx64, (uint64_t)addr, (uint64_t)size);
+        error.SetErrorStringWithFormat("failed to send packet: '%s'", packet);
     }
-    assert (packet_len + 1 < (int)sizeof(packet));
-    StringExtractorGDBRemote response;
-    if (m_gdb_comm.SendPacketAndWaitForResponse(packet, packet_len, response, true) == GDBRemoteCommunication::PacketResult::Success)
+    return 0;
+}
+
+size_t
+ProcessGDBRemote::DoReadMemoryPipelined (addr_t addr, void *buf, size_t size, Error &error)
+{
+    const bool binary_memory_read = m_gdb_comm.GetxPacketSupported();
+    std::vector<std::string> payloads;
+    for (size_t offset = 0; offset < size; offset += m_max_memory_size)
     {
-        if (response.IsNormalResponse())
-        {
-            error.Clear();
-            if (binary_memory_read)
-            {
-                // The lower level GDBRemoteCommunication packet receive layer has already de-quoted any
-                // 0x7d character escaping that was present in the packet
+        char packet[64];
+        const size_t chunk_size = std::min<size_t> (size - offset, m_max_memory_size);
+        const int packet_len = MakeReadMemoryPacket (packet, sizeof(packet), binary_memory_read, addr + offset, chunk_size);
+        payloads.push_back (std::string (packet, packet_len));
+    }
 
-                size_t data_received_size = response.GetBytesLeft();
-                if (data_received_size > size)
-                {
-                    // Don't write past the end of BUF if the remote debug server gave us too
-                    // much data for some reason.
-                    data_received_size = size;
-                }
-                memcpy (buf, response.GetStringRef().data(), data_received_size);
-                return data_received_size;
-            }
-            else
-            {
-                return response.GetHexBytes(buf, size, '\xdd');
-            }
-        }
-        else if (response.IsErrorResponse())
-            error.SetErrorStringWithFormat("memory read failed for 0x%" PRIx64, addr);
-        else if (response.IsUnsupportedResponse())
-            error.SetErrorStringWithFormat("GDB server does not support reading memory");
-        else
-            error.SetErrorStringWithFormat("unexpected response to GDB server memory read packet '%s': '%s'", packet, response.GetStringRef().c_str());
+    std::vector<StringExtractorGDBRemote> responses;
+    m_gdb_comm.SendPacketsAndWaitForResponses (payloads, responses, true);
+    if (responses.empty())
+    {
+        error.SetErrorStringWithFormat("failed to send packet: '%s'", payloads.front().c_str());
+        return 0;
     }
-    else
+
+    // Stop at the first short or failed chunk; the bytes before it are
+    // still valid.
+    size_t bytes_read = 0;
+    for (size_t i = 0; i < responses.size(); ++i)
     {
-        error.SetErrorStringWithFormat("failed to send packet: '%s'", packet);
+        const size_t chunk_size = std::min<size_t> (size - bytes_read, m_max_memory_size);
+        Error chunk_error;
+        const size_t chunk_read = DecodeReadMemoryResponse (responses[i],
+                                                            binary_memory_read,
+                                                            payloads[i].c_str(),
+                                                            addr + bytes_read,
+                                                            (uint8_t *)buf + bytes_read,
+                                                            chunk_size,
+                                                            chunk_error);
+        bytes_read += chunk_read;
+        if (chunk_read < chunk_size)
+        {
+            // Only report an error if we didn't get anything at all
+            if (bytes_read == 0)
+                error = chunk_error;
+            return bytes_read;
+        }
     }
-    return 0;
+    error.Clear();
+    return bytes_read;
 }
 
 size_t
@@ -2660,6 +2753,105 @@ ProcessGDBRemote::DisableBreakpointSite (BreakpointSite *bp_site)
     return error;
 }
 
+void
+ProcessGDBRemote::EnableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors)
+{
+    errors.clear();
+    errors.resize (bp_sites.size());
+
+    // Send all the plain software breakpoints in "_Z0" packets, anything
+    // else, and anything the stub refused, goes through EnableBreakpointSite.
+    std::vector<size_t> indexes;
+    std::vector<addr_t> addrs;
+    std::vector<uint32_t> lengths;
+    if (bp_sites.size() > 1 && m_gdb_comm.SupportsGDBStoppointPacket(eBreakpointSoftware))
+    {
+        for (size_t i = 0; i < bp_sites.size(); ++i)
+        {
+            BreakpointSite *bp_site = bp_sites[i];
+            if (bp_site->IsEnabled() || bp_site->HardwareRequired())
+                continue;
+            indexes.push_back (i);
+            addrs.push_back (bp_site->GetLoadAddress());
+            lengths.push_back (GetSoftwareBreakpointTrapOpcode (bp_site));
+        }
+    }
+
+    std::vector<uint8_t> results;
+    if (indexes.size() > 1)
+        m_gdb_comm.SendMultiBreakpointPacket (eBreakpointSoftware, true, addrs, lengths, results);
+
+    std::vector<bool> handled (bp_sites.size(), false);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i] != 0)
+            continue;
+        BreakpointSite *bp_site = bp_sites[indexes[i]];
+        bp_site->SetEnabled(true);
+        bp_site->SetType(BreakpointSite::eExternal);
+        handled[indexes[i]] = true;
+    }
+
+    Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf("ProcessGDBRemote::%s enabled %" PRIu64 " of %" PRIu64 " breakpoint sites with _Z0",
+                    __FUNCTION__, (uint64_t)std::count (handled.begin(), handled.end(), true), (uint64_t)bp_sites.size());
+
+    for (size_t i = 0; i < bp_sites.size(); ++i)
+    {
+        if (!handled[i])
+            errors[i] = EnableBreakpointSite (bp_sites[i]);
+    }
+}
+
+void
+ProcessGDBRemote::DisableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors)
+{
+    errors.clear();
+    errors.resize (bp_sites.size());
+
+    // Only the sites we set with "Z0" can be removed with "_z0".
+    std::vector<size_t> indexes;
+    std::vector<addr_t> addrs;
+    std::vector<uint32_t> lengths;
+    if (bp_sites.size() > 1)
+    {
+        for (size_t i = 0; i < bp_sites.size(); ++i)
+        {
+            BreakpointSite *bp_site = bp_sites[i];
+            if (!bp_site->IsEnabled() || bp_site->GetType() != BreakpointSite::eExternal || bp_site->IsHardware())
+                continue;
+            indexes.push_back (i);
+            addrs.push_back (bp_site->GetLoadAddress());
+            lengths.push_back (GetSoftwareBreakpointTrapOpcode (bp_site));
+        }
+    }
+
+    std::vector<uint8_t> results;
+    if (indexes.size() > 1)
+        m_gdb_comm.SendMultiBreakpointPacket (eBreakpointSoftware, false, addrs, lengths, results);
+
+    std::vector<bool> handled (bp_sites.size(), false);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i] != 0)
+            continue;
+        bp_sites[indexes[i]]->SetEnabled(false);
+        handled[indexes[i]] = true;
+    }
+
+    Log *log(ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_BREAKPOINTS));
+    if (log)
+        log->Printf("ProcessGDBRemote::%s disabled %" PRIu64 " of %" PRIu64 " breakpoint sites with _z0",
+                    __FUNCTION__, (uint64_t)std::count (handled.begin(), handled.end(), true), (uint64_t)bp_sites.size());
+
+    for (size_t i = 0; i < bp_sites.size(); ++i)
+    {
+        if (!handled[i])
+            errors[i] = DisableBreakpointSite (bp_sites[i]);
+    }
+}
+
 // Pre-requisite: wp != NULL.
 static GDBStoppointType
 GetGDBStoppointType (Watchpoint *wp)
@@ -3288,6 +3480,24 @@ ProcessGDBRemote::GetAuxvData()
     return buf;
 }
 
+StructuredData::ObjectSP
+ProcessGDBRemote::GetPacketStatistics ()
+{
+    return m_gdb_comm.GetPacketStatistics();
+}
+
+void
+ProcessGDBRemote::ResetPacketStatistics ()
+{
+    m_gdb_comm.ResetPacketStatistics();
+}
+
+bool
+ProcessGDBRemote::SupportsRangeStepping ()
+{
+    return m_gdb_comm.GetVContSupported ('r');
+}
+
 StructuredData::ObjectSP
 ProcessGDBRemote::GetExtendedInfoForThread (lldb::tid_t tid)
 {
@@ -3465,6 +3675,54 @@ public:
     }
 };
 
+class CommandObjectProcessGDBRemotePacketStats : public CommandObjectParsed
+{
+private:
+    
+public:
+    CommandObjectProcessGDBRemotePacketStats(CommandInterpreter &interpreter) :
+    CommandObjectParsed (interpreter,
+                         "process plugin packet stats",
+                         "Dumps the count, size and latency of the packets sent to the remote server, grouped by packet type. "
+                         "Pass 'reset' to clear the statistics, e.g. before the operation to be measured.",
+                         "process plugin packet stats [reset]")
+    {
+    }
+    
+    ~CommandObjectProcessGDBRemotePacketStats ()
+    {
+    }
+    
+    bool
+    DoExecute (Args& command, CommandReturnObject &result) override
+    {
+        const size_t argc = command.GetArgumentCount();
+        ProcessGDBRemote *process = (ProcessGDBRemote *)m_interpreter.GetExecutionContext().GetProcessPtr();
+        if (process == NULL)
+        {
+            result.AppendError ("no process");
+        }
+        else if (argc == 0)
+        {
+            process->GetGDBRemote().DumpPacketStatistics(result.GetOutputStream());
+            result.SetStatus (eReturnStatusSuccessFinishResult);
+            return true;
+        }
+        else if (argc == 1 && ::strcmp (command.GetArgumentAtIndex(0), "reset") == 0)
+        {
+            process->GetGDBRemote().ResetPacketStatistics();
+            result.SetStatus (eReturnStatusSuccessFinishNoResult);
+            return true;
+        }
+        else
+        {
+            result.AppendErrorWithFormat ("'%s' takes no arguments, or 'reset'", m_cmd_name.c_str());
+        }
+        result.SetStatus (eReturnStatusFailed);
+        return false;
+    }
+};
+
 class CommandObjectProcessGDBRemotePacketXferSize : public CommandObjectParsed
 {
 private:
@@ -3635,6 +3893,7 @@ public:
                                 NULL)
     {
         LoadSubCommand ("history", CommandObjectSP (new CommandObjectProcessGDBRemotePacketHistory (interpreter)));
+        LoadSubCommand ("stats", CommandObjectSP (new CommandObjectProcessGDBRemotePacketStats (interpreter)));
         LoadSubCommand ("send", CommandObjectSP (new CommandObjectProcessGDBRemotePacketSend (interpreter)));
         LoadSubCommand ("monitor", CommandObjectSP (new CommandObjectProcessGDBRemotePacketMonitor (interpreter)));
         LoadSubCommand ("xfer-size", CommandObjectSP (new CommandObjectProcessGDBRemotePacketXferSize (interpreter)));
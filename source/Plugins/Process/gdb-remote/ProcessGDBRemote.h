@@ -197,6 +197,12 @@ public:
     Error
     DisableBreakpointSite (BreakpointSite *bp_site) override;
 
+    void
+    EnableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors) override;
+
+    void
+    DisableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors) override;
+
     //----------------------------------------------------------------------
     // Process Watchpoints
     //----------------------------------------------------------------------
@@ -241,6 +247,15 @@ public:
                   const ArchSpec& arch,
                   ModuleSpec &module_spec) override;
 
+    StructuredData::ObjectSP
+    GetPacketStatistics () override;
+
+    void
+    ResetPacketStatistics () override;
+
+    bool
+    SupportsRangeStepping () override;
+
 protected:
     friend class ThreadGDBRemote;
     friend class GDBRemoteCommunicationClient;
@@ -318,6 +333,9 @@ protected:
     void
     GetMaxMemorySize();
 
+    size_t
+    DoReadMemoryPipelined (lldb::addr_t addr, void *buf, size_t size, Error &error);
+
     //------------------------------------------------------------------
     /// Broadcaster event bits definitions.
     //------------------------------------------------------------------
@@ -339,12 +357,20 @@ protected:
     Mutex m_async_thread_state_mutex;
     typedef std::vector<lldb::tid_t> tid_collection;
     typedef std::vector< std::pair<lldb::tid_t,int> > tid_sig_collection;
+    struct TIDStepRange
+    {
+        lldb::tid_t tid;
+        lldb::addr_t start;
+        lldb::addr_t end;
+    };
+    typedef std::vector<TIDStepRange> tid_range_collection;
     typedef std::map<lldb::addr_t, lldb::addr_t> MMapMap;
     tid_collection m_thread_ids; // Thread IDs for all threads. This list gets updated after stopping
     tid_collection m_continue_c_tids;                  // 'c' for continue
     tid_sig_collection m_continue_C_tids; // 'C' for continue with signal
     tid_collection m_continue_s_tids;                  // 's' for step
     tid_sig_collection m_continue_S_tids; // 'S' for step with signal
+    tid_range_collection m_continue_r_tids; // 'r' for stepping through an address range
     uint64_t m_max_memory_size;       // The maximum number of bytes to read/write when reading and writing memory
     uint64_t m_remote_stub_max_memory_size;    // The maximum memory size the remote gdb stub can handle
     MMapMap m_addr_to_mmap_size;
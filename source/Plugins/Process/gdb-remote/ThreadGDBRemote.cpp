@@ -21,6 +21,7 @@
 #include "lldb/Target/StopInfo.h"
 #include "lldb/Target/SystemRuntime.h"
 #include "lldb/Target/Target.h"
+#include "lldb/Target/ThreadPlan.h"
 #include "lldb/Target/UnixSignals.h"
 #include "lldb/Target/Unwind.h"
 
@@ -192,7 +193,18 @@ ThreadGDBRemote::WillResume (StateType resume_state)
             if (gdb_process->GetUnixSignals().SignalIsValid (signo))
                 gdb_process->m_continue_S_tids.push_back(std::make_pair(tid, signo));
             else
-                gdb_process->m_continue_s_tids.push_back(tid);
+            {
+                // If the current plan is stepping through an address range,
+                // let the remote stub do all of the stepping.
+                ProcessGDBRemote::TIDStepRange step_range = { tid, LLDB_INVALID_ADDRESS, LLDB_INVALID_ADDRESS };
+                ThreadPlan *current_plan = GetCurrentPlan();
+                if (current_plan &&
+                    current_plan->GetStepRange (step_range.start, step_range.end) &&
+                    gdb_process->SupportsRangeStepping())
+                    gdb_process->m_continue_r_tids.push_back(step_range);
+                else
+                    gdb_process->m_continue_s_tids.push_back(tid);
+            }
             break;
 
         default:
@@ -11,6 +11,7 @@
 
 #include "lldb/Core/dwarf.h"
 
+#include "DWARFCompileUnit.h"
 #include "DWARFFormValue.h"
 
 using namespace lldb_private;
@@ -19,6 +20,11 @@ DWARFAbbreviationDeclaration::DWARFAbbreviationDeclaration() :
     m_code  (InvalidCode),
     m_tag   (0),
     m_has_children (0),
+    m_has_variable_size_forms (false),
+    m_num_addr_forms (0),
+    m_num_ref_addr_forms (0),
+    m_num_offset_forms (0),
+    m_fixed_forms_byte_size (0),
     m_attributes()
 {
 }
@@ -27,6 +33,11 @@ DWARFAbbreviationDeclaration::DWARFAbbreviationDeclaration(dw_tag_t tag, uint8_t
     m_code  (InvalidCode),
     m_tag   (tag),
     m_has_children (has_children),
+    m_has_variable_size_forms (false),
+    m_num_addr_forms (0),
+    m_num_ref_addr_forms (0),
+    m_num_offset_forms (0),
+    m_fixed_forms_byte_size (0),
     m_attributes()
 {
 }
@@ -42,6 +53,7 @@ DWARFAbbreviationDeclaration::Extract(const DWARFDataExtractor& data, lldb::offs
 {
     m_code = code;
     m_attributes.clear();
+    ClearFormSizes();
     if (m_code)
     {
         m_tag = data.GetULEB128(offset_ptr);
@@ -53,7 +65,7 @@ DWARFAbbreviationDeclaration::Extract(const DWARFDataExtractor& data, lldb::offs
             dw_form_t form = data.GetULEB128(offset_ptr);
 
             if (attr && form)
-                m_attributes.push_back(DWARFAttribute(attr, form));
+                AddAttribute(DWARFAttribute(attr, form));
             else
                 break;
         }
@@ -70,6 +82,56 @@ DWARFAbbreviationDeclaration::Extract(const DWARFDataExtractor& data, lldb::offs
 }
 
 
+void
+DWARFAbbreviationDeclaration::ClearFormSizes()
+{
+    m_has_variable_size_forms = false;
+    m_num_addr_forms = 0;
+    m_num_ref_addr_forms = 0;
+    m_num_offset_forms = 0;
+    m_fixed_forms_byte_size = 0;
+}
+
+void
+DWARFAbbreviationDeclaration::AccumulateFormSize(dw_form_t form)
+{
+    switch (form)
+    {
+    case DW_FORM_addr:          ++m_num_addr_forms; break;
+    case DW_FORM_ref_addr:      ++m_num_ref_addr_forms; break;
+    case DW_FORM_strp:
+    case DW_FORM_sec_offset:    ++m_num_offset_forms; break;
+    case DW_FORM_flag_present:  break;
+    case DW_FORM_data1:
+    case DW_FORM_flag:
+    case DW_FORM_ref1:          m_fixed_forms_byte_size += 1; break;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:          m_fixed_forms_byte_size += 2; break;
+    case DW_FORM_data4:
+    case DW_FORM_ref4:          m_fixed_forms_byte_size += 4; break;
+    case DW_FORM_data8:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_sig8:      m_fixed_forms_byte_size += 8; break;
+    default:                    m_has_variable_size_forms = true; break;
+    }
+}
+
+bool
+DWARFAbbreviationDeclaration::GetFixedAttributesByteSize(const DWARFCompileUnit *cu, uint32_t &byte_size) const
+{
+    if (m_has_variable_size_forms)
+        return false;
+
+    const uint32_t addr_size = cu->GetAddressByteSize();
+    const uint32_t offset_size = cu->IsDWARF64() ? 8 : 4;
+    const uint32_t ref_addr_size = cu->GetVersion() <= 2 ? addr_size : offset_size;
+    byte_size = m_fixed_forms_byte_size +
+                m_num_addr_forms * addr_size +
+                m_num_ref_addr_forms * ref_addr_size +
+                m_num_offset_forms * offset_size;
+    return true;
+}
+
 void
 DWARFAbbreviationDeclaration::Dump(Stream *s)  const
 {
@@ -26,6 +26,7 @@ public:
     void            AddAttribute(const DWARFAttribute& attr)
                     {
                         m_attributes.push_back(attr);
+                        AccumulateFormSize(attr.get_form());
                     }
 
     dw_uleb128_t    Code() const { return m_code; }
@@ -56,6 +57,11 @@ public:
                         return m_attributes[idx].get_form();
                     }
     uint32_t        FindAttributeIndex(dw_attr_t attr) const;
+                    // If none of the attribute forms have a size that depends
+                    // on the data (blocks, strings, LEB128, indirect), return
+                    // true and the number of .debug_info bytes the attributes
+                    // of a DIE in "cu" use, so they can be skipped in one step.
+    bool            GetFixedAttributesByteSize(const DWARFCompileUnit *cu, uint32_t &byte_size) const;
     bool            Extract(const lldb_private::DWARFDataExtractor& data, lldb::offset_t *offset_ptr);
     bool            Extract(const lldb_private::DWARFDataExtractor& data, lldb::offset_t *offset_ptr, dw_uleb128_t code);
     bool            IsValid();
@@ -63,9 +69,17 @@ public:
     bool            operator == (const DWARFAbbreviationDeclaration& rhs) const;
     const DWARFAttribute::collection& Attributes() const { return m_attributes; }
 protected:
+    void            ClearFormSizes();
+    void            AccumulateFormSize(dw_form_t form);
+
     dw_uleb128_t        m_code;
     dw_tag_t            m_tag;
     uint8_t             m_has_children;
+    bool                m_has_variable_size_forms;  // True if any attribute form isn't fixed size
+    uint16_t            m_num_addr_forms;           // Number of DW_FORM_addr attributes
+    uint16_t            m_num_ref_addr_forms;       // Number of DW_FORM_ref_addr attributes
+    uint16_t            m_num_offset_forms;         // Number of DW_FORM_strp and DW_FORM_sec_offset attributes
+    uint32_t            m_fixed_forms_byte_size;    // Total size of the remaining fixed size attributes
     DWARFAttribute::collection m_attributes;
 };
 
@@ -52,7 +52,8 @@ DWARFCompileUnit::DWARFCompileUnit(SymbolFileDWARF* dwarf2Data) :
     m_producer_version_minor (0),
     m_producer_version_update (0),
     m_language_type (eLanguageTypeUnknown),
-    m_is_dwarf64    (false)
+    m_is_dwarf64    (false),
+    m_last_die_access (0)
 {
 }
 
@@ -114,6 +115,8 @@ DWARFCompileUnit::ClearDIEs(bool keep_compile_unit_die)
 {
     if (m_die_array.size() > 1)
     {
+        const size_t initial_byte_size = GetDIEArrayByteSize();
+
         // std::vectors never get any smaller when resized to a smaller size,
         // or when clear() or erase() are called, the size will report that it
         // is smaller, but the memory allocated remains intact (call capacity()
@@ -127,9 +130,22 @@ DWARFCompileUnit::ClearDIEs(bool keep_compile_unit_die)
         m_die_array.swap(tmp_array);
         if (keep_compile_unit_die)
             m_die_array.push_back(tmp_array.front());
+
+        m_dwarf2Data->DIEArrayByteSizeChanged (initial_byte_size, GetDIEArrayByteSize());
     }
 }
 
+bool
+DWARFCompileUnit::ContainsAnyDIEPtr (const std::vector<const DWARFDebugInfoEntry *> &sorted_dies) const
+{
+    if (m_die_array.empty() || sorted_dies.empty())
+        return false;
+    const DWARFDebugInfoEntry *first_die = &m_die_array.front();
+    const DWARFDebugInfoEntry *last_die = &m_die_array.back();
+    std::vector<const DWARFDebugInfoEntry *>::const_iterator pos = std::lower_bound (sorted_dies.begin(), sorted_dies.end(), first_die);
+    return pos != sorted_dies.end() && *pos <= last_die;
+}
+
 //----------------------------------------------------------------------
 // ParseCompileUnitDIEsIfNeeded
 //
@@ -139,10 +155,15 @@ DWARFCompileUnit::ClearDIEs(bool keep_compile_unit_die)
 size_t
 DWARFCompileUnit::ExtractDIEsIfNeeded (bool cu_die_only)
 {
+    if (!cu_die_only)
+        m_last_die_access = m_dwarf2Data->GetNextDIEAccess();
+
     const size_t initial_die_array_size = m_die_array.size();
     if ((cu_die_only && initial_die_array_size > 0) || initial_die_array_size > 1)
         return 0; // Already parsed
 
+    const size_t initial_byte_size = GetDIEArrayByteSize();
+
     Timer scoped_timer (__PRETTY_FUNCTION__,
                         "%8.8x: DWARFCompileUnit::ExtractDIEsIfNeeded( cu_die_only = %i )",
                         m_offset,
@@ -195,7 +216,10 @@ DWARFCompileUnit::ExtractDIEsIfNeeded (bool cu_die_only)
             if (initial_die_array_size == 0)
                 AddDIE (die);
             if (cu_die_only)
+            {
+                m_dwarf2Data->DIEArrayByteSizeChanged (initial_byte_size, GetDIEArrayByteSize());
                 return 1;
+            }
         }
         else
         {
@@ -271,6 +295,8 @@ DWARFCompileUnit::ExtractDIEsIfNeeded (bool cu_die_only)
         DWARFDebugInfoEntry::collection exact_size_die_array (m_die_array.begin(), m_die_array.end());
         exact_size_die_array.swap (m_die_array);
     }
+    m_dwarf2Data->DIEArrayByteSizeChanged (initial_byte_size, GetDIEArrayByteSize());
+
     Log *verbose_log (LogChannelDWARF::GetLogIfAll (DWARF_LOG_DEBUG_INFO | DWARF_LOG_VERBOSE));
     if (verbose_log)
     {
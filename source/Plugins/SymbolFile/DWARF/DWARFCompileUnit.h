@@ -104,6 +104,24 @@ public:
         return m_die_array.size() > 1;
     }
 
+    // Number of heap bytes used by the extracted DIE array
+    size_t
+    GetDIEArrayByteSize () const
+    {
+        return m_die_array.capacity() * sizeof(DWARFDebugInfoEntry);
+    }
+
+    // Value of the owning SymbolFileDWARF's access counter the last time
+    // our DIEs were looked up, used to evict least recently used DIEs
+    uint32_t
+    GetLastDIEAccess () const
+    {
+        return m_last_die_access;
+    }
+
+    bool
+    ContainsAnyDIEPtr (const std::vector<const DWARFDebugInfoEntry *> &sorted_dies) const;
+
     DWARFDebugInfoEntry*
     GetDIEAtIndexUnchecked (uint32_t idx)
     {
@@ -210,6 +228,7 @@ protected:
     uint32_t            m_producer_version_update;
     lldb::LanguageType  m_language_type;
     bool                m_is_dwarf64;
+    uint32_t            m_last_die_access;
     
     void
     ParseProducerInfo ();
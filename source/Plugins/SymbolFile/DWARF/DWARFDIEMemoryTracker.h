@@ -0,0 +1,44 @@
+//===-- DWARFDIEMemoryTracker.h ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SymbolFileDWARF_DWARFDIEMemoryTracker_h_
+#define SymbolFileDWARF_DWARFDIEMemoryTracker_h_
+
+#include <stdint.h>
+
+#include <atomic>
+
+//----------------------------------------------------------------------
+// Accounting for the memory used by extracted DIEs.
+//
+// A SymbolFileDWARF owns one of these, unless it is one of the object
+// files of a debug map: those all share the debug map's tracker, so DIEs
+// are evicted by a single owner that sees the DIE references of every
+// object file.
+//----------------------------------------------------------------------
+struct DWARFDIEMemoryTracker
+{
+    DWARFDIEMemoryTracker () :
+        byte_size (0),
+        access_counter (0),
+        scope_depth (0),
+        next_eviction_byte_size (0)
+    {
+    }
+
+    // Updated by DWARFCompileUnit, which may run outside of a DIEMemoryScope
+    std::atomic<uint64_t> byte_size;        // Bytes used by the DIE arrays of all compile units
+    std::atomic<uint32_t> access_counter;   // Bumped whenever a compile unit's DIEs are looked up
+
+    // Only used with the owner's module mutex locked
+    uint32_t scope_depth;                   // Number of active DIEMemoryScope objects
+    uint64_t next_eviction_byte_size;       // Don't look for DIEs to evict until byte_size exceeds this
+};
+
+#endif  // SymbolFileDWARF_DWARFDIEMemoryTracker_h_
@@ -150,6 +150,17 @@ DWARFDebugInfoEntry::FastExtract
         }
         m_tag = abbrevDecl->Tag();
         m_has_children = abbrevDecl->HasChildren();
+
+        // We only keep the skeleton of the DIE tree (offset, tag and
+        // parent/sibling links) and decode attributes on demand, so when
+        // every attribute has a fixed size we can skip them all at once.
+        uint32_t fixed_attributes_byte_size;
+        if (abbrevDecl->GetFixedAttributesByteSize (cu, fixed_attributes_byte_size))
+        {
+            *offset_ptr = offset + fixed_attributes_byte_size;
+            return true;
+        }
+
         // Skip all data in the .debug_info for the attributes
         const uint32_t numAttributes = abbrevDecl->NumAttributes();
         uint32_t i;
@@ -239,10 +250,7 @@ DWARFDebugInfoEntry::FastExtract
 
                     case DW_FORM_strp        :
                     case DW_FORM_sec_offset  :
-                        if (cu->IsDWARF64 ())
-                            debug_info_data.GetU64 (offset_ptr);
-                        else
-                            debug_info_data.GetU32 (offset_ptr);
+                        form_size = cu->IsDWARF64 () ? 8 : 4;
                         break;
 
                     default:
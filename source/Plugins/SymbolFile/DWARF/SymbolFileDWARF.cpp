@@ -26,6 +26,7 @@
 
 #include "llvm/Support/Casting.h"
 
+#include "lldb/Core/Debugger.h"
 #include "lldb/Core/Module.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/RegularExpression.h"
@@ -38,6 +39,9 @@
 
 #include "lldb/Host/Host.h"
 
+#include "lldb/Interpreter/OptionValueProperties.h"
+#include "lldb/Interpreter/Property.h"
+
 #include "lldb/Symbol/Block.h"
 #include "lldb/Symbol/ClangExternalASTSourceCallbacks.h"
 #include "lldb/Symbol/CompileUnit.h"
@@ -64,6 +68,7 @@
 #include "LogChannelDWARF.h"
 #include "SymbolFileDWARFDebugMap.h"
 
+#include <algorithm>
 #include <map>
 
 #include <ctype.h>
@@ -83,6 +88,63 @@
 using namespace lldb;
 using namespace lldb_private;
 
+namespace {
+
+    PropertyDefinition
+    g_properties[] =
+    {
+        { "die-memory-limit", OptionValue::eTypeUInt64, true, 0, NULL, NULL, "The maximum number of bytes of parsed DWARF debug information entries to keep for each symbol file. When the limit is exceeded, compile units whose DIEs don't back any parsed type are cleared, least recently used first, and will be parsed again when needed. Zero means no limit." },
+        {  NULL            , OptionValue::eTypeInvalid, false, 0, NULL, NULL, NULL  }
+    };
+
+    enum
+    {
+        ePropertyDIEMemoryLimit
+    };
+
+    class PluginProperties : public Properties
+    {
+    public:
+
+        static ConstString
+        GetSettingName ()
+        {
+            return SymbolFileDWARF::GetPluginNameStatic();
+        }
+
+        PluginProperties() :
+        Properties ()
+        {
+            m_collection_sp.reset (new OptionValueProperties(GetSettingName()));
+            m_collection_sp->Initialize(g_properties);
+        }
+
+        virtual
+        ~PluginProperties()
+        {
+        }
+
+        uint64_t
+        GetDIEMemoryLimit()
+        {
+            const uint32_t idx = ePropertyDIEMemoryLimit;
+            return m_collection_sp->GetPropertyAtIndexAsUInt64(NULL, idx, g_properties[idx].default_uint_value);
+        }
+    };
+
+    typedef std::shared_ptr<PluginProperties> SymbolFileDWARFPropertiesSP;
+
+    static const SymbolFileDWARFPropertiesSP &
+    GetGlobalPluginProperties()
+    {
+        static SymbolFileDWARFPropertiesSP g_settings_sp;
+        if (!g_settings_sp)
+            g_settings_sp.reset (new PluginProperties ());
+        return g_settings_sp;
+    }
+
+} // anonymous namespace end
+
 //static inline bool
 //child_requires_parent_class_union_or_struct_to_be_completed (dw_tag_t tag)
 //{
@@ -227,7 +289,21 @@ SymbolFileDWARF::Initialize()
     LogChannelDWARF::Initialize();
     PluginManager::RegisterPlugin (GetPluginNameStatic(),
                                    GetPluginDescriptionStatic(),
-                                   CreateInstance);
+                                   CreateInstance,
+                                   DebuggerInitialize);
+}
+
+void
+SymbolFileDWARF::DebuggerInitialize (Debugger &debugger)
+{
+    if (!PluginManager::GetSettingForSymbolFilePlugin(debugger, PluginProperties::GetSettingName()))
+    {
+        const bool is_global_setting = true;
+        PluginManager::CreateSettingForSymbolFilePlugin (debugger,
+                                                         GetGlobalPluginProperties()->GetValueProperties(),
+                                                         ConstString ("Properties for the dwarf symbol-file plug-in."),
+                                                         is_global_setting);
+    }
 }
 
 void
@@ -336,6 +412,7 @@ SymbolFileDWARF::GetTypes (SymbolContextScope *sc_scope,
                            TypeList &type_list)
 
 {
+    DIEMemoryScope die_memory_scope (this);
     TypeSet type_set;
     
     CompileUnit *comp_unit = NULL;
@@ -517,6 +594,7 @@ SymbolFileDWARF::SymbolFileDWARF(ObjectFile* objfile) :
     m_using_apple_tables (false),
     m_supports_DW_AT_APPLE_objc_complete_type (eLazyBoolCalculate),
     m_ranges(),
+    m_die_memory_tracker (),
     m_unique_ast_type_map ()
 {
 }
@@ -1035,6 +1113,7 @@ SymbolFileDWARF::GetNumCompileUnits()
 CompUnitSP
 SymbolFileDWARF::ParseCompileUnitAtIndex(uint32_t cu_idx)
 {
+    DIEMemoryScope die_memory_scope (this);
     CompUnitSP cu_sp;
     DWARFDebugInfo* info = DebugInfo();
     if (info)
@@ -1194,6 +1273,7 @@ SymbolFileDWARF::FixupAddress (Address &addr)
 lldb::LanguageType
 SymbolFileDWARF::ParseCompileUnitLanguage (const SymbolContext& sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     assert (sc.comp_unit);
     DWARFCompileUnit* dwarf_cu = GetDWARFCompileUnit(sc.comp_unit);
     if (dwarf_cu)
@@ -1212,6 +1292,7 @@ SymbolFileDWARF::ParseCompileUnitLanguage (const SymbolContext& sc)
 size_t
 SymbolFileDWARF::ParseCompileUnitFunctions(const SymbolContext &sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     assert (sc.comp_unit);
     size_t functions_added = 0;
     DWARFCompileUnit* dwarf_cu = GetDWARFCompileUnit(sc.comp_unit);
@@ -1237,6 +1318,7 @@ SymbolFileDWARF::ParseCompileUnitFunctions(const SymbolContext &sc)
 bool
 SymbolFileDWARF::ParseCompileUnitSupportFiles (const SymbolContext& sc, FileSpecList& support_files)
 {
+    DIEMemoryScope die_memory_scope (this);
     assert (sc.comp_unit);
     DWARFCompileUnit* dwarf_cu = GetDWARFCompileUnit(sc.comp_unit);
     if (dwarf_cu)
@@ -1318,6 +1400,7 @@ ParseDWARFLineTableCallback(dw_offset_t offset, const DWARFDebugLine::State& sta
 bool
 SymbolFileDWARF::ParseCompileUnitLineTable (const SymbolContext &sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     assert (sc.comp_unit);
     if (sc.comp_unit->GetLineTable() != NULL)
         return true;
@@ -2355,6 +2438,7 @@ SymbolFileDWARF::ParseChildMembers
 clang::DeclContext*
 SymbolFileDWARF::GetClangDeclContextContainingTypeUID (lldb::user_id_t type_uid)
 {
+    DIEMemoryScope die_memory_scope (this);
     DWARFDebugInfo* debug_info = DebugInfo();
     if (debug_info && UserIDMatches(type_uid))
     {
@@ -2369,6 +2453,7 @@ SymbolFileDWARF::GetClangDeclContextContainingTypeUID (lldb::user_id_t type_uid)
 clang::DeclContext*
 SymbolFileDWARF::GetClangDeclContextForTypeUID (const lldb_private::SymbolContext &sc, lldb::user_id_t type_uid)
 {
+    DIEMemoryScope die_memory_scope (this);
     if (UserIDMatches(type_uid))
         return GetClangDeclContextForDIEOffset (sc, type_uid);
     return NULL;
@@ -2377,6 +2462,7 @@ SymbolFileDWARF::GetClangDeclContextForTypeUID (const lldb_private::SymbolContex
 Type*
 SymbolFileDWARF::ResolveTypeUID (lldb::user_id_t type_uid)
 {
+    DIEMemoryScope die_memory_scope (this);
     if (UserIDMatches(type_uid))
     {
         DWARFDebugInfo* debug_info = DebugInfo();
@@ -2465,6 +2551,7 @@ SymbolFileDWARF::HasForwardDeclForClangType (const ClangASTType &clang_type)
 bool
 SymbolFileDWARF::ResolveClangOpaqueTypeDefinition (ClangASTType &clang_type)
 {
+    DIEMemoryScope die_memory_scope (this);
     // We have a struct/union/class/enum that needs to be fully resolved.
     ClangASTType clang_type_no_qualifiers = clang_type.RemoveFastQualifiers();
     const DWARFDebugInfoEntry* die = m_forward_decl_clang_type_to_die.lookup (clang_type_no_qualifiers.GetOpaqueQualType());
@@ -2897,10 +2984,133 @@ SymbolFileDWARF::GetGlobalAranges()
     return *m_global_aranges_ap;
 }
 
+DWARFDIEMemoryTracker &
+SymbolFileDWARF::GetDIEMemoryTracker ()
+{
+    if (GetDebugMapSymfile ())
+        return m_debug_map_symfile->GetDIEMemoryTracker ();
+    return m_die_memory_tracker;
+}
+
+Mutex &
+SymbolFileDWARF::GetDIEMemoryMutex ()
+{
+    if (GetDebugMapSymfile ())
+        return m_debug_map_symfile->GetObjectFile()->GetModule()->GetMutex();
+    return GetObjectFile()->GetModule()->GetMutex();
+}
+
+void
+SymbolFileDWARF::DIEArrayByteSizeChanged (size_t old_byte_size, size_t new_byte_size)
+{
+    DWARFDIEMemoryTracker &tracker = GetDIEMemoryTracker ();
+    tracker.byte_size -= old_byte_size;
+    tracker.byte_size += new_byte_size;
+}
+
+void
+SymbolFileDWARF::EvictDIEsIfNeeded ()
+{
+    if (GetDebugMapSymfile ())
+        m_debug_map_symfile->EvictDIEsIfNeeded ();
+    else
+        EvictDIEs (m_die_memory_tracker, std::vector<SymbolFileDWARF *> (1, this), GetObjectFile()->GetModule());
+}
+
+void
+SymbolFileDWARF::AppendReferencedDIEs (std::vector<const DWARFDebugInfoEntry *> &dies) const
+{
+    for (DIEToTypePtr::const_iterator pos = m_die_to_type.begin(), end = m_die_to_type.end(); pos != end; ++pos)
+        dies.push_back (pos->first);
+    for (DIEToDeclContextMap::const_iterator pos = m_die_to_decl_ctx.begin(), end = m_die_to_decl_ctx.end(); pos != end; ++pos)
+        dies.push_back (pos->first);
+    for (DeclContextToDIEMap::const_iterator pos = m_decl_ctx_to_die.begin(), end = m_decl_ctx_to_die.end(); pos != end; ++pos)
+        dies.insert (dies.end(), pos->second.begin(), pos->second.end());
+    for (DIEToVariableSP::const_iterator pos = m_die_to_variable_sp.begin(), end = m_die_to_variable_sp.end(); pos != end; ++pos)
+        dies.push_back (pos->first);
+    for (DIEToClangType::const_iterator pos = m_forward_decl_die_to_clang_type.begin(), end = m_forward_decl_die_to_clang_type.end(); pos != end; ++pos)
+        dies.push_back (pos->first);
+    for (ClangTypeToDIE::const_iterator pos = m_forward_decl_clang_type_to_die.begin(), end = m_forward_decl_clang_type_to_die.end(); pos != end; ++pos)
+        dies.push_back (pos->second);
+}
+
+void
+SymbolFileDWARF::EvictDIEs (DWARFDIEMemoryTracker &tracker,
+                            const std::vector<SymbolFileDWARF *> &dwarfs,
+                            const ModuleSP &module_sp)
+{
+    const uint64_t die_memory_limit = GetGlobalPluginProperties()->GetDIEMemoryLimit();
+    const uint64_t initial_byte_size = tracker.byte_size;
+    if (die_memory_limit == 0 || dwarfs.empty() ||
+        initial_byte_size <= std::max<uint64_t> (die_memory_limit, tracker.next_eviction_byte_size))
+        return;
+
+    Timer scoped_timer (__PRETTY_FUNCTION__,
+                        "SymbolFileDWARF::EvictDIEs () with %" PRIu64 " bytes of DIEs (limit = %" PRIu64 ")",
+                        initial_byte_size,
+                        die_memory_limit);
+
+    // Gather all DIEs that are pointed to by our maps, and by the unique
+    // type map which a debug map shares between its object files. Any
+    // compile unit that contains one of these must keep its DIEs since the
+    // types, variables and decl contexts that were parsed from them still
+    // refer to them.
+    std::vector<const DWARFDebugInfoEntry *> live_dies;
+    for (SymbolFileDWARF *dwarf : dwarfs)
+        dwarf->AppendReferencedDIEs (live_dies);
+    dwarfs.front()->GetUniqueDWARFASTTypeMap().AppendDIEs (live_dies);
+    std::sort (live_dies.begin(), live_dies.end());
+
+    typedef std::pair<uint32_t, DWARFCompileUnit *> AccessAndCompileUnit;
+    std::vector<AccessAndCompileUnit> candidates;
+    for (SymbolFileDWARF *dwarf : dwarfs)
+    {
+        if (!dwarf->m_info)
+            continue;
+        const size_t num_cus = dwarf->m_info->GetNumCompileUnits();
+        for (size_t cu_idx = 0; cu_idx < num_cus; ++cu_idx)
+        {
+            DWARFCompileUnit *dwarf_cu = dwarf->m_info->GetCompileUnitAtIndex(cu_idx);
+            if (dwarf_cu && dwarf_cu->HasDIEsParsed() && !dwarf_cu->ContainsAnyDIEPtr (live_dies))
+                candidates.push_back (AccessAndCompileUnit (dwarf_cu->GetLastDIEAccess(), dwarf_cu));
+        }
+    }
+    std::sort (candidates.begin(), candidates.end());
+
+    // Evict a bit more than we need to so we don't end up doing this again
+    // on the next lookup.
+    const uint64_t target_byte_size = die_memory_limit - die_memory_limit / 4;
+    size_t num_evicted = 0;
+    for (size_t i = 0; i < candidates.size() && tracker.byte_size > target_byte_size; ++i)
+    {
+        candidates[i].second->ClearDIEs (true);
+        ++num_evicted;
+    }
+
+    // If most of the DIEs are still referenced, scanning again on every
+    // lookup would only find the same few candidates. Wait until another
+    // eighth of the limit has been extracted.
+    if (tracker.byte_size > target_byte_size)
+        tracker.next_eviction_byte_size = tracker.byte_size + die_memory_limit / 8;
+    else
+        tracker.next_eviction_byte_size = 0;
+
+    Log *log (LogChannelDWARF::GetLogIfAll(DWARF_LOG_DEBUG_INFO));
+    if (log && module_sp)
+        module_sp->LogMessage (log,
+                               "SymbolFileDWARF::EvictDIEs () cleared the DIEs of %" PRIu64 " of %" PRIu64 " candidate compile units, %" PRIu64 " -> %" PRIu64 " bytes (limit = %" PRIu64 ")",
+                               (uint64_t)num_evicted,
+                               (uint64_t)candidates.size(),
+                               initial_byte_size,
+                               (uint64_t)tracker.byte_size,
+                               die_memory_limit);
+}
+
 
 uint32_t
 SymbolFileDWARF::ResolveSymbolContext (const Address& so_addr, uint32_t resolve_scope, SymbolContext& sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     Timer scoped_timer(__PRETTY_FUNCTION__,
                        "SymbolFileDWARF::ResolveSymbolContext (so_addr = { section = %p, offset = 0x%" PRIx64 " }, resolve_scope = 0x%8.8x)",
                        static_cast<void*>(so_addr.GetSection().get()),
@@ -3052,6 +3262,7 @@ SymbolFileDWARF::ResolveSymbolContext (const Address& so_addr, uint32_t resolve_
 uint32_t
 SymbolFileDWARF::ResolveSymbolContext(const FileSpec& file_spec, uint32_t line, bool check_inlines, uint32_t resolve_scope, SymbolContextList& sc_list)
 {
+    DIEMemoryScope die_memory_scope (this);
     const uint32_t prev_size = sc_list.GetSize();
     if (resolve_scope & eSymbolContextCompUnit)
     {
@@ -3302,6 +3513,7 @@ SymbolFileDWARF::DIEIsInNamespace (const ClangNamespaceDecl *namespace_decl,
 uint32_t
 SymbolFileDWARF::FindGlobalVariables (const ConstString &name, const lldb_private::ClangNamespaceDecl *namespace_decl, bool append, uint32_t max_matches, VariableList& variables)
 {
+    DIEMemoryScope die_memory_scope (this);
     Log *log (LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS));
 
     if (log)
@@ -3421,6 +3633,7 @@ SymbolFileDWARF::FindGlobalVariables (const ConstString &name, const lldb_privat
 uint32_t
 SymbolFileDWARF::FindGlobalVariables(const RegularExpression& regex, bool append, uint32_t max_matches, VariableList& variables)
 {
+    DIEMemoryScope die_memory_scope (this);
     Log *log (LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS));
 
     if (log)
@@ -3750,6 +3963,7 @@ SymbolFileDWARF::FindFunctions (const ConstString &name,
                                 bool append, 
                                 SymbolContextList& sc_list)
 {
+    DIEMemoryScope die_memory_scope (this);
     Timer scoped_timer (__PRETTY_FUNCTION__,
                         "SymbolFileDWARF::FindFunctions (name = '%s')",
                         name.AsCString());
@@ -4061,6 +4275,7 @@ SymbolFileDWARF::FindFunctions (const ConstString &name,
 uint32_t
 SymbolFileDWARF::FindFunctions(const RegularExpression& regex, bool include_inlines, bool append, SymbolContextList& sc_list)
 {
+    DIEMemoryScope die_memory_scope (this);
     Timer scoped_timer (__PRETTY_FUNCTION__,
                         "SymbolFileDWARF::FindFunctions (regex = '%s')",
                         regex.GetText());
@@ -4112,6 +4327,7 @@ SymbolFileDWARF::FindTypes (const SymbolContext& sc,
                             uint32_t max_matches, 
                             TypeList& types)
 {
+    DIEMemoryScope die_memory_scope (this);
     DWARFDebugInfo* info = DebugInfo();
     if (info == NULL)
         return 0;
@@ -4229,6 +4445,7 @@ SymbolFileDWARF::FindNamespace (const SymbolContext& sc,
                                 const ConstString &name,
                                 const lldb_private::ClangNamespaceDecl *parent_namespace_decl)
 {
+    DIEMemoryScope die_memory_scope (this);
     Log *log (LogChannelDWARF::GetLogIfAll(DWARF_LOG_LOOKUPS));
     
     if (log)
@@ -7136,6 +7353,7 @@ SymbolFileDWARF::ParseTypes
 size_t
 SymbolFileDWARF::ParseFunctionBlocks (const SymbolContext &sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     assert(sc.comp_unit && sc.function);
     size_t functions_added = 0;
     DWARFCompileUnit* dwarf_cu = GetDWARFCompileUnit(sc.comp_unit);
@@ -7156,6 +7374,7 @@ SymbolFileDWARF::ParseFunctionBlocks (const SymbolContext &sc)
 size_t
 SymbolFileDWARF::ParseTypes (const SymbolContext &sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     // At least a compile unit must be valid
     assert(sc.comp_unit);
     size_t types_added = 0;
@@ -7187,6 +7406,7 @@ SymbolFileDWARF::ParseTypes (const SymbolContext &sc)
 size_t
 SymbolFileDWARF::ParseVariablesForContext (const SymbolContext& sc)
 {
+    DIEMemoryScope die_memory_scope (this);
     if (sc.comp_unit != NULL)
     {
         DWARFDebugInfo* info = DebugInfo();
@@ -31,12 +31,14 @@
 #include "lldb/Core/Flags.h"
 #include "lldb/Core/RangeMap.h"
 #include "lldb/Core/UniqueCStringMap.h"
+#include "lldb/Host/Mutex.h"
 #include "lldb/Symbol/ClangASTContext.h"
 #include "lldb/Symbol/SymbolFile.h"
 #include "lldb/Symbol/SymbolContext.h"
 
 // Project includes
 #include "DWARFDefines.h"
+#include "DWARFDIEMemoryTracker.h"
 #include "DWARFDataExtractor.h"
 #include "HashedNameToDIE.h"
 #include "NameToDIE.h"
@@ -84,6 +86,9 @@ public:
 
     static lldb_private::SymbolFile*
     CreateInstance (lldb_private::ObjectFile* obj_file);
+
+    static void
+    DebuggerInitialize (lldb_private::Debugger &debugger);
     //------------------------------------------------------------------
     // Constructors and Destructors
     //------------------------------------------------------------------
@@ -561,6 +566,68 @@ protected:
     GlobalVariableMap &
     GetGlobalAranges();
 
+    //------------------------------------------------------------------
+    // Extracted DIE memory accounting. DWARFCompileUnit objects report
+    // every change to the size of their DIE arrays, and compile units
+    // whose DIEs are no longer referenced get cleared in least recently
+    // used order when the "die-memory-limit" setting is exceeded.
+    //
+    // The object files of a debug map share the debug map's tracker and
+    // are evicted together, under the debug map module's mutex.
+    //------------------------------------------------------------------
+    DWARFDIEMemoryTracker &
+    GetDIEMemoryTracker ();
+
+    lldb_private::Mutex &
+    GetDIEMemoryMutex ();
+
+    uint32_t
+    GetNextDIEAccess ()
+    {
+        return ++GetDIEMemoryTracker ().access_counter;
+    }
+
+    void
+    DIEArrayByteSizeChanged (size_t old_byte_size, size_t new_byte_size);
+
+    void
+    EvictDIEsIfNeeded ();
+
+    static void
+    EvictDIEs (DWARFDIEMemoryTracker &tracker,
+               const std::vector<SymbolFileDWARF *> &dwarfs,
+               const lldb::ModuleSP &module_sp);
+
+    // Append every DIE our maps refer to, the compile units that contain
+    // them can't be cleared.
+    void
+    AppendReferencedDIEs (std::vector<const DWARFDebugInfoEntry *> &dies) const;
+
+    // DIE pointers can only be held on the stack while we are inside one
+    // of the SymbolFile entry points, so DIEs are only evicted when the
+    // outermost entry point returns. The owner's module mutex is held for
+    // the whole scope so no other thread can be using DIEs at that point.
+    class DIEMemoryScope
+    {
+    public:
+        DIEMemoryScope (SymbolFileDWARF *dwarf) :
+            m_dwarf (dwarf),
+            m_locker (dwarf->GetDIEMemoryMutex ())
+        {
+            ++m_dwarf->GetDIEMemoryTracker ().scope_depth;
+        }
+
+        ~DIEMemoryScope ()
+        {
+            if (--m_dwarf->GetDIEMemoryTracker ().scope_depth == 0)
+                m_dwarf->EvictDIEsIfNeeded ();
+        }
+
+    private:
+        SymbolFileDWARF *m_dwarf;
+        lldb_private::Mutex::Locker m_locker;
+    };
+
     lldb::ModuleWP                        m_debug_map_module_wp;
     SymbolFileDWARFDebugMap *             m_debug_map_symfile;
     clang::TranslationUnitDecl *          m_clang_tu_decl;
@@ -603,6 +670,7 @@ protected:
     lldb_private::LazyBool              m_supports_DW_AT_APPLE_objc_complete_type;
 
     std::unique_ptr<DWARFDebugRanges>     m_ranges;
+    DWARFDIEMemoryTracker               m_die_memory_tracker;
     UniqueDWARFASTTypeMap m_unique_ast_type_map;
     typedef llvm::SmallPtrSet<const DWARFDebugInfoEntry *, 4> DIEPointerSet;
     typedef llvm::DenseMap<const DWARFDebugInfoEntry *, clang::DeclContext *> DIEToDeclContextMap;
@@ -293,6 +293,7 @@ SymbolFileDWARFDebugMap::SymbolFileDWARFDebugMap (ObjectFile* ofile) :
     m_compile_unit_infos(),
     m_func_indexes(),
     m_glob_indexes(),
+    m_die_memory_tracker (),
     m_supports_DW_AT_APPLE_objc_complete_type (eLazyBoolCalculate)
 {
 }
@@ -598,6 +599,28 @@ SymbolFileDWARFDebugMap::GetSymbolFileAsSymbolFileDWARF (SymbolFile *sym_file)
     return NULL;
 }
 
+void
+SymbolFileDWARFDebugMap::EvictDIEsIfNeeded ()
+{
+    // Only look at the object files that have already been loaded, there
+    // is nothing to evict from the others.
+    std::vector<SymbolFileDWARF *> oso_dwarfs;
+    for (auto &pair : m_oso_map)
+    {
+        const OSOInfoSP &oso_sp = pair.second;
+        if (!oso_sp || !oso_sp->module_sp)
+            continue;
+        SymbolVendor *sym_vendor = oso_sp->module_sp->GetSymbolVendor (false);
+        if (sym_vendor)
+        {
+            SymbolFileDWARF *oso_dwarf = GetSymbolFileAsSymbolFileDWARF (sym_vendor->GetSymbolFile());
+            if (oso_dwarf)
+                oso_dwarfs.push_back (oso_dwarf);
+        }
+    }
+    SymbolFileDWARF::EvictDIEs (m_die_memory_tracker, oso_dwarfs, m_obj_file->GetModule());
+}
+
 SymbolFileDWARF *
 SymbolFileDWARFDebugMap::GetSymbolFileByCompUnitInfo (CompileUnitInfo *comp_unit_info)
 {
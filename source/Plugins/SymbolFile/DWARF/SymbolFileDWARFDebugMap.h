@@ -19,6 +19,7 @@
 #include "lldb/Core/RangeMap.h"
 #include "lldb/Symbol/SymbolFile.h"
 
+#include "DWARFDIEMemoryTracker.h"
 #include "UniqueDWARFASTType.h"
 
 class SymbolFileDWARF;
@@ -290,6 +291,19 @@ protected:
     {
         return m_unique_ast_type_map;
     }
+
+    //------------------------------------------------------------------
+    // The object files share our DIE memory accounting, so DIEs are
+    // evicted across all of the object files that have been loaded.
+    //------------------------------------------------------------------
+    DWARFDIEMemoryTracker &
+    GetDIEMemoryTracker ()
+    {
+        return m_die_memory_tracker;
+    }
+
+    void
+    EvictDIEsIfNeeded ();
     
     
     //------------------------------------------------------------------
@@ -351,6 +365,7 @@ protected:
     std::vector<uint32_t> m_glob_indexes;
     std::map<lldb_private::ConstString, OSOInfoSP> m_oso_map;
     UniqueDWARFASTTypeMap m_unique_ast_type_map;
+    DWARFDIEMemoryTracker m_die_memory_tracker;
     lldb_private::LazyBool m_supports_DW_AT_APPLE_objc_complete_type;
     DebugMap m_debug_map;
     
@@ -123,6 +123,14 @@ public:
           const lldb_private::Declaration &decl,
           const int32_t byte_size,
           UniqueDWARFASTType &entry) const;
+
+    void
+    AppendDIEs (std::vector<const DWARFDebugInfoEntry *> &dies) const
+    {
+        collection::const_iterator pos, end = m_collection.end();
+        for (pos = m_collection.begin(); pos != end; ++pos)
+            dies.push_back (pos->m_die);
+    }
     
 protected:
     typedef std::vector<UniqueDWARFASTType> collection;
@@ -166,6 +174,15 @@ public:
         return false;
     }
 
+    // Append the DIEs of every unique type so they can be kept alive
+    void
+    AppendDIEs (std::vector<const DWARFDebugInfoEntry *> &dies) const
+    {
+        collection::const_iterator pos, end = m_collection.end();
+        for (pos = m_collection.begin(); pos != end; ++pos)
+            pos->second.AppendDIEs (dies);
+    }
+
 protected:
     // A unique name string should be used
     typedef llvm::DenseMap<const char *, UniqueDWARFASTTypeList> collection;
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "UnwindAssembly-x86.h"
+#include "X86InstructionLength.h"
 
 #include "llvm-c/Disassembler.h"
 #include "llvm/ADT/STLExtras.h"
@@ -141,6 +142,7 @@ public:
 
 private:
     enum { kMaxInstructionByteSize = 32 };
+    enum { kFunctionBytesChunkSize = 4096 };
 
     bool nonvolatile_reg_p (int machine_regno);
     bool push_rbp_pattern_p ();
@@ -158,7 +160,9 @@ private:
     bool call_next_insn_pattern_p();
     uint32_t extract_4 (uint8_t *b);
     bool machine_regno_to_lldb_regno (int machine_regno, uint32_t& lldb_regno);
-    bool instruction_length (Address addr, int &length);
+    void begin_reading_function (const AddressRange &func);
+    bool read_function_bytes (addr_t func_offset);
+    bool fetch_instruction (addr_t func_offset, int &length);
 
     const ExecutionContext m_exe_ctx;
 
@@ -167,6 +171,13 @@ private:
     Address m_cur_insn;
     uint8_t m_cur_insn_bytes[kMaxInstructionByteSize];
 
+    // The function being parsed and a window of its bytes, which are read in
+    // kFunctionBytesChunkSize pieces so a huge function size can't make us
+    // read (and allocate) all of it up front
+    AddressRange m_func_read_range;
+    std::vector<uint8_t> m_func_bytes;
+    addr_t m_func_bytes_offset;                 // Offset of m_func_bytes[0] into m_func_read_range
+
     uint32_t m_machine_ip_regnum;
     uint32_t m_machine_sp_regnum;
     uint32_t m_machine_fp_regnum;
@@ -187,6 +198,9 @@ AssemblyParse_x86::AssemblyParse_x86 (const ExecutionContext &exe_ctx, int cpu,
     m_exe_ctx (exe_ctx),
     m_func_bounds(func),
     m_cur_insn (),
+    m_func_read_range (),
+    m_func_bytes (),
+    m_func_bytes_offset (0),
     m_machine_ip_regnum (LLDB_INVALID_REGNUM),
     m_machine_sp_regnum (LLDB_INVALID_REGNUM),
     m_machine_fp_regnum (LLDB_INVALID_REGNUM),
@@ -195,7 +209,8 @@ AssemblyParse_x86::AssemblyParse_x86 (const ExecutionContext &exe_ctx, int cpu,
     m_lldb_fp_regnum (LLDB_INVALID_REGNUM),
     m_wordsize (-1),
     m_cpu(cpu),
-    m_arch(arch)
+    m_arch(arch),
+    m_disasm_context (NULL)
 {
     int *initialized_flag = NULL;
     if (cpu == k_i386)
@@ -259,17 +274,12 @@ AssemblyParse_x86::AssemblyParse_x86 (const ExecutionContext &exe_ctx, int cpu,
        if (machine_regno_to_lldb_regno (m_machine_ip_regnum, lldb_regno))
            m_lldb_ip_regnum = lldb_regno;
    }
-
-   m_disasm_context = ::LLVMCreateDisasm(m_arch.GetTriple().getTriple().c_str(),
-                                          (void*)this,
-                                          /*TagType=*/1,
-                                          NULL,
-                                          NULL);
 }
 
 AssemblyParse_x86::~AssemblyParse_x86 ()
 {
-    ::LLVMDisasmDispose(m_disasm_context);
+    if (m_disasm_context)
+        ::LLVMDisasmDispose(m_disasm_context);
 }
 
 // This function expects an x86 native register number (i.e. the bits stripped out of the
@@ -610,35 +620,95 @@ AssemblyParse_x86::machine_regno_to_lldb_regno (int machine_regno, uint32_t &lld
     return false;
 }
 
+void
+AssemblyParse_x86::begin_reading_function (const AddressRange &func)
+{
+    m_func_read_range = func;
+    m_func_bytes.clear();
+    m_func_bytes_offset = 0;
+}
+
+// Read the next chunk of the function, starting func_offset bytes into it.
+
 bool
-AssemblyParse_x86::instruction_length (Address addr, int &length)
+AssemblyParse_x86::read_function_bytes (addr_t func_offset)
 {
-    const uint32_t max_op_byte_size = m_arch.GetMaximumOpcodeByteSize();
-    llvm::SmallVector <uint8_t, 32> opcode_data;
-    opcode_data.resize (max_op_byte_size);
+    m_func_bytes.clear();
+    m_func_bytes_offset = func_offset;
 
-    if (!addr.IsValid())
+    Target *target = m_exe_ctx.GetTargetPtr();
+    if (target == NULL || !m_func_read_range.GetBaseAddress().IsValid() || func_offset >= m_func_read_range.GetByteSize())
         return false;
 
+    m_func_bytes.resize (std::min<addr_t> (kFunctionBytesChunkSize, m_func_read_range.GetByteSize() - func_offset));
+    Address read_addr (m_func_read_range.GetBaseAddress());
+    read_addr.Slide (func_offset);
     const bool prefer_file_cache = true;
     Error error;
-    Target *target = m_exe_ctx.GetTargetPtr();
-    if (target->ReadMemory (addr, prefer_file_cache, opcode_data.data(),
-                            max_op_byte_size, error) == static_cast<size_t>(-1))
+    const size_t bytes_read = target->ReadMemory (read_addr, prefer_file_cache, m_func_bytes.data(),
+                                                  m_func_bytes.size(), error);
+    if (bytes_read == 0 || bytes_read == static_cast<size_t>(-1))
     {
+        m_func_bytes.clear();
+        return false;
+    }
+
+    // We may only have been able to read the start of the chunk, the
+    // instructions after that are treated like unreadable memory.
+    m_func_bytes.resize (bytes_read);
+    return true;
+}
+
+// Decode the length of the instruction at func_offset bytes into the function
+// and copy it into m_cur_insn_bytes for the *_pattern_p() methods.
+
+bool
+AssemblyParse_x86::fetch_instruction (addr_t func_offset, int &length)
+{
+    const addr_t func_size = m_func_read_range.GetByteSize();
+    if (func_offset >= func_size)
         return false;
+
+    // Move the window if it doesn't hold the longest instruction that could
+    // start at func_offset
+    const addr_t insn_end = std::min<addr_t> (func_offset + kMaxX86InstructionLength, func_size);
+    if (func_offset < m_func_bytes_offset || insn_end > m_func_bytes_offset + m_func_bytes.size())
+    {
+        if (!read_function_bytes (func_offset))
+            return false;
+    }
+
+    uint8_t *insn_bytes = m_func_bytes.data() + (func_offset - m_func_bytes_offset);
+    const size_t bytes_avail = m_func_bytes.size() - (func_offset - m_func_bytes_offset);
+    size_t insn_size = GetX86InstructionLength (insn_bytes, bytes_avail, m_cpu == k_x86_64);
+    if (insn_size == 0)
+    {
+        // The length decoder doesn't know this instruction, let the llvm
+        // disassembler have a go at it before we give up.
+        if (m_disasm_context == NULL)
+            m_disasm_context = ::LLVMCreateDisasm(m_arch.GetTriple().getTriple().c_str(),
+                                                  (void*)this,
+                                                  /*TagType=*/1,
+                                                  NULL,
+                                                  NULL);
+        if (m_disasm_context)
+        {
+            char out_string[512];
+            insn_size = ::LLVMDisasmInstruction (m_disasm_context,
+                                                 insn_bytes,
+                                                 bytes_avail,
+                                                 m_func_read_range.GetBaseAddress().GetFileAddress() + func_offset, // PC value
+                                                 out_string,
+                                                 sizeof(out_string));
+        }
     }
 
-    char out_string[512];
-    const addr_t pc = addr.GetFileAddress();
-    const size_t inst_size = ::LLVMDisasmInstruction (m_disasm_context,
-                                                      opcode_data.data(),
-                                                      max_op_byte_size,
-                                                      pc, // PC value
-                                                      out_string,
-                                                      sizeof(out_string));
+    if (insn_size == 0 || insn_size > kMaxInstructionByteSize || insn_size > bytes_avail)
+        return false;
 
-    length = inst_size;
+    ::memset (m_cur_insn_bytes, 0, sizeof(m_cur_insn_bytes));
+    ::memcpy (m_cur_insn_bytes, insn_bytes, insn_size);
+    length = insn_size;
     return true;
 }
 
@@ -651,7 +721,6 @@ AssemblyParse_x86::get_non_call_site_unwind_plan (UnwindPlan &unwind_plan)
     addr_t current_func_text_offset = 0;
     int current_sp_bytes_offset_from_cfa = 0;
     UnwindPlan::Row::RegisterLocation initial_regloc;
-    Error error;
 
     if (!m_cur_insn.IsValid())
     {
@@ -687,8 +756,6 @@ AssemblyParse_x86::get_non_call_site_unwind_plan (UnwindPlan &unwind_plan)
     // (i386_register_numbers, x86_64_register_numbers).
     std::vector<bool> saved_registers(32, false);
 
-    const bool prefer_file_cache = true;
-
     // Once the prologue has completed we'll save a copy of the unwind instructions
     // If there is an epilogue in the middle of the function, after that epilogue we'll reinstate
     // the unwind setup -- we assume that some code path jumps over the mid-function epilogue
@@ -697,7 +764,9 @@ AssemblyParse_x86::get_non_call_site_unwind_plan (UnwindPlan &unwind_plan)
     int prologue_completed_sp_bytes_offset_from_cfa;   // The sp value before the epilogue started executed
     std::vector<bool> prologue_completed_saved_registers;
 
-    Target *target = m_exe_ctx.GetTargetPtr();
+    // If we can't read the function, the loop below stops at the first instruction
+    begin_reading_function (m_func_bounds);
+
     while (m_func_bounds.ContainsFileAddress (m_cur_insn))
     {
         int stack_offset, insn_len;
@@ -707,19 +776,12 @@ AssemblyParse_x86::get_non_call_site_unwind_plan (UnwindPlan &unwind_plan)
         bool in_epilogue = false;                          // we're in the middle of an epilogue sequence
         bool row_updated = false;                          // The UnwindPlan::Row 'row' has been updated
 
-        if (!instruction_length (m_cur_insn, insn_len) || insn_len == 0 || insn_len > kMaxInstructionByteSize)
+        if (!fetch_instruction (current_func_text_offset, insn_len))
         {
-            // An unrecognized/junk instruction
+            // An unrecognized/junk instruction, or we couldn't read it out of the file
             break;
         }
 
-        if (target->ReadMemory (m_cur_insn, prefer_file_cache, m_cur_insn_bytes,
-                                insn_len, error) == static_cast<size_t>(-1))
-        {
-           // Error reading the instruction out of the file, stop scanning
-           break;
-        }
-
         if (push_rbp_pattern_p ())
         {
             current_sp_bytes_offset_from_cfa += m_wordsize;
@@ -956,7 +1018,6 @@ AssemblyParse_x86::augment_unwind_plan_from_call_site (AddressRange& func, Unwin
 
     UnwindPlan::RowSP original_last_row = unwind_plan.GetRowForFunctionOffset (-1);
 
-    Target *target = m_exe_ctx.GetTargetPtr();
     m_cur_insn = func.GetBaseAddress();
     uint64_t offset = 0;
     int row_id = 1;
@@ -968,23 +1029,16 @@ AssemblyParse_x86::augment_unwind_plan_from_call_site (AddressRange& func, Unwin
     // on x86 but it is possible.
     bool reinstate_unwind_state = false;
 
+    begin_reading_function (func);
+
     while (func.ContainsFileAddress (m_cur_insn))
     {
         int insn_len;
-        if (!instruction_length (m_cur_insn, insn_len)
-            || insn_len == 0 || insn_len > kMaxInstructionByteSize)
+        if (!fetch_instruction (offset, insn_len))
         {
-            // An unrecognized/junk instruction.
+            // An unrecognized/junk instruction, or we couldn't read it out of the file.
             break;
         }
-        const bool prefer_file_cache = true;
-        Error error;
-        if (target->ReadMemory (m_cur_insn, prefer_file_cache, m_cur_insn_bytes,
-                                insn_len, error) == static_cast<size_t>(-1))
-        {
-           // Error reading the instruction out of the file, stop scanning.
-           break;
-        }
 
         // Advance offsets.
         offset += insn_len;
@@ -1139,9 +1193,8 @@ AssemblyParse_x86::augment_unwind_plan_from_call_site (AddressRange& func, Unwin
             //  => [0xc3] ret
             if (pop_rbp_pattern_p ())
             {
-                if (target->ReadMemory (m_cur_insn, prefer_file_cache, m_cur_insn_bytes,
-                                        1, error) != static_cast<size_t>(-1)
-                    && ret_pattern_p ())
+                int next_insn_len;
+                if (fetch_instruction (offset, next_insn_len) && ret_pattern_p ())
                 {
                     row->SetOffset (offset);
                     row->GetCFAValue().SetIsRegisterPlusOffset (
@@ -1271,29 +1324,24 @@ AssemblyParse_x86::find_first_non_prologue_insn (Address &address)
         return false;
     }
 
-    const bool prefer_file_cache = true;
-    Target *target = m_exe_ctx.GetTargetPtr();
+    begin_reading_function (m_func_bounds);
+
+    addr_t func_offset = 0;
     while (m_func_bounds.ContainsFileAddress (m_cur_insn))
     {
-        Error error;
         int insn_len, offset, regno;
-        if (!instruction_length (m_cur_insn, insn_len) || insn_len > kMaxInstructionByteSize || insn_len == 0)
+        if (!fetch_instruction (func_offset, insn_len))
         {
             // An error parsing the instruction, i.e. probably data/garbage - stop scanning
             break;
         }
-        if (target->ReadMemory (m_cur_insn, prefer_file_cache, m_cur_insn_bytes,
-                                insn_len, error) == static_cast<size_t>(-1))
-        {
-           // Error reading the instruction out of the file, stop scanning
-           break;
-        }
 
         if (push_rbp_pattern_p () || mov_rsp_rbp_pattern_p () || sub_rsp_pattern_p (offset)
             || push_reg_p (regno) || mov_reg_to_local_stack_frame_p (regno, offset)
             || (lea_rsp_pattern_p (offset) && offset < 0))
         {
             m_cur_insn.SetOffset (m_cur_insn.GetOffset() + insn_len);
+            func_offset += insn_len;
             continue;
         }
 
@@ -0,0 +1,292 @@
+//===-- X86InstructionLength.cpp --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "X86InstructionLength.h"
+
+#include <algorithm>
+
+using namespace lldb_private;
+
+//-----------------------------------------------------------------------------------------------
+//  x86 instruction length decoder
+//
+//  The unwinder only needs to know where each instruction ends, so rather than running the
+//  full llvm disassembler (which formats every instruction into a string) we walk the prefix,
+//  opcode, ModRM/SIB, displacement and immediate bytes using the tables below.
+//-----------------------------------------------------------------------------------------------
+
+enum x86_opcode_flags
+{
+    kNone       = 0,
+    kModRM      = (1u << 0),    // A ModRM byte (plus optional SIB and displacement) follows
+    kImm8       = (1u << 1),    // 8 bit immediate
+    kImm16      = (1u << 2),    // 16 bit immediate
+    kImmZ       = (1u << 3),    // 16 or 32 bit immediate depending on the operand size
+    kImmV       = (1u << 4),    // 16, 32 or 64 bit immediate depending on the operand size
+    kRelZ       = (1u << 5),    // 16 or 32 bit branch displacement, always 32 bits in 64 bit mode
+    kMoffs      = (1u << 6),    // Address sized memory offset
+    kPrefix     = (1u << 7),    // Legacy prefix byte
+    kInvalid    = (1u << 8),    // Not a valid opcode
+
+    kModRMImm8  = kModRM | kImm8,
+    kModRMImmZ  = kModRM | kImmZ,
+    kFarPtr     = kImmZ | kImm16
+};
+
+static const uint16_t
+g_one_byte_opcode_flags[256] =
+{
+    /* 00 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kNone,      kNone,
+    /* 08 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kNone,      kNone,
+    /* 10 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kNone,      kNone,
+    /* 18 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kNone,      kNone,
+    /* 20 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kPrefix,    kNone,
+    /* 28 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kPrefix,    kNone,
+    /* 30 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kPrefix,    kNone,
+    /* 38 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImmZ,      kPrefix,    kNone,
+    /* 40 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* 48 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* 50 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* 58 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* 60 */ kNone,      kNone,      kModRM,     kModRM,     kPrefix,    kPrefix,    kPrefix,    kPrefix,
+    /* 68 */ kImmZ,      kModRMImmZ, kImm8,      kModRMImm8, kNone,      kNone,      kNone,      kNone,
+    /* 70 */ kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,
+    /* 78 */ kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,
+    /* 80 */ kModRMImm8, kModRMImmZ, kModRMImm8, kModRMImm8, kModRM,     kModRM,     kModRM,     kModRM,
+    /* 88 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 90 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* 98 */ kNone,      kNone,      kFarPtr,    kNone,      kNone,      kNone,      kNone,      kNone,
+    /* a0 */ kMoffs,     kMoffs,     kMoffs,     kMoffs,     kNone,      kNone,      kNone,      kNone,
+    /* a8 */ kImm8,      kImmZ,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* b0 */ kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,
+    /* b8 */ kImmV,      kImmV,      kImmV,      kImmV,      kImmV,      kImmV,      kImmV,      kImmV,
+    /* c0 */ kModRMImm8, kModRMImm8, kImm16,     kNone,      kModRM,     kModRM,     kModRMImm8, kModRMImmZ,
+    /* c8 */ kImm16|kImm8,kNone,     kImm16,     kNone,      kNone,      kImm8,      kNone,      kNone,
+    /* d0 */ kModRM,     kModRM,     kModRM,     kModRM,     kImm8,      kImm8,      kNone,      kNone,
+    /* d8 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* e0 */ kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,      kImm8,
+    /* e8 */ kRelZ,      kRelZ,      kFarPtr,    kImm8,      kNone,      kNone,      kNone,      kNone,
+    /* f0 */ kPrefix,    kNone,      kPrefix,    kPrefix,    kNone,      kNone,      kModRM,     kModRM,
+    /* f8 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kModRM,     kModRM
+};
+
+// Opcodes that follow a 0x0f escape byte. 0x0f 0x38 and 0x0f 0x3a are three byte opcodes
+// and are handled in GetX86InstructionLength().
+static const uint16_t
+g_two_byte_opcode_flags[256] =
+{
+    /* 00 */ kModRM,     kModRM,     kModRM,     kModRM,     kInvalid,   kNone,      kNone,      kNone,
+    /* 08 */ kNone,      kNone,      kInvalid,   kNone,      kInvalid,   kModRM,     kNone,      kModRMImm8,
+    /* 10 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 18 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 20 */ kModRM,     kModRM,     kModRM,     kModRM,     kInvalid,   kInvalid,   kInvalid,   kInvalid,
+    /* 28 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 30 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kInvalid,   kNone,
+    /* 38 */ kModRM,     kInvalid,   kModRMImm8, kInvalid,   kInvalid,   kInvalid,   kInvalid,   kInvalid,
+    /* 40 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 48 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 50 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 58 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 60 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 68 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 70 */ kModRMImm8, kModRMImm8, kModRMImm8, kModRMImm8, kModRM,     kModRM,     kModRM,     kNone,
+    /* 78 */ kModRM,     kModRM,     kInvalid,   kInvalid,   kModRM,     kModRM,     kModRM,     kModRM,
+    /* 80 */ kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,
+    /* 88 */ kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,      kRelZ,
+    /* 90 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* 98 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* a0 */ kNone,      kNone,      kNone,      kModRM,     kModRMImm8, kModRM,     kInvalid,   kInvalid,
+    /* a8 */ kNone,      kNone,      kNone,      kModRM,     kModRMImm8, kModRM,     kModRM,     kModRM,
+    /* b0 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* b8 */ kModRM,     kModRM,     kModRMImm8, kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* c0 */ kModRM,     kModRM,     kModRMImm8, kModRM,     kModRMImm8, kModRMImm8, kModRMImm8, kModRM,
+    /* c8 */ kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,      kNone,
+    /* d0 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* d8 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* e0 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* e8 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* f0 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,
+    /* f8 */ kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM,     kModRM
+};
+
+static bool
+x86_opcode_invalid_in_64bit_mode (uint8_t opcode)
+{
+    switch (opcode)
+    {
+        case 0x06: case 0x07: case 0x0e: case 0x16: case 0x17: case 0x1e: case 0x1f:
+        case 0x27: case 0x2f: case 0x37: case 0x3f: case 0x60: case 0x61: case 0x82:
+        case 0x9a: case 0xce: case 0xd4: case 0xd5: case 0xd6: case 0xea:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t
+lldb_private::GetX86InstructionLength (const uint8_t *bytes, size_t bytes_avail, bool is_64bit)
+{
+    const size_t max_length = std::min<size_t> (bytes_avail, kMaxX86InstructionLength);
+    bool operand_size_prefix = false;
+    bool address_size_prefix = false;
+    bool rex_w = false;
+    size_t i = 0;
+
+    // Legacy prefixes, and the REX prefix which must immediately precede the opcode
+    while (i < max_length)
+    {
+        const uint8_t byte = bytes[i];
+        if (g_one_byte_opcode_flags[byte] & kPrefix)
+        {
+            if (byte == 0x66)
+                operand_size_prefix = true;
+            else if (byte == 0x67)
+                address_size_prefix = true;
+            rex_w = false;
+        }
+        else if (is_64bit && (byte & 0xf0) == 0x40)
+            rex_w = (byte & 0x08) != 0;
+        else
+            break;
+        ++i;
+    }
+    if (i >= max_length)
+        return 0;
+
+    const uint8_t opcode = bytes[i++];
+    uint16_t flags = kNone;
+    bool test_group = false;    // f6/f7 have an immediate only for the test instruction
+    if (opcode == 0x0f)
+    {
+        if (i >= max_length)
+            return 0;
+        const uint8_t opcode2 = bytes[i++];
+        if (opcode2 == 0x38 || opcode2 == 0x3a)
+            ++i; // Skip the third opcode byte
+        flags = g_two_byte_opcode_flags[opcode2];
+    }
+    else if ((opcode == 0xc4 || opcode == 0xc5 || opcode == 0x62) &&
+             i < max_length && (is_64bit || (bytes[i] & 0xc0) == 0xc0))
+    {
+        // VEX (c4/c5) and EVEX (62) encoded instructions. Outside of 64 bit mode these
+        // opcodes are les, lds and bound unless the following byte has a register ModRM form.
+        uint8_t map = 1;
+        if (opcode == 0xc5)
+            i += 1;
+        else if (opcode == 0xc4)
+        {
+            map = bytes[i] & 0x1f;
+            i += 2;
+        }
+        else
+        {
+            map = bytes[i] & 0x03;
+            i += 3;
+        }
+        if (i >= max_length)
+            return 0;
+        const uint8_t vex_opcode = bytes[i++];
+        switch (map)
+        {
+            case 1:
+                // Everything in the 0x0f map takes a ModRM byte except vzeroupper/vzeroall
+                if (opcode != 0x62 && vex_opcode == 0x77)
+                    flags = kNone;
+                else
+                    flags = kModRM | (g_two_byte_opcode_flags[vex_opcode] & kImm8);
+                break;
+            case 2:
+                flags = kModRM;
+                break;
+            case 3:
+                flags = kModRMImm8;
+                break;
+            default:
+                return 0;
+        }
+    }
+    else if (opcode == 0x8f && i < max_length && (bytes[i] & 0x38) != 0)
+    {
+        // AMD XOP encoded instruction
+        return 0;
+    }
+    else
+    {
+        if (is_64bit && x86_opcode_invalid_in_64bit_mode (opcode))
+            return 0;
+        flags = g_one_byte_opcode_flags[opcode];
+        test_group = (opcode == 0xf6 || opcode == 0xf7);
+    }
+
+    if (flags & kInvalid)
+        return 0;
+
+    if (flags & kModRM)
+    {
+        if (i >= max_length)
+            return 0;
+        const uint8_t modrm = bytes[i++];
+        const uint8_t mod = modrm >> 6;
+        const uint8_t reg = (modrm >> 3) & 0x7;
+        const uint8_t rm = modrm & 0x7;
+
+        if (test_group && reg < 2)
+            flags |= (opcode == 0xf6) ? kImm8 : kImmZ;
+
+        if (mod != 3)
+        {
+            if (!is_64bit && address_size_prefix)
+            {
+                // 16 bit addressing, no SIB byte
+                if (mod == 1)
+                    i += 1;
+                else if (mod == 2 || (mod == 0 && rm == 6))
+                    i += 2;
+            }
+            else
+            {
+                if (rm == 4)
+                {
+                    if (i >= max_length)
+                        return 0;
+                    const uint8_t sib = bytes[i++];
+                    if (mod == 0 && (sib & 0x7) == 5)
+                        i += 4;
+                }
+                if (mod == 1)
+                    i += 1;
+                else if (mod == 2 || (mod == 0 && rm == 5))
+                    i += 4;
+            }
+        }
+    }
+
+    const size_t operand_size = (operand_size_prefix && !rex_w) ? 2 : 4;
+    if (flags & kImm8)
+        i += 1;
+    if (flags & kImm16)
+        i += 2;
+    if (flags & kImmZ)
+        i += operand_size;
+    if (flags & kImmV)
+        i += rex_w ? 8 : operand_size;
+    if (flags & kRelZ)
+        i += is_64bit ? 4 : operand_size;
+    if (flags & kMoffs)
+    {
+        if (is_64bit)
+            i += address_size_prefix ? 4 : 8;
+        else
+            i += address_size_prefix ? 2 : 4;
+    }
+
+    if (i > max_length)
+        return 0;
+    return i;
+}
@@ -0,0 +1,31 @@
+//===-- X86InstructionLength.h ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef liblldb_X86InstructionLength_h_
+#define liblldb_X86InstructionLength_h_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace lldb_private {
+
+// The longest encoding an x86 instruction may have
+const size_t kMaxX86InstructionLength = 15;
+
+//------------------------------------------------------------------
+/// Returns the length of the x86 instruction that starts at \a bytes,
+/// or zero if the instruction isn't one we know how to decode or doesn't
+/// fit in the \a bytes_avail bytes we have.
+//------------------------------------------------------------------
+size_t
+GetX86InstructionLength (const uint8_t *bytes, size_t bytes_avail, bool is_64bit);
+
+} // namespace lldb_private
+
+#endif  // liblldb_X86InstructionLength_h_
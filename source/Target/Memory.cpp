@@ -218,6 +218,39 @@ MemoryCache::Read (addr_t addr,
     return dst_len - bytes_left;
 }
 
+size_t
+MemoryCache::Prefetch (addr_t addr, size_t size, Error &error)
+{
+    const uint32_t cache_line_byte_size = m_cache_line_byte_size;
+    if (size == 0 || cache_line_byte_size == 0)
+        return 0;
+
+    const addr_t start_addr = addr - (addr % cache_line_byte_size);
+    const addr_t end_addr = ((addr + size + cache_line_byte_size - 1) / cache_line_byte_size) * cache_line_byte_size;
+
+    DataBufferHeap buffer (end_addr - start_addr, 0);
+    const size_t bytes_read = m_process.ReadMemoryFromInferior (start_addr,
+                                                                buffer.GetBytes(),
+                                                                buffer.GetByteSize(),
+                                                                error);
+
+    // Only whole lines go in the cache; Read() treats a short line as the
+    // end of readable memory.
+    const size_t num_lines = bytes_read / cache_line_byte_size;
+    Mutex::Locker locker (m_mutex);
+    for (size_t i = 0; i < num_lines; ++i)
+    {
+        const addr_t line_addr = start_addr + i * cache_line_byte_size;
+        if (m_cache.find (line_addr) != m_cache.end())
+            continue;
+        if (m_invalid_ranges.FindEntryThatContains (line_addr))
+            continue;
+        m_cache[line_addr] = DataBufferSP (new DataBufferHeap (buffer.GetBytes() + i * cache_line_byte_size,
+                                                               cache_line_byte_size));
+    }
+    return num_lines * cache_line_byte_size;
+}
+
 
 
 AllocatedBlock::AllocatedBlock (lldb::addr_t addr, 
@@ -46,6 +46,11 @@ using namespace lldb_private;
 
 static uint32_t g_initialize_count = 0;
 
+// Size of the blocks used for block by block file transfers. Remote
+// platforms split each block into pipelined packets, so large blocks keep
+// many requests in flight.
+static const size_t k_bulk_transfer_size = 1024 * 1024;
+
 // Use a singleton function for g_local_platform_sp to avoid init
 // constructors since LLDB is often part of a shared library
 static PlatformSP&
@@ -68,13 +73,15 @@ namespace {
     {
         { "use-module-cache"      , OptionValue::eTypeBoolean , true,  true, nullptr, nullptr, "Use module cache." },
         { "module-cache-directory", OptionValue::eTypeFileSpec, true,  0 ,   nullptr, nullptr, "Root directory for cached modules." },
+        { "module-cache-max-size" , OptionValue::eTypeUInt64  , true,  0,    nullptr, nullptr, "Maximum size in bytes of the module cache. Least recently used modules are evicted once it is exceeded. Zero means unlimited." },
         {  nullptr                , OptionValue::eTypeInvalid , false, 0,    nullptr, nullptr, nullptr }
     };
 
     enum
     {
         ePropertyUseModuleCache,
-        ePropertyModuleCacheDirectory
+        ePropertyModuleCacheDirectory,
+        ePropertyModuleCacheMaxSize
     };
 
 }  // namespace
@@ -128,6 +135,19 @@ PlatformProperties::SetModuleCacheDirectory (const FileSpec& dir_spec)
     return m_collection_sp->SetPropertyAtIndexAsFileSpec (nullptr, ePropertyModuleCacheDirectory, dir_spec);
 }
 
+uint64_t
+PlatformProperties::GetModuleCacheMaxSize () const
+{
+    const auto idx = ePropertyModuleCacheMaxSize;
+    return m_collection_sp->GetPropertyAtIndexAsUInt64 (nullptr, idx, g_properties[idx].default_uint_value);
+}
+
+bool
+PlatformProperties::SetModuleCacheMaxSize (uint64_t max_size)
+{
+    return m_collection_sp->SetPropertyAtIndexAsUInt64 (nullptr, ePropertyModuleCacheMaxSize, max_size);
+}
+
 //------------------------------------------------------------------
 /// Get the native host platform plug-in. 
 ///
@@ -496,6 +516,14 @@ Platform::GetStatus (Stream &strm)
     {
         strm.Printf("WorkingDir: %s\n", GetWorkingDirectory().GetCString());
     }
+
+    if (!IsHost() && GetGlobalPlatformProperties ()->GetUseModuleCache ())
+    {
+        const auto stats = m_module_cache->GetStatistics ();
+        strm.Printf("ModuleCache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " bytes saved, %" PRIu64 " evictions\n",
+                    stats.hits, stats.misses, stats.bytes_saved, stats.evictions);
+    }
+
     if (!IsConnected())
         return;
 
@@ -1420,7 +1448,7 @@ Platform::PutFile (const FileSpec& source,
         return error;
     if (dest_file == UINT64_MAX)
         return Error("unable to open target file");
-    lldb::DataBufferSP buffer_sp(new DataBufferHeap(1024, 0));
+    lldb::DataBufferSP buffer_sp(new DataBufferHeap(k_bulk_transfer_size, 0));
     uint64_t offset = 0;
     for (;;)
     {
@@ -1513,6 +1541,7 @@ Error
 Platform::LaunchNativeProcess (
     ProcessLaunchInfo &launch_info,
     lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+    MainLoopBase &mainloop,
     NativeProcessProtocolSP &process_sp)
 {
     // Platforms should override this implementation if they want to
@@ -1523,6 +1552,7 @@ Platform::LaunchNativeProcess (
 Error
 Platform::AttachNativeProcess (lldb::pid_t pid,
                                lldb_private::NativeProcessProtocol::NativeDelegate &native_delegate,
+                               MainLoopBase &mainloop,
                                NativeProcessProtocolSP &process_sp)
 {
     // Platforms should override this implementation if they want to
@@ -1836,68 +1866,40 @@ Platform::GetCachedSharedModule (const ModuleSpec &module_spec,
 
     Log *log = GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PLATFORM);
 
-    // Check local cache for a module.
-    auto error = m_module_cache->Get (GetModuleCacheRoot (),
-                                      GetCacheHostname (),
-                                      module_spec,
-                                      module_sp,
-                                      did_create_ptr);
-    if (error.Success ())
-        return true;
-
-    if (log)
-        log->Printf("Platform::%s - module %s not found in local cache: %s",
-                    __FUNCTION__, module_spec.GetUUID ().GetAsString ().c_str (), error.AsCString ());
-
-    // Get temporary file name for a downloaded module.
-    llvm::SmallString<PATH_MAX> tmp_download_file_path;
-    const auto err_code = llvm::sys::fs::createTemporaryFile (
-        "lldb", module_spec.GetUUID ().GetAsString ().c_str (), tmp_download_file_path);
-    if (err_code)
-    {
-        if (log)
-            log->Printf ("Platform::%s - failed to create unique file: %s",
-                         __FUNCTION__, err_code.message ().c_str ());
-        return false;
-    }
-
-    llvm::FileRemover tmp_file_remover (tmp_download_file_path.c_str ());
-
-    const FileSpec tmp_download_file_spec (tmp_download_file_path.c_str (), true);
-    // Download a module file.
-    error = DownloadModuleSlice (module_spec.GetFileSpec (),
-                                 module_spec.GetObjectOffset (),
-                                 module_spec.GetObjectSize (),
-                                 tmp_download_file_spec);
+    // Check local cache for a module, downloading it if it isn't there.
+    bool downloaded = false;
+    auto error = m_module_cache->GetAndPut (
+        GetModuleCacheRoot (),
+        GetCacheHostname (),
+        module_spec,
+        [this, &downloaded] (const ModuleSpec &download_module_spec, const FileSpec &tmp_download_file_spec)
+        {
+            downloaded = true;
+            return DownloadModuleSlice (download_module_spec.GetFileSpec (),
+                                        download_module_spec.GetObjectOffset (),
+                                        download_module_spec.GetObjectSize (),
+                                        tmp_download_file_spec);
+        },
+        module_sp,
+        did_create_ptr);
     if (error.Fail ())
     {
         if (log)
-            log->Printf("Platform::%s - failed to download %s to %s: %s",
-                        __FUNCTION__, module_spec.GetFileSpec ().GetPath ().c_str (),
-                        tmp_download_file_path.c_str (), error.AsCString ());
+            log->Printf("Platform::%s - failed to get module %s from cache: %s",
+                        __FUNCTION__, module_spec.GetUUID ().GetAsString ().c_str (), error.AsCString ());
         return false;
     }
 
-    // Put downloaded file into local module cache.
-    error = m_module_cache->Put (GetModuleCacheRoot (),
-                                 GetCacheHostname (),
-                                 module_spec,
-                                 tmp_download_file_spec);
-    if (error.Fail ())
+    // Now that the new module is in use, make room for it.
+    const auto max_cache_size = GetGlobalPlatformProperties ()->GetModuleCacheMaxSize ();
+    if (downloaded && max_cache_size > 0)
     {
-        if (log)
-            log->Printf("Platform::%s - failed to put module %s into cache: %s",
-                        __FUNCTION__, module_spec.GetUUID ().GetAsString ().c_str (),
-                        error.AsCString ());
-        return false;
+        error = m_module_cache->Trim (GetModuleCacheRoot (), max_cache_size);
+        if (error.Fail () && log)
+            log->Printf("Platform::%s - failed to trim module cache: %s",
+                        __FUNCTION__, error.AsCString ());
     }
-
-    error = m_module_cache->Get (GetModuleCacheRoot (),
-                                 GetCacheHostname (),
-                                 module_spec,
-                                 module_sp,
-                                 did_create_ptr);
-    return error.Success ();
+    return true;
 }
 
 Error
@@ -1907,8 +1909,29 @@ Platform::DownloadModuleSlice (const FileSpec& src_file_spec,
                                const FileSpec& dst_file_spec)
 {
     Error error;
+    Log *log = GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PLATFORM);
+
+    // A previous, interrupted download can only be resumed when the slice
+    // is the whole file: the assembled file is then checked against the
+    // remote MD5, which catches a remote file that changed in between.
+    uint64_t remote_low = 0, remote_high = 0;
+    const bool can_verify = src_offset == 0 &&
+                            src_size == GetFileSize (src_file_spec) &&
+                            CalculateMD5 (src_file_spec, remote_low, remote_high);
 
-    std::ofstream dst (dst_file_spec.GetPath(), std::ios::out | std::ios::binary);
+    uint64_t total_bytes_read = 0;
+    if (can_verify && dst_file_spec.Exists ())
+    {
+        total_bytes_read = dst_file_spec.GetByteSize ();
+        if (total_bytes_read > src_size)
+            total_bytes_read = 0;
+        else if (total_bytes_read > 0 && log)
+            log->Printf ("Platform::%s - resuming download of %s at offset %" PRIu64,
+                         __FUNCTION__, src_file_spec.GetPath ().c_str (), total_bytes_read);
+    }
+
+    std::ofstream dst (dst_file_spec.GetPath(),
+                       std::ios::out | std::ios::binary | (total_bytes_read > 0 ? std::ios::app : std::ios::trunc));
     if (!dst.is_open())
     {
         error.SetErrorStringWithFormat ("unable to open destination file: %s", dst_file_spec.GetPath ().c_str ());
@@ -1926,28 +1949,53 @@ Platform::DownloadModuleSlice (const FileSpec& src_file_spec,
        return error;
    }
 
-    std::vector<char> buffer (1024);
-    auto offset = src_offset;
-    uint64_t total_bytes_read = 0;
+    std::vector<char> buffer (k_bulk_transfer_size);
+    auto offset = src_offset + total_bytes_read;
     while (total_bytes_read < src_size)
     {
         const auto to_read = std::min (static_cast<uint64_t>(buffer.size ()), src_size - total_bytes_read);
         const uint64_t n_read = ReadFile (src_fd, offset, &buffer[0], to_read, error);
         if (error.Fail ())
             break;
-        if (n_read == 0)
+        // The slice size is known, so a short read means the remote file
+        // is shorter than expected.
+        if (n_read != to_read)
         {
-            error.SetErrorString ("read 0 bytes");
+            error.SetErrorStringWithFormat ("short read at offset %" PRIu64 ": %" PRIu64 " of %" PRIu64 " bytes read",
+                                            offset, n_read, to_read);
+            break;
+        }
+        if (!dst.write (&buffer[0], n_read))
+        {
+            error.SetErrorStringWithFormat ("failed to write to %s", dst_file_spec.GetPath ().c_str ());
             break;
         }
         offset += n_read;
         total_bytes_read += n_read;
-        dst.write (&buffer[0], n_read);
     }
+    dst.close ();
+    if (error.Success () && !dst)
+        error.SetErrorStringWithFormat ("failed to write to %s", dst_file_spec.GetPath ().c_str ());
 
     Error close_error;
     CloseFile (src_fd, close_error);  // Ignoring close error.
 
+    if (error.Fail ())
+        return error;
+
+    // Make sure what we assembled (possibly across several resumed
+    // transfers) matches the remote copy.
+    if (can_verify)
+    {
+        uint64_t local_low, local_high;
+        if (!FileSystem::CalculateMD5 (dst_file_spec, local_low, local_high) ||
+            local_low != remote_low || local_high != remote_high)
+        {
+            FileSystem::Unlink (dst_file_spec.GetPath ().c_str ());
+            error.SetErrorStringWithFormat ("MD5 mismatch for downloaded file %s", src_file_spec.GetPath ().c_str ());
+        }
+    }
+
     return error;
 }
 
@@ -729,6 +729,10 @@ Process::Process(Target &target, Listener &listener, const UnixSignalsSP &unix_s
     m_image_tokens (),
     m_listener (listener),
     m_breakpoint_site_list (),
+    m_breakpoint_site_batch_mutex (Mutex::eMutexTypeRecursive),
+    m_breakpoint_site_batch_depth (0),
+    m_pending_enable_sites (),
+    m_pending_disable_sites (),
     m_dynamic_checkers_ap (),
     m_unix_signals_sp (unix_signals_sp),
     m_abi_sp (),
@@ -2126,13 +2130,166 @@ Process::GetBreakpointSiteList() const
 }
 
 
+// Breakpoint site failures are only worth reporting once the process is
+// up and running; during launch and attach they are expected.
+static bool
+ShouldShowBreakpointSiteErrors (Process &process)
+{
+    bool show_error = true;
+    switch (process.GetState())
+    {
+        case eStateInvalid:
+        case eStateUnloaded:
+        case eStateConnected:
+        case eStateAttaching:
+        case eStateLaunching:
+        case eStateDetached:
+        case eStateExited:
+            show_error = false;
+            break;
+            
+        case eStateStopped:
+        case eStateRunning:
+        case eStateStepping:
+        case eStateCrashed:
+        case eStateSuspended:
+            show_error = process.IsAlive();
+            break;
+    }
+    return show_error;
+}
+
 void
 Process::DisableAllBreakpointSites ()
 {
-    m_breakpoint_site_list.ForEach([this](BreakpointSite *bp_site) -> void {
-//        bp_site->SetEnabled(true);
-        DisableBreakpointSite(bp_site);
+    std::vector<BreakpointSite *> bp_sites;
+    m_breakpoint_site_list.ForEach([&bp_sites](BreakpointSite *bp_site) -> void {
+        bp_sites.push_back (bp_site);
     });
+
+    std::vector<Error> errors;
+    DisableBreakpointSites (bp_sites, errors);
+}
+
+void
+Process::EnableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors)
+{
+    errors.clear();
+    for (BreakpointSite *bp_site : bp_sites)
+        errors.push_back (EnableBreakpointSite (bp_site));
+}
+
+void
+Process::DisableBreakpointSites (const std::vector<BreakpointSite *> &bp_sites, std::vector<Error> &errors)
+{
+    errors.clear();
+    for (BreakpointSite *bp_site : bp_sites)
+        errors.push_back (DisableBreakpointSite (bp_site));
+}
+
+Process::BreakpointSiteBatch::BreakpointSiteBatch (const ProcessSP &process_sp) :
+    m_process_sp (process_sp)
+{
+    if (m_process_sp)
+        m_process_sp->BeginBreakpointSiteBatch ();
+}
+
+Process::BreakpointSiteBatch::~BreakpointSiteBatch ()
+{
+    if (m_process_sp)
+        m_process_sp->EndBreakpointSiteBatch ();
+}
+
+void
+Process::BeginBreakpointSiteBatch ()
+{
+    // Released by the matching EndBreakpointSiteBatch(), once the queued
+    // sites have been applied.
+    m_breakpoint_site_batch_mutex.Lock();
+    ++m_breakpoint_site_batch_depth;
+}
+
+void
+Process::EndBreakpointSiteBatch ()
+{
+    assert (m_breakpoint_site_batch_depth > 0);
+    if (--m_breakpoint_site_batch_depth == 0)
+        ApplyBreakpointSiteBatch ();
+    m_breakpoint_site_batch_mutex.Unlock();
+}
+
+void
+Process::ApplyBreakpointSiteBatch ()
+{
+
+    // Take the queues before acting on them; clearing a site that failed to
+    // enable calls back into RemoveOwnerFromBreakpointSite.
+    std::vector<BreakpointSiteSP> disable_sites;
+    disable_sites.swap (m_pending_disable_sites);
+    std::vector<BreakpointSiteSP> enable_sites;
+    for (auto &pos : m_pending_enable_sites)
+        enable_sites.push_back (pos.second);
+    m_pending_enable_sites.clear();
+
+    if (!disable_sites.empty())
+    {
+        // A site that picked up a new owner later in the batch stays.
+        std::vector<BreakpointSite *> bp_sites;
+        for (const BreakpointSiteSP &bp_site_sp : disable_sites)
+        {
+            if (bp_site_sp->GetNumberOfOwners() == 0)
+                bp_sites.push_back (bp_site_sp.get());
+        }
+
+        // Don't try to disable the sites if we don't have a live process anymore.
+        if (IsAlive())
+        {
+            std::vector<Error> errors;
+            DisableBreakpointSites (bp_sites, errors);
+        }
+        for (BreakpointSite *bp_site : bp_sites)
+            m_breakpoint_site_list.RemoveByAddress (bp_site->GetLoadAddress());
+    }
+
+    if (!enable_sites.empty())
+    {
+        std::vector<BreakpointSite *> bp_sites;
+        for (const BreakpointSiteSP &bp_site_sp : enable_sites)
+            bp_sites.push_back (bp_site_sp.get());
+
+        std::vector<Error> errors;
+        EnableBreakpointSites (bp_sites, errors);
+
+        const bool show_error = ShouldShowBreakpointSiteErrors (*this);
+        for (size_t i = 0; i < enable_sites.size(); ++i)
+        {
+            BreakpointSiteSP &bp_site_sp = enable_sites[i];
+            if (i < errors.size() && errors[i].Success())
+            {
+                m_breakpoint_site_list.Add (bp_site_sp);
+                continue;
+            }
+
+            const char *error_cstr = i < errors.size() ? errors[i].AsCString() : nullptr;
+            if (show_error && bp_site_sp->GetNumberOfOwners() > 0)
+            {
+                BreakpointLocationSP owner (bp_site_sp->GetOwnerAtIndex (0));
+                m_target.GetDebugger().GetErrorFile()->Printf ("warning: failed to set breakpoint site at 0x%" PRIx64 " for breakpoint %i.%i: %s\n",
+                                                               bp_site_sp->GetLoadAddress(),
+                                                               owner->GetBreakpoint().GetID(),
+                                                               owner->GetID(),
+                                                               error_cstr ? error_cstr : "unknown error");
+            }
+
+            // Detach the owners, as CreateBreakpointSite would have by not
+            // handing the site out in the first place.
+            std::vector<BreakpointLocationSP> owners;
+            for (size_t j = 0; j < bp_site_sp->GetNumberOfOwners(); ++j)
+                owners.push_back (bp_site_sp->GetOwnerAtIndex (j));
+            for (BreakpointLocationSP &owner : owners)
+                owner->ClearBreakpointSite();
+        }
+    }
 }
 
 Error
@@ -2184,29 +2341,11 @@ Process::EnableBreakpointSiteByID (lldb::user_id_t break_id)
 lldb::break_id_t
 Process::CreateBreakpointSite (const BreakpointLocationSP &owner, bool use_hardware)
 {
+    Mutex::Locker locker (m_breakpoint_site_batch_mutex);
+
     addr_t load_addr = LLDB_INVALID_ADDRESS;
     
-    bool show_error = true;
-    switch (GetState())
-    {
-        case eStateInvalid:
-        case eStateUnloaded:
-        case eStateConnected:
-        case eStateAttaching:
-        case eStateLaunching:
-        case eStateDetached:
-        case eStateExited:
-            show_error = false;
-            break;
-            
-        case eStateStopped:
-        case eStateRunning:
-        case eStateStepping:
-        case eStateCrashed:
-        case eStateSuspended:
-            show_error = IsAlive();
-            break;
-    }
+    const bool show_error = ShouldShowBreakpointSiteErrors (*this);
 
     // Reset the IsIndirect flag here, in case the location changes from
     // pointing to a indirect symbol to a regular symbol.
@@ -2247,6 +2386,14 @@ Process::CreateBreakpointSite (const BreakpointLocationSP &owner, bool use_hardw
 
         bp_site_sp = m_breakpoint_site_list.FindByAddress (load_addr);
 
+        // Sites created earlier in the current batch aren't in the list yet.
+        if (!bp_site_sp && m_breakpoint_site_batch_depth > 0)
+        {
+            auto pos = m_pending_enable_sites.find (load_addr);
+            if (pos != m_pending_enable_sites.end())
+                bp_site_sp = pos->second;
+        }
+
         if (bp_site_sp)
         {
             bp_site_sp->AddOwner (owner);
@@ -2258,6 +2405,14 @@ Process::CreateBreakpointSite (const BreakpointLocationSP &owner, bool use_hardw
             bp_site_sp.reset (new BreakpointSite (&m_breakpoint_site_list, owner, load_addr, use_hardware));
             if (bp_site_sp)
             {
+                if (m_breakpoint_site_batch_depth > 0)
+                {
+                    // Enable it, and add it to the list, when the batch ends.
+                    owner->SetBreakpointSite (bp_site_sp);
+                    m_pending_enable_sites[load_addr] = bp_site_sp;
+                    return bp_site_sp->GetID();
+                }
+
                 Error error = EnableBreakpointSite (bp_site_sp.get());
                 if (error.Success())
                 {
@@ -2287,9 +2442,23 @@ Process::CreateBreakpointSite (const BreakpointLocationSP &owner, bool use_hardw
 void
 Process::RemoveOwnerFromBreakpointSite (lldb::user_id_t owner_id, lldb::user_id_t owner_loc_id, BreakpointSiteSP &bp_site_sp)
 {
+    Mutex::Locker locker (m_breakpoint_site_batch_mutex);
+
     uint32_t num_owners = bp_site_sp->RemoveOwner (owner_id, owner_loc_id);
     if (num_owners == 0)
     {
+        if (m_breakpoint_site_batch_depth > 0)
+        {
+            // A site that was never enabled can just be dropped, anything
+            // else is disabled and removed when the batch ends.
+            auto pos = m_pending_enable_sites.find (bp_site_sp->GetLoadAddress());
+            if (pos != m_pending_enable_sites.end() && pos->second == bp_site_sp)
+                m_pending_enable_sites.erase (pos);
+            else if (std::find (m_pending_disable_sites.begin(), m_pending_disable_sites.end(), bp_site_sp) == m_pending_disable_sites.end())
+                m_pending_disable_sites.push_back (bp_site_sp);
+            return;
+        }
+
         // Don't try to disable the site if we don't have a live process anymore.
         if (IsAlive())
             DisableBreakpointSite (bp_site_sp.get());
@@ -2302,27 +2471,23 @@ size_t
 Process::RemoveBreakpointOpcodesFromBuffer (addr_t bp_addr, size_t size, uint8_t *buf) const
 {
     size_t bytes_removed = 0;
-    BreakpointSiteList bp_sites_in_range;
 
-    if (m_breakpoint_site_list.FindInRange (bp_addr, bp_addr + size, bp_sites_in_range))
-    {
-        bp_sites_in_range.ForEach([bp_addr, size, buf, &bytes_removed](BreakpointSite *bp_site) -> void {
-            if (bp_site->GetType() == BreakpointSite::eSoftware)
+    m_breakpoint_site_list.ForEachInRange (bp_addr, bp_addr + size, [bp_addr, size, buf, &bytes_removed](BreakpointSite *bp_site) -> void {
+        if (bp_site->GetType() == BreakpointSite::eSoftware)
+        {
+            addr_t intersect_addr;
+            size_t intersect_size;
+            size_t opcode_offset;
+            if (bp_site->IntersectsRange(bp_addr, size, &intersect_addr, &intersect_size, &opcode_offset))
             {
-                addr_t intersect_addr;
-                size_t intersect_size;
-                size_t opcode_offset;
-                if (bp_site->IntersectsRange(bp_addr, size, &intersect_addr, &intersect_size, &opcode_offset))
-                {
-                    assert(bp_addr <= intersect_addr && intersect_addr < bp_addr + size);
-                    assert(bp_addr < intersect_addr + intersect_size && intersect_addr + intersect_size <= bp_addr + size);
-                    assert(opcode_offset + intersect_size <= bp_site->GetByteSize());
-                    size_t buf_offset = intersect_addr - bp_addr;
-                    ::memcpy(buf + buf_offset, bp_site->GetSavedOpcodeBytes() + opcode_offset, intersect_size);
-                }
+                assert(bp_addr <= intersect_addr && intersect_addr < bp_addr + size);
+                assert(bp_addr < intersect_addr + intersect_size && intersect_addr + intersect_size <= bp_addr + size);
+                assert(opcode_offset + intersect_size <= bp_site->GetByteSize());
+                size_t buf_offset = intersect_addr - bp_addr;
+                ::memcpy(buf + buf_offset, bp_site->GetSavedOpcodeBytes() + opcode_offset, intersect_size);
             }
-        });
-    }
+        }
+    });
     return bytes_removed;
 }
 
@@ -2711,6 +2876,15 @@ Process::ReadMemoryFromInferior (addr_t addr, void *buf, size_t size, Error &err
     return bytes_read;
 }
 
+size_t
+Process::PrefetchMemory (addr_t addr, size_t size, Error &error)
+{
+    error.Clear();
+    if (GetDisableMemoryCache())
+        return 0;
+    return m_memory_cache.Prefetch (addr, size, error);
+}
+
 uint64_t
 Process::ReadUnsignedIntegerFromMemory (lldb::addr_t vm_addr, size_t integer_byte_size, uint64_t fail_value, Error &error)
 {
@@ -2780,72 +2954,60 @@ Process::WriteMemory (addr_t addr, const void *buf, size_t size, Error &error)
     // (enabled software breakpoints) any software traps (breakpoints) that we
     // may have placed in our tasks memory.
 
-    BreakpointSiteList bp_sites_in_range;
-    
-    if (m_breakpoint_site_list.FindInRange (addr, addr + size, bp_sites_in_range))
-    {
-        // No breakpoint sites overlap
-        if (bp_sites_in_range.IsEmpty())
-            return WriteMemoryPrivate (addr, buf, size, error);
-        else
-        {
-            const uint8_t *ubuf = (const uint8_t *)buf;
-            uint64_t bytes_written = 0;
+    const uint8_t *ubuf = (const uint8_t *)buf;
+    uint64_t bytes_written = 0;
 
-            bp_sites_in_range.ForEach([this, addr, size, &bytes_written, &ubuf, &error](BreakpointSite *bp) -> void {
-                
-                if (error.Success())
+    const size_t num_bp_sites = m_breakpoint_site_list.ForEachInRange (addr, addr + size, [this, addr, size, &bytes_written, &ubuf, &error](BreakpointSite *bp) -> void {
+        
+        if (error.Success())
+        {
+            addr_t intersect_addr;
+            size_t intersect_size;
+            size_t opcode_offset;
+            const bool intersects = bp->IntersectsRange(addr, size, &intersect_addr, &intersect_size, &opcode_offset);
+            assert(intersects);
+            assert(addr <= intersect_addr && intersect_addr < addr + size);
+            assert(addr < intersect_addr + intersect_size && intersect_addr + intersect_size <= addr + size);
+            assert(opcode_offset + intersect_size <= bp->GetByteSize());
+            
+            // Check for bytes before this breakpoint
+            const addr_t curr_addr = addr + bytes_written;
+            if (intersect_addr > curr_addr)
+            {
+                // There are some bytes before this breakpoint that we need to
+                // just write to memory
+                size_t curr_size = intersect_addr - curr_addr;
+                size_t curr_bytes_written = WriteMemoryPrivate (curr_addr,
+                                                                ubuf + bytes_written,
+                                                                curr_size,
+                                                                error);
+                bytes_written += curr_bytes_written;
+                if (curr_bytes_written != curr_size)
                 {
-                    addr_t intersect_addr;
-                    size_t intersect_size;
-                    size_t opcode_offset;
-                    const bool intersects = bp->IntersectsRange(addr, size, &intersect_addr, &intersect_size, &opcode_offset);
-                    assert(intersects);
-                    assert(addr <= intersect_addr && intersect_addr < addr + size);
-                    assert(addr < intersect_addr + intersect_size && intersect_addr + intersect_size <= addr + size);
-                    assert(opcode_offset + intersect_size <= bp->GetByteSize());
-                    
-                    // Check for bytes before this breakpoint
-                    const addr_t curr_addr = addr + bytes_written;
-                    if (intersect_addr > curr_addr)
-                    {
-                        // There are some bytes before this breakpoint that we need to
-                        // just write to memory
-                        size_t curr_size = intersect_addr - curr_addr;
-                        size_t curr_bytes_written = WriteMemoryPrivate (curr_addr,
-                                                                        ubuf + bytes_written,
-                                                                        curr_size,
-                                                                        error);
-                        bytes_written += curr_bytes_written;
-                        if (curr_bytes_written != curr_size)
-                        {
-                            // We weren't able to write all of the requested bytes, we
-                            // are done looping and will return the number of bytes that
-                            // we have written so far.
-                            if (error.Success())
-                                error.SetErrorToGenericError();
-                        }
-                    }
-                    // Now write any bytes that would cover up any software breakpoints
-                    // directly into the breakpoint opcode buffer
-                    ::memcpy(bp->GetSavedOpcodeBytes() + opcode_offset, ubuf + bytes_written, intersect_size);
-                    bytes_written += intersect_size;
+                    // We weren't able to write all of the requested bytes, we
+                    // are done looping and will return the number of bytes that
+                    // we have written so far.
+                    if (error.Success())
+                        error.SetErrorToGenericError();
                 }
-            });
-            
-            if (bytes_written < size)
-                WriteMemoryPrivate (addr + bytes_written,
-                                    ubuf + bytes_written,
-                                    size - bytes_written,
-                                    error);
+            }
+            // Now write any bytes that would cover up any software breakpoints
+            // directly into the breakpoint opcode buffer
+            ::memcpy(bp->GetSavedOpcodeBytes() + opcode_offset, ubuf + bytes_written, intersect_size);
+            bytes_written += intersect_size;
         }
-    }
-    else
-    {
+    });
+
+    // No breakpoint sites overlap
+    if (num_bp_sites == 0)
         return WriteMemoryPrivate (addr, buf, size, error);
-    }
 
     // Write any remaining bytes after the last breakpoint if we have any left
+    if (bytes_written < size)
+        WriteMemoryPrivate (addr + bytes_written,
+                            ubuf + bytes_written,
+                            size - bytes_written,
+                            error);
     return 0; //bytes_written;
 }
 
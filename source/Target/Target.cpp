@@ -686,6 +686,7 @@ Target::RemoveAllBreakpoints (bool internal_also)
     if (log)
         log->Printf ("Target::%s (internal_also = %s)\n", __FUNCTION__, internal_also ? "yes" : "no");
 
+    Process::BreakpointSiteBatch batch (m_process_sp);
     m_breakpoint_list.RemoveAll (true);
     if (internal_also)
         m_internal_breakpoint_list.RemoveAll (false);
@@ -700,6 +701,7 @@ Target::DisableAllBreakpoints (bool internal_also)
     if (log)
         log->Printf ("Target::%s (internal_also = %s)\n", __FUNCTION__, internal_also ? "yes" : "no");
 
+    Process::BreakpointSiteBatch batch (m_process_sp);
     m_breakpoint_list.SetEnabledAll (false);
     if (internal_also)
         m_internal_breakpoint_list.SetEnabledAll (false);
@@ -712,6 +714,7 @@ Target::EnableAllBreakpoints (bool internal_also)
     if (log)
         log->Printf ("Target::%s (internal_also = %s)\n", __FUNCTION__, internal_also ? "yes" : "no");
 
+    Process::BreakpointSiteBatch batch (m_process_sp);
     m_breakpoint_list.SetEnabledAll (true);
     if (internal_also)
         m_internal_breakpoint_list.SetEnabledAll (true);
@@ -371,6 +371,11 @@ ThreadPlanStepRange::SetNextBranchBreakpoint ()
     if (!m_use_fast_step)
          return false;
 
+    // If the process can step through the whole range without stopping,
+    // that is cheaper than running to each branch and stepping over it.
+    if (m_thread.GetProcess()->SupportsRangeStepping())
+        return false;
+
     lldb::addr_t cur_addr = GetThread().GetRegisterContext()->GetPC();
     // Find the current address in our address ranges, and fetch the disassembly if we haven't already:
     size_t pc_index;
@@ -479,6 +484,32 @@ ThreadPlanStepRange::GetPlanRunState ()
         return eStateStepping;
 }
 
+bool
+ThreadPlanStepRange::GetStepRange (lldb::addr_t &range_start, lldb::addr_t &range_end)
+{
+    // When running to the next branch breakpoint we aren't stepping at all
+    if (m_next_branch_bp_sp)
+        return false;
+
+    Target *target = m_thread.CalculateTarget().get();
+    const lldb::addr_t pc_load_addr = m_thread.GetRegisterContext()->GetPC();
+    const size_t num_ranges = m_address_ranges.size();
+    for (size_t i = 0; i < num_ranges; i++)
+    {
+        const lldb::addr_t start = m_address_ranges[i].GetBaseAddress().GetLoadAddress(target);
+        if (start == LLDB_INVALID_ADDRESS)
+            continue;
+        const lldb::addr_t end = start + m_address_ranges[i].GetByteSize();
+        if (start <= pc_load_addr && pc_load_addr < end)
+        {
+            range_start = start;
+            range_end = end;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool
 ThreadPlanStepRange::MischiefManaged ()
 {
@@ -0,0 +1,161 @@
+//===-- HexCodec.cpp --------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "lldb/Utility/HexCodec.h"
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace lldb_private;
+
+static const char g_hex_chars[] = "0123456789abcdef";
+
+static inline int
+xdigit_to_sint (char ch)
+{
+    if (ch >= 'a' && ch <= 'f')
+        return 10 + ch - 'a';
+    if (ch >= 'A' && ch <= 'F')
+        return 10 + ch - 'A';
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    return -1;
+}
+
+#if defined(__SSE2__)
+
+// Convert 16 nibbles (0-15) to their lowercase ASCII hex characters
+static inline __m128i
+NibblesToHexChars (__m128i nibbles)
+{
+    const __m128i is_letter = _mm_cmpgt_epi8 (nibbles, _mm_set1_epi8 (9));
+    const __m128i chars = _mm_add_epi8 (nibbles, _mm_set1_epi8 ('0'));
+    return _mm_add_epi8 (chars, _mm_and_si128 (is_letter, _mm_set1_epi8 ('a' - '0' - 10)));
+}
+
+// Convert 16 ASCII hex characters to their values. Lanes of "valid" are
+// set to 0xff for the characters that are hex digits and 0 otherwise.
+static inline __m128i
+HexCharsToNibbles (__m128i chars, __m128i &valid)
+{
+    // SSE2 has no unsigned byte compare, but x <= n exactly when min(x, n) == x
+    const __m128i digit = _mm_sub_epi8 (chars, _mm_set1_epi8 ('0'));
+    const __m128i is_digit = _mm_cmpeq_epi8 (_mm_min_epu8 (digit, _mm_set1_epi8 (9)), digit);
+    const __m128i letter = _mm_sub_epi8 (_mm_or_si128 (chars, _mm_set1_epi8 (0x20)), _mm_set1_epi8 ('a'));
+    const __m128i is_letter = _mm_cmpeq_epi8 (_mm_min_epu8 (letter, _mm_set1_epi8 (5)), letter);
+    valid = _mm_or_si128 (is_digit, is_letter);
+    return _mm_or_si128 (_mm_and_si128 (is_digit, digit),
+                         _mm_and_si128 (is_letter, _mm_add_epi8 (letter, _mm_set1_epi8 (10))));
+}
+
+// Combine pairs of nibbles into bytes. Each 16 bit lane holds the high
+// nibble in its low byte and the low nibble in its high byte, and the
+// byte is left in the low byte of the lane.
+static inline __m128i
+CombineNibblePairs (__m128i nibbles)
+{
+    return _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (nibbles, _mm_set1_epi16 (0x00ff)), 4),
+                         _mm_srli_epi16 (nibbles, 8));
+}
+
+#endif
+
+// Find the first byte in src that is equal to any of a, b, c or d
+static size_t
+FindFirstOf (const uint8_t *src, size_t src_len, uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8 (a);
+    const __m128i vb = _mm_set1_epi8 (b);
+    const __m128i vc = _mm_set1_epi8 (c);
+    const __m128i vd = _mm_set1_epi8 (d);
+    for (; i + 16 <= src_len; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128 ((const __m128i *)(src + i));
+        const __m128i matches = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (bytes, va), _mm_cmpeq_epi8 (bytes, vb)),
+                                              _mm_or_si128 (_mm_cmpeq_epi8 (bytes, vc), _mm_cmpeq_epi8 (bytes, vd)));
+        const int mask = _mm_movemask_epi8 (matches);
+        if (mask)
+            return i + __builtin_ctz (mask);
+    }
+#endif
+    for (; i < src_len; ++i)
+    {
+        const uint8_t byte = src[i];
+        if (byte == a || byte == b || byte == c || byte == d)
+            return i;
+    }
+    return src_len;
+}
+
+size_t
+lldb_private::EncodeHexBytes (const void *src_void, size_t src_len, char *dst)
+{
+    const uint8_t *src = (const uint8_t *)src_void;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i low_nibble_mask = _mm_set1_epi8 (0x0f);
+    for (; i + 16 <= src_len; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128 ((const __m128i *)(src + i));
+        const __m128i hi = NibblesToHexChars (_mm_and_si128 (_mm_srli_epi16 (bytes, 4), low_nibble_mask));
+        const __m128i lo = NibblesToHexChars (_mm_and_si128 (bytes, low_nibble_mask));
+        _mm_storeu_si128 ((__m128i *)(dst + 2 * i), _mm_unpacklo_epi8 (hi, lo));
+        _mm_storeu_si128 ((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8 (hi, lo));
+    }
+#endif
+    for (; i < src_len; ++i)
+    {
+        dst[2 * i] = g_hex_chars[src[i] >> 4];
+        dst[2 * i + 1] = g_hex_chars[src[i] & 0xf];
+    }
+    return 2 * src_len;
+}
+
+size_t
+lldb_private::DecodeHexBytes (const char *src, size_t src_len, void *dst_void, size_t dst_len)
+{
+    uint8_t *dst = (uint8_t *)dst_void;
+    size_t decoded = 0;
+#if defined(__SSE2__)
+    for (; decoded + 16 <= dst_len && 2 * (decoded + 16) <= src_len; decoded += 16)
+    {
+        __m128i first_valid, second_valid;
+        const __m128i first = HexCharsToNibbles (_mm_loadu_si128 ((const __m128i *)(src + 2 * decoded)), first_valid);
+        const __m128i second = HexCharsToNibbles (_mm_loadu_si128 ((const __m128i *)(src + 2 * decoded + 16)), second_valid);
+        if (_mm_movemask_epi8 (_mm_and_si128 (first_valid, second_valid)) != 0xffff)
+            break; // Let the scalar loop find the first invalid pair
+        _mm_storeu_si128 ((__m128i *)(dst + decoded), _mm_packus_epi16 (CombineNibblePairs (first), CombineNibblePairs (second)));
+    }
+#endif
+    for (; decoded < dst_len && 2 * decoded + 1 < src_len; ++decoded)
+    {
+        const int hi_nibble = xdigit_to_sint (src[2 * decoded]);
+        const int lo_nibble = xdigit_to_sint (src[2 * decoded + 1]);
+        if (hi_nibble == -1 || lo_nibble == -1)
+            break;
+        dst[decoded] = (uint8_t)((hi_nibble << 4) + lo_nibble);
+    }
+    return decoded;
+}
+
+size_t
+lldb_private::FindGDBRemoteEscapeChar (const void *src, size_t src_len)
+{
+    return FindFirstOf ((const uint8_t *)src, src_len, '#', '$', '}', '*');
+}
+
+size_t
+lldb_private::FindGDBRemoteDecodeChar (const char *src, size_t src_len)
+{
+    return FindFirstOf ((const uint8_t *)src, src_len, '}', '*', '}', '*');
+}
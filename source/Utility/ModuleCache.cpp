@@ -9,21 +9,35 @@
 
 #include "ModuleCache.h"
 
+#include "lldb/Core/Log.h"
 #include "lldb/Core/Module.h"
 #include "lldb/Core/ModuleSpec.h"
 #include "lldb/Host/FileSystem.h"
+#include "lldb/Host/TimeValue.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 
 #include <assert.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
 
+#include <algorithm>
 #include <cstdio>
-#
+#include <fstream>
+#include <vector>
+
 using namespace lldb;
 using namespace lldb_private;
 
 namespace {
 
 const char* kModulesSubdir = ".cache";
+const char* kDownloadFileSuffix = ".partial";
+const char* kLockDirName = ".lock";
+const char* kAccessStampFileName = ".stamp";
 
 FileSpec
 JoinPath (const FileSpec &path1, const char* path2)
@@ -48,8 +62,159 @@ MakeDirectory (const FileSpec &dir_path)
                                       eFilePermissionsDirectoryDefault);
 }
 
+//----------------------------------------------------------------------
+// Advisory lock on a module's UUID directory. Every lldb process that
+// shares the cache root takes it before downloading, publishing, using or
+// evicting the module in that directory.
+//
+// The lock files live in ${CACHE_ROOT}/.lock rather than in the UUID
+// directories, so evicting a module never unlinks a lock file that
+// another process has open and is about to lock.
+//----------------------------------------------------------------------
+class ModuleLock
+{
+public:
+    ModuleLock (const FileSpec &root_dir_spec, const char *uuid_str, bool exclusive, bool wait) :
+        m_fd (-1),
+        m_locked (false)
+    {
+#if defined(_WIN32)
+        // No cross-process locking on Windows, only atomic publishing.
+        m_locked = true;
+#else
+        const auto lock_dir_spec = JoinPath (root_dir_spec, kLockDirName);
+        if (MakeDirectory (lock_dir_spec).Fail ())
+            return;
+        const auto lock_file_path = JoinPath (lock_dir_spec, uuid_str).GetPath ();
+        m_fd = ::open (lock_file_path.c_str (), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd == -1)
+            return;
+        int operation = exclusive ? LOCK_EX : LOCK_SH;
+        if (!wait)
+            operation |= LOCK_NB;
+        m_locked = ::flock (m_fd, operation) == 0;
+#endif
+    }
+
+    ~ModuleLock ()
+    {
+#if !defined(_WIN32)
+        if (m_fd != -1)
+            ::close (m_fd); // Releases the lock
+#endif
+    }
+
+    bool
+    IsLocked () const
+    {
+        return m_locked;
+    }
+
+private:
+    int m_fd;
+    bool m_locked;
+};
+
+// Record that the module in module_dir_spec was just used. Trim() evicts
+// the modules with the oldest stamps first.
+void
+TouchAccessStamp (const FileSpec &module_dir_spec)
+{
+    std::ofstream stamp (JoinPath (module_dir_spec, kAccessStampFileName).GetPath (),
+                         std::ios::out | std::ios::trunc);
+}
+
+struct CacheEntry
+{
+    CacheEntry () :
+        last_used (0),
+        size (0)
+    {
+    }
+
+    FileSpec dir_spec;
+    uint64_t last_used;
+    uint64_t size;
+};
+
+FileSpec::EnumerateDirectoryResult
+AddFileSize (void *baton, FileSpec::FileType file_type, const FileSpec &file_spec)
+{
+    if (file_type == FileSpec::eFileTypeRegular)
+        static_cast<CacheEntry *> (baton)->size += file_spec.GetByteSize ();
+    return FileSpec::eEnumerateDirectoryResultNext;
+}
+
+FileSpec::EnumerateDirectoryResult
+AddCacheEntry (void *baton, FileSpec::FileType file_type, const FileSpec &dir_spec)
+{
+    if (file_type != FileSpec::eFileTypeDirectory)
+        return FileSpec::eEnumerateDirectoryResultNext;
+
+    CacheEntry entry;
+    entry.dir_spec = dir_spec;
+    FileSpec::EnumerateDirectory (dir_spec.GetPath ().c_str (), false, true, false, AddFileSize, &entry);
+
+    const auto stamp_spec = JoinPath (dir_spec, kAccessStampFileName);
+    entry.last_used = (stamp_spec.Exists () ? stamp_spec : dir_spec).GetModificationTime ().GetAsNanoSecondsSinceJan1_1970 ();
+
+    static_cast<std::vector<CacheEntry> *> (baton)->push_back (entry);
+    return FileSpec::eEnumerateDirectoryResultNext;
+}
+
 }  // namespace
 
+ModuleCache::ModuleCache () :
+    m_loaded_modules (),
+    m_just_put_modules (),
+    m_mutex (Mutex::eMutexTypeRecursive),
+    m_stats ()
+{
+}
+
+Error
+ModuleCache::GetAndPut (const FileSpec &root_dir_spec,
+                        const char *hostname,
+                        const ModuleSpec &module_spec,
+                        const ModuleDownloader &module_downloader,
+                        ModuleSP &cached_module_sp,
+                        bool *did_create_ptr)
+{
+    const auto module_spec_dir = GetModuleDirectory (root_dir_spec, module_spec.GetUUID ());
+    auto error = MakeDirectory (module_spec_dir);
+    if (error.Fail ())
+        return error;
+
+    // Don't hold m_mutex across the download, the file lock also keeps
+    // other threads of this process from downloading the same module.
+    ModuleLock lock (root_dir_spec, module_spec.GetUUID ().GetAsString ().c_str (), true, true);
+    if (!lock.IsLocked ())
+        return Error ("failed to lock module cache directory %s", module_spec_dir.GetPath ().c_str ());
+
+    // Another process may have downloaded the module while we waited for
+    // the lock.
+    error = GetLocked (root_dir_spec, hostname, module_spec, cached_module_sp, did_create_ptr);
+    if (error.Success ())
+        return error;
+
+    std::string download_file_name (module_spec.GetFileSpec ().GetFilename ().AsCString (""));
+    download_file_name += kDownloadFileSuffix;
+    const auto download_file_spec = JoinPath (module_spec_dir, download_file_name.c_str ());
+
+    // A failed download leaves the partial file behind to be resumed.
+    error = module_downloader (module_spec, download_file_spec);
+    if (error.Fail ())
+        return Error ("failed to download module: %s", error.AsCString ());
+
+    llvm::FileRemover download_file_remover (download_file_spec.GetPath ().c_str ());
+
+    error = PutLocked (root_dir_spec, hostname, module_spec, download_file_spec);
+    if (error.Fail ())
+        return Error ("failed to put module into cache: %s", error.AsCString ());
+
+    return GetLocked (root_dir_spec, hostname, module_spec, cached_module_sp, did_create_ptr);
+}
+
 Error
 ModuleCache::Put (const FileSpec &root_dir_spec,
                   const char *hostname,
@@ -61,17 +226,58 @@ ModuleCache::Put (const FileSpec &root_dir_spec,
     if (error.Fail ())
         return error;
 
-    const auto module_file_path = JoinPath (module_spec_dir, module_spec.GetFileSpec ().GetFilename ().AsCString ());
+    ModuleLock lock (root_dir_spec, module_spec.GetUUID ().GetAsString ().c_str (), true, true);
+    if (!lock.IsLocked ())
+        return Error ("failed to lock module cache directory %s", module_spec_dir.GetPath ().c_str ());
+
+    return PutLocked (root_dir_spec, hostname, module_spec, tmp_file);
+}
+
+Error
+ModuleCache::PutLocked (const FileSpec &root_dir_spec,
+                        const char *hostname,
+                        const ModuleSpec &module_spec,
+                        const FileSpec &tmp_file)
+{
+    Mutex::Locker locker (m_mutex);
 
+    const auto module_spec_dir = GetModuleDirectory (root_dir_spec, module_spec.GetUUID ());
+    auto error = MakeDirectory (module_spec_dir);
+    if (error.Fail ())
+        return error;
+
+    const auto module_file_path = JoinPath (module_spec_dir, module_spec.GetFileSpec ().GetFilename ().AsCString ());
+    const auto module_file_path_str = module_file_path.GetPath ();
     const auto tmp_file_path = tmp_file.GetPath ();
-    const auto err_code = llvm::sys::fs::copy_file (tmp_file_path.c_str (), module_file_path.GetPath ().c_str ());
-    if (err_code)
+
+    // Another process may have published the same module while we were
+    // downloading it.
+    if (!module_file_path.Exists ())
     {
-        error.SetErrorStringWithFormat ("failed to copy file %s to %s: %s",
-                                        tmp_file_path.c_str (),
-                                        module_file_path.GetPath ().c_str (),
-                                        err_code.message ().c_str ());
+        // Publish atomically so readers never see a partially written
+        // module: move the download into place if it is on the same file
+        // system, otherwise copy it next to the destination first.
+        auto err_code = llvm::sys::fs::rename (tmp_file_path.c_str (), module_file_path_str.c_str ());
+        if (err_code)
+        {
+            const auto staging_file_path = module_file_path_str + ".tmp";
+            err_code = llvm::sys::fs::copy_file (tmp_file_path.c_str (), staging_file_path.c_str ());
+            if (!err_code)
+                err_code = llvm::sys::fs::rename (staging_file_path.c_str (), module_file_path_str.c_str ());
+            if (err_code)
+            {
+                llvm::sys::fs::remove (staging_file_path.c_str ());
+                return Error ("failed to copy file %s to %s: %s",
+                              tmp_file_path.c_str (),
+                              module_file_path_str.c_str (),
+                              err_code.message ().c_str ());
+            }
+        }
     }
+    TouchAccessStamp (module_spec_dir);
+
+    ++m_stats.misses;
+    m_just_put_modules.insert (module_spec.GetUUID ().GetAsString ());
 
     // Create sysroot link to a module.
     const auto sysroot_module_path_spec = GetHostSysRootModulePath (root_dir_spec, hostname, module_spec.GetFileSpec ());
@@ -85,7 +291,41 @@ ModuleCache::Get (const FileSpec &root_dir_spec,
                   ModuleSP &cached_module_sp,
                   bool *did_create_ptr)
 {
-    const auto find_it = m_loaded_modules.find (module_spec.GetUUID ().GetAsString());
+    {
+        Mutex::Locker locker (m_mutex);
+        const auto find_it = m_loaded_modules.find (module_spec.GetUUID ().GetAsString ());
+        if (find_it != m_loaded_modules.end ())
+        {
+            cached_module_sp = (*find_it).second.lock ();
+            if (cached_module_sp)
+                return Error ();
+        }
+    }
+
+    const auto module_spec_dir = GetModuleDirectory (root_dir_spec,  module_spec.GetUUID ());
+    if (!module_spec_dir.Exists ())
+        return Error ("module %s not found", module_spec_dir.GetPath ().c_str ());
+
+    // Keep Trim() in other processes from evicting the module while we
+    // open it.
+    ModuleLock lock (root_dir_spec, module_spec.GetUUID ().GetAsString ().c_str (), false, true);
+    if (!lock.IsLocked ())
+        return Error ("failed to lock module cache directory %s", module_spec_dir.GetPath ().c_str ());
+
+    return GetLocked (root_dir_spec, hostname, module_spec, cached_module_sp, did_create_ptr);
+}
+
+Error
+ModuleCache::GetLocked (const FileSpec &root_dir_spec,
+                        const char *hostname,
+                        const ModuleSpec &module_spec,
+                        ModuleSP &cached_module_sp,
+                        bool *did_create_ptr)
+{
+    Mutex::Locker locker (m_mutex);
+
+    const auto uuid_str = module_spec.GetUUID ().GetAsString ();
+    const auto find_it = m_loaded_modules.find (uuid_str);
     if (find_it != m_loaded_modules.end ())
     {
         cached_module_sp = (*find_it).second.lock ();
@@ -100,10 +340,12 @@ ModuleCache::Get (const FileSpec &root_dir_spec,
     if (!module_file_path.Exists ())
         return Error ("module %s not found", module_file_path.GetPath ().c_str ());
 
+    TouchAccessStamp (module_spec_dir);
+
     // We may have already cached module but downloaded from an another host - in this case let's create a symlink to it.
     const auto sysroot_module_path_spec = GetHostSysRootModulePath (root_dir_spec, hostname, module_spec.GetFileSpec ());
     if (!sysroot_module_path_spec.Exists ())
-        CreateHostSysRootModuleSymLink (sysroot_module_path_spec, module_spec.GetFileSpec ());
+        CreateHostSysRootModuleSymLink (sysroot_module_path_spec, module_file_path);
 
     auto cached_module_spec (module_spec);
     cached_module_spec.GetUUID ().Clear ();  // Clear UUID since it may contain md5 content hash instead of real UUID.
@@ -113,11 +355,90 @@ ModuleCache::Get (const FileSpec &root_dir_spec,
     if (did_create_ptr)
         *did_create_ptr = true;
 
-    m_loaded_modules.insert (std::make_pair (module_spec.GetUUID ().GetAsString (), cached_module_sp));
+    m_loaded_modules.insert (std::make_pair (uuid_str, cached_module_sp));
+
+    if (m_just_put_modules.erase (uuid_str) == 0)
+    {
+        ++m_stats.hits;
+        m_stats.bytes_saved += module_file_path.GetByteSize ();
+    }
 
     return Error ();
 }
 
+Error
+ModuleCache::Trim (const FileSpec &root_dir_spec, uint64_t max_size)
+{
+    Mutex::Locker locker (m_mutex);
+
+    const auto modules_dir_spec = JoinPath (root_dir_spec, kModulesSubdir);
+    if (!modules_dir_spec.Exists ())
+        return Error ();
+
+    std::vector<CacheEntry> entries;
+    FileSpec::EnumerateDirectory (modules_dir_spec.GetPath ().c_str (), true, false, false, AddCacheEntry, &entries);
+
+    uint64_t total_size = 0;
+    for (const auto &entry : entries)
+        total_size += entry.size;
+    if (total_size <= max_size)
+        return Error ();
+
+    std::sort (entries.begin (), entries.end (),
+               [] (const CacheEntry &lhs, const CacheEntry &rhs) { return lhs.last_used < rhs.last_used; });
+
+    Log *log = GetLogIfAnyCategoriesSet (LIBLLDB_LOG_PLATFORM);
+    Error error;
+    for (const auto &entry : entries)
+    {
+        if (total_size <= max_size)
+            break;
+
+        if (IsModuleLoaded (entry.dir_spec.GetFilename ().AsCString ("")))
+            continue;
+
+        // Skip modules another process is downloading, publishing or using
+        // right now.
+        ModuleLock lock (root_dir_spec, entry.dir_spec.GetFilename ().AsCString (""), true, false);
+        if (!lock.IsLocked ())
+            continue;
+
+        const auto dir_path = entry.dir_spec.GetPath ();
+        error = FileSystem::DeleteDirectory (dir_path.c_str (), true);
+        if (error.Fail ())
+            break;
+
+        if (log)
+            log->Printf ("ModuleCache::%s - evicted %s (%" PRIu64 " bytes)", __FUNCTION__, dir_path.c_str (), entry.size);
+
+        total_size -= entry.size;
+        ++m_stats.evictions;
+        m_stats.bytes_evicted += entry.size;
+    }
+    return error;
+}
+
+ModuleCache::Statistics
+ModuleCache::GetStatistics () const
+{
+    Mutex::Locker locker (m_mutex);
+    return m_stats;
+}
+
+void
+ModuleCache::ResetStatistics ()
+{
+    Mutex::Locker locker (m_mutex);
+    m_stats = Statistics ();
+}
+
+bool
+ModuleCache::IsModuleLoaded (const std::string &uuid_str)
+{
+    const auto find_it = m_loaded_modules.find (uuid_str);
+    return find_it != m_loaded_modules.end () && !find_it->second.expired ();
+}
+
 FileSpec
 ModuleCache::GetModuleDirectory (const FileSpec &root_dir_spec, const UUID &uuid)
 {
@@ -139,6 +460,19 @@ ModuleCache::CreateHostSysRootModuleSymLink (const FileSpec &sysroot_module_path
     if (error.Fail ())
         return error;
 
-    return FileSystem::Symlink (sysroot_module_path_spec.GetPath ().c_str (),
-                                module_file_path.GetPath ().c_str ());
+    // Remove a dangling link left behind by an evicted module.
+    const auto sysroot_module_path = sysroot_module_path_spec.GetPath ();
+    FileSystem::Unlink (sysroot_module_path.c_str ());
+
+    const auto symlink_error = FileSystem::Symlink (sysroot_module_path.c_str (),
+                                                    module_file_path.GetPath ().c_str ());
+    if (symlink_error.Success ())
+        return symlink_error;
+
+    // Fall back to a hard link where symbolic links aren't available.
+    const auto err_code = llvm::sys::fs::create_hard_link (module_file_path.GetPath ().c_str (),
+                                                           sysroot_module_path.c_str ());
+    if (err_code)
+        return symlink_error;
+    return Error ();
 }
@@ -15,9 +15,12 @@
 
 #include "lldb/Core/Error.h"
 #include "lldb/Host/FileSpec.h"
+#include "lldb/Host/Mutex.h"
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace lldb_private {
 
@@ -34,7 +37,17 @@ class UUID;
 ///  - Sysroot view: /${CACHE_ROOT}/${PLATFORM_NAME}/${HOSTNAME}/${MODULE_FULL_FILEPATH}
 ///
 /// UUID views stores a real module file, whereas Sysroot view holds a symbolic
-/// link to UUID-view file.
+/// link to UUID-view file, so hosts that run the same module share a single
+/// copy of it.
+///
+/// The cache directory may be shared by several lldb processes. Modules are
+/// downloaded and published atomically by renaming them into the UUID view
+/// while holding an exclusive lock on the module, and every use of a module
+/// refreshes an access stamp that Trim() uses to evict the least recently
+/// used modules once the cache grows beyond a size limit.
+///
+/// The locks are files in /${CACHE_ROOT}/${PLATFORM_NAME}/.lock/${UUID},
+/// outside the UUID view, so they survive the eviction of their module.
 ///
 /// Example:
 /// UUID view   : /tmp/lldb/remote-linux/.cache/30C94DC6-6A1F-E951-80C3-D68D2B89E576-D5AE213C/libc.so.6
@@ -44,6 +57,42 @@ class UUID;
 class ModuleCache
 {
 public:
+    struct Statistics
+    {
+        Statistics () :
+            hits (0),
+            misses (0),
+            bytes_saved (0),
+            evictions (0),
+            bytes_evicted (0)
+        {
+        }
+
+        uint64_t hits;          // Modules found in the cache
+        uint64_t misses;        // Modules that had to be downloaded
+        uint64_t bytes_saved;   // Bytes that didn't have to be downloaded thanks to a hit
+        uint64_t evictions;     // Modules removed by Trim()
+        uint64_t bytes_evicted; // Bytes removed by Trim()
+    };
+
+    // Downloads a module into the given file.
+    typedef std::function<Error (const ModuleSpec &, const FileSpec &)> ModuleDownloader;
+
+    ModuleCache ();
+
+    // Get a module from the cache, downloading it with module_downloader
+    // and putting it into the cache first if it isn't there. The module's
+    // lock is held across the download, so only one process at a time
+    // downloads a module and the partially downloaded file it leaves behind
+    // when interrupted can safely be resumed by the next attempt.
+    Error
+    GetAndPut (const FileSpec &root_dir_spec,
+               const char *hostname,
+               const ModuleSpec &module_spec,
+               const ModuleDownloader &module_downloader,
+               lldb::ModuleSP &cached_module_sp,
+               bool *did_create_ptr);
+
     Error
     Put (const FileSpec &root_dir_spec,
          const char *hostname,
@@ -57,7 +106,33 @@ public:
          lldb::ModuleSP &cached_module_sp,
          bool *did_create_ptr);
 
+    // Evict least recently used modules until the cache holds at most
+    // max_size bytes. Modules that are loaded by this process or locked by
+    // another one are left alone.
+    Error
+    Trim (const FileSpec &root_dir_spec, uint64_t max_size);
+
+    Statistics
+    GetStatistics () const;
+
+    void
+    ResetStatistics ();
+
 private:
+    // Get and Put without taking the module's lock, which the caller holds
+    Error
+    PutLocked (const FileSpec &root_dir_spec,
+               const char *hostname,
+               const ModuleSpec &module_spec,
+               const FileSpec &tmp_file);
+
+    Error
+    GetLocked (const FileSpec &root_dir_spec,
+               const char *hostname,
+               const ModuleSpec &module_spec,
+               lldb::ModuleSP &cached_module_sp,
+               bool *did_create_ptr);
+
     static FileSpec
     GetModuleDirectory (const FileSpec &root_dir_spec, const UUID &uuid);
 
@@ -67,7 +142,13 @@ private:
     static Error
     CreateHostSysRootModuleSymLink (const FileSpec &sysroot_module_path_spec, const FileSpec &module_file_path);
 
+    bool
+    IsModuleLoaded (const std::string &uuid_str);
+
     std::unordered_map<std::string, lldb::ModuleWP> m_loaded_modules;
+    std::unordered_set<std::string> m_just_put_modules; // UUIDs we downloaded, so the next Get isn't a hit
+    mutable Mutex m_mutex;
+    Statistics m_stats;
 };
 
 } // namespace lldb_private
@@ -15,6 +15,7 @@
 // C++ Includes
 // Other libraries and framework includes
 // Project includes
+#include "lldb/Utility/HexCodec.h"
 
 static inline int
 xdigit_to_sint (char ch)
@@ -342,13 +343,13 @@ StringExtractor::GetHexBytes (void *dst_void, size_t dst_len, uint8_t fail_fill_
 {
     uint8_t *dst = (uint8_t*)dst_void;
     size_t bytes_extracted = 0;
-    while (bytes_extracted < dst_len && GetBytesLeft ())
+    if (GetBytesLeft ())
     {
-        dst[bytes_extracted] = GetHexU8 (fail_fill_value);
-        if (IsGood())
-            ++bytes_extracted;
-        else
-            break;
+        bytes_extracted = lldb_private::DecodeHexBytes (m_packet.data() + m_index, GetBytesLeft (), dst, dst_len);
+        m_index += 2 * bytes_extracted;
+        // Like GetHexU8, running into something other than a hex pair is an error
+        if (bytes_extracted < dst_len && GetBytesLeft ())
+            m_index = UINT64_MAX;
     }
 
     for (size_t i = bytes_extracted; i < dst_len; ++i)
@@ -366,16 +367,11 @@ StringExtractor::GetHexBytes (void *dst_void, size_t dst_len, uint8_t fail_fill_
 size_t
 StringExtractor::GetHexBytesAvail (void *dst_void, size_t dst_len)
 {
-    uint8_t *dst = (uint8_t*)dst_void;
     size_t bytes_extracted = 0;
-    while (bytes_extracted < dst_len)
+    if (GetBytesLeft ())
     {
-        int decode = DecodeHexU8();
-        if (decode == -1)
-        {
-            break;
-        }
-        dst[bytes_extracted++] = (uint8_t)decode;
+        bytes_extracted = lldb_private::DecodeHexBytes (m_packet.data() + m_index, GetBytesLeft (), dst_void, dst_len);
+        m_index += 2 * bytes_extracted;
     }
     return bytes_extracted;
 }
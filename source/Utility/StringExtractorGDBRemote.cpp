@@ -239,6 +239,16 @@ StringExtractorGDBRemote::GetServerPacketType () const
 
         case 'm':
             return eServerPacketType__m;
+
+        case 'Z':
+            if (packet_cstr[2] == '0' || packet_cstr[2] == '1')
+                return eServerPacketType__Z;
+            break;
+
+        case 'z':
+            if (packet_cstr[2] == '0' || packet_cstr[2] == '1')
+                return eServerPacketType__z;
+            break;
         }
         break;
 
@@ -257,7 +267,7 @@ StringExtractorGDBRemote::GetServerPacketType () const
         break;
 
       case 'g':
-        if (packet_size == 1) return eServerPacketType_g;
+        if (packet_size == 1 || packet_cstr[1] == ';') return eServerPacketType_g;
         break;
 
       case 'G':
@@ -145,6 +145,8 @@ public:
 
         eServerPacketType__M,
         eServerPacketType__m,
+        eServerPacketType__Z,
+        eServerPacketType__z,
     };
     
     ServerPacketType
@@ -29,6 +29,24 @@ class PythonBreakpointCommandSettingTestCase(TestBase):
         self.buildDwarf()
         self.do_set_python_command_from_python ()
 
+    @python_api_test
+    @dwarf_test
+    def test_lightweight_callbacks_with_dwarf_python(self):
+        """Test that the commands still run with lightweight script callbacks."""
+        self.buildDwarf()
+        self.runCmd("settings set script-lightweight-callbacks true")
+        self.addTearDownHook(lambda: self.runCmd("settings clear script-lightweight-callbacks"))
+        self.do_set_python_command_from_python ()
+
+    @python_api_test
+    @dwarf_test
+    def test_lightweight_callbacks_bind_debugger_with_dwarf_python(self):
+        """Test that lightweight script callbacks see lldb.debugger, also after another debugger went away."""
+        self.buildDwarf()
+        self.runCmd("settings set script-lightweight-callbacks true")
+        self.addTearDownHook(lambda: self.runCmd("settings clear script-lightweight-callbacks"))
+        self.do_lightweight_callbacks_bind_debugger ()
+
     def setUp (self):
         TestBase.setUp(self)
         self.main_source = "main.c"
@@ -99,7 +117,41 @@ print 'Hit breakpoint'")
                         "'output2.txt' exists due to breakpoint command for breakpoint function.")
         self.RemoveTempFile("output2.txt")
 
-        
+
+    def do_lightweight_callbacks_bind_debugger (self):
+        # Another debugger that has been in a script session.
+        other_dbg = lldb.SBDebugger.Create(False)
+        other_dbg.HandleCommand("script other_dbg_var = 1")
+
+        exe = os.path.join(os.getcwd(), "a.out")
+        self.target = self.dbg.CreateTarget(exe)
+        self.assertTrue(self.target, VALID_TARGET)
+
+        body_bkpt = self.target.BreakpointCreateBySourceRegex("Set break point at this line.", self.main_source_spec)
+        self.assertTrue(body_bkpt, VALID_BREAKPOINT)
+
+        self.dbg.HandleCommand("command script import --allow-reload ./bktptcmd.py")
+        body_bkpt.SetScriptCallbackFunction("bktptcmd.record_debugger")
+        self.runCmd("type summary add -F bktptcmd.debugger_summary int")
+        self.addTearDownHook(lambda: self.runCmd("type summary clear"))
+
+        self.process = self.target.LaunchSimple (None, None, self.get_process_working_directory())
+        self.assertTrue(self.process, PROCESS_IS_VALID)
+
+        threads = lldbutil.get_threads_stopped_at_breakpoint (self.process, body_bkpt)
+        self.assertTrue(len(threads) == 1, "Stopped at inner breakpoint.")
+
+        # The callback took over lldb.debugger from the other debugger.
+        bktptcmd = sys.modules["bktptcmd"]
+        self.assertEqual(bktptcmd.debugger_ids, [self.dbg.GetID()])
+
+        # Destroying the other debugger sets lldb.debugger to None, so the
+        # next lightweight session has to bind it again.
+        lldb.SBDebugger.Destroy(other_dbg)
+        argc = threads[0].GetFrameAtIndex(0).FindVariable("argc")
+        self.assertTrue(argc.IsValid(), "Found argc")
+        self.assertEqual(argc.GetSummary(), "debugger %d" % self.dbg.GetID())
+
 if __name__ == '__main__':
     import atexit
     lldb.SBDebugger.Initialize()
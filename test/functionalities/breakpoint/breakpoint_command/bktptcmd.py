@@ -1,4 +1,17 @@
+import lldb
+
 def function(frame, bp_loc, dict):
 	there = open("output2.txt", "w");
 	print >> there, "lldb";
 	there.close()
+
+# The IDs of the debuggers lldb.debugger was bound to in record_debugger
+debugger_ids = []
+
+def record_debugger(frame, bp_loc, dict):
+	debugger_ids.append(lldb.debugger.GetID() if lldb.debugger else None)
+
+def debugger_summary(valobj, dict):
+	if lldb.debugger:
+		return "debugger %d" % lldb.debugger.GetID()
+	return "no debugger"
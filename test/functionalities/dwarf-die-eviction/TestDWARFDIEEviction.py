@@ -0,0 +1,89 @@
+"""
+Test that lookups keep working when a tiny plugin.symbol-file.dwarf.die-memory-limit
+forces the DIEs of compile units to be evicted and parsed again.
+"""
+
+import os, re
+import unittest2
+import lldb
+from lldbtest import *
+import lldbutil
+
+class DWARFDIEEvictionTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @skipUnlessDarwin
+    @dsym_test
+    def test_with_dsym(self):
+        """Test lookups across compile units with DIE eviction."""
+        self.buildDsym()
+        self.die_eviction()
+
+    @dwarf_test
+    def test_with_dwarf(self):
+        """Test lookups across compile units with DIE eviction."""
+        self.buildDwarf()
+        self.die_eviction()
+
+    def setUp(self):
+        # Call super's setUp().
+        TestBase.setUp(self)
+        self.a_line = line_number('a.c', '// Set break point in a_function.')
+        self.b_line = line_number('b.c', '// Set break point in b_function.')
+        self.main_line = line_number('main.c', '// Set break point in main.')
+        self.log_file = os.path.join(os.getcwd(), 'dwarf-die-eviction.log')
+        if os.path.exists(self.log_file):
+            os.remove(self.log_file)
+
+    def die_eviction(self):
+        """Evict DIEs after every lookup and check that the debug info is still usable."""
+        self.runCmd("settings set plugin.symbol-file.dwarf.die-memory-limit 1")
+        self.addTearDownHook(lambda: self.runCmd("settings clear plugin.symbol-file.dwarf.die-memory-limit"))
+        self.runCmd("log enable -f '%s' dwarf info" % self.log_file)
+        self.addTearDownHook(lambda: self.runCmd("log disable dwarf"))
+
+        exe = os.path.join(os.getcwd(), "a.out")
+        self.runCmd("file " + exe, CURRENT_EXECUTABLE_SET)
+
+        lldbutil.run_break_set_by_file_and_line (self, "a.c", self.a_line, num_expected_locations=1, loc_exact=True)
+        lldbutil.run_break_set_by_file_and_line (self, "b.c", self.b_line, num_expected_locations=1, loc_exact=True)
+        lldbutil.run_break_set_by_file_and_line (self, "main.c", self.main_line, num_expected_locations=1, loc_exact=True)
+
+        self.runCmd("run", RUN_SUCCEEDED)
+
+        # a.c was parsed to resolve its breakpoint and has most likely been
+        # evicted since, its DIEs get extracted again for the locals.
+        self.expect("frame variable local_a", VARIABLES_DISPLAYED_CORRECTLY,
+            substrs = ['x = 2', 'y = 2'])
+        self.expect("target variable g_point_b", VARIABLES_DISPLAYED_CORRECTLY,
+            substrs = ['x = 3', 'y = 4', 'z = 5'])
+
+        self.runCmd("continue")
+        self.expect("frame variable local_b", VARIABLES_DISPLAYED_CORRECTLY,
+            substrs = ['x = 3', 'y = 4', 'z = 6'])
+        self.expect("target variable g_point_a", VARIABLES_DISPLAYED_CORRECTLY,
+            substrs = ['x = 1', 'y = 2'])
+        self.expect("image lookup -t point_a",
+            substrs = ['point_a'])
+        self.expect("bt",
+            substrs = ['b_function', 'main'])
+
+        self.runCmd("continue")
+        self.expect("frame variable result", VARIABLES_DISPLAYED_CORRECTLY,
+            substrs = ['(int) result = 17'])
+        self.expect("expression -- a_function(2) + b_function(2)",
+            substrs = ['(int) $0 = 19'])
+
+        # Make sure DIEs were actually evicted along the way.
+        self.runCmd("log disable dwarf")
+        self.assertTrue(os.path.isfile(self.log_file))
+        with open(self.log_file, 'r') as f:
+            log_text = f.read()
+        self.assertTrue(re.search("cleared the DIEs of [1-9]", log_text), "no DIEs were evicted")
+
+if __name__ == '__main__':
+    import atexit
+    lldb.SBDebugger.Initialize()
+    atexit.register(lambda: lldb.SBDebugger.Terminate())
+    unittest2.main()
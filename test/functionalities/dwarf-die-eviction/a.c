@@ -0,0 +1,11 @@
+#include "shared.h"
+
+struct point_a g_point_a = { 1, 2 };
+
+int
+a_function (int value)
+{
+    struct point_a local_a = g_point_a;
+    local_a.x += value;
+    return local_a.x + local_a.y; // Set break point in a_function.
+}
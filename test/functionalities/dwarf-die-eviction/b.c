@@ -0,0 +1,11 @@
+#include "shared.h"
+
+struct point_b g_point_b = { 3, 4, 5 };
+
+int
+b_function (int value)
+{
+    struct point_b local_b = g_point_b;
+    local_b.z += value;
+    return (int)(local_b.x + local_b.y + local_b.z); // Set break point in b_function.
+}
@@ -0,0 +1,11 @@
+#include <stdio.h>
+#include "shared.h"
+
+int
+main (int argc, char const *argv[])
+{
+    int result = a_function (argc);
+    result += b_function (argc);
+    printf ("result = %d\n", result); // Set break point in main.
+    return 0;
+}
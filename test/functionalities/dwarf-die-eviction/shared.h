@@ -0,0 +1,15 @@
+struct point_a
+{
+    int x;
+    int y;
+};
+
+struct point_b
+{
+    long x;
+    long y;
+    long z;
+};
+
+int a_function (int value);
+int b_function (int value);
@@ -0,0 +1,141 @@
+"""
+Test that thread step-over steps through whole lines, including when the
+stub range steps them (vCont;r), and still stops at breakpoints inside a line.
+"""
+
+import os
+import unittest2
+import lldb
+from lldbtest import *
+import lldbutil
+
+class ThreadStepOverRangeTestCase(TestBase):
+
+    mydir = TestBase.compute_mydir(__file__)
+
+    @dsym_test
+    def test_step_over_loop_with_dsym(self):
+        """Test thread step-over across a line that loops."""
+        self.buildDsym()
+        self.step_over_loop()
+
+    @dwarf_test
+    def test_step_over_loop_with_dwarf(self):
+        """Test thread step-over across a line that loops."""
+        self.buildDwarf()
+        self.step_over_loop()
+
+    @dsym_test
+    def test_step_over_stops_at_breakpoint_with_dsym(self):
+        """Test thread step-over stops at a breakpoint inside the line."""
+        self.buildDsym()
+        self.step_over_stops_at_breakpoint()
+
+    @dwarf_test
+    def test_step_over_stops_at_breakpoint_with_dwarf(self):
+        """Test thread step-over stops at a breakpoint inside the line."""
+        self.buildDwarf()
+        self.step_over_stops_at_breakpoint()
+
+    def setUp(self):
+        # Call super's setUp().
+        TestBase.setUp(self)
+        self.break_line = line_number('main.c', '// Set break point at this line.')
+        self.loop_line = line_number('main.c', '// Step over the loop.')
+        self.call_line = line_number('main.c', '// Step over the call.')
+        self.last_line = line_number('main.c', '// Last line stepped to.')
+
+    def run_to_loop(self):
+        """Stop on the line with the loop and log the packets sent to the stub from then on."""
+        exe = os.path.join(os.getcwd(), "a.out")
+        self.target = self.dbg.CreateTarget(exe)
+        self.assertTrue(self.target, VALID_TARGET)
+
+        breakpoint = self.target.BreakpointCreateByLocation('main.c', self.break_line)
+        self.assertTrue(breakpoint, VALID_BREAKPOINT)
+
+        self.process = self.target.LaunchSimple(None, None, self.get_process_working_directory())
+        self.assertTrue(self.process, PROCESS_IS_VALID)
+        self.thread = lldbutil.get_stopped_thread(self.process, lldb.eStopReasonBreakpoint)
+        self.assertTrue(self.thread.IsValid(), "There should be a thread stopped due to breakpoint")
+        self.target.BreakpointDelete(breakpoint.GetID())
+
+        self.runCmd("thread step-over")
+        self.assertEqual(self.current_line(), self.loop_line)
+
+        # lldb-server range steps the lines, other stubs are single stepped
+        # through them.
+        self.packet_log = None
+        if self.process.GetPluginName() == "gdb-remote" and self.getPlatform() == "linux":
+            self.packet_log = os.path.join(os.getcwd(), "step-over-packets.log")
+            self.runCmd("log enable -f %s gdb-remote packets" % self.packet_log)
+            def cleanup():
+                self.runCmd("log disable gdb-remote packets")
+                if os.path.exists(self.packet_log):
+                    os.remove(self.packet_log)
+            self.addTearDownHook(cleanup)
+
+    def current_line(self):
+        return self.thread.GetFrameAtIndex(0).GetLineEntry().GetLine()
+
+    def current_count(self):
+        return self.target.FindFirstGlobalVariable("g_count").GetValueAsUnsigned()
+
+    def check_range_stepped(self):
+        if self.packet_log:
+            with open(self.packet_log, "r") as f:
+                self.assertTrue("vCont;r" in f.read(), "Expected the stub to range step the line")
+
+    def step_over_loop(self):
+        self.run_to_loop()
+
+        # The whole loop runs before the step stops.
+        self.runCmd("thread step-over")
+        self.assertEqual(self.thread.GetStopReason(), lldb.eStopReasonPlanComplete)
+        self.assertEqual(self.current_line(), self.call_line)
+        self.assertEqual(self.current_count(), 100)
+
+        # Stepping into add_one leaves the range, the step comes back out.
+        self.runCmd("thread step-over")
+        self.assertEqual(self.thread.GetStopReason(), lldb.eStopReasonPlanComplete)
+        self.assertEqual(self.current_line(), self.last_line)
+        self.assertEqual(self.current_count(), 101)
+
+        self.check_range_stepped()
+
+    def step_over_stops_at_breakpoint(self):
+        self.run_to_loop()
+
+        # The last instruction of the loop's line runs on every iteration.
+        frame = self.thread.GetFrameAtIndex(0)
+        loop_addresses = []
+        for instruction in frame.GetFunction().GetInstructions(self.target):
+            address = instruction.GetAddress()
+            if address.GetLineEntry().GetLine() == self.loop_line:
+                loop_addresses.append(address.GetLoadAddress(self.target))
+        self.assertTrue(len(loop_addresses) > 1, "Expected the loop's line to have several instructions")
+        breakpoint_addr = loop_addresses[-1]
+        breakpoint = self.target.BreakpointCreateByAddress(breakpoint_addr)
+        self.assertTrue(breakpoint, VALID_BREAKPOINT)
+
+        # The step stops at the breakpoint before the loop is done.
+        self.runCmd("thread step-over")
+        self.assertEqual(self.thread.GetStopReason(), lldb.eStopReasonBreakpoint)
+        self.assertEqual(self.thread.GetStopReasonDataAtIndex(0), breakpoint.GetID())
+        self.assertEqual(self.thread.GetFrameAtIndex(0).GetPC(), breakpoint_addr)
+        self.assertTrue(self.current_count() < 100)
+
+        # Without the breakpoint the next step finishes the loop.
+        self.target.BreakpointDelete(breakpoint.GetID())
+        self.runCmd("thread step-over")
+        self.assertEqual(self.thread.GetStopReason(), lldb.eStopReasonPlanComplete)
+        self.assertEqual(self.current_line(), self.call_line)
+        self.assertEqual(self.current_count(), 100)
+
+        self.check_range_stepped()
+
+if __name__ == '__main__':
+    import atexit
+    lldb.SBDebugger.Initialize()
+    atexit.register(lambda: lldb.SBDebugger.Terminate())
+    unittest2.main()
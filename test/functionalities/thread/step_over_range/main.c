@@ -0,0 +1,32 @@
+//===-- main.c --------------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Each line stepped over by the test runs many instructions, so a stub that
+// supports range stepping steps through it without stopping.
+
+#include <stdio.h>
+
+volatile int g_count = 0;
+
+int
+add_one (int value)
+{
+    return value + 1;
+}
+
+int
+main (int argc, char const *argv[])
+{
+    int i;
+    g_count = 0; // Set break point at this line.
+    for (i = 0; i < 100; ++i) g_count++; // Step over the loop.
+    g_count = add_one (g_count); // Step over the call.
+    printf ("%d\n", g_count); // Last line stepped to.
+    return 0;
+}
@@ -28,6 +28,20 @@ class FrameAPITestCase(TestBase):
         self.buildDwarf()
         self.do_get_arg_vals()
 
+    @python_api_test
+    @dwarf_test
+    def test_get_variables_as_json_with_dwarf(self):
+        """Exercise SBFrame.GetVariablesAsJSON() API."""
+        self.buildDwarf()
+        self.do_get_variables_as_json()
+
+    @python_api_test
+    @dwarf_test
+    def test_get_variables_as_json_escapes_with_dwarf(self):
+        """Exercise SBFrame.GetVariablesAsJSON() with values that need escaping."""
+        self.buildDwarf()
+        self.do_get_variables_as_json_escapes()
+
     @python_api_test
     def test_frame_api_boundary_condition(self):
         """Exercise SBFrame APIs with boundary condition inputs."""
@@ -127,6 +141,89 @@ class FrameAPITestCase(TestBase):
             substrs = ["a((int)val=1, (char)ch='A')",
                        "a((int)val=3, (char)ch='A')"])
 
+    def do_get_variables_as_json(self):
+        """Check that the JSON snapshot agrees with SBFrame.GetVariables()."""
+        exe = os.path.join(os.getcwd(), "a.out")
+
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target, VALID_TARGET)
+
+        breakpoint = target.BreakpointCreateByName('c', 'a.out')
+        self.assertTrue(breakpoint and
+                        breakpoint.GetNumLocations() == 1,
+                        VALID_BREAKPOINT)
+
+        process = target.LaunchSimple (None, None, self.get_process_working_directory())
+        self.assertTrue(process.GetState() == lldb.eStateStopped,
+                        PROCESS_STOPPED)
+
+        frame = process.GetThreadAtIndex(0).GetFrameAtIndex(0)
+        options = lldb.SBVariablesOptions()
+        options.SetIncludeArguments(True)
+        options.SetIncludeLocals(True)
+
+        stream = lldb.SBStream()
+        self.assertTrue(frame.GetVariablesAsJSON(options, 1, 8, stream))
+        if self.TraceOn():
+            print "JSON snapshot:", stream.GetData()
+
+        import json
+        snapshot = json.loads(stream.GetData())
+        expected = {}
+        for val in frame.GetVariables(options):
+            expected[val.GetName()] = (val.GetTypeName(), val.GetValue())
+        self.assertTrue(len(snapshot) == len(expected))
+        for entry in snapshot:
+            self.assertTrue(entry["name"] in expected)
+            self.assertTrue((entry["type"], entry["value"]) == expected[entry["name"]])
+            self.assertTrue(entry["num_children"] == 0)
+        names = [entry["name"] for entry in snapshot]
+        self.assertTrue("val" in names and "my_ch" in names)
+
+    def do_get_variables_as_json_escapes(self):
+        """Check that NUL, newline and backslash characters survive the JSON snapshot."""
+        exe = os.path.join(os.getcwd(), "a.out")
+
+        target = self.dbg.CreateTarget(exe)
+        self.assertTrue(target, VALID_TARGET)
+
+        breakpoint = target.BreakpointCreateByName('c', 'a.out')
+        self.assertTrue(breakpoint and
+                        breakpoint.GetNumLocations() == 1,
+                        VALID_BREAKPOINT)
+
+        process = target.LaunchSimple (None, None, self.get_process_working_directory())
+        self.assertTrue(process.GetState() == lldb.eStateStopped,
+                        PROCESS_STOPPED)
+
+        frame = process.GetThreadAtIndex(0).GetFrameAtIndex(0)
+        options = lldb.SBVariablesOptions()
+        options.SetIncludeStatics(True)
+
+        stream = lldb.SBStream()
+        self.assertTrue(frame.GetVariablesAsJSON(options, 0, 8, stream))
+        if self.TraceOn():
+            print "JSON snapshot:", stream.GetData()
+
+        import json
+        snapshot = json.loads(stream.GetData())
+        entries = {}
+        for entry in snapshot:
+            entries[entry["name"]] = entry
+
+        for name in ["g_nul_ch", "g_newline_ch"]:
+            val = frame.FindVariable(name)
+            self.assertTrue(val.IsValid(), "Found " + name)
+            self.assertTrue("\\" in val.GetValue())
+            self.assertTrue(name in entries)
+            self.assertTrue(entries[name]["value"] == val.GetValue())
+
+        path = frame.FindVariable("g_path")
+        self.assertTrue(path.IsValid(), "Found g_path")
+        self.assertTrue("\\" in path.GetSummary())
+        self.assertTrue("g_path" in entries)
+        self.assertTrue(entries["g_path"]["summary"] == path.GetSummary())
+
     def frame_api_boundary_condition(self):
         exe = os.path.join(os.getcwd(), "a.out")
 
@@ -10,6 +10,11 @@
 
 // This simple program is to test the lldb Python API related to frames.
 
+// Globals whose values and summaries need escaping in JSON.
+char g_nul_ch = '\0';
+char g_newline_ch = '\n';
+char g_path[] = "a\\b\n";
+
 int a(int, char);
 int b(int, char);
 int c(int, char);
@@ -185,5 +185,74 @@ class MiVarTestCase(lldbmi_testcase.MiTestCaseBase):
         self.runCmd("-var-update --all-values var_complx_array")
         self.expect("\^done,changelist=\[\{name=\"var_complx_array\",value=\"\{\.\.\.\}\",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"\}\]")
 
+    @lldbmi_test
+    @expectedFailureWindows("llvm.org/pr22274: need a pexpect replacement for windows")
+    @skipIfFreeBSD # llvm.org/pr22411: Failure presumably due to known thread races
+    @skipIfLinux # llvm.org/pr22841: lldb-mi tests fail on all Linux buildbots
+    def test_lldbmi_var_update_padding(self):
+        """Test that 'lldb-mi --interpreter' -var-update ignores struct padding."""
+
+        self.spawnLldbMi(args = None)
+
+        # Load executable
+        self.runCmd("-file-exec-and-symbols %s" % self.myexe)
+        self.expect("\^done")
+
+        # Run to BP_var_update_padding_init
+        line = line_number('main.cpp', '// BP_var_update_padding_init')
+        self.runCmd("-break-insert main.cpp:%d" % line)
+        self.expect("\^done,bkpt={number=\"1\"")
+        self.runCmd("-exec-run")
+        self.expect("\^running")
+        self.expect("\*stopped,reason=\"breakpoint-hit\"")
+
+        # Setup variables
+        self.runCmd("-var-create var_padded * padded")
+        self.expect("\^done,name=\"var_padded\",numchild=\"2\",value=\"\{\.\.\.\}\",type=\"padded_type\",thread-id=\"1\",has_more=\"0\"")
+        self.runCmd("-var-create var_padded_array * padded_array")
+        self.expect("\^done,name=\"var_padded_array\",numchild=\"3\",value=\"\{\.\.\.\}\",type=\"padded_type \[3\]\",thread-id=\"1\",has_more=\"0\"")
+
+        # Go to BP_var_update_padding_unchanged
+        line = line_number('main.cpp', '// BP_var_update_padding_unchanged')
+        self.runCmd("-break-insert main.cpp:%d" % line)
+        self.expect("\^done,bkpt={number=\"2\"")
+        self.runCmd("-exec-continue")
+        self.expect("\^running")
+        self.expect("\*stopped,reason=\"breakpoint-hit\"")
+
+        # Test that only writing to the padding doesn't change the struct or the array
+        self.runCmd("-var-update --all-values var_padded")
+        self.expect("\^done,changelist=\[\]")
+        self.runCmd("-var-update --all-values var_padded_array")
+        self.expect("\^done,changelist=\[\]")
+
+        # Go to BP_var_update_padding_array
+        line = line_number('main.cpp', '// BP_var_update_padding_array')
+        self.runCmd("-break-insert main.cpp:%d" % line)
+        self.expect("\^done,bkpt={number=\"3\"")
+        self.runCmd("-exec-continue")
+        self.expect("\^running")
+        self.expect("\*stopped,reason=\"breakpoint-hit\"")
+
+        # Test that a member of the last element changes the array, and only once
+        self.runCmd("-var-update --all-values var_padded_array")
+        self.expect("\^done,changelist=\[\{name=\"var_padded_array\",value=\"\{\.\.\.\}\",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"\}\]")
+        self.runCmd("-var-update --all-values var_padded_array")
+        self.expect("\^done,changelist=\[\]")
+        self.runCmd("-var-update --all-values var_padded")
+        self.expect("\^done,changelist=\[\]")
+
+        # Go to BP_var_update_padding_array_again
+        line = line_number('main.cpp', '// BP_var_update_padding_array_again')
+        self.runCmd("-break-insert main.cpp:%d" % line)
+        self.expect("\^done,bkpt={number=\"4\"")
+        self.runCmd("-exec-continue")
+        self.expect("\^running")
+        self.expect("\*stopped,reason=\"breakpoint-hit\"")
+
+        # Test that a member of the first element changes the array
+        self.runCmd("-var-update --all-values var_padded_array")
+        self.expect("\^done,changelist=\[\{name=\"var_padded_array\",value=\"\{\.\.\.\}\",in_scope=\"true\",type_changed=\"false\",has_more=\"0\"\}\]")
+
 if __name__ == '__main__':
     unittest2.main()
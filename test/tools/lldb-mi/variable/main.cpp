@@ -34,6 +34,31 @@ var_update_test(void)
     // BP_var_update_test_complx_array
 }
 
+struct padded_type
+{
+    char c; // Followed by padding
+    int i;
+};
+
+void
+var_update_padding_test(void)
+{
+    padded_type padded = { 'a', 1 };
+    padded_type padded_array[3] = { { 'b', 2 }, { 'c', 3 }, { 'd', 4 } };
+    // BP_var_update_padding_init
+
+    // Only write to the padding, the values stay the same
+    reinterpret_cast<char *>(&padded)[1] = 0x55;
+    reinterpret_cast<char *>(&padded_array[1])[2] = 0x55;
+    // BP_var_update_padding_unchanged
+
+    padded_array[2].i = 5;
+    // BP_var_update_padding_array
+
+    padded_array[0].c = 'e';
+    // BP_var_update_padding_array_again
+}
+
 int g_MyVar = 3;
 static int s_MyVar = 4;
 
@@ -43,5 +68,6 @@ main(int argc, char const *argv[])
     int a = 10, b = 20;
     s_MyVar = a + b;
     var_update_test();
+    var_update_padding_test();
     return 0; // BP_return
 }
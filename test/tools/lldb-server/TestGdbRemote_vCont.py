@@ -1,6 +1,8 @@
 import unittest2
 
 import gdbremote_testcase
+import lldbgdbserverutils
+import signal
 from lldbtest import *
 
 class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
@@ -33,6 +35,122 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
     def vCont_supports_S(self):
         self.vCont_supports_mode("S")
 
+    def vCont_supports_r(self):
+        self.vCont_supports_mode("r")
+
+    def run_to_range_loop(self, loop_function):
+        """Run the inferior to the start of one of its range loops and return the loop addresses."""
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["get-range-loop-hex:{}".format(loop_function), "sleep:1", "call-function:{}".format(loop_function)])
+        self.add_process_info_collection_packets()
+        self.add_register_info_collection_packets()
+        self.test_sequence.add_log_lines(
+            [# Start running after initial stop.
+             "read packet: $c#63",
+             # Match the output line with the loop addresses.
+             { "type":"output_match", "regex":r"^range loop: 0x([0-9a-fA-F]+) 0x([0-9a-fA-F]+) 0x([0-9a-fA-F]+) 0x([0-9a-fA-F]+)\r\n$",
+               "capture":{ 1:"loop_start", 2:"loop_body", 3:"loop_end", 4:"count_address"} },
+             # Now stop the inferior while it sleeps.
+             "read packet: {}".format(chr(03)),
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        process_info = self.parse_process_info_response(context)
+        self.endian = process_info.get("endian")
+        self.assertIsNotNone(self.endian)
+
+        reg_infos = self.parse_register_info_packets(context)
+        (self.pc_lldb_reg_index, pc_reg_info) = self.find_pc_reg_info(reg_infos)
+        self.assertIsNotNone(self.pc_lldb_reg_index)
+
+        loop = {}
+        for key in ["loop_start", "loop_body", "loop_end", "count_address"]:
+            self.assertIsNotNone(context.get(key))
+            loop[key] = int(context.get(key), 16)
+
+        # Run to the start of the loop.
+        self.reset_test_sequence()
+        self.add_set_breakpoint_packets(loop["loop_start"], do_continue=True)
+        self.add_remove_breakpoint_packets(loop["loop_start"])
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertEquals(int(context.get("stop_signo"), 16), signal.SIGTRAP)
+        loop["thread_id"] = int(context.get("stop_thread_id"), 16)
+        self.assertEquals(self.read_pc_and_range_loop_count(loop)[0], loop["loop_start"])
+        return loop
+
+    def read_pc_and_range_loop_count(self, loop):
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $p{0:x}#00".format(self.pc_lldb_reg_index),
+             { "direction":"send", "regex":r"^\$([0-9a-fA-F]+)#", "capture":{1:"p_response"} },
+             "read packet: $m{0:x},4#00".format(loop["count_address"]),
+             { "direction":"send", "regex":r"^\$([0-9a-fA-F]+)#", "capture":{1:"count"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        pc = lldbgdbserverutils.unpack_register_hex_unsigned(self.endian, context.get("p_response"))
+        count = lldbgdbserverutils.unpack_register_hex_unsigned(self.endian, context.get("count"))
+        return (pc, count)
+
+    def range_step(self, loop):
+        """Range step through the loop and return the stop signal and the stop reason."""
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $vCont;r{0:x},{1:x}:{2:x}#00".format(loop["loop_start"], loop["loop_end"], loop["thread_id"]),
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);([^#]*)#", "capture":{1:"stop_signo", 2:"stop_thread_id", 3:"stop_key_vals_text"} }],
+            True)
+        context = self.expect_gdbremote_sequence(timeout_seconds=30)
+        self.assertIsNotNone(context)
+        self.assertEquals(int(context.get("stop_thread_id"), 16), loop["thread_id"])
+        kv_dict = self.parse_key_val_dict(context.get("stop_key_vals_text"))
+        return (int(context.get("stop_signo"), 16), kv_dict.get("reason"))
+
+    def vCont_r_stops_once_when_leaving_range(self):
+        loop = self.run_to_range_loop("range_loop_count")
+
+        # Every iteration of the loop runs before the one stop is reported.
+        # Another stop reply would show up in place of the p and m replies.
+        self.assertEquals(self.range_step(loop), (signal.SIGTRAP, "trace"))
+        (pc, count) = self.read_pc_and_range_loop_count(loop)
+        self.assertTrue(pc < loop["loop_start"] or pc >= loop["loop_end"])
+        self.assertEquals(count, 100)
+
+    def vCont_r_stops_at_breakpoint_in_range(self):
+        loop = self.run_to_range_loop("range_loop_count")
+
+        # A breakpoint in the range stops the range step before the first
+        # iteration's increment, and is reported as a breakpoint hit.
+        self.reset_test_sequence()
+        self.add_set_breakpoint_packets(loop["loop_body"], do_continue=False)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        self.assertEquals(self.range_step(loop), (signal.SIGTRAP, "breakpoint"))
+        self.assertEquals(self.read_pc_and_range_loop_count(loop), (loop["loop_body"], 0))
+
+        # Without the breakpoint the range step goes on until the loop ends.
+        self.reset_test_sequence()
+        self.add_remove_breakpoint_packets(loop["loop_body"])
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        self.assertEquals(self.range_step(loop), (signal.SIGTRAP, "trace"))
+        (pc, count) = self.read_pc_and_range_loop_count(loop)
+        self.assertTrue(pc < loop["loop_start"] or pc >= loop["loop_end"])
+        self.assertEquals(count, 100)
+
+    def vCont_r_stops_for_signal_in_range(self):
+        loop = self.run_to_range_loop("range_loop_alarm")
+
+        # The loop never leaves the range on its own, the SIGALRM it asks
+        # for a second after starting must end the range step right away.
+        self.assertEquals(self.range_step(loop)[0], signal.SIGALRM)
+        (pc, count) = self.read_pc_and_range_loop_count(loop)
+        self.assertTrue(loop["loop_start"] <= pc < loop["loop_end"])
+
     @debugserver_test
     @dsym_test
     def test_vCont_supports_c_debugserver_dsym(self):
@@ -88,6 +206,37 @@ class TestGdbRemote_vCont(gdbremote_testcase.GdbRemoteTestCaseBase):
         self.buildDwarf()
         self.vCont_supports_S()
 
+    @llgs_test
+    @dwarf_test
+    def test_vCont_supports_r_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.vCont_supports_r()
+
+    @llgs_test
+    @dwarf_test
+    def test_vCont_r_stops_once_when_leaving_range_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.vCont_r_stops_once_when_leaving_range()
+
+    @llgs_test
+    @dwarf_test
+    def test_vCont_r_stops_at_breakpoint_in_range_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.vCont_r_stops_at_breakpoint_in_range()
+
+    @llgs_test
+    @dwarf_test
+    def test_vCont_r_stops_for_signal_in_range_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.vCont_r_stops_for_signal_in_range()
+
     @debugserver_test
     @dsym_test
     def test_single_step_only_steps_one_instruction_with_Hc_vCont_s_debugserver_dsym(self):
@@ -703,6 +703,67 @@ class LldbGdbServerTestCase(gdbremote_testcase.GdbRemoteTestCaseBase):
         self.set_inferior_startup_attach()
         self.p_returns_correct_data_size_for_each_qRegisterInfo()
 
+    def g_returns_register_data_matching_p(self):
+        procs = self.prep_debug_monitor_and_inferior()
+        self.add_register_info_collection_packets()
+
+        # Run the packet stream.
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        # Gather register info entries.
+        reg_infos = self.parse_register_info_packets(context)
+        self.assertIsNotNone(reg_infos)
+        self.assertTrue(len(reg_infos) > 0)
+
+        # Read all registers at once.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $g#00",
+             { "direction":"send", "regex":r"^\$([0-9a-fA-F]+)#", "capture":{1:"g_response"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        # The register data must cover every register at its qRegisterInfo offset.
+        g_response = context.get("g_response")
+        self.assertIsNotNone(g_response)
+        reg_data_size = max([int(reg_info["offset"]) + int(reg_info["bitsize"]) / 8 for reg_info in reg_infos])
+        self.assertEquals(len(g_response), 2 * reg_data_size)
+
+        # The pc in the g data must match what p reports.
+        (pc_lldb_reg_index, pc_reg_info) = self.find_pc_reg_info(reg_infos)
+        self.assertIsNotNone(pc_lldb_reg_index)
+        self.assertIsNotNone(pc_reg_info)
+
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $p{0:x}#00".format(pc_lldb_reg_index),
+             { "direction":"send", "regex":r"^\$([0-9a-fA-F]+)#", "capture":{1:"p_response"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        pc_offset = int(pc_reg_info["offset"])
+        pc_size = int(pc_reg_info["bitsize"]) / 8
+        self.assertEquals(g_response[2 * pc_offset:2 * (pc_offset + pc_size)], context.get("p_response"))
+
+    @debugserver_test
+    @dsym_test
+    def test_g_returns_register_data_matching_p_debugserver_dsym(self):
+        self.init_debugserver_test()
+        self.buildDsym()
+        self.set_inferior_startup_launch()
+        self.g_returns_register_data_matching_p()
+
+    @llgs_test
+    @dwarf_test
+    def test_g_returns_register_data_matching_p_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.g_returns_register_data_matching_p()
+
     def Hg_switches_to_3_threads(self):
         # Startup the inferior with three threads (main + 2 new ones).
         procs = self.prep_debug_monitor_and_inferior(inferior_args=["thread:new", "thread:new"])
@@ -1280,6 +1341,235 @@ class LldbGdbServerTestCase(gdbremote_testcase.GdbRemoteTestCaseBase):
         self.set_inferior_startup_launch()
         self.software_breakpoint_set_and_remove_work()
 
+    def multi_breakpoint_set_and_remove_work(self):
+        # Start up the inferior.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["get-code-address-hex:hello", "sleep:1", "call-function:hello"])
+
+        # Run the process and grab the function address.
+        self.test_sequence.add_log_lines(
+            [# Start running after initial stop.
+             "read packet: $c#63",
+             # Match output line that prints the memory address of the function call entry point.
+             { "type":"output_match", "regex":r"^code address: 0x([0-9a-fA-F]+)\r\n$", "capture":{ 1:"function_address"} },
+             # Now stop the inferior.
+             "read packet: {}".format(chr(03)),
+             # And wait for the stop notification.
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} }],
+            True)
+
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertIsNotNone(context.get("function_address"))
+        function_address = int(context.get("function_address"), 16)
+
+        # Set a breakpoint at the function and one at an unmapped address in
+        # the same packet.  Only the second one should fail.
+        BREAKPOINT_KIND = 1
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            [
+             "read packet: $_Z0;{0:x},{1};0,{1}#00".format(function_address, BREAKPOINT_KIND),
+             "send packet: $OK;E09#00",
+             "read packet: $c#63",
+             # Wait for the breakpoint stop.
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} },
+             ], True)
+
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        stop_signo = context.get("stop_signo")
+        self.assertIsNotNone(stop_signo)
+        self.assertEquals(int(stop_signo,16), signal.SIGTRAP)
+
+        # Remove the breakpoint and run to completion.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            [
+            "read packet: $_z0;{0:x},{1}#00".format(function_address, BREAKPOINT_KIND),
+            "send packet: $OK#00",
+            "read packet: $c#63",
+            # We should now receive the output from the call.
+            { "type":"output_match", "regex":r"^hello, world\r\n$" },
+            # And wait for program completion.
+            {"direction":"send", "regex":r"^\$W00(.*)#[0-9a-fA-F]{2}$" },
+            ], True)
+
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+    @llgs_test
+    @dwarf_test
+    def test_multi_breakpoint_set_and_remove_work_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.multi_breakpoint_set_and_remove_work()
+
+    def large_write_watchpoint_reports_hit(self):
+        # Larger than any debug register can cover, so the stub has to
+        # write-protect the page holding it.
+        WATCH_SIZE = 64
+
+        # Start up the inferior.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["get-data-address-hex:g_message", "sleep:1", "set-message:watched"])
+
+        self.test_sequence.add_log_lines(
+            [# Start running after initial stop.
+             "read packet: $c#63",
+             # Match output line that prints the memory address of the message buffer within the inferior.
+             { "type":"output_match", "regex":r"^data address: 0x([0-9a-fA-F]+)\r\n$", "capture":{ 1:"message_address"} },
+             # Now stop the inferior.
+             "read packet: {}".format(chr(03)),
+             # And wait for the stop notification.
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        self.assertIsNotNone(context.get("message_address"))
+        message_address = int(context.get("message_address"), 16)
+
+        # Set the watchpoint and continue; set-message writes into it.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $Z2,{0:x},{1:x}#00".format(message_address, WATCH_SIZE),
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})[^#]*reason:watchpoint;", "capture":{1:"stop_signo"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertEquals(int(context.get("stop_signo"), 16), signal.SIGTRAP)
+
+        # Removing it lets the inferior run to completion.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $z2,{0:x},{1:x}#00".format(message_address, WATCH_SIZE),
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             {"direction":"send", "regex":r"^\$W00(.*)#[0-9a-fA-F]{2}$" }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+    @llgs_test
+    @dwarf_test
+    @unittest2.skipUnless(platform.machine() == 'x86_64', "page watchpoints need x86_64")
+    def test_large_write_watchpoint_reports_hit_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.large_write_watchpoint_reports_hit()
+
+    def large_write_watchpoint_spares_forked_child(self):
+        WATCH_SIZE = 64
+
+        # Start up the inferior.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["get-data-address-hex:g_message", "sleep:1", "fork-and-write:"])
+
+        self.test_sequence.add_log_lines(
+            [# Start running after initial stop.
+             "read packet: $c#63",
+             # Match output line that prints the memory address of the message buffer within the inferior.
+             { "type":"output_match", "regex":r"^data address: 0x([0-9a-fA-F]+)\r\n$", "capture":{ 1:"message_address"} },
+             # Now stop the inferior.
+             "read packet: {}".format(chr(03)),
+             # And wait for the stop notification.
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        self.assertIsNotNone(context.get("message_address"))
+        message_address = int(context.get("message_address"), 16)
+
+        # The child writes to the watched buffer.  It must not inherit the
+        # protection, and its store is not a hit in the inferior.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $Z2,{0:x},{1:x}#00".format(message_address, WATCH_SIZE),
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             { "type":"output_match", "regex":r"^fork child status: (\d+)\r\n$", "capture":{ 1:"child_status"} },
+             {"direction":"send", "regex":r"^\$W00(.*)#[0-9a-fA-F]{2}$" }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+        self.assertEquals(int(context.get("child_status")), 0)
+
+    @llgs_test
+    @dwarf_test
+    @unittest2.skipUnless(platform.machine() == 'x86_64', "page watchpoints need x86_64")
+    def test_large_write_watchpoint_spares_forked_child_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.large_write_watchpoint_spares_forked_child()
+
+    def large_write_watchpoint_with_threads_storing_to_page(self):
+        WATCH_SIZE = 64
+
+        # Start up the inferior.
+        procs = self.prep_debug_monitor_and_inferior(
+            inferior_args=["get-data-address-hex:g_page_writes", "sleep:1", "write-from-threads:"])
+
+        self.test_sequence.add_log_lines(
+            [# Start running after initial stop.
+             "read packet: $c#63",
+             # Match output line that prints the memory address of the watched buffer within the inferior.
+             { "type":"output_match", "regex":r"^data address: 0x([0-9a-fA-F]+)\r\n$", "capture":{ 1:"page_writes_address"} },
+             # Now stop the inferior.
+             "read packet: {}".format(chr(03)),
+             # And wait for the stop notification.
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})thread:([0-9a-fA-F]+);", "capture":{1:"stop_signo", 2:"stop_thread_id"} }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+        self.assertIsNotNone(context.get("page_writes_address"))
+        page_writes_address = int(context.get("page_writes_address"), 16)
+
+        # Several threads running the same code store to the watched page,
+        # outside of the watched bytes, at once.  Each store is stepped over
+        # without a stop and without disturbing the other threads.  Then the
+        # main thread stores to the watched bytes.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $Z2,{0:x},{1:x}#00".format(page_writes_address, WATCH_SIZE),
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             { "type":"output_match", "regex":r"^page writes: ([0-9 ]+)\r\n$", "capture":{ 1:"page_writes"} },
+             {"direction":"send", "regex":r"^\$T([0-9a-fA-F]{2})[^#]*reason:watchpoint;", "capture":{1:"stop_signo"} }],
+            True)
+        context = self.expect_gdbremote_sequence(timeout_seconds=60)
+        self.assertIsNotNone(context)
+        self.assertEquals(context.get("page_writes"), "100 100 100 100")
+        self.assertEquals(int(context.get("stop_signo"), 16), signal.SIGTRAP)
+
+        # Removing it lets the inferior run to completion.
+        self.reset_test_sequence()
+        self.test_sequence.add_log_lines(
+            ["read packet: $z2,{0:x},{1:x}#00".format(page_writes_address, WATCH_SIZE),
+             "send packet: $OK#00",
+             "read packet: $c#63",
+             {"direction":"send", "regex":r"^\$W00(.*)#[0-9a-fA-F]{2}$" }],
+            True)
+        context = self.expect_gdbremote_sequence()
+        self.assertIsNotNone(context)
+
+    @llgs_test
+    @dwarf_test
+    @unittest2.skipUnless(platform.machine() == 'x86_64', "page watchpoints need x86_64")
+    def test_large_write_watchpoint_with_threads_storing_to_page_llgs_dwarf(self):
+        self.init_llgs_test()
+        self.buildDwarf()
+        self.set_inferior_startup_launch()
+        self.large_write_watchpoint_with_threads_storing_to_page()
+
     def qSupported_returns_known_stub_features(self):
         # Start up the stub and start/prep the inferior.
         procs = self.prep_debug_monitor_and_inferior()
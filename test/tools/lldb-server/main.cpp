@@ -12,6 +12,7 @@
 #include <time.h>
 #include <unistd.h>
 #include <vector>
+#include <sys/wait.h>
 
 #if defined(__APPLE__)
 __OSX_AVAILABLE_STARTING(__MAC_10_6, __IPHONE_3_2)
@@ -29,11 +30,14 @@ static const char *const SLEEP_PREFIX                = "sleep:";
 static const char *const STDERR_PREFIX               = "stderr:";
 static const char *const SET_MESSAGE_PREFIX          = "set-message:";
 static const char *const PRINT_MESSAGE_COMMAND       = "print-message:";
+static const char *const FORK_AND_WRITE_COMMAND      = "fork-and-write:";
+static const char *const WRITE_FROM_THREADS_COMMAND  = "write-from-threads:";
 static const char *const GET_DATA_ADDRESS_PREFIX     = "get-data-address-hex:";
 static const char *const GET_STACK_ADDRESS_COMMAND   = "get-stack-address-hex:";
 static const char *const GET_HEAP_ADDRESS_COMMAND    = "get-heap-address-hex:";
 
 static const char *const GET_CODE_ADDRESS_PREFIX     = "get-code-address-hex:";
+static const char *const GET_RANGE_LOOP_PREFIX       = "get-range-loop-hex:";
 static const char *const CALL_FUNCTION_PREFIX        = "call-function:";
 
 static const char *const THREAD_PREFIX = "thread:";
@@ -51,9 +55,18 @@ static bool g_is_segfaulting = false;
 
 static char g_message[256];
 
+// Aligned so that it never straddles a page.
+static char g_page_writes[256] __attribute__ ((aligned (256)));
+static const int PAGE_WRITER_COUNT = 4;
+static const int PAGE_WRITES_PER_THREAD = 100;
+static volatile int g_page_writers_ready = 0;
+
 static volatile char g_c1 = '0';
 static volatile char g_c2 = '1';
 
+static volatile int g_range_loop_count = 0;
+static volatile sig_atomic_t g_range_loop_alarm = 0;
+
 static void
 print_thread_id ()
 {
@@ -134,6 +147,101 @@ swap_chars ()
     g_c2 = '1';
 }
 
+// The range step tests step through the code between the loop_start and
+// loop_end labels in one go. When print_addresses is true the addresses
+// of the labels and of the loop counter are printed instead of running
+// the loop.
+static void
+range_loop_count (bool print_addresses)
+{
+    if (print_addresses)
+    {
+        pthread_mutex_lock (&g_print_mutex);
+        printf ("range loop: %p %p %p %p\n", &&loop_start, &&loop_body, &&loop_end, &g_range_loop_count);
+        pthread_mutex_unlock (&g_print_mutex);
+        return;
+    }
+
+loop_start:
+    for (int i = 0; i < 100; ++i)
+    {
+loop_body:
+        ++g_range_loop_count;
+    }
+loop_end:
+    pthread_mutex_lock (&g_print_mutex);
+    printf ("range loop count: %d\n", g_range_loop_count);
+    pthread_mutex_unlock (&g_print_mutex);
+}
+
+static void
+range_loop_alarm_handler (int signo)
+{
+    g_range_loop_alarm = 1;
+}
+
+// Like range_loop_count, but the loop only ends once a SIGALRM arrives,
+// which happens about a second after the loop starts.
+static void
+range_loop_alarm (bool print_addresses)
+{
+    if (print_addresses)
+    {
+        pthread_mutex_lock (&g_print_mutex);
+        printf ("range loop: %p %p %p %p\n", &&loop_start, &&loop_body, &&loop_end, &g_range_loop_count);
+        pthread_mutex_unlock (&g_print_mutex);
+        return;
+    }
+
+    signal (SIGALRM, range_loop_alarm_handler);
+    alarm (1);
+loop_start:
+    while (!g_range_loop_alarm)
+    {
+loop_body:
+        ++g_range_loop_count;
+    }
+loop_end:
+    signal (SIGALRM, signal_handler);
+}
+
+static void*
+page_writer_func (void *arg)
+{
+    // Each thread counts in its own byte, on the page of g_page_writes but
+    // past its first 64 bytes, where the page watchpoint tests watch.
+    volatile char *counter = &g_page_writes[128 + reinterpret_cast<intptr_t> (arg)];
+
+    // Start storing at the same time as the other threads.
+    __sync_fetch_and_add (&g_page_writers_ready, 1);
+    while (g_page_writers_ready < PAGE_WRITER_COUNT)
+        ;
+
+    for (int i = 0; i < PAGE_WRITES_PER_THREAD; ++i)
+        ++*counter;
+    return nullptr;
+}
+
+static void
+write_from_threads ()
+{
+    pthread_t page_writers[PAGE_WRITER_COUNT];
+    for (intptr_t i = 0; i < PAGE_WRITER_COUNT; ++i)
+        pthread_create (&page_writers[i], nullptr, page_writer_func, reinterpret_cast<void*> (i));
+    for (int i = 0; i < PAGE_WRITER_COUNT; ++i)
+        pthread_join (page_writers[i], nullptr);
+
+    pthread_mutex_lock (&g_print_mutex);
+    printf ("page writes:");
+    for (int i = 0; i < PAGE_WRITER_COUNT; ++i)
+        printf (" %d", g_page_writes[128 + i]);
+    printf ("\n");
+    pthread_mutex_unlock (&g_print_mutex);
+
+    // Then a store to the watched bytes.
+    g_page_writes[0] = 'x';
+}
+
 static void
 hello ()
 {
@@ -273,6 +381,27 @@ int main (int argc, char **argv)
 				// std::cout << "sleep result (call " << i << "): " << sleep_seconds_remaining << std::endl;
 			}
         }
+		else if (std::strstr (argv[i], FORK_AND_WRITE_COMMAND))
+		{
+			// Write to g_message from a forked child, which is not debugged.
+			const pid_t child_pid = fork ();
+			if (child_pid == 0)
+			{
+				g_message[0] = 'x';
+				_exit (0);
+			}
+
+			int status = 0;
+			waitpid (child_pid, &status, 0);
+			pthread_mutex_lock (&g_print_mutex);
+			printf ("fork child status: %d\n", status);
+			pthread_mutex_unlock (&g_print_mutex);
+		}
+		else if (std::strstr (argv[i], WRITE_FROM_THREADS_COMMAND))
+		{
+			// Store to the page of g_page_writes from several threads at once.
+			write_from_threads ();
+		}
 		else if (std::strstr (argv[i], SET_MESSAGE_PREFIX))
 		{
 			// Copy the contents after "set-message:" to the g_message buffer.
@@ -295,6 +424,8 @@ int main (int argc, char **argv)
 
             if (std::strstr (argv[i] + strlen (GET_DATA_ADDRESS_PREFIX), "g_message"))
                 data_p = &g_message[0];
+            else if (std::strstr (argv[i] + strlen (GET_DATA_ADDRESS_PREFIX), "g_page_writes"))
+                data_p = &g_page_writes[0];
             else if (std::strstr (argv[i] + strlen (GET_DATA_ADDRESS_PREFIX), "g_c1"))
                 data_p = &g_c1;
             else if (std::strstr (argv[i] + strlen (GET_DATA_ADDRESS_PREFIX), "g_c2"))
@@ -333,6 +464,13 @@ int main (int argc, char **argv)
             printf ("code address: %p\n", func_p);
 			pthread_mutex_unlock (&g_print_mutex);
         }
+        else if (std::strstr (argv[i], GET_RANGE_LOOP_PREFIX))
+        {
+            if (std::strstr (argv[i] + strlen (GET_RANGE_LOOP_PREFIX), "range_loop_count"))
+                range_loop_count (true);
+            else if (std::strstr (argv[i] + strlen (GET_RANGE_LOOP_PREFIX), "range_loop_alarm"))
+                range_loop_alarm (true);
+        }
         else if (std::strstr (argv[i], CALL_FUNCTION_PREFIX))
         {
             // Defaut to providing the address of main.
@@ -340,6 +478,10 @@ int main (int argc, char **argv)
                 hello();
             else if (std::strcmp (argv[i] + strlen (CALL_FUNCTION_PREFIX), "swap_chars") == 0)
                 swap_chars();
+            else if (std::strcmp (argv[i] + strlen (CALL_FUNCTION_PREFIX), "range_loop_count") == 0)
+                range_loop_count (false);
+            else if (std::strcmp (argv[i] + strlen (CALL_FUNCTION_PREFIX), "range_loop_alarm") == 0)
+                range_loop_alarm (false);
             else
             {
                 pthread_mutex_lock (&g_print_mutex);
@@ -394,8 +394,9 @@ CMICmdCmdVarUpdate::Execute(void)
         return MIstatus::failure;
     }
 
+    // Decide from the value's raw bytes where possible, only walk the children when that can't be done
     lldb::SBValue &rValue = varObj.GetValue();
-    if (!ExamineSBValueForChange(rValue, m_bValueChanged))
+    if (!varObj.GetValueBytesChanged(m_bValueChanged) && !ExamineSBValueForChange(rValue, m_bValueChanged))
         return MIstatus::failure;
 
     if (m_bValueChanged)
@@ -7,6 +7,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+// Third Party Headers:
+#include <algorithm>
+#include "lldb/API/SBData.h"
+#include "lldb/API/SBError.h"
+
 // In-house headers:
 #include "MICmnLLDBDebugSessionInfoVarObj.h"
 #include "MICmnLLDBProxySBValue.h"
@@ -34,6 +39,7 @@ MIuint CMICmnLLDBDebugSessionInfoVarObj::ms_nVarUniqueId = 0; // Index from 0
 CMICmnLLDBDebugSessionInfoVarObj::CMICmnLLDBDebugSessionInfoVarObj(void)
     : m_eVarFormat(eVarFormat_Natural)
     , m_eVarType(eVarType_Internal)
+    , m_bValueBytesValid(false)
 {
     // Do not call UpdateValue() in here as not necessary
 }
@@ -54,6 +60,7 @@ CMICmnLLDBDebugSessionInfoVarObj::CMICmnLLDBDebugSessionInfoVarObj(const CMIUtil
     , m_strName(vrStrName)
     , m_SBValue(vrValue)
     , m_strNameReal(vrStrNameReal)
+    , m_bValueBytesValid(false)
 {
     UpdateValue();
 }
@@ -76,6 +83,7 @@ CMICmnLLDBDebugSessionInfoVarObj::CMICmnLLDBDebugSessionInfoVarObj(const CMIUtil
     , m_SBValue(vrValue)
     , m_strNameReal(vrStrNameReal)
     , m_strVarObjParentName(vrStrVarObjParentName)
+    , m_bValueBytesValid(false)
 {
     UpdateValue();
 }
@@ -166,6 +174,9 @@ CMICmnLLDBDebugSessionInfoVarObj::CopyOther(const CMICmnLLDBDebugSessionInfoVarO
     m_strNameReal = vrOther.m_strNameReal;
     m_strFormattedValue = vrOther.m_strFormattedValue;
     m_strVarObjParentName = vrOther.m_strVarObjParentName;
+    m_vecValueBytes = vrOther.m_vecValueBytes;
+    m_vecValueByteMask = vrOther.m_vecValueByteMask;
+    m_bValueBytesValid = vrOther.m_bValueBytesValid;
 
     return MIstatus::success;
 }
@@ -193,6 +204,9 @@ CMICmnLLDBDebugSessionInfoVarObj::MoveOther(CMICmnLLDBDebugSessionInfoVarObj &vr
     vrwOther.m_strNameReal.clear();
     vrwOther.m_strFormattedValue.clear();
     vrwOther.m_strVarObjParentName.clear();
+    vrwOther.m_vecValueBytes.clear();
+    vrwOther.m_vecValueByteMask.clear();
+    vrwOther.m_bValueBytesValid = false;
 
     return MIstatus::success;
 }
@@ -550,9 +564,167 @@ CMICmnLLDBDebugSessionInfoVarObj::UpdateValue(void)
     if (CMICmnLLDBProxySBValue::GetValueAsUnsigned(m_SBValue, nValue) == MIstatus::failure)
         m_eVarType = eVarType_Composite;
 
+    // Remember the bytes that were formatted so later updates can tell cheaply whether anything changed.
+    // The type doesn't change, so which of those bytes hold the value only needs working out once.
+    m_bValueBytesValid = ReadValueBytes(m_SBValue, m_vecValueBytes);
+    if (m_bValueBytesValid && (m_vecValueByteMask.size() != m_vecValueBytes.size()))
+    {
+        m_vecValueByteMask.assign(m_vecValueBytes.size(), 0);
+        if (!MarkValueBytes(m_SBValue.GetType(), 0, m_vecValueByteMask))
+            m_vecValueByteMask.clear();
+    }
+    m_bValueBytesValid = m_bValueBytesValid && (m_vecValueByteMask.size() == m_vecValueBytes.size());
+
     CMICmnLLDBDebugSessionInfoVarObj::VarObjUpdate(*this);
 }
 
+//++ ------------------------------------------------------------------------------------
+// Details: Compare the value's current raw bytes with those it had when *this var object
+//          was last updated. A struct or array changes exactly when its bytes do, so this
+//          avoids walking and updating every child value. Synthetic values (i.e. STL
+//          containers) keep their children out of line and are not covered.
+// Type:    Method.
+// Args:    vrwbChanged - (W) True = value bytes changed, false = unchanged.
+// Return:  MIstatus::success - Functional succeeded, vrwbChanged is valid.
+//          MIstatus::failure - The change cannot be decided from the value's bytes.
+// Throws:  None.
+//--
+bool
+CMICmnLLDBDebugSessionInfoVarObj::GetValueBytesChanged(bool &vrwbChanged)
+{
+    if (!m_bValueBytesValid || m_SBValue.IsSynthetic())
+        return MIstatus::failure;
+
+    VecBytes_t vecBytes;
+    if (!ReadValueBytes(m_SBValue, vecBytes) || (vecBytes.size() != m_vecValueBytes.size()))
+        return MIstatus::failure;
+
+    // Padding bytes are not part of the value, they may differ while every member is the same
+    vrwbChanged = false;
+    const size_t nBytes = vecBytes.size();
+    for (size_t i = 0; i < nBytes; i++)
+    {
+        if (m_vecValueByteMask[i] && (vecBytes[i] != m_vecValueBytes[i]))
+        {
+            vrwbChanged = true;
+            break;
+        }
+    }
+
+    return MIstatus::success;
+}
+
+//++ ------------------------------------------------------------------------------------
+// Details: Mark the bytes that hold a value of the given type, leaving the padding between
+//          and after struct members unmarked.
+// Type:    Static method.
+// Args:    vType       - (R) The type of the value, or of a member of it.
+//          vnOffset    - (R) Offset of the value within the outermost value.
+//          vrwVecMask  - (W) One entry per byte of the outermost value, set to 1 for the
+//                            bytes that are part of the value.
+// Return:  MIstatus::success - Functional succeeded.
+//          MIstatus::failure - The layout of the type cannot be worked out, i.e. it has
+//                              virtual base classes.
+// Throws:  None.
+//--
+bool
+CMICmnLLDBDebugSessionInfoVarObj::MarkValueBytes(lldb::SBType vType, const size_t vnOffset, VecBytes_t &vrwVecMask)
+{
+    lldb::SBType type = vType.GetCanonicalType();
+    if (!type.IsValid())
+        return MIstatus::failure;
+
+    const size_t nByteSize = type.GetByteSize();
+    if (vnOffset + nByteSize > vrwVecMask.size())
+        return MIstatus::failure;
+
+    if (type.IsArrayType())
+    {
+        lldb::SBType elementType = type.GetArrayElementType();
+        const size_t nElementSize = elementType.GetByteSize();
+        if (nElementSize == 0)
+            return MIstatus::failure;
+
+        // Every element has the same layout, work it out for the first and copy it to the others
+        if (!MarkValueBytes(elementType, vnOffset, vrwVecMask))
+            return MIstatus::failure;
+        const size_t nElements = nByteSize / nElementSize;
+        for (size_t i = 1; i < nElements; i++)
+            std::copy(vrwVecMask.begin() + vnOffset, vrwVecMask.begin() + vnOffset + nElementSize,
+                      vrwVecMask.begin() + vnOffset + i * nElementSize);
+        return MIstatus::success;
+    }
+
+    const lldb::TypeClass eTypeClass = type.GetTypeClass();
+    if ((eTypeClass != lldb::eTypeClassStruct) && (eTypeClass != lldb::eTypeClassClass) && (eTypeClass != lldb::eTypeClassUnion))
+    {
+        std::fill(vrwVecMask.begin() + vnOffset, vrwVecMask.begin() + vnOffset + nByteSize, 1);
+        return MIstatus::success;
+    }
+
+    // Virtual base classes are not at a fixed offset
+    if (type.GetNumberOfVirtualBaseClasses() != 0)
+        return MIstatus::failure;
+
+    const MIuint nBaseClasses = type.GetNumberOfDirectBaseClasses();
+    for (MIuint i = 0; i < nBaseClasses; i++)
+    {
+        lldb::SBTypeMember baseClass = type.GetDirectBaseClassAtIndex(i);
+        if (!MarkValueBytes(baseClass.GetType(), vnOffset + baseClass.GetOffsetInBytes(), vrwVecMask))
+            return MIstatus::failure;
+    }
+
+    const MIuint nFields = type.GetNumberOfFields();
+    for (MIuint i = 0; i < nFields; i++)
+    {
+        lldb::SBTypeMember field = type.GetFieldAtIndex(i);
+        if (field.IsBitfield())
+        {
+            // Mark every byte the bit-field touches
+            const size_t nFirstBit = field.GetOffsetInBits();
+            const size_t nFirstByte = vnOffset + nFirstBit / 8;
+            const size_t nEndByte = vnOffset + (nFirstBit + field.GetBitfieldSizeInBits() + 7) / 8;
+            if (nEndByte > vrwVecMask.size())
+                return MIstatus::failure;
+            std::fill(vrwVecMask.begin() + nFirstByte, vrwVecMask.begin() + nEndByte, 1);
+        }
+        else if (!MarkValueBytes(field.GetType(), vnOffset + field.GetOffsetInBytes(), vrwVecMask))
+            return MIstatus::failure;
+    }
+
+    return MIstatus::success;
+}
+
+//++ ------------------------------------------------------------------------------------
+// Details: Retrieve the raw bytes held by the value.
+// Type:    Static method.
+// Args:    vrValue     - (R) The LLDB value object.
+//          vrwVecBytes - (W) The value's bytes.
+// Return:  MIstatus::success - Functional succeeded.
+//          MIstatus::failure - Functional failed, i.e. the value is not in scope.
+// Throws:  None.
+//--
+bool
+CMICmnLLDBDebugSessionInfoVarObj::ReadValueBytes(lldb::SBValue &vrValue, VecBytes_t &vrwVecBytes)
+{
+    vrwVecBytes.clear();
+
+    lldb::SBData data = vrValue.GetData();
+    const size_t nBytes = data.IsValid() ? data.GetByteSize() : 0;
+    if (nBytes == 0)
+        return MIstatus::failure;
+
+    vrwVecBytes.resize(nBytes);
+    lldb::SBError error;
+    if (data.ReadRawData(error, 0, &vrwVecBytes[0], nBytes) != nBytes || error.Fail())
+    {
+        vrwVecBytes.clear();
+        return MIstatus::failure;
+    }
+
+    return MIstatus::success;
+}
+
 //++ ------------------------------------------------------------------------------------
 // Details: Retrieve the enumeration type of the var object.
 // Type:    Method.
@@ -11,6 +11,7 @@
 
 // Third Party Headers:
 #include <map>
+#include <vector>
 #include "lldb/API/SBValue.h"
 
 // In-house headers:
@@ -91,6 +92,7 @@ class CMICmnLLDBDebugSessionInfoVarObj
     bool SetVarFormat(const varFormat_e veVarFormat);
     const CMIUtilString &GetVarParentName(void) const;
     void UpdateValue(void);
+    bool GetValueBytesChanged(bool &vrwbChanged);
 
     // Overridden:
   public:
@@ -101,10 +103,13 @@ class CMICmnLLDBDebugSessionInfoVarObj
   private:
     typedef std::map<CMIUtilString, CMICmnLLDBDebugSessionInfoVarObj> MapKeyToVarObj_t;
     typedef std::pair<CMIUtilString, CMICmnLLDBDebugSessionInfoVarObj> MapPairKeyToVarObj_t;
+    typedef std::vector<MIuchar> VecBytes_t;
 
     // Statics:
   private:
     static CMIUtilString GetStringFormatted(const MIuint64 vnValue, const MIchar *vpStrValueNatural, varFormat_e veVarFormat);
+    static bool ReadValueBytes(lldb::SBValue &vrValue, VecBytes_t &vrwVecBytes);
+    static bool MarkValueBytes(lldb::SBType vType, const size_t vnOffset, VecBytes_t &vrwVecMask);
 
     // Methods:
   private:
@@ -126,5 +131,8 @@ class CMICmnLLDBDebugSessionInfoVarObj
     CMIUtilString m_strNameReal;
     CMIUtilString m_strFormattedValue;
     CMIUtilString m_strVarObjParentName;
+    VecBytes_t m_vecValueBytes;    // Raw bytes of the value when it was last formatted
+    VecBytes_t m_vecValueByteMask; // 1 for each byte of m_vecValueBytes that is part of the value, 0 for padding
+    bool m_bValueBytesValid;       // True = m_vecValueBytes can be used to detect changes
     // *** Upate the copy move constructors and assignment operator ***
 };
@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+
+"""
+Generate a large synthetic executable for lldb-perf-symbols.
+
+The executable is built from NUM_CUS compile units, each defining
+FUNCTIONS_PER_CU functions and as many global variables, all with debug
+info. The defaults produce 2000 compile units and about 4 million symbols.
+
+The sources are generated deterministically, so two runs with the same
+arguments and compiler produce the same binary.
+"""
+
+import multiprocessing
+import optparse
+import os
+import subprocess
+import sys
+
+
+def write_compile_unit(path, cu_index, functions_per_cu):
+    with open(path, "w") as f:
+        f.write("// Generated by generate-symbols-testcase.py, do not edit.\n")
+        f.write("struct cu%u_struct { int value; const char *name; };\n" % cu_index)
+        for i in range(functions_per_cu):
+            f.write("struct cu%u_struct cu%u_global_%u = { %u, \"cu%u_global_%u\" };\n" %
+                    (cu_index, cu_index, i, i, cu_index, i))
+            f.write("int cu%u_function_%u (int arg) { return arg + cu%u_global_%u.value; }\n" %
+                    (cu_index, i, cu_index, i))
+        f.write("int cu%u_entry (int arg)\n{\n    int sum = arg;\n" % cu_index)
+        for i in range(functions_per_cu):
+            f.write("    sum += cu%u_function_%u (sum);\n" % (cu_index, i))
+        f.write("    return sum;\n}\n")
+
+
+def write_main(path, num_cus):
+    with open(path, "w") as f:
+        f.write("// Generated by generate-symbols-testcase.py, do not edit.\n")
+        for cu_index in range(num_cus):
+            f.write("int cu%u_entry (int arg);\n" % cu_index)
+        f.write("int main (int argc, char **argv)\n{\n    int sum = argc;\n")
+        for cu_index in range(num_cus):
+            f.write("    sum += cu%u_entry (sum);\n" % cu_index)
+        f.write("    return sum == 0;\n}\n")
+
+
+def compile_source(args):
+    compiler, source, obj = args
+    if os.path.exists(obj) and os.path.getmtime(obj) >= os.path.getmtime(source):
+        return 0
+    return subprocess.call([compiler, "-c", "-g", "-O0", "-o", obj, source])
+
+
+def main():
+    parser = optparse.OptionParser(usage="usage: %prog [options] OUTPUT-DIR")
+    parser.add_option("--num-cus", type="int", default=2000,
+                      help="number of compile units to generate (default: %default)")
+    parser.add_option("--functions-per-cu", type="int", default=1000,
+                      help="number of functions and globals in each compile unit (default: %default)")
+    parser.add_option("--cc", default=os.environ.get("CC", "cc"),
+                      help="C compiler used to build the executable (default: %default)")
+    parser.add_option("-j", "--jobs", type="int", default=multiprocessing.cpu_count(),
+                      help="number of compilers to run in parallel (default: %default)")
+    (options, args) = parser.parse_args()
+    if len(args) != 1:
+        parser.error("an output directory is required")
+
+    output_dir = args[0]
+    source_dir = os.path.join(output_dir, "src")
+    if not os.path.isdir(source_dir):
+        os.makedirs(source_dir)
+
+    sources = []
+    for cu_index in range(options.num_cus):
+        source = os.path.join(source_dir, "cu%u.c" % cu_index)
+        write_compile_unit(source + ".tmp", cu_index, options.functions_per_cu)
+        # Only touch sources whose content changed so objects can be reused
+        if not os.path.exists(source) or open(source).read() != open(source + ".tmp").read():
+            os.rename(source + ".tmp", source)
+        else:
+            os.remove(source + ".tmp")
+        sources.append(source)
+    main_source = os.path.join(source_dir, "main.c")
+    write_main(main_source, options.num_cus)
+    sources.append(main_source)
+
+    objects = [os.path.splitext(source)[0] + ".o" for source in sources]
+    pool = multiprocessing.Pool(options.jobs)
+    results = pool.map(compile_source, [(options.cc, s, o) for (s, o) in zip(sources, objects)])
+    pool.close()
+    if any(results):
+        sys.stderr.write("error: failed to compile the generated sources\n")
+        return 1
+
+    executable = os.path.join(output_dir, "symbols-testcase")
+    # Link through a response file, the command line would be too long
+    response_file = os.path.join(output_dir, "objects.rsp")
+    with open(response_file, "w") as f:
+        f.write("\n".join(objects))
+    if subprocess.call([options.cc, "-o", executable, "@" + response_file]) != 0:
+        sys.stderr.write("error: failed to link '%s'\n" % executable)
+        return 1
+    print(executable)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
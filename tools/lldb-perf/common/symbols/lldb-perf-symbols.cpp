@@ -0,0 +1,432 @@
+//===-- lldb-perf-symbols.cpp -----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb-perf/lib/Timer.h"
+#include "lldb-perf/lib/Metric.h"
+#include "lldb-perf/lib/Measurement.h"
+#include "lldb-perf/lib/Results.h"
+#include "lldb-perf/lib/TestCase.h"
+#include "lldb-perf/lib/Xcode.h"
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+using namespace lldb_perf;
+
+//----------------------------------------------------------------------
+// Measures the phases of loading symbols for a large executable, usually
+// one made by generate-symbols-testcase.py. Each phase is timed from the
+// outside, and the time lldb's own Timer categories attribute to it is
+// reported alongside, as well as how much memory the phase used.
+//
+// No process is launched, everything is done on the target's module.
+//----------------------------------------------------------------------
+class SymbolsTest : public TestCase
+{
+    typedef void (*no_function) (void);
+
+public:
+    SymbolsTest () :
+        TestCase(),
+        m_module (),
+        m_time_create_target (),
+        m_time_parse_symbols (),
+        m_time_init_name_indexes (),
+        m_time_dwarf_index (),
+        m_time_resolve_symbol_context (),
+        m_memory_create_target (),
+        m_memory_parse_symbols (),
+        m_memory_init_name_indexes (),
+        m_memory_dwarf_index (),
+        m_memory_resolve_symbol_context (),
+        m_num_symbols (0),
+        m_num_resolved_addresses (0),
+        m_max_resolved_addresses (100000),
+        m_timer_categories (),
+        m_exe_path (),
+        m_out_path ()
+    {
+    }
+
+    virtual
+    ~SymbolsTest ()
+    {
+    }
+
+    virtual bool
+    Setup (int& argc, const char**& argv)
+    {
+        if (m_exe_path.empty())
+            return false;
+        // Timers are quiet by default, so this only records them
+        Xcode::RunCommand (m_debugger, "log timers enable", false);
+        return true;
+    }
+
+    virtual void
+    TestStep (int counter, ActionWanted &next_action)
+    {
+        // ObjectFileELF::ParseSymbols
+        m_memory_create_target.Start();
+        m_time_create_target.Start();
+        m_target = m_debugger.CreateTarget (m_exe_path.c_str());
+        m_time_create_target.Stop();
+        m_memory_create_target.Stop();
+        if (!m_target.IsValid() || m_target.GetNumModules() == 0)
+        {
+            fprintf (stderr, "error: unable to create a target for '%s'\n", m_exe_path.c_str());
+            exit (1);
+        }
+        m_module = m_target.GetModuleAtIndex (0);
+
+        m_memory_parse_symbols.Start();
+        m_time_parse_symbols.Start();
+        m_num_symbols = m_module.GetNumSymbols();
+        m_time_parse_symbols.Stop();
+        m_memory_parse_symbols.Stop();
+
+        // Symtab::InitNameIndexes, the first lookup by name builds them
+        m_memory_init_name_indexes.Start();
+        m_time_init_name_indexes.Start();
+        m_module.FindSymbols ("main", eSymbolTypeCode);
+        m_time_init_name_indexes.Stop();
+        m_memory_init_name_indexes.Stop();
+
+        // SymbolFileDWARF::Index, ELF files don't have accelerator tables
+        // so the first function lookup indexes all of the DWARF
+        m_memory_dwarf_index.Start();
+        m_time_dwarf_index.Start();
+        m_module.FindFunctions ("main", eFunctionNameTypeAuto);
+        m_time_dwarf_index.Stop();
+        m_memory_dwarf_index.Stop();
+
+        // SymbolFileDWARF::ResolveSymbolContext, spread the addresses over
+        // the whole symbol table
+        const size_t stride = m_num_symbols > m_max_resolved_addresses ? m_num_symbols / m_max_resolved_addresses : 1;
+        m_memory_resolve_symbol_context.Start();
+        m_time_resolve_symbol_context.Start();
+        for (size_t i = 0; i < m_num_symbols; i += stride)
+        {
+            SBSymbol symbol (m_module.GetSymbolAtIndex (i));
+            if (symbol.GetType() != eSymbolTypeCode && symbol.GetType() != eSymbolTypeData)
+                continue;
+            SBAddress addr (symbol.GetStartAddress());
+            if (!addr.IsValid())
+                continue;
+            m_target.ResolveSymbolContextForAddress (addr, eSymbolContextEverything);
+            ++m_num_resolved_addresses;
+        }
+        m_time_resolve_symbol_context.Stop();
+        m_memory_resolve_symbol_context.Stop();
+
+        GetTimerCategoryTimes ();
+        next_action.Kill();
+    }
+
+    void
+    WriteResults (Results &results)
+    {
+        Results::Dictionary& results_dict = results.GetDictionary();
+
+        results_dict.AddUnsigned ("num-symbols", "The number of symbols in the executable.", m_num_symbols);
+        results_dict.AddUnsigned ("num-resolved-addresses", "The number of addresses resolved in the resolve-symbol-context phase.", m_num_resolved_addresses);
+
+        WritePhase (results_dict, "create-target", "creating the target", NULL, m_time_create_target, m_memory_create_target);
+        WritePhase (results_dict, "parse-symbols", "parsing the symbol table", "ObjectFileELF::ParseSymbols", m_time_parse_symbols, m_memory_parse_symbols);
+        WritePhase (results_dict, "init-name-indexes", "building the symbol table name indexes", "Symtab::InitNameIndexes", m_time_init_name_indexes, m_memory_init_name_indexes);
+        WritePhase (results_dict, "dwarf-index", "indexing the DWARF", "SymbolFileDWARF::Index", m_time_dwarf_index, m_memory_dwarf_index);
+        WritePhase (results_dict, "resolve-symbol-context", "resolving symbol contexts", "SymbolFileDWARF::ResolveSymbolContext", m_time_resolve_symbol_context, m_memory_resolve_symbol_context);
+
+        results.Write(GetResultFilePath());
+    }
+
+    void
+    SetExecutablePath (const char *path)
+    {
+        if (path && path[0])
+            m_exe_path = path;
+        else
+            m_exe_path.clear();
+    }
+
+    void
+    SetResultFilePath (const char *path)
+    {
+        if (path && path[0])
+            m_out_path = path;
+        else
+            m_out_path.clear();
+    }
+
+    const char *
+    GetExecutablePath () const
+    {
+        if (m_exe_path.empty())
+            return NULL;
+        return m_exe_path.c_str();
+    }
+
+    const char *
+    GetResultFilePath () const
+    {
+        if (m_out_path.empty())
+            return NULL;
+        return m_out_path.c_str();
+    }
+
+    void
+    SetMaxResolvedAddresses (uint32_t max_resolved_addresses)
+    {
+        if (max_resolved_addresses > 0)
+            m_max_resolved_addresses = max_resolved_addresses;
+    }
+
+private:
+    //------------------------------------------------------------------
+    // Parse the "<seconds> sec for <category>" lines of "log timers dump".
+    // The categories are pretty function names, so they are matched on
+    // the qualified function name only.
+    //------------------------------------------------------------------
+    void
+    GetTimerCategoryTimes ()
+    {
+        SBCommandReturnObject result;
+        m_debugger.GetCommandInterpreter().HandleCommand ("log timers dump", result);
+        const char *output = result.GetOutput();
+        while (output && output[0])
+        {
+            const char *line_end = strchr (output, '\n');
+            std::string line (output, line_end ? line_end - output : strlen (output));
+            output = line_end ? line_end + 1 : NULL;
+
+            char *end = NULL;
+            const double seconds = strtod (line.c_str(), &end);
+            const char *separator = " sec for ";
+            if (end == line.c_str() || strncmp (end, separator, strlen (separator)) != 0)
+                continue;
+            m_timer_categories[std::string (end + strlen (separator))] += seconds;
+        }
+    }
+
+    double
+    GetTimerCategoryTime (const char *function_name) const
+    {
+        double seconds = 0.0;
+        for (auto pos = m_timer_categories.begin(); pos != m_timer_categories.end(); ++pos)
+        {
+            const size_t name_pos = pos->first.find (function_name);
+            if (name_pos != std::string::npos && pos->first[name_pos + strlen (function_name)] == '(')
+                seconds += pos->second;
+        }
+        return seconds;
+    }
+
+    void
+    WritePhase (Results::Dictionary &results_dict,
+                const char *name,
+                const char *description,
+                const char *timer_function_name,
+                const TimeMeasurement<no_function> &time,
+                const MemoryMeasurement<no_function> &memory)
+    {
+        std::string key;
+        std::string desc;
+
+        key = std::string ("time-") + name;
+        desc = std::string ("Elapsed time ") + description + ".";
+        results_dict.AddDouble (key.c_str(), desc.c_str(), time.GetGauge().GetDeltaValue());
+
+        if (timer_function_name)
+        {
+            key = std::string ("timer-") + name;
+            desc = std::string ("Time the ") + timer_function_name + " timer category recorded while " + description + ".";
+            results_dict.AddDouble (key.c_str(), desc.c_str(), GetTimerCategoryTime (timer_function_name));
+        }
+
+        key = std::string ("memory-change-") + name;
+        desc = std::string ("Memory increase that occurs due to ") + description + ".";
+        results_dict.Add (key.c_str(), desc.c_str(), memory.GetGauge().GetDeltaValue().GetResult(NULL, NULL));
+    }
+
+    SBModule m_module;
+    TimeMeasurement<no_function> m_time_create_target;
+    TimeMeasurement<no_function> m_time_parse_symbols;
+    TimeMeasurement<no_function> m_time_init_name_indexes;
+    TimeMeasurement<no_function> m_time_dwarf_index;
+    TimeMeasurement<no_function> m_time_resolve_symbol_context;
+    MemoryMeasurement<no_function> m_memory_create_target;
+    MemoryMeasurement<no_function> m_memory_parse_symbols;
+    MemoryMeasurement<no_function> m_memory_init_name_indexes;
+    MemoryMeasurement<no_function> m_memory_dwarf_index;
+    MemoryMeasurement<no_function> m_memory_resolve_symbol_context;
+    size_t m_num_symbols;
+    size_t m_num_resolved_addresses;
+    size_t m_max_resolved_addresses;
+    std::map<std::string, double> m_timer_categories;
+    std::string m_exe_path;
+    std::string m_out_path;
+};
+
+struct Options
+{
+    bool verbose;
+    bool error;
+    bool print_help;
+
+    Options() :
+        verbose (false),
+        error (false),
+        print_help (false)
+    {
+    }
+};
+
+static struct option g_long_options[] = {
+    { "verbose",      no_argument,            NULL, 'v' },
+    { "help",         no_argument,            NULL, 'h' },
+    { "test-file",    required_argument,      NULL, 't' },
+    { "out-file",     required_argument,      NULL, 'o' },
+    { "addresses",    required_argument,      NULL, 'a' },
+    { NULL,           0,                      NULL,  0  }
+};
+
+
+std::string
+GetShortOptionString (struct option *long_options)
+{
+    std::string option_string;
+    for (int i = 0; long_options[i].name != NULL; ++i)
+    {
+        if (long_options[i].flag == NULL)
+        {
+            option_string.push_back ((char) long_options[i].val);
+            switch (long_options[i].has_arg)
+            {
+                default:
+                case no_argument:
+                    break;
+                case required_argument:
+                    option_string.push_back (':');
+                    break;
+                case optional_argument:
+                    option_string.append (2, ':');
+                    break;
+            }
+        }
+    }
+    return option_string;
+}
+
+int main(int argc, const char * argv[])
+{
+    std::string short_option_string (GetShortOptionString(g_long_options));
+
+    SymbolsTest test;
+
+    Options option_data;
+    bool done = false;
+
+#if __GLIBC__
+    optind = 0;
+#else
+    optreset = 1;
+    optind = 1;
+#endif
+    while (!done)
+    {
+        int long_options_index = -1;
+        const int short_option = ::getopt_long_only (argc,
+                                                     const_cast<char **>(argv),
+                                                     short_option_string.c_str(),
+                                                     g_long_options,
+                                                     &long_options_index);
+
+        switch (short_option)
+        {
+            case 0:
+                // Already handled
+                break;
+
+            case -1:
+                done = true;
+                break;
+
+            case '?':
+            case 'h':
+                option_data.print_help = true;
+                break;
+
+            case 'v':
+                option_data.verbose = true;
+                break;
+
+            case 't':
+                {
+                    SBFileSpec file(optarg);
+                    if (file.Exists())
+                        test.SetExecutablePath(optarg);
+                    else
+                        fprintf(stderr, "error: file specified in --test-file (-t) option doesn't exist: '%s'\n", optarg);
+                }
+                break;
+
+            case 'o':
+                test.SetResultFilePath(optarg);
+                break;
+
+            case 'a':
+                test.SetMaxResolvedAddresses(strtoul(optarg, NULL, 0));
+                break;
+
+            default:
+                option_data.error = true;
+                option_data.print_help = true;
+                fprintf (stderr, "error: unrecognized option %c\n", short_option);
+                break;
+        }
+    }
+
+    if (test.GetExecutablePath() == NULL)
+    {
+        // --test-file is mandatory
+        option_data.print_help = true;
+        option_data.error = true;
+        fprintf (stderr, "error: the '--test-file=PATH' option is mandatory\n");
+    }
+
+    if (option_data.print_help)
+    {
+        puts(R"(
+NAME
+    lldb-perf-symbols -- a tool that measures how long LLDB takes to load the symbols of a large executable.
+
+SYNOPSIS
+    lldb-perf-symbols --test-file=FILE [--out-file=PATH --addresses=N --verbose]
+
+DESCRIPTION
+    Creates a target for FILE, usually made by generate-symbols-testcase.py,
+    and times parsing its symbol table, building the symbol table name
+    indexes, indexing its DWARF and resolving symbol contexts for up to N
+    addresses (100000 by default). The memory used by each phase is reported
+    as well. Results are written to PATH, or to stdout.
+)");
+        exit(option_data.error ? 1 : 0);
+    }
+
+    // Update argc and argv after parsing options
+    argc -= optind;
+    argv += optind;
+
+    test.SetVerbose(option_data.verbose);
+    TestCase::Run(test, argc, argv);
+    return 0;
+}
@@ -11,9 +11,13 @@
 #include "lldb/lldb-forward.h"
 #include <assert.h>
 #include <cmath>
+#ifdef __APPLE__
 #include <mach/mach.h>
 #include <mach/task.h>
 #include <mach/mach_traps.h>
+#else
+#include <stdio.h>
+#endif
 
 using namespace lldb_perf;
 
@@ -101,6 +105,7 @@ MemoryStats::GetResult (const char *name, const char *description) const
 MemoryGauge::ValueType
 MemoryGauge::Now ()
 {
+#ifdef __APPLE__
     task_t task = mach_task_self();
     mach_task_basic_info_data_t taskBasicInfo;
     mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
@@ -109,6 +114,27 @@ MemoryGauge::Now ()
         return MemoryStats(taskBasicInfo.virtual_size, taskBasicInfo.resident_size, taskBasicInfo.resident_size_max);
     }
     return 0;
+#else
+    // The sizes in /proc/self/status are in kB
+    MemoryStats stats;
+    FILE *status_file = ::fopen ("/proc/self/status", "r");
+    if (status_file)
+    {
+        char line[256];
+        unsigned long long kb;
+        while (::fgets (line, sizeof(line), status_file))
+        {
+            if (::sscanf (line, "VmSize: %llu", &kb) == 1)
+                stats.SetVirtualSize (kb * 1024);
+            else if (::sscanf (line, "VmRSS: %llu", &kb) == 1)
+                stats.SetResidentSize (kb * 1024);
+            else if (::sscanf (line, "VmHWM: %llu", &kb) == 1)
+                stats.SetMaxResidentSize (kb * 1024);
+        }
+        ::fclose (status_file);
+    }
+    return stats;
+#endif
 }
 
 MemoryGauge::MemoryGauge () :
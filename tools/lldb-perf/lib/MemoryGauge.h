@@ -13,7 +13,12 @@
 #include "Gauge.h"
 #include "Results.h"
 
+#ifdef __APPLE__
 #include <mach/task_info.h>
+#else
+#include <stdint.h>
+typedef uint64_t mach_vm_size_t;
+#endif
 
 namespace lldb_perf {
 
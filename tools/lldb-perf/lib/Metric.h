@@ -12,7 +12,9 @@
 
 #include <vector>
 #include <string>
+#ifdef __APPLE__
 #include <mach/task_info.h>
+#endif
 
 namespace lldb_perf {
 
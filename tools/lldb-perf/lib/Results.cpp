@@ -15,10 +15,18 @@
 #include "CFCMutableDictionary.h"
 #include "CFCReleaser.h"
 #include "CFCString.h"
+#else
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lldb/Core/StreamString.h"
+#include "lldb/Core/StructuredData.h"
 #endif
 
 using namespace lldb_perf;
 
+#ifdef __APPLE__
 static void
 AddResultToArray (CFCMutableArray &array, Results::Result *result);
 
@@ -154,6 +162,103 @@ AddResultToDictionary (CFCMutableDictionary &parent_dict, const char *key, Resul
         break;
     }
 }
+#else
+static void
+WriteJSONString (FILE *out, const char *cstr)
+{
+    lldb_private::StreamString strm;
+    lldb_private::StructuredData::DumpJSONString (strm, cstr, strlen (cstr));
+    fwrite (strm.GetData(), 1, strm.GetSize(), out);
+}
+
+static void
+WriteJSONIndent (FILE *out, int indent)
+{
+    fprintf (out, "\n%*s", indent * 2, "");
+}
+
+//----------------------------------------------------------------------
+// Writes the results in the same layout as the plist on Darwin: arrays
+// and dictionaries nest the same way, and a dictionary's description is
+// stored under a "description" key.
+//----------------------------------------------------------------------
+static void
+WriteResultAsJSON (FILE *out, Results::Result *result, int indent)
+{
+    switch (result->GetType())
+    {
+    case Results::Result::Type::Invalid:
+        fputs ("null", out);
+        break;
+
+    case Results::Result::Type::Array:
+        {
+            bool first = true;
+            fputc ('[', out);
+            result->GetAsArray()->ForEach([out, indent, &first](const Results::ResultSP &value_sp) -> bool
+                                          {
+                                              if (!first)
+                                                  fputc (',', out);
+                                              first = false;
+                                              WriteJSONIndent (out, indent + 1);
+                                              WriteResultAsJSON (out, value_sp.get(), indent + 1);
+                                              return true;
+                                          });
+            if (!first)
+                WriteJSONIndent (out, indent);
+            fputc (']', out);
+        }
+        break;
+
+    case Results::Result::Type::Dictionary:
+        {
+            bool first = true;
+            fputc ('{', out);
+            result->GetAsDictionary()->ForEach([out, indent, &first](const std::string &key, const Results::ResultSP &value_sp) -> bool
+                                               {
+                                                   if (!first)
+                                                       fputc (',', out);
+                                                   first = false;
+                                                   WriteJSONIndent (out, indent + 1);
+                                                   WriteJSONString (out, key.c_str());
+                                                   fputs (": ", out);
+                                                   WriteResultAsJSON (out, value_sp.get(), indent + 1);
+                                                   return true;
+                                               });
+            if (result->GetDescription())
+            {
+                if (!first)
+                    fputc (',', out);
+                first = false;
+                WriteJSONIndent (out, indent + 1);
+                fputs ("\"description\": ", out);
+                WriteJSONString (out, result->GetDescription());
+            }
+            if (!first)
+                WriteJSONIndent (out, indent);
+            fputc ('}', out);
+        }
+        break;
+
+    case Results::Result::Type::Double:
+        fprintf (out, "%.17g", result->GetAsDouble()->GetValue());
+        break;
+
+    case Results::Result::Type::String:
+        WriteJSONString (out, result->GetAsString()->GetValue());
+        break;
+
+    case Results::Result::Type::Unsigned:
+        fprintf (out, "%" PRIu64, result->GetAsUnsigned()->GetValue());
+        break;
+
+    default:
+        assert (!"unhandled result");
+        break;
+    }
+}
+#endif
+
 void
 Results::Write (const char *out_path)
 {
@@ -173,6 +278,25 @@ Results::Write (const char *out_path)
     CFURLRef file = CFURLCreateFromFileSystemRepresentation(NULL, (const UInt8*)out_path, strlen(out_path), FALSE);
     
     CFURLWriteDataAndPropertiesToResource(file, xmlData, NULL, NULL);
+#else
+    // There is no CoreFoundation to write a plist with, so write the
+    // results as JSON instead.
+    FILE *out = stdout;
+    if (out_path && out_path[0])
+    {
+        out = fopen (out_path, "w");
+        if (out == NULL)
+        {
+            fprintf (stderr, "error: unable to open '%s' for writing\n", out_path);
+            return;
+        }
+    }
+    WriteResultAsJSON (out, &m_results, 0);
+    fputc ('\n', out);
+    if (out == stdout)
+        fflush (out);
+    else
+        fclose (out);
 #endif
 }
 
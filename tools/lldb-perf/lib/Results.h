@@ -11,6 +11,7 @@
 #define __PerfTestDriver_Results_h__
 
 #include "lldb/lldb-forward.h"
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
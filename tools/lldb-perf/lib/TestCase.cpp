@@ -195,13 +195,18 @@ TestCase::Loop ()
                         for (auto thread_index = 0; thread_index < num_threads; thread_index++)
                         {
                             SBThread thread(m_process.GetThreadAtIndex(thread_index));
-                            SBFrame frame(thread.GetFrameAtIndex(0));
-                            SBStream strm;
-                            strm.RedirectToFileHandle(stdout, false);
-                            frame.GetDescription(strm);
                             bool select_thread = false;
                             StopReason stop_reason = thread.GetStopReason();
-                            if (m_verbose) printf("tid = 0x%llx pc = 0x%llx ",thread.GetThreadID(),frame.GetPC());
+                            if (m_verbose)
+                            {
+                                // Only describe the frames when asked to, it
+                                // would add to the time the test step measures
+                                SBFrame frame(thread.GetFrameAtIndex(0));
+                                SBStream strm;
+                                strm.RedirectToFileHandle(stdout, false);
+                                frame.GetDescription(strm);
+                                printf("tid = 0x%llx pc = 0x%llx ",thread.GetThreadID(),frame.GetPC());
+                            }
                             switch (stop_reason)
                             {
                                 case eStopReasonNone:
@@ -0,0 +1,516 @@
+//===-- lldb-perf-lldb-server.cpp -------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb-perf/lib/Timer.h"
+#include "lldb-perf/lib/Metric.h"
+#include "lldb-perf/lib/Measurement.h"
+#include "lldb-perf/lib/TestCase.h"
+#include "lldb-perf/lib/Xcode.h"
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace lldb_perf;
+
+//----------------------------------------------------------------------
+// Measures the raw cost of the operations lldb-server performs for a
+// local Linux debug session (lldb talks to lldb-server gdbserver over
+// loopback, which drives the inferior through NativeProcessLinux):
+//
+// - single-step rate
+// - latency of reading a register that wasn't expedited in the stop reply
+// - memory read throughput
+// - breakpoint hit rate and stop latency as the number of threads in the
+//   inferior grows
+//
+// The inferior is lldb-server-testcase.cpp in this directory.
+//----------------------------------------------------------------------
+class LLGSTest : public TestCase
+{
+    typedef void (*no_function) (void);
+
+public:
+    LLGSTest () :
+        m_breakpoint (),
+        m_thread_counts (),
+        m_stop_latencies (),
+        m_thread_count_index (0),
+        m_hit_index (0),
+        m_num_steps (1000),
+        m_num_hits (200),
+        m_num_memory_passes (8),
+        m_memory_bytes_read (0),
+        m_step_measurement (),
+        m_register_read_measurement (),
+        m_memory_read_measurement (),
+        m_stop_measurement (),
+        m_app_path (),
+        m_out_path ()
+    {
+    }
+
+    virtual
+    ~LLGSTest() {}
+
+    virtual bool
+    Setup (int& argc, const char**& argv)
+    {
+        TestCase::Setup (argc, argv);
+
+        if (m_thread_counts.empty())
+        {
+            const uint32_t default_thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+            m_thread_counts.assign (default_thread_counts, default_thread_counts + sizeof(default_thread_counts)/sizeof(default_thread_counts[0]));
+        }
+        m_stop_latencies.resize (m_thread_counts.size());
+
+        // Local processes are debugged through lldb-server on Linux, make
+        // sure that is what we are measuring.
+        SBCommandReturnObject return_object;
+        m_debugger.GetCommandInterpreter().HandleCommand("settings set platform.plugin.linux.use-llgs-for-local true",
+                                                         return_object);
+        if (!return_object.Succeeded())
+        {
+            if (return_object.GetError() != NULL)
+                printf ("Got an error running settings set: %s.\n", return_object.GetError());
+            else
+                printf ("Failed running settings set, no error.\n");
+        }
+
+        m_target = m_debugger.CreateTarget(m_app_path.c_str());
+        m_breakpoint = m_target.BreakpointCreateByName("breakpoint_function");
+
+        // Give the inferior enough loop iterations for every breakpoint hit
+        // plus the iterations the single stepping walks through.
+        char iterations_arg[32];
+        snprintf (iterations_arg, sizeof(iterations_arg), "%u", (m_num_hits + 1) * (uint32_t)m_thread_counts.size() + m_num_steps + 1);
+        const char* args[] = { m_app_path.c_str(), iterations_arg, nullptr };
+        SBLaunchInfo launch_info (args);
+
+        return Launch (launch_info);
+    }
+
+    void
+    WriteResults (Results &results)
+    {
+        Results::Dictionary& results_dict = results.GetDictionary();
+
+        const Metric<double> &step_metric = m_step_measurement.GetMetric();
+        if (step_metric.GetCount() > 0 && step_metric.GetSum() > 0)
+            results_dict.AddDouble ("single-steps-per-second", "Number of instructions single stepped per second.", step_metric.GetCount() / step_metric.GetSum());
+
+        const Metric<double> &register_metric = m_register_read_measurement.GetMetric();
+        if (register_metric.GetCount() > 0)
+        {
+            results_dict.AddDouble ("register-read-latency", "Average time to read a register that wasn't expedited in the stop reply.", register_metric.GetAverage());
+            results_dict.AddDouble ("register-read-latency-stddev", "StdDev of the time to read a register.", register_metric.GetStandardDeviation());
+        }
+
+        const Metric<double> &memory_metric = m_memory_read_measurement.GetMetric();
+        if (memory_metric.GetSum() > 0)
+            results_dict.AddDouble ("memory-read-mb-per-second", "Megabytes of inferior memory read per second.", (m_memory_bytes_read / (1024.0 * 1024.0)) / memory_metric.GetSum());
+
+        for (size_t i = 0; i < m_thread_counts.size(); ++i)
+        {
+            const Metric<double> &stop_metric = m_stop_latencies[i];
+            if (stop_metric.GetCount() == 0 || stop_metric.GetSum() <= 0)
+                continue;
+
+            char name[64];
+            char description[128];
+            snprintf (name, sizeof(name), "stop-latency-%u-threads", m_thread_counts[i]);
+            snprintf (description, sizeof(description), "Average time from continuing to stopping at a breakpoint with %u threads running.", m_thread_counts[i]);
+            results_dict.AddDouble (name, description, stop_metric.GetAverage());
+
+            snprintf (name, sizeof(name), "stop-latency-stddev-%u-threads", m_thread_counts[i]);
+            snprintf (description, sizeof(description), "StdDev of the stop latency with %u threads running.", m_thread_counts[i]);
+            results_dict.AddDouble (name, description, stop_metric.GetStandardDeviation());
+
+            snprintf (name, sizeof(name), "breakpoint-hits-per-second-%u-threads", m_thread_counts[i]);
+            snprintf (description, sizeof(description), "Number of breakpoint hits per second with %u threads running.", m_thread_counts[i]);
+            results_dict.AddDouble (name, description, stop_metric.GetCount() / stop_metric.GetSum());
+        }
+
+        results.Write(GetResultFilePath());
+    }
+
+    const char *
+    GetExecutablePath () const
+    {
+        if (m_app_path.empty())
+            return NULL;
+        return m_app_path.c_str();
+    }
+
+    const char *
+    GetResultFilePath () const
+    {
+        if (m_out_path.empty())
+            return NULL;
+        return m_out_path.c_str();
+    }
+
+    void
+    SetExecutablePath (const char *path)
+    {
+        if (path && path[0])
+            m_app_path = path;
+        else
+            m_app_path.clear();
+    }
+
+    void
+    SetResultFilePath (const char *path)
+    {
+        if (path && path[0])
+            m_out_path = path;
+        else
+            m_out_path.clear();
+    }
+
+    bool
+    SetThreadCounts (const char *arg)
+    {
+        m_thread_counts.clear();
+        while (arg && arg[0])
+        {
+            char *end = NULL;
+            const unsigned long count = strtoul (arg, &end, 0);
+            if (end == arg || count == 0)
+                return false;
+            m_thread_counts.push_back (count);
+            if (*end == ',')
+                ++end;
+            else if (*end != '\0')
+                return false;
+            arg = end;
+        }
+        return !m_thread_counts.empty();
+    }
+
+    void
+    SetNumSteps (uint32_t num_steps)
+    {
+        m_num_steps = num_steps;
+    }
+
+    void
+    SetNumHits (uint32_t num_hits)
+    {
+        m_num_hits = num_hits;
+    }
+
+private:
+    //------------------------------------------------------------------
+    // Runs the measurements that don't need the process to resume. The
+    // debugger is put into synchronous mode so each step returns once
+    // the process has stopped again.
+    //------------------------------------------------------------------
+    void
+    MeasureStoppedOperations (SBThread thread)
+    {
+        m_debugger.SetAsync (false);
+
+        // lldb-server expedites every register of the first register set
+        // (the general purpose registers) in the stop reply packet, so
+        // reading one of those only hits the register cache. Use the first
+        // register of the next set (the floating point registers), which
+        // needs a round trip to the server after every step.
+        std::string register_name;
+        SBValueList register_sets (thread.GetFrameAtIndex(0).GetRegisters());
+        for (uint32_t set_idx = 1; set_idx < register_sets.GetSize() && register_name.empty(); ++set_idx)
+        {
+            SBValue register_set (register_sets.GetValueAtIndex(set_idx));
+            if (register_set.GetNumChildren() > 0 && register_set.GetChildAtIndex(0).GetName())
+                register_name = register_set.GetChildAtIndex(0).GetName();
+        }
+
+        for (uint32_t i = 0; i < m_num_steps; ++i)
+        {
+            m_step_measurement.Start();
+            thread.StepInstruction (false);
+            m_step_measurement.Stop();
+
+            if (!register_name.empty())
+            {
+                m_register_read_measurement.Start();
+                thread.GetFrameAtIndex(0).FindRegister(register_name.c_str()).GetValueAsUnsigned();
+                m_register_read_measurement.Stop();
+            }
+        }
+
+        SBValue buffer (m_target.FindFirstGlobalVariable ("g_memory_buffer"));
+        const addr_t buffer_addr = buffer.GetLoadAddress();
+        const size_t buffer_size = buffer.GetByteSize();
+        if (buffer_addr != LLDB_INVALID_ADDRESS && buffer_size > 0)
+        {
+            const size_t chunk_size = 1024 * 1024;
+            std::vector<uint8_t> chunk (chunk_size);
+            for (uint32_t pass = 0; pass < m_num_memory_passes; ++pass)
+            {
+                for (size_t offset = 0; offset < buffer_size; offset += chunk_size)
+                {
+                    SBError error;
+                    const size_t read_size = std::min (chunk_size, buffer_size - offset);
+                    m_memory_read_measurement.Start();
+                    const size_t bytes_read = m_process.ReadMemory (buffer_addr + offset, &chunk[0], read_size, error);
+                    m_memory_read_measurement.Stop();
+                    m_memory_bytes_read += bytes_read;
+                }
+            }
+        }
+
+        m_debugger.SetAsync (true);
+    }
+
+    bool
+    SetInferiorThreadCount (uint32_t num_threads)
+    {
+        SBValue num_threads_var (m_target.FindFirstGlobalVariable ("g_num_threads"));
+        const addr_t addr = num_threads_var.GetLoadAddress();
+        if (addr == LLDB_INVALID_ADDRESS)
+            return false;
+        int32_t value = num_threads;
+        SBError error;
+        return m_process.WriteMemory (addr, &value, sizeof(value), error) == sizeof(value);
+    }
+
+    virtual void
+	TestStep (int counter, ActionWanted &next_action)
+    {
+        if (counter == 0)
+        {
+            MeasureStoppedOperations (m_thread);
+        }
+        else
+        {
+            const double stop_latency = m_stop_measurement.Stop();
+            // The first stop after changing the thread count includes the
+            // time the inferior took to start the new threads.
+            if (m_hit_index > 0)
+                m_stop_latencies[m_thread_count_index].Append (stop_latency);
+            ++m_hit_index;
+            if (m_hit_index > m_num_hits)
+            {
+                ++m_thread_count_index;
+                m_hit_index = 0;
+            }
+        }
+
+        if (m_thread_count_index >= m_thread_counts.size())
+        {
+            next_action.Kill();
+            return;
+        }
+
+        if (m_hit_index == 0 && !SetInferiorThreadCount (m_thread_counts[m_thread_count_index]))
+        {
+            fprintf (stderr, "error: unable to set the number of threads in the inferior\n");
+            next_action.Kill();
+            return;
+        }
+
+        m_stop_measurement.Start();
+        next_action.Continue();
+    }
+
+    SBBreakpoint m_breakpoint;
+    std::vector<uint32_t> m_thread_counts;
+    std::vector<Metric<double>> m_stop_latencies;
+    size_t m_thread_count_index;
+    uint32_t m_hit_index;
+    uint32_t m_num_steps;
+    uint32_t m_num_hits;
+    uint32_t m_num_memory_passes;
+    uint64_t m_memory_bytes_read;
+    TimeMeasurement<no_function> m_step_measurement;
+    TimeMeasurement<no_function> m_register_read_measurement;
+    TimeMeasurement<no_function> m_memory_read_measurement;
+    TimeMeasurement<no_function> m_stop_measurement;
+    std::string m_app_path;
+    std::string m_out_path;
+};
+
+struct Options
+{
+    bool verbose;
+    bool error;
+    bool print_help;
+
+    Options() :
+        verbose (false),
+        error (false),
+        print_help (false)
+    {
+    }
+};
+
+static struct option g_long_options[] = {
+    { "verbose",      no_argument,            NULL, 'v' },
+    { "help",         no_argument,            NULL, 'h' },
+    { "test-file",    required_argument,      NULL, 't' },
+    { "out-file",     required_argument,      NULL, 'o' },
+    { "threads",      required_argument,      NULL, 'T' },
+    { "steps",        required_argument,      NULL, 's' },
+    { "hits",         required_argument,      NULL, 'b' },
+    { NULL,           0,                      NULL,  0  }
+};
+
+
+std::string
+GetShortOptionString (struct option *long_options)
+{
+    std::string option_string;
+    for (int i = 0; long_options[i].name != NULL; ++i)
+    {
+        if (long_options[i].flag == NULL)
+        {
+            option_string.push_back ((char) long_options[i].val);
+            switch (long_options[i].has_arg)
+            {
+                default:
+                case no_argument:
+                    break;
+                case required_argument:
+                    option_string.push_back (':');
+                    break;
+                case optional_argument:
+                    option_string.append (2, ':');
+                    break;
+            }
+        }
+    }
+    return option_string;
+}
+
+int main(int argc, const char * argv[])
+{
+    std::string short_option_string (GetShortOptionString(g_long_options));
+
+    LLGSTest test;
+
+    Options option_data;
+    bool done = false;
+
+#if __GLIBC__
+    optind = 0;
+#else
+    optreset = 1;
+    optind = 1;
+#endif
+    while (!done)
+    {
+        int long_options_index = -1;
+        const int short_option = ::getopt_long_only (argc,
+                                                     const_cast<char **>(argv),
+                                                     short_option_string.c_str(),
+                                                     g_long_options,
+                                                     &long_options_index);
+
+        switch (short_option)
+        {
+            case 0:
+                // Already handled
+                break;
+
+            case -1:
+                done = true;
+                break;
+
+            case '?':
+            case 'h':
+                option_data.print_help = true;
+                break;
+
+            case 'v':
+                option_data.verbose = true;
+                break;
+
+            case 't':
+                {
+                    SBFileSpec file(optarg);
+                    if (file.Exists())
+                        test.SetExecutablePath(optarg);
+                    else
+                        fprintf(stderr, "error: file specified in --test-file (-t) option doesn't exist: '%s'\n", optarg);
+                }
+                break;
+
+            case 'o':
+                test.SetResultFilePath(optarg);
+                break;
+
+            case 'T':
+                if (!test.SetThreadCounts(optarg))
+                {
+                    fprintf(stderr, "error: invalid thread count list for --threads (-T): '%s'\n", optarg);
+                    option_data.error = true;
+                }
+                break;
+
+            case 's':
+                test.SetNumSteps(strtoul(optarg, NULL, 0));
+                break;
+
+            case 'b':
+                test.SetNumHits(strtoul(optarg, NULL, 0));
+                break;
+
+            default:
+                option_data.error = true;
+                option_data.print_help = true;
+                fprintf (stderr, "error: unrecognized option %c\n", short_option);
+                break;
+        }
+    }
+
+    if (test.GetExecutablePath() == NULL)
+    {
+        // --test-file is mandatory
+        option_data.print_help = true;
+        option_data.error = true;
+        fprintf (stderr, "error: the '--test-file=PATH' option is mandatory\n");
+    }
+
+    if (option_data.print_help)
+    {
+        puts(R"(
+NAME
+    lldb-perf-lldb-server -- a tool that measures the performance of lldb-server and the native process layer.
+
+SYNOPSIS
+    lldb-perf-lldb-server --test-file=FILE [--out-file=PATH --threads=N[,N...] --steps=N --hits=N --verbose]
+
+DESCRIPTION
+    Debugs FILE (built from lldb-server-testcase.cpp) through lldb-server
+    over loopback and measures the single step rate, register read latency,
+    memory read throughput, and the breakpoint hit rate and stop latency
+    for each of the thread counts given with --threads (1,2,4,8,16,32,64 by
+    default). Results are written as JSON to PATH, or to stdout.
+)");
+        exit(option_data.error ? 1 : 0);
+    }
+    if (option_data.error)
+    {
+        exit(1);
+    }
+
+    // Update argc and argv after parsing options
+    argc -= optind;
+    argv += optind;
+
+    test.SetVerbose(option_data.verbose);
+    TestCase::Run(test, argc, argv);
+    return 0;
+}
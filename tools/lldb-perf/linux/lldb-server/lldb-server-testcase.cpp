@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Read back by the benchmark with SBProcess::ReadMemory().
+char g_memory_buffer[16 * 1024 * 1024];
+
+// Written by the benchmark to change how many threads are running.
+volatile int g_num_threads = 0;
+
+static std::atomic<int> g_num_running (0);
+static std::atomic<bool> g_done (false);
+
+static void
+worker_thread_function ()
+{
+    ++g_num_running;
+    while (!g_done)
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+}
+
+__attribute__((noinline)) int
+breakpoint_function (int i)
+{
+    return i * 2;
+}
+
+int main (int argc, char **argv)
+{
+    const int num_iterations = argc > 1 ? atoi (argv[1]) : 1000000;
+    std::vector<std::thread> threads;
+    int sum = 0;
+
+    memset (g_memory_buffer, 0x5a, sizeof(g_memory_buffer));
+
+    for (int i = 0; i < num_iterations; ++i)
+    {
+        while ((int)threads.size() < g_num_threads)
+            threads.push_back (std::thread (worker_thread_function));
+        // Make sure every thread is running before the next stop
+        while (g_num_running < (int)threads.size())
+            std::this_thread::yield();
+        sum += breakpoint_function (i);
+    }
+
+    g_done = true;
+    for (auto &thread : threads)
+        thread.join();
+    return sum > 0 ? 0 : 1;
+}
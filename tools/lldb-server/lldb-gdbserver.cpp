@@ -28,8 +28,10 @@
 #include "lldb/Core/Debugger.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Core/StreamFile.h"
+#include "lldb/Core/StreamLogBuffer.h"
 #include "lldb/Host/ConnectionFileDescriptor.h"
 #include "lldb/Host/HostThread.h"
+#include "lldb/Host/MainLoop.h"
 #include "lldb/Host/Pipe.h"
 #include "lldb/Host/OptionParser.h"
 #include "lldb/Host/Socket.h"
@@ -67,6 +69,8 @@ HostThread s_listen_thread;
 
 static int g_debug = 0;
 static int g_verbose = 0;
+static int g_log_async = 0;
+static int g_log_ring_buffer = 0;
 
 static struct option g_long_options[] =
 {
@@ -76,6 +80,8 @@ static struct option g_long_options[] =
     { "lldb-command",       required_argument,  NULL,               'c' },
     { "log-file",           required_argument,  NULL,               'l' },
     { "log-flags",          required_argument,  NULL,               'f' },
+    { "log-async",          no_argument,        &g_log_async,       1   },  // Write the log from a background thread.
+    { "log-ring-buffer",    no_argument,        &g_log_ring_buffer, 1   },  // Keep recent log lines in memory, write them out when an error is logged.
     { "attach",             required_argument,  NULL,               'a' },
     { "named-pipe",         required_argument,  NULL,               'P' },
     { "native-regs",        no_argument,        NULL,               'r' },  // Specify to use the native registers instead of the gdb defaults for the architecture.  NOTE: this is a do-nothing arg as it's behavior is default now.  FIXME remove call from lldb-platform.
@@ -107,22 +113,27 @@ signal_handler(int signo)
     case SIGPIPE:
         g_sigpipe_received = 1;
         break;
-    case SIGHUP:
-        ++g_sighup_received_count;
-
-        // For now, swallow SIGHUP.
-        if (log)
-            log->Printf ("lldb-server:%s swallowing SIGHUP (receive count=%d)", __FUNCTION__, g_sighup_received_count);
-        signal (SIGHUP, signal_handler);
-        break;
     }
 }
+
+static void
+sighup_handler (MainLoopBase &mainloop)
+{
+    ++g_sighup_received_count;
+
+    Log *log (GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+    if (log)
+        log->Printf ("lldb-server:%s swallowing SIGHUP (receive count=%d)", __FUNCTION__, g_sighup_received_count);
+
+    if (g_sighup_received_count >= 2)
+        mainloop.RequestTermination ();
+}
 #endif // #ifndef _WIN32
 
 static void
 display_usage (const char *progname, const char* subcommand)
 {
-    fprintf(stderr, "Usage:\n  %s %s [--log-file log-file-path] [--log-flags flags] [--lldb-command command]* [--platform platform_name] [--setsid] [--named-pipe named-pipe-path] [--native-regs] [--attach pid] [[HOST]:PORT] "
+    fprintf(stderr, "Usage:\n  %s %s [--log-file log-file-path] [--log-flags flags] [--log-async | --log-ring-buffer] [--lldb-command command]* [--platform platform_name] [--setsid] [--named-pipe named-pipe-path] [--native-regs] [--attach pid] [[HOST]:PORT] "
             "[-- PROGRAM ARG1 ARG2 ...]\n", progname, subcommand);
     exit(0);
 }
@@ -326,7 +337,7 @@ writePortToPipe (const char *const named_pipe_path, const uint16_t port)
 }
 
 void
-ConnectToRemote (GDBRemoteCommunicationServerLLGS &gdb_server, bool reverse_connect, const char *const host_and_port, const char *const progname, const char *const subcommand, const char *const named_pipe_path)
+ConnectToRemote (MainLoop &mainloop, GDBRemoteCommunicationServerLLGS &gdb_server, bool reverse_connect, const char *const host_and_port, const char *const progname, const char *const subcommand, const char *const named_pipe_path)
 {
     Error error;
 
@@ -389,7 +400,12 @@ ConnectToRemote (GDBRemoteCommunicationServerLLGS &gdb_server, bool reverse_conn
 
             // We're connected.
             printf ("Connection established.\n");
-            gdb_server.SetConnection (connection_up.release());
+            error = gdb_server.InitializeConnection (std::move (connection_up));
+            if (error.Fail ())
+            {
+                fprintf (stderr, "Failed to initialize connection: %s\n", error.AsCString());
+                exit (-1);
+            }
         }
         else
         {
@@ -429,7 +445,12 @@ ConnectToRemote (GDBRemoteCommunicationServerLLGS &gdb_server, bool reverse_conn
             if (s_listen_connection_up)
             {
                 printf ("Connection established '%s'\n", s_listen_connection_up->GetURI().c_str());
-                gdb_server.SetConnection (s_listen_connection_up.release());
+                error = gdb_server.InitializeConnection (std::move (s_listen_connection_up));
+                if (error.Fail ())
+                {
+                    fprintf (stderr, "Failed to initialize connection: %s\n", error.AsCString());
+                    exit (-1);
+                }
             }
             else
             {
@@ -445,23 +466,16 @@ ConnectToRemote (GDBRemoteCommunicationServerLLGS &gdb_server, bool reverse_conn
         // After we connected, we need to get an initial ack from...
         if (gdb_server.HandshakeWithClient(&error))
         {
-            // We'll use a half a second timeout interval so that an exit conditions can
-            // be checked that often.
-            const uint32_t TIMEOUT_USEC = 500000;
+#ifndef _WIN32
+            // SIGHUP is swallowed once; the second one ends the session.
+            MainLoop::SignalHandleUP sighup_handle = mainloop.RegisterSignal (SIGHUP,
+                    [] (MainLoopBase &loop) { sighup_handler (loop); }, error);
+#endif
 
-            bool interrupt = false;
-            bool done = false;
-            while (!interrupt && !done && (g_sighup_received_count < 2))
-            {
-                const GDBRemoteCommunication::PacketResult result = gdb_server.GetPacketAndSendResponse (TIMEOUT_USEC, error, interrupt, done);
-                if ((result != GDBRemoteCommunication::PacketResult::Success) &&
-                    (result != GDBRemoteCommunication::PacketResult::ErrorReplyTimeout))
-                {
-                    // We're bailing out - we only support successful handling and timeouts.
-                    fprintf(stderr, "leaving packet loop due to PacketResult %d\n", result);
-                    break;
-                }
-            }
+            // Packets, inferior events and signals are all served from here
+            // until the client goes away or the inferior exits.
+            if (error.Success ())
+                error = mainloop.Run ();
 
             if (error.Fail())
             {
@@ -490,9 +504,21 @@ main_gdbserver (int argc, char *argv[])
 #ifndef _WIN32
     // Setup signal handlers first thing.
     signal (SIGPIPE, signal_handler);
-    signal (SIGHUP, signal_handler);
+
+    // Inferior exits and stops and SIGHUP are picked up from signalfds on
+    // the main loop, which only works if no thread ever takes them itself.
+    // Block them before any threads (e.g. the async log thread) are started
+    // so they all inherit the mask.  A SIGHUP that arrives before the loop
+    // watches it stays pending until then.
+    sigset_t loop_signals_mask;
+    sigemptyset (&loop_signals_mask);
+    sigaddset (&loop_signals_mask, SIGCHLD);
+    sigaddset (&loop_signals_mask, SIGHUP);
+    pthread_sigmask (SIG_BLOCK, &loop_signals_mask, nullptr);
 #endif
 
+    MainLoop mainloop;
+
     const char *progname = argv[0];
     const char *subcommand = argv[1];
     argc--;
@@ -639,7 +665,19 @@ main_gdbserver (int argc, char *argv[])
     {
         if (log_args.GetArgumentCount() == 0)
             log_args.AppendArgument("default");
-        ProcessGDBRemoteLog::EnableLog (log_stream_sp, 0,log_args.GetConstArgumentVector(), log_stream_sp.get());
+        uint32_t log_options = 0;
+        StreamSP feedback_stream_sp (log_stream_sp);
+        if (g_log_ring_buffer)
+        {
+            log_options = LLDB_LOG_OPTION_RING_BUFFER;
+            log_stream_sp.reset (new StreamLogBuffer (log_stream_sp, StreamLogBuffer::eModeRingBuffer));
+        }
+        else if (g_log_async)
+        {
+            log_options = LLDB_LOG_OPTION_ASYNC;
+            log_stream_sp.reset (new StreamLogBuffer (log_stream_sp, StreamLogBuffer::eModeAsynchronous));
+        }
+        ProcessGDBRemoteLog::EnableLog (log_stream_sp, log_options, log_args.GetConstArgumentVector(), feedback_stream_sp.get());
     }
     Log *log(lldb_private::GetLogIfAnyCategoriesSet (GDBR_LOG_VERBOSE));
     if (log)
@@ -667,7 +705,7 @@ main_gdbserver (int argc, char *argv[])
     // Setup the platform that GDBRemoteCommunicationServerLLGS will use.
     lldb::PlatformSP platform_sp = setup_platform (platform_name);
 
-    GDBRemoteCommunicationServerLLGS gdb_server (platform_sp, debugger_sp);
+    GDBRemoteCommunicationServerLLGS gdb_server (platform_sp, debugger_sp, mainloop);
 
     const char *const host_and_port = argv[0];
     argc -= 1;
@@ -685,7 +723,7 @@ main_gdbserver (int argc, char *argv[])
     // Print version info.
     printf("%s-%s", LLGS_PROGRAM_NAME, LLGS_VERSION_STR);
 
-    ConnectToRemote (gdb_server, reverse_connect, host_and_port, progname, subcommand, named_pipe_path.c_str ());
+    ConnectToRemote (mainloop, gdb_server, reverse_connect, host_and_port, progname, subcommand, named_pipe_path.c_str ());
 
     fprintf(stderr, "lldb-server exiting...\n");
 
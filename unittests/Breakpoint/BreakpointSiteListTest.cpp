@@ -0,0 +1,255 @@
+//===-- BreakpointSiteListTest.cpp ------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Breakpoint/BreakpointSite.h"
+#include "lldb/Breakpoint/BreakpointSiteList.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace lldb_private
+{
+    class BreakpointSiteListTest : public ::testing::Test
+    {
+    protected:
+        // A site of byte_size bytes at addr, as Process would make it once
+        // it has set the trap opcode.
+        BreakpointSiteSP
+        CreateSite (lldb::addr_t addr, uint32_t byte_size = 1)
+        {
+            BreakpointSiteSP site_sp (new BreakpointSite (&m_sites, BreakpointLocationSP (), addr, false));
+            const uint8_t trap_opcode[8] = { 0xcc, 0xcc, 0xcc, 0xcc, 0xcc, 0xcc, 0xcc, 0xcc };
+            site_sp->SetTrapOpcode (trap_opcode, byte_size);
+            return site_sp;
+        }
+
+        BreakpointSiteSP
+        AddSite (lldb::addr_t addr, uint32_t byte_size = 1)
+        {
+            BreakpointSiteSP site_sp (CreateSite (addr, byte_size));
+            EXPECT_EQ (site_sp->GetID (), m_sites.Add (site_sp));
+            return site_sp;
+        }
+
+        std::vector<lldb::addr_t>
+        GetAddressesInRange (lldb::addr_t lower_bound, lldb::addr_t upper_bound)
+        {
+            std::vector<lldb::addr_t> addrs;
+            const size_t num_visited = m_sites.ForEachInRange (lower_bound,
+                                                               upper_bound,
+                                                               [&addrs](BreakpointSite *site) -> void {
+                                                                   addrs.push_back (site->GetLoadAddress ());
+                                                               });
+            EXPECT_EQ (addrs.size (), num_visited);
+            return addrs;
+        }
+
+        BreakpointSiteList m_sites;
+    };
+}
+
+TEST_F (BreakpointSiteListTest, FindByAddressAndID)
+{
+    BreakpointSiteSP site_2000 = AddSite (0x2000);
+    BreakpointSiteSP site_1000 = AddSite (0x1000);
+    BreakpointSiteSP site_3000 = AddSite (0x3000);
+    EXPECT_EQ (3u, m_sites.GetSize ());
+
+    EXPECT_EQ (site_1000, m_sites.FindByAddress (0x1000));
+    EXPECT_EQ (site_2000, m_sites.FindByAddress (0x2000));
+    EXPECT_EQ (site_3000, m_sites.FindByAddress (0x3000));
+    EXPECT_FALSE (m_sites.FindByAddress (0x1001));
+
+    EXPECT_EQ (site_2000, m_sites.FindByID (site_2000->GetID ()));
+    EXPECT_EQ (site_3000->GetID (), m_sites.FindIDByAddress (0x3000));
+    EXPECT_EQ (LLDB_INVALID_BREAK_ID, m_sites.FindIDByAddress (0x4000));
+
+    // Only one site per address
+    EXPECT_EQ (LLDB_INVALID_BREAK_ID, m_sites.Add (CreateSite (0x2000)));
+    EXPECT_EQ (3u, m_sites.GetSize ());
+}
+
+TEST_F (BreakpointSiteListTest, Remove)
+{
+    BreakpointSiteSP site_1000 = AddSite (0x1000);
+    BreakpointSiteSP site_2000 = AddSite (0x2000);
+
+    EXPECT_TRUE (m_sites.Remove (site_1000->GetID ()));
+    EXPECT_FALSE (m_sites.Remove (site_1000->GetID ()));
+    EXPECT_FALSE (m_sites.FindByID (site_1000->GetID ()));
+
+    EXPECT_FALSE (m_sites.RemoveByAddress (0x1000));
+    EXPECT_TRUE (m_sites.RemoveByAddress (0x2000));
+    EXPECT_TRUE (m_sites.IsEmpty ());
+}
+
+TEST_F (BreakpointSiteListTest, ForEachVisitsInAddressOrder)
+{
+    AddSite (0x3000);
+    AddSite (0x1000);
+    AddSite (0x2000);
+
+    std::vector<lldb::addr_t> addrs;
+    m_sites.ForEach ([&addrs](BreakpointSite *site) -> void {
+        addrs.push_back (site->GetLoadAddress ());
+    });
+    ASSERT_EQ (3u, addrs.size ());
+    EXPECT_EQ (0x1000u, addrs[0]);
+    EXPECT_EQ (0x2000u, addrs[1]);
+    EXPECT_EQ (0x3000u, addrs[2]);
+}
+
+TEST_F (BreakpointSiteListTest, ForEachInRangeOverlap)
+{
+    AddSite (0x1000, 4);
+    AddSite (0x1010, 1);
+    AddSite (0x1020, 4);
+
+    // A site that starts below the range but reaches into it is visited.
+    std::vector<lldb::addr_t> addrs = GetAddressesInRange (0x1002, 0x1010);
+    ASSERT_EQ (1u, addrs.size ());
+    EXPECT_EQ (0x1000u, addrs[0]);
+
+    // One that ends right at the lower bound is not, and neither is one
+    // that starts at the upper bound.
+    addrs = GetAddressesInRange (0x1004, 0x1020);
+    ASSERT_EQ (1u, addrs.size ());
+    EXPECT_EQ (0x1010u, addrs[0]);
+
+    addrs = GetAddressesInRange (0x1000, 0x1024);
+    EXPECT_EQ (3u, addrs.size ());
+
+    addrs = GetAddressesInRange (0x1011, 0x1020);
+    EXPECT_TRUE (addrs.empty ());
+
+    // Empty and inverted ranges never match.
+    EXPECT_TRUE (GetAddressesInRange (0x1000, 0x1000).empty ());
+    EXPECT_TRUE (GetAddressesInRange (0x1024, 0x1000).empty ());
+}
+
+TEST_F (BreakpointSiteListTest, FindInRange)
+{
+    AddSite (0x1000, 4);
+    AddSite (0x1010, 1);
+
+    BreakpointSiteList found;
+    EXPECT_TRUE (m_sites.FindInRange (0x1003, 0x1011, found));
+    EXPECT_EQ (2u, found.GetSize ());
+
+    BreakpointSiteList none;
+    EXPECT_FALSE (m_sites.FindInRange (0x1004, 0x1010, none));
+    EXPECT_TRUE (none.IsEmpty ());
+}
+
+TEST_F (BreakpointSiteListTest, ForEachVisitsSnapshot)
+{
+    BreakpointSiteSP site_1000 = AddSite (0x1000);
+    BreakpointSiteSP site_2000 = AddSite (0x2000);
+    BreakpointSiteSP site_3000 = AddSite (0x3000);
+
+    // The callback changes the list under the ForEach; it still visits
+    // exactly the sites that were there when it started, and they stay
+    // alive even after they are removed.
+    std::vector<BreakpointSiteSP> added;
+    std::vector<lldb::addr_t> addrs;
+    site_2000.reset ();
+    m_sites.ForEach ([this, &added, &addrs](BreakpointSite *site) -> void {
+        addrs.push_back (site->GetLoadAddress ());
+        if (site->GetLoadAddress () == 0x1000)
+        {
+            EXPECT_TRUE (m_sites.RemoveByAddress (0x2000));
+            added.push_back (AddSite (0x2800));
+        }
+        m_sites.Remove (site->GetID ());
+    });
+
+    ASSERT_EQ (3u, addrs.size ());
+    EXPECT_EQ (0x1000u, addrs[0]);
+    EXPECT_EQ (0x2000u, addrs[1]);
+    EXPECT_EQ (0x3000u, addrs[2]);
+
+    // Only the site added during the ForEach is left.
+    ASSERT_EQ (1u, m_sites.GetSize ());
+    EXPECT_EQ (added[0], m_sites.FindByAddress (0x2800));
+}
+
+TEST_F (BreakpointSiteListTest, ForEachInRangeVisitsSnapshot)
+{
+    AddSite (0x1000);
+    AddSite (0x1001);
+
+    size_t num_visited = 0;
+    m_sites.ForEachInRange (0x1000, 0x2000, [this, &num_visited](BreakpointSite *site) -> void {
+        ++num_visited;
+        m_sites.Remove (site->GetID ());
+        m_sites.Add (CreateSite (site->GetLoadAddress () + 0x10));
+    });
+    EXPECT_EQ (2u, num_visited);
+    EXPECT_TRUE (m_sites.FindByAddress (0x1010));
+    EXPECT_TRUE (m_sites.FindByAddress (0x1011));
+    EXPECT_EQ (2u, m_sites.GetSize ());
+}
+
+TEST_F (BreakpointSiteListTest, ReadersRaceWriters)
+{
+    const lldb::addr_t kNumSites = 64;
+    std::vector<BreakpointSiteSP> sites;
+    for (lldb::addr_t i = 0; i < kNumSites; ++i)
+        sites.push_back (CreateSite (0x1000 + i * 0x10, 4));
+
+    // Even sites are always in the list, odd ones come and go.
+    for (lldb::addr_t i = 0; i < kNumSites; i += 2)
+        m_sites.Add (sites[i]);
+
+    std::atomic<bool> done (false);
+    std::thread writer ([this, &sites, &done, kNumSites] () {
+        for (int round = 0; round < 200; ++round)
+        {
+            for (lldb::addr_t i = 1; i < kNumSites; i += 2)
+                m_sites.Add (sites[i]);
+            for (lldb::addr_t i = 1; i < kNumSites; i += 2)
+                m_sites.Remove (sites[i]->GetID ());
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    std::atomic<size_t> num_missing (0);
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.push_back (std::thread ([this, &sites, &done, &num_missing, kNumSites] () {
+            while (!done)
+            {
+                for (lldb::addr_t i = 0; i < kNumSites; i += 2)
+                {
+                    if (m_sites.FindByAddress (sites[i]->GetLoadAddress ()) != sites[i])
+                        ++num_missing;
+                }
+                lldb::addr_t prev_addr = 0;
+                m_sites.ForEachInRange (0, LLDB_INVALID_ADDRESS, [&prev_addr, &num_missing](BreakpointSite *site) -> void {
+                    if (site->GetLoadAddress () <= prev_addr)
+                        ++num_missing;
+                    prev_addr = site->GetLoadAddress ();
+                });
+            }
+        }));
+    }
+
+    writer.join ();
+    for (std::thread &reader : readers)
+        reader.join ();
+    EXPECT_EQ (0u, num_missing.load ());
+    EXPECT_EQ ((size_t)kNumSites / 2, m_sites.GetSize ());
+}
@@ -0,0 +1,166 @@
+//===-- BackgroundWorkerTest.cpp --------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/BackgroundWorker.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    class BackgroundWorkerTest : public ::testing::Test
+    {
+    public:
+        BackgroundWorkerTest () :
+            m_worker ("<lldb.test.background-worker>")
+        {
+        }
+
+    protected:
+        // Wait up to ten seconds for the worker to run everything dispatched
+        bool
+        WaitUntilIdle ()
+        {
+            for (int i = 0; i < 10000 && m_worker.IsBusy(); ++i)
+                std::this_thread::sleep_for (std::chrono::milliseconds (1));
+            return !m_worker.IsBusy();
+        }
+
+        BackgroundWorker m_worker;
+    };
+}
+
+TEST_F (BackgroundWorkerTest, JobsWaitForDispatch)
+{
+    std::atomic<bool> ran (false);
+    BackgroundWorker::JobSP job_sp = m_worker.Post ([&ran](const std::atomic<bool> &cancel) { ran = true; });
+    ASSERT_TRUE (job_sp);
+
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+    EXPECT_FALSE (m_worker.IsBusy());
+    EXPECT_FALSE (job_sp->IsDone());
+    EXPECT_FALSE (ran);
+
+    m_worker.Dispatch();
+    ASSERT_TRUE (WaitUntilIdle());
+    EXPECT_TRUE (job_sp->IsDone());
+    EXPECT_FALSE (job_sp->WasCancelled());
+    EXPECT_TRUE (ran);
+    EXPECT_EQ (1u, m_worker.GetFinishedCount());
+}
+
+TEST_F (BackgroundWorkerTest, JobsRunOneAtATimeInOrder)
+{
+    const int kNumJobs = 50;
+    std::atomic<int> num_active (0);
+    std::atomic<int> max_active (0);
+    std::vector<int> order;
+    for (int i = 0; i < kNumJobs; ++i)
+    {
+        m_worker.Post ([i, &num_active, &max_active, &order](const std::atomic<bool> &cancel)
+        {
+            const int active = ++num_active;
+            if (active > max_active)
+                max_active = active;
+            std::this_thread::sleep_for (std::chrono::microseconds (100));
+            order.push_back (i);
+            --num_active;
+        });
+        // Dispatch in a few batches while earlier jobs are running
+        if (i % 10 == 9)
+            m_worker.Dispatch();
+    }
+
+    ASSERT_TRUE (WaitUntilIdle());
+    EXPECT_EQ (1, max_active.load());
+    ASSERT_EQ ((size_t)kNumJobs, order.size());
+    for (int i = 0; i < kNumJobs; ++i)
+        EXPECT_EQ (i, order[i]);
+}
+
+TEST_F (BackgroundWorkerTest, CancelQueuedJob)
+{
+    std::atomic<bool> release (false);
+    std::atomic<bool> second_ran (false);
+    BackgroundWorker::JobSP first_sp = m_worker.Post ([&release](const std::atomic<bool> &cancel)
+    {
+        while (!release)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    });
+    BackgroundWorker::JobSP second_sp = m_worker.Post ([&second_ran](const std::atomic<bool> &cancel) { second_ran = true; });
+    BackgroundWorker::JobSP posted_sp = m_worker.Post ([&second_ran](const std::atomic<bool> &cancel) { second_ran = true; });
+    m_worker.Dispatch();
+    EXPECT_TRUE (m_worker.IsBusy());
+
+    // Not dispatched yet, so it never counts as finished
+    BackgroundWorker::JobSP undispatched_sp = m_worker.Post ([](const std::atomic<bool> &cancel) {});
+    m_worker.Cancel (undispatched_sp);
+    EXPECT_TRUE (undispatched_sp->IsDone());
+
+    m_worker.Cancel (second_sp);
+    EXPECT_TRUE (second_sp->IsDone());
+    EXPECT_TRUE (second_sp->WasCancelled());
+    EXPECT_FALSE (first_sp->IsDone());
+
+    m_worker.Cancel (posted_sp);
+    release = true;
+    ASSERT_TRUE (WaitUntilIdle());
+    EXPECT_TRUE (first_sp->IsDone());
+    EXPECT_FALSE (first_sp->WasCancelled());
+    EXPECT_FALSE (second_ran);
+    EXPECT_EQ (3u, m_worker.GetFinishedCount());
+}
+
+TEST_F (BackgroundWorkerTest, CancelAllWaitsForRunningJob)
+{
+    std::atomic<bool> started (false);
+    std::atomic<bool> returned (false);
+    std::atomic<bool> later_ran (false);
+    BackgroundWorker::JobSP running_sp = m_worker.Post ([&started, &returned](const std::atomic<bool> &cancel)
+    {
+        started = true;
+        while (!cancel)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        returned = true;
+    });
+    BackgroundWorker::JobSP queued_sp = m_worker.Post ([&later_ran](const std::atomic<bool> &cancel) { later_ran = true; });
+    m_worker.Dispatch();
+    BackgroundWorker::JobSP posted_sp = m_worker.Post ([&later_ran](const std::atomic<bool> &cancel) { later_ran = true; });
+
+    while (!started)
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+    m_worker.CancelAll();
+    EXPECT_TRUE (returned);
+    EXPECT_FALSE (m_worker.IsBusy());
+    EXPECT_TRUE (running_sp->IsDone());
+    EXPECT_TRUE (running_sp->WasCancelled());
+    EXPECT_TRUE (queued_sp->IsDone());
+    EXPECT_TRUE (posted_sp->IsDone());
+
+    // Nothing is left to run
+    m_worker.Dispatch();
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+    EXPECT_FALSE (later_ran);
+    EXPECT_EQ (2u, m_worker.GetFinishedCount());
+
+    // The worker keeps running jobs after a CancelAll
+    std::atomic<bool> ran (false);
+    m_worker.Post ([&ran](const std::atomic<bool> &cancel) { ran = true; });
+    m_worker.Dispatch();
+    ASSERT_TRUE (WaitUntilIdle());
+    EXPECT_TRUE (ran);
+}
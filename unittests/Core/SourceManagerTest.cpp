@@ -0,0 +1,179 @@
+//===-- SourceManagerTest.cpp -----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdio.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "lldb/Core/SourceManager.h"
+#include "lldb/Core/StreamString.h"
+#include "lldb/Host/FileSpec.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    class SourceManagerTest : public ::testing::Test
+    {
+    public:
+        void
+        TearDown () override
+        {
+            for (const std::string &path : m_paths)
+                llvm::sys::fs::remove (path);
+        }
+
+    protected:
+        // Create a source file with the given contents that is removed
+        // when the test ends
+        FileSpec
+        CreateSourceFile (const char *contents)
+        {
+            int fd = -1;
+            llvm::SmallString<128> path;
+            EXPECT_FALSE (llvm::sys::fs::createTemporaryFile ("SourceManagerTest", "c", fd, path));
+            ::close (fd);
+            m_paths.push_back (std::string (path.c_str()));
+            WriteSourceFile (path.c_str(), contents, 1);
+            return FileSpec (path.c_str(), false);
+        }
+
+        // Replace the contents of a file in place, the way "cat > file"
+        // does, and give it a new modification time
+        static void
+        WriteSourceFile (const char *path, const char *contents, int age_in_minutes)
+        {
+            FILE *file = ::fopen (path, "w");
+            ASSERT_TRUE (file != NULL);
+            ::fputs (contents, file);
+            ::fclose (file);
+
+            struct timeval times[2];
+            ::gettimeofday (&times[0], NULL);
+            times[0].tv_sec -= age_in_minutes * 60;
+            times[1] = times[0];
+            ::utimes (path, times);
+        }
+
+        static FileSpec
+        GetMissingFileSpec (uint32_t idx)
+        {
+            char path[64];
+            ::snprintf (path, sizeof(path), "/lldb-source-manager-test/missing%u.c", idx);
+            return FileSpec (path, false);
+        }
+
+        std::vector<std::string> m_paths;
+    };
+}
+
+TEST_F (SourceManagerTest, GetLine)
+{
+    FileSpec file_spec = CreateSourceFile ("one\ntwo\nthree\n");
+    SourceManager::File file (file_spec, NULL);
+
+    std::string line;
+    ASSERT_TRUE (file.GetLine (2, line));
+    EXPECT_EQ ("two\n", line);
+    ASSERT_TRUE (file.GetLine (3, line));
+    EXPECT_EQ ("three\n", line);
+    EXPECT_FALSE (file.GetLine (5, line));
+}
+
+TEST_F (SourceManagerTest, FileRewrittenInPlace)
+{
+    FileSpec file_spec = CreateSourceFile ("one\ntwo\nthree\n");
+    SourceManager::File file (file_spec, NULL);
+    std::string line;
+    ASSERT_TRUE (file.GetLine (3, line));
+
+    // Truncating the file must not affect the contents that were already
+    // read, the file isn't looked at again until it is displayed
+    WriteSourceFile (file_spec.GetPath().c_str(), "", 0);
+    ASSERT_TRUE (file.GetLine (3, line));
+    EXPECT_EQ ("three\n", line);
+
+    // Displaying the file picks up the new contents
+    WriteSourceFile (file_spec.GetPath().c_str(), "uno\ndos\n", 0);
+    StreamString strm;
+    file.DisplaySourceLines (2, 0, 0, &strm);
+    EXPECT_EQ ("dos\n", strm.GetString());
+    ASSERT_TRUE (file.GetLine (1, line));
+    EXPECT_EQ ("uno\n", line);
+    EXPECT_FALSE (file.GetLine (3, line));
+}
+
+TEST_F (SourceManagerTest, CacheFindsFilesBySpec)
+{
+    SourceManager::SourceFileCache cache;
+    SourceManager::FileSP file_sp (new SourceManager::File (GetMissingFileSpec (0), NULL));
+    cache.AddSourceFile (file_sp);
+
+    EXPECT_EQ (file_sp, cache.FindSourceFile (GetMissingFileSpec (0)));
+    EXPECT_FALSE (cache.FindSourceFile (GetMissingFileSpec (1)));
+
+    // Adding a file for the same spec replaces the old one
+    SourceManager::FileSP new_file_sp (new SourceManager::File (GetMissingFileSpec (0), NULL));
+    cache.AddSourceFile (new_file_sp);
+    EXPECT_EQ (new_file_sp, cache.FindSourceFile (GetMissingFileSpec (0)));
+}
+
+TEST_F (SourceManagerTest, CacheEvictsLeastRecentlyUsed)
+{
+    // The cache holds 128 files
+    const uint32_t kNumFiles = 128;
+    SourceManager::SourceFileCache cache;
+    for (uint32_t i = 0; i < kNumFiles; ++i)
+        cache.AddSourceFile (SourceManager::FileSP (new SourceManager::File (GetMissingFileSpec (i), NULL)));
+    for (uint32_t i = 0; i < kNumFiles; ++i)
+        EXPECT_TRUE (cache.FindSourceFile (GetMissingFileSpec (i))) << i;
+
+    // Looking a file up makes it the most recently used one
+    EXPECT_TRUE (cache.FindSourceFile (GetMissingFileSpec (0)));
+    cache.AddSourceFile (SourceManager::FileSP (new SourceManager::File (GetMissingFileSpec (kNumFiles), NULL)));
+    EXPECT_TRUE (cache.FindSourceFile (GetMissingFileSpec (0)));
+    EXPECT_FALSE (cache.FindSourceFile (GetMissingFileSpec (1)));
+    EXPECT_TRUE (cache.FindSourceFile (GetMissingFileSpec (2)));
+    EXPECT_TRUE (cache.FindSourceFile (GetMissingFileSpec (kNumFiles)));
+}
+
+TEST_F (SourceManagerTest, PrefetchLoadsExistingFiles)
+{
+    FileSpec file_spec = CreateSourceFile ("one\ntwo\n");
+    std::vector<FileSpec> file_specs;
+    file_specs.push_back (file_spec);
+    file_specs.push_back (GetMissingFileSpec (0));
+
+    SourceManager::SourceFileCache cache;
+    cache.PrefetchSourceFiles (file_specs);
+    cache.WaitForPrefetch ();
+
+    SourceManager::FileSP file_sp = cache.FindSourceFile (file_spec);
+    ASSERT_TRUE (file_sp);
+    std::string line;
+    ASSERT_TRUE (file_sp->GetLine (2, line));
+    EXPECT_EQ ("two\n", line);
+
+    // Files that would have to be found through a target are left alone
+    EXPECT_FALSE (cache.FindSourceFile (GetMissingFileSpec (0)));
+
+    // A cached file isn't loaded again
+    cache.PrefetchSourceFiles (file_specs);
+    cache.WaitForPrefetch ();
+    EXPECT_EQ (file_sp, cache.FindSourceFile (file_spec));
+}
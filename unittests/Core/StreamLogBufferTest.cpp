@@ -0,0 +1,227 @@
+//===-- StreamLogBufferTest.cpp ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdio.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/Log.h"
+#include "lldb/Core/StreamLogBuffer.h"
+#include "lldb/Host/Mutex.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    // Records every write as one entry, so the tests can check that records
+    // are never split or merged.
+    class RecordingStream : public Stream
+    {
+    public:
+        RecordingStream () :
+            Stream (),
+            m_mutex (Mutex::eMutexTypeNormal),
+            m_records (),
+            m_flush_count (0)
+        {
+        }
+
+        void
+        Flush () override
+        {
+            Mutex::Locker locker (m_mutex);
+            ++m_flush_count;
+        }
+
+        size_t
+        Write (const void *src, size_t src_len) override
+        {
+            Mutex::Locker locker (m_mutex);
+            m_records.push_back (std::string ((const char *)src, src_len));
+            return src_len;
+        }
+
+        std::vector<std::string>
+        GetRecords ()
+        {
+            Mutex::Locker locker (m_mutex);
+            return m_records;
+        }
+
+        size_t
+        GetFlushCount ()
+        {
+            Mutex::Locker locker (m_mutex);
+            return m_flush_count;
+        }
+
+    private:
+        Mutex m_mutex;
+        std::vector<std::string> m_records;
+        size_t m_flush_count;
+    };
+
+    class StreamLogBufferTest : public ::testing::Test
+    {
+    public:
+        void
+        SetUp () override
+        {
+            m_recording_stream = new RecordingStream ();
+            m_stream_sp.reset (m_recording_stream);
+        }
+
+    protected:
+        static std::string
+        MakeRecord (uint32_t thread_idx, uint32_t record_idx)
+        {
+            char record[64];
+            snprintf (record, sizeof(record), "thread %u record %5.5u\n", thread_idx, record_idx);
+            return record;
+        }
+
+        RecordingStream *m_recording_stream;
+        StreamSP m_stream_sp;
+    };
+}
+
+TEST_F (StreamLogBufferTest, AsyncFlushWritesEverything)
+{
+    StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeAsynchronous);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const std::string record = MakeRecord (0, i);
+        ASSERT_EQ (record.size(), log_buffer.Write (record.data(), record.size()));
+    }
+    log_buffer.Flush();
+
+    const std::vector<std::string> records = m_recording_stream->GetRecords();
+    ASSERT_EQ (1000u, records.size());
+    for (uint32_t i = 0; i < records.size(); ++i)
+        EXPECT_EQ (MakeRecord (0, i), records[i]);
+    EXPECT_LT (0u, m_recording_stream->GetFlushCount());
+}
+
+TEST_F (StreamLogBufferTest, AsyncManyProducers)
+{
+    const uint32_t kNumThreads = 8;
+    const uint32_t kNumRecords = 5000;
+    {
+        StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeAsynchronous);
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kNumThreads; ++t)
+        {
+            threads.push_back (std::thread ([&log_buffer, t, kNumRecords] ()
+            {
+                for (uint32_t i = 0; i < kNumRecords; ++i)
+                {
+                    const std::string record = MakeRecord (t, i);
+                    log_buffer.Write (record.data(), record.size());
+                }
+            }));
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        log_buffer.Flush();
+        EXPECT_EQ (kNumThreads * kNumRecords, m_recording_stream->GetRecords().size());
+    }
+
+    // No record was lost, split or duplicated, and the records of each
+    // thread are in the order they were written.
+    std::vector<uint32_t> next_record (kNumThreads, 0);
+    for (const std::string &record : m_recording_stream->GetRecords())
+    {
+        unsigned thread_idx, record_idx;
+        ASSERT_EQ (2, sscanf (record.c_str(), "thread %u record %u\n", &thread_idx, &record_idx)) << record;
+        ASSERT_LT (thread_idx, kNumThreads);
+        ASSERT_EQ (MakeRecord (thread_idx, record_idx), record);
+        EXPECT_EQ (next_record[thread_idx], record_idx);
+        next_record[thread_idx] = record_idx + 1;
+    }
+    for (uint32_t t = 0; t < kNumThreads; ++t)
+        EXPECT_EQ (kNumRecords, next_record[t]);
+}
+
+TEST_F (StreamLogBufferTest, AsyncDestructorWritesPendingRecords)
+{
+    {
+        StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeAsynchronous);
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            const std::string record = MakeRecord (0, i);
+            log_buffer.Write (record.data(), record.size());
+        }
+    }
+    EXPECT_EQ (100u, m_recording_stream->GetRecords().size());
+}
+
+TEST_F (StreamLogBufferTest, FlushAllFlushesAsyncBuffers)
+{
+    StreamSP log_buffer_sp (new StreamLogBuffer (m_stream_sp, StreamLogBuffer::eModeAsynchronous));
+    const std::string record = MakeRecord (0, 0);
+    log_buffer_sp->Write (record.data(), record.size());
+
+    // This is what runs when the process calls exit()
+    StreamLogBuffer::FlushAll();
+    ASSERT_EQ (1u, m_recording_stream->GetRecords().size());
+    EXPECT_EQ (record, m_recording_stream->GetRecords()[0]);
+}
+
+TEST_F (StreamLogBufferTest, AsyncFlushLogRecord)
+{
+    StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeAsynchronous);
+    const std::string record = MakeRecord (0, 0);
+    log_buffer.Write (record.data(), record.size());
+
+    // A fatal record waits for the writer so it can't be lost
+    log_buffer.FlushLogRecord (LLDB_LOG_FLAG_FATAL);
+    EXPECT_EQ (1u, m_recording_stream->GetRecords().size());
+}
+
+TEST_F (StreamLogBufferTest, RingBufferKeepsNewestRecords)
+{
+    const std::string first = MakeRecord (0, 0);
+    StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeRingBuffer, 10 * first.size());
+    for (uint32_t i = 0; i < 25; ++i)
+    {
+        const std::string record = MakeRecord (0, i);
+        log_buffer.Write (record.data(), record.size());
+    }
+
+    // Nothing is written until an error is logged
+    log_buffer.FlushLogRecord (0);
+    log_buffer.FlushLogRecord (LLDB_LOG_FLAG_WARNING);
+    EXPECT_TRUE (m_recording_stream->GetRecords().empty());
+
+    log_buffer.FlushLogRecord (LLDB_LOG_FLAG_ERROR);
+    const std::vector<std::string> records = m_recording_stream->GetRecords();
+    ASSERT_EQ (11u, records.size());
+    EXPECT_NE (std::string::npos, records[0].find ("15 older log records were discarded"));
+    for (uint32_t i = 1; i < records.size(); ++i)
+        EXPECT_EQ (MakeRecord (0, 14 + i), records[i]);
+
+    // The ring buffer starts over once it was dumped
+    log_buffer.FlushLogRecord (LLDB_LOG_FLAG_FATAL);
+    EXPECT_EQ (11u, m_recording_stream->GetRecords().size());
+}
+
+TEST_F (StreamLogBufferTest, RingBufferKeepsOversizedRecord)
+{
+    StreamLogBuffer log_buffer (m_stream_sp, StreamLogBuffer::eModeRingBuffer, 4);
+    const std::string record = MakeRecord (0, 0);
+    log_buffer.Write (record.data(), record.size());
+    log_buffer.DumpRingBuffer();
+    ASSERT_EQ (1u, m_recording_stream->GetRecords().size());
+    EXPECT_EQ (record, m_recording_stream->GetRecords()[0]);
+}
@@ -0,0 +1,67 @@
+//===-- StructuredDataTest.cpp ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/StreamString.h"
+#include "lldb/Core/StructuredData.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    std::string
+    DumpString (const std::string &value)
+    {
+        StructuredData::String string;
+        string.SetValue (value);
+        StreamString stream;
+        string.Dump (stream);
+        return stream.GetString ();
+    }
+}
+
+TEST (StructuredDataTest, DumpPlainString)
+{
+    EXPECT_EQ ("\"\"", DumpString (""));
+    EXPECT_EQ ("\"'A'\"", DumpString ("'A'"));
+    EXPECT_EQ ("\"caf\xc3\xa9\"", DumpString ("caf\xc3\xa9"));
+}
+
+TEST (StructuredDataTest, DumpEscapesQuotesAndBackslashes)
+{
+    EXPECT_EQ ("\"\\\"a\\\\b\\\"\"", DumpString ("\"a\\b\""));
+    EXPECT_EQ ("\"'\\\\\\\\'\"", DumpString ("'\\\\'"));
+}
+
+TEST (StructuredDataTest, DumpEscapesControlCharacters)
+{
+    EXPECT_EQ ("\"'\\n'\"", DumpString ("'\n'"));
+    EXPECT_EQ ("\"\\b\\f\\n\\r\\t\"", DumpString ("\b\f\n\r\t"));
+    EXPECT_EQ ("\"\\u0001\\u001f\\u007f\"", DumpString ("\x01\x1f\x7f"));
+}
+
+TEST (StructuredDataTest, DumpKeepsEmbeddedNUL)
+{
+    // A char array summary with a NUL in the middle
+    EXPECT_EQ ("\"'\\u0000'\"", DumpString (std::string ("'\0'", 3)));
+    EXPECT_EQ ("\"ab\\u0000cd\"", DumpString (std::string ("ab\0cd", 5)));
+}
+
+TEST (StructuredDataTest, DumpEscapesDictionaryKeys)
+{
+    StructuredData::Dictionary dict;
+    dict.AddStringItem ("a\"b", "c\nd");
+    StreamString stream;
+    dict.Dump (stream);
+    EXPECT_EQ ("{\"a\\\"b\":\"c\\nd\"}", stream.GetString ());
+}
@@ -0,0 +1,110 @@
+//===-- TimerTest.cpp -------------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/StreamString.h"
+#include "lldb/Core/StructuredData.h"
+#include "lldb/Core/Timer.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    class TimerTest : public ::testing::Test
+    {
+    public:
+        static void
+        SetUpTestCase ()
+        {
+            Timer::Initialize ();
+        }
+
+        void
+        SetUp () override
+        {
+            Timer::SetDisplayDepth (UINT32_MAX);
+            Timer::ResetCategoryTimes ();
+        }
+
+        void
+        TearDown () override
+        {
+            Timer::SetDisplayDepth (0);
+            Timer::ResetCategoryTimes ();
+        }
+
+    protected:
+        static std::string
+        DumpTraceEvents ()
+        {
+            StreamString stream;
+            Timer::DumpTraceEvents (&stream);
+            return stream.GetString ();
+        }
+
+        static StructuredData::Array *
+        GetTraceEvents (const StructuredData::ObjectSP &object_sp)
+        {
+            StructuredData::Dictionary *dict = object_sp ? object_sp->GetAsDictionary () : nullptr;
+            if (!dict)
+                return nullptr;
+            StructuredData::ObjectSP events_sp = dict->GetValueForKey ("traceEvents");
+            return events_sp ? events_sp->GetAsArray () : nullptr;
+        }
+    };
+}
+
+TEST_F (TimerTest, DumpTraceEventsIsJSON)
+{
+    {
+        Timer outer ("outer", "outer");
+        Timer inner ("inner", "inner");
+    }
+
+    StructuredData::ObjectSP object_sp = StructuredData::ParseJSON (DumpTraceEvents ());
+    StructuredData::Array *events = GetTraceEvents (object_sp);
+    ASSERT_TRUE (events != nullptr);
+    ASSERT_EQ (2u, events->GetSize ());
+
+    // Timers are recorded as they complete
+    StructuredData::Dictionary *event = nullptr;
+    std::string name;
+    ASSERT_TRUE (events->GetItemAtIndexAsDictionary (0, event));
+    ASSERT_TRUE (event->GetValueForKeyAsString ("name", name));
+    EXPECT_EQ ("inner", name);
+    ASSERT_TRUE (events->GetItemAtIndexAsDictionary (1, event));
+    ASSERT_TRUE (event->GetValueForKeyAsString ("name", name));
+    EXPECT_EQ ("outer", name);
+    ASSERT_TRUE (event->GetValueForKeyAsString ("ph", name));
+    EXPECT_EQ ("X", name);
+}
+
+TEST_F (TimerTest, DumpTraceEventsEscapesCategories)
+{
+    {
+        Timer quoted ("a \"quoted\" C:\\path", "quoted");
+        Timer control ("tab\tnewline\nbell\x07", "control");
+    }
+
+    const std::string json = DumpTraceEvents ();
+    EXPECT_NE (std::string::npos, json.find ("\"name\":\"a \\\"quoted\\\" C:\\\\path\"")) << json;
+    EXPECT_NE (std::string::npos, json.find ("\"name\":\"tab\\tnewline\\nbell\\u0007\"")) << json;
+    EXPECT_EQ (std::string::npos, json.find ('\t')) << json;
+    EXPECT_EQ (std::string::npos, json.find ('\x07')) << json;
+
+    // Escaping keeps the rest of the document intact
+    StructuredData::ObjectSP object_sp = StructuredData::ParseJSON (json);
+    StructuredData::Array *events = GetTraceEvents (object_sp);
+    ASSERT_TRUE (events != nullptr);
+    EXPECT_EQ (2u, events->GetSize ());
+}
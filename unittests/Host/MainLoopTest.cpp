@@ -0,0 +1,111 @@
+//===-- MainLoopTest.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if defined(__linux__)
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Host/File.h"
+#include "lldb/Host/MainLoop.h"
+
+using namespace lldb_private;
+
+class MainLoopTest : public testing::Test
+{
+  protected:
+    MainLoop m_loop;
+    int m_callback_count = 0;
+
+    MainLoop::Callback
+    CountAndTerminate()
+    {
+        return [this](MainLoopBase &loop) {
+            ++m_callback_count;
+            loop.RequestTermination();
+        };
+    }
+};
+
+TEST_F(MainLoopTest, PendingCallbackFromOtherThread)
+{
+    std::thread poster([this] { m_loop.AddPendingCallback(CountAndTerminate()); });
+
+    Error error = m_loop.Run();
+    poster.join();
+
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_EQ(1, m_callback_count);
+}
+
+TEST_F(MainLoopTest, ReadObject)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+    lldb::IOObjectSP read_object_sp(new File(fds[0], true));
+
+    Error error;
+    MainLoop::ReadHandleUP handle = m_loop.RegisterReadObject(read_object_sp, CountAndTerminate(), error);
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_TRUE(handle != nullptr);
+
+    // Registering the same descriptor twice is refused.
+    Error dup_error;
+    ASSERT_TRUE(m_loop.RegisterReadObject(read_object_sp, CountAndTerminate(), dup_error) == nullptr);
+    ASSERT_TRUE(dup_error.Fail());
+
+    char c = 'X';
+    ASSERT_EQ(1, ::write(fds[1], &c, 1));
+
+    error = m_loop.Run();
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_EQ(1, m_callback_count);
+
+    handle.reset();
+    ::close(fds[1]);
+}
+
+TEST_F(MainLoopTest, Signal)
+{
+    Error error;
+    MainLoop::SignalHandleUP handle = m_loop.RegisterSignal(SIGUSR1, CountAndTerminate(), error);
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_TRUE(handle != nullptr);
+
+    // The signal is blocked while registered, so it stays pending for the
+    // loop instead of killing the test.
+    ASSERT_EQ(0, ::raise(SIGUSR1));
+
+    error = m_loop.Run();
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_EQ(1, m_callback_count);
+}
+
+TEST_F(MainLoopTest, SignalCallbackPerDelivery)
+{
+    Error error;
+    MainLoop::SignalHandleUP handle = m_loop.RegisterSignal(SIGRTMIN, CountAndTerminate(), error);
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_TRUE(handle != nullptr);
+
+    // Real-time signals are queued, so both deliveries are pending and the
+    // callback runs for each of them.
+    ASSERT_EQ(0, ::raise(SIGRTMIN));
+    ASSERT_EQ(0, ::raise(SIGRTMIN));
+
+    error = m_loop.Run();
+    ASSERT_TRUE(error.Success()) << error.AsCString();
+    ASSERT_EQ(2, m_callback_count);
+}
+
+#endif
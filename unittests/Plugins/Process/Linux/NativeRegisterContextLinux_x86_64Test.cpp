@@ -0,0 +1,193 @@
+//===-- NativeRegisterContextLinux_x86_64Test.cpp ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if defined(__x86_64__)
+
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/ArchSpec.h"
+#include "lldb/Core/Error.h"
+#include "lldb/Core/RegisterValue.h"
+#include "Plugins/Process/Linux/NativeRegisterContextLinux_x86_64.h"
+#include "Plugins/Process/Utility/RegisterContextLinux_x86_64.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::process_linux;
+
+namespace
+{
+    // An i386 register and the x86_64 register it is sliced out of.
+    struct GPRSlice
+    {
+        uint32_t reg_i386;
+        uint32_t reg_x86_64;
+        uint32_t offset;        // Byte offset of reg_i386 inside reg_x86_64
+    };
+
+    const GPRSlice g_gpr_slices[] =
+    {
+        { lldb_eax_i386,    lldb_rax_x86_64,    0 },
+        { lldb_ebx_i386,    lldb_rbx_x86_64,    0 },
+        { lldb_ecx_i386,    lldb_rcx_x86_64,    0 },
+        { lldb_edx_i386,    lldb_rdx_x86_64,    0 },
+        { lldb_edi_i386,    lldb_rdi_x86_64,    0 },
+        { lldb_esi_i386,    lldb_rsi_x86_64,    0 },
+        { lldb_ebp_i386,    lldb_rbp_x86_64,    0 },
+        { lldb_esp_i386,    lldb_rsp_x86_64,    0 },
+        { lldb_eip_i386,    lldb_rip_x86_64,    0 },
+        { lldb_eflags_i386, lldb_rflags_x86_64, 0 },
+        { lldb_cs_i386,     lldb_cs_x86_64,     0 },
+        { lldb_fs_i386,     lldb_fs_x86_64,     0 },
+        { lldb_gs_i386,     lldb_gs_x86_64,     0 },
+        { lldb_ss_i386,     lldb_ss_x86_64,     0 },
+        { lldb_ds_i386,     lldb_ds_x86_64,     0 },
+        { lldb_es_i386,     lldb_es_x86_64,     0 },
+        { lldb_ax_i386,     lldb_rax_x86_64,    0 },
+        { lldb_sp_i386,     lldb_rsp_x86_64,    0 },
+        { lldb_ah_i386,     lldb_rax_x86_64,    1 },
+        { lldb_dh_i386,     lldb_rdx_x86_64,    1 },
+        { lldb_al_i386,     lldb_rax_x86_64,    0 },
+        { lldb_dl_i386,     lldb_rdx_x86_64,    0 },
+    };
+
+    class NativeRegisterContextLinux_x86_64Test : public ::testing::Test
+    {
+    public:
+        NativeRegisterContextLinux_x86_64Test () :
+            m_context_i386 (ArchSpec ("i386-pc-linux")),
+            m_context_x86_64 (ArchSpec ("x86_64-pc-linux")),
+            m_gpr (),
+            m_gpr_size (0)
+        {
+        }
+
+        void
+        SetUp () override
+        {
+            // A GPR set as PTRACE_GETREGS returns it to a 64-bit lldb-server,
+            // every byte holds its own offset.
+            m_gpr_size = m_context_x86_64.GetGPRSize();
+            ASSERT_EQ (m_gpr_size, m_context_i386.GetGPRSize());
+            m_gpr.resize (m_gpr_size / sizeof(uint64_t));
+            uint8_t *bytes = reinterpret_cast<uint8_t *> (m_gpr.data());
+            for (size_t i = 0; i < m_gpr_size; ++i)
+                bytes[i] = (uint8_t)i;
+        }
+
+    protected:
+        const RegisterInfo *
+        GetI386 (uint32_t reg) const
+        {
+            return &m_context_i386.GetRegisterInfo()[reg];
+        }
+
+        const RegisterInfo *
+        GetX86_64 (uint32_t reg) const
+        {
+            return &m_context_x86_64.GetRegisterInfo()[reg];
+        }
+
+        // The little endian value of the byte_size bytes at byte_offset
+        uint64_t
+        GetGPRBytes (uint32_t byte_offset, uint32_t byte_size) const
+        {
+            uint64_t value = 0;
+            memcpy (&value, reinterpret_cast<const uint8_t *> (m_gpr.data()) + byte_offset, byte_size);
+            return value;
+        }
+
+        RegisterContextLinux_x86_64 m_context_i386;
+        RegisterContextLinux_x86_64 m_context_x86_64;
+        std::vector<uint64_t> m_gpr;
+        size_t m_gpr_size;
+    };
+}
+
+TEST_F (NativeRegisterContextLinux_x86_64Test, I386RegistersUseX86_64Offsets)
+{
+    for (const GPRSlice &slice : g_gpr_slices)
+    {
+        const RegisterInfo *reg_info = GetI386 (slice.reg_i386);
+        EXPECT_EQ (GetX86_64 (slice.reg_x86_64)->byte_offset + slice.offset, reg_info->byte_offset) << reg_info->name;
+    }
+}
+
+TEST_F (NativeRegisterContextLinux_x86_64Test, ReadI386RegistersFromGPR)
+{
+    for (const GPRSlice &slice : g_gpr_slices)
+    {
+        const RegisterInfo *reg_info = GetI386 (slice.reg_i386);
+        const uint32_t byte_offset = GetX86_64 (slice.reg_x86_64)->byte_offset + slice.offset;
+
+        RegisterValue reg_value;
+        Error error = NativeRegisterContextLinux_x86_64::ReadRegisterFromGPR (reg_info, m_gpr.data(), m_gpr_size, eByteOrderLittle, reg_value);
+        ASSERT_TRUE (error.Success ()) << reg_info->name << ": " << error.AsCString ();
+        EXPECT_EQ (reg_info->byte_size, reg_value.GetByteSize ()) << reg_info->name;
+        EXPECT_EQ (GetGPRBytes (byte_offset, reg_info->byte_size), reg_value.GetAsUInt64 ()) << reg_info->name;
+    }
+}
+
+TEST_F (NativeRegisterContextLinux_x86_64Test, AllI386GPRsFitInGPR)
+{
+    for (uint32_t reg = k_first_gpr_i386; reg <= k_last_gpr_i386; ++reg)
+    {
+        const RegisterInfo *reg_info = GetI386 (reg);
+        RegisterValue reg_value;
+        Error error = NativeRegisterContextLinux_x86_64::ReadRegisterFromGPR (reg_info, m_gpr.data(), m_gpr_size, eByteOrderLittle, reg_value);
+        EXPECT_TRUE (error.Success ()) << reg_info->name << ": " << error.AsCString ();
+    }
+}
+
+TEST_F (NativeRegisterContextLinux_x86_64Test, WriteI386SubRegisters)
+{
+    const uint32_t rax_offset = GetX86_64 (lldb_rax_x86_64)->byte_offset;
+    const uint64_t rbx = GetGPRBytes (GetX86_64 (lldb_rbx_x86_64)->byte_offset, 8);
+    m_gpr[rax_offset / 8] = 0x1122334455667788ull;
+
+    RegisterValue ah_value;
+    ah_value.SetUInt8 (0xab);
+    Error error = NativeRegisterContextLinux_x86_64::WriteRegisterToGPR (GetI386 (lldb_ah_i386), ah_value, m_gpr.data(), m_gpr_size, eByteOrderLittle);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (0x112233445566ab88ull, m_gpr[rax_offset / 8]);
+
+    RegisterValue eax_value;
+    eax_value.SetUInt32 (0xdeadbeef);
+    error = NativeRegisterContextLinux_x86_64::WriteRegisterToGPR (GetI386 (lldb_eax_i386), eax_value, m_gpr.data(), m_gpr_size, eByteOrderLittle);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (0x11223344deadbeefull, m_gpr[rax_offset / 8]);
+
+    // The neighbouring register is untouched.
+    EXPECT_EQ (rbx, GetGPRBytes (GetX86_64 (lldb_rbx_x86_64)->byte_offset, 8));
+
+    RegisterValue al_value;
+    error = NativeRegisterContextLinux_x86_64::ReadRegisterFromGPR (GetI386 (lldb_al_i386), m_gpr.data(), m_gpr_size, eByteOrderLittle, al_value);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (0xefu, al_value.GetAsUInt64 ());
+}
+
+TEST_F (NativeRegisterContextLinux_x86_64Test, RegisterOutsideOfGPRFails)
+{
+    RegisterInfo reg_info = *GetI386 (lldb_eax_i386);
+    reg_info.byte_offset = m_gpr_size - 2;
+
+    RegisterValue reg_value;
+    EXPECT_TRUE (NativeRegisterContextLinux_x86_64::ReadRegisterFromGPR (&reg_info, m_gpr.data(), m_gpr_size, eByteOrderLittle, reg_value).Fail ());
+
+    reg_value.SetUInt32 (0xdeadbeef);
+    const uint64_t last = m_gpr.back();
+    EXPECT_TRUE (NativeRegisterContextLinux_x86_64::WriteRegisterToGPR (&reg_info, reg_value, m_gpr.data(), m_gpr_size, eByteOrderLittle).Fail ());
+    EXPECT_EQ (last, m_gpr.back());
+}
+
+#endif
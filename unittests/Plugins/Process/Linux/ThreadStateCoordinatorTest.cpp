@@ -814,3 +814,41 @@ TEST_F (ThreadStateCoordinatorTest, CallAfterRunningThreadsStopRequestsStopTwoOt
     ASSERT_EQ (true, DidFireDeferredNotification ());
     ASSERT_EQ (TRIGGERING_TID, GetDeferredNotificationTID ());
 }
+
+TEST_F (ThreadStateCoordinatorTest, EventQueuedFunctionFiresOnEachEnqueue)
+{
+    int queued_count = 0;
+    m_coordinator.SetEventQueuedFunction ([&queued_count] () { ++queued_count; });
+
+    NotifyThreadCreate (TRIGGERING_TID, true);
+    NotifyThreadCreate (PENDING_STOP_TID, false);
+
+    ASSERT_EQ (2, queued_count);
+}
+
+TEST_F (ThreadStateCoordinatorTest, ProcessPendingEventsDrainsQueueWithoutBlocking)
+{
+    // Nothing queued: must return immediately.
+    ASSERT_EQ (ThreadStateCoordinator::eventLoopResultContinue, m_coordinator.ProcessPendingEvents ());
+
+    NotifyThreadCreate (TRIGGERING_TID, true);
+    NotifyThreadCreate (PENDING_STOP_TID, false);
+    CallAfterRunningThreadsStop (TRIGGERING_TID);
+
+    // All three events are handled in one call.
+    ASSERT_EQ (ThreadStateCoordinator::eventLoopResultContinue, m_coordinator.ProcessPendingEvents ());
+    ASSERT_EQ (false, HasError ());
+    ASSERT_EQ (true, DidRequestStopForTid (PENDING_STOP_TID));
+    ASSERT_EQ (false, DidFireDeferredNotification ());
+
+    NotifyThreadStop (PENDING_STOP_TID);
+    ASSERT_EQ (ThreadStateCoordinator::eventLoopResultContinue, m_coordinator.ProcessPendingEvents ());
+    ASSERT_EQ (true, DidFireDeferredNotification ());
+    ASSERT_EQ (TRIGGERING_TID, GetDeferredNotificationTID ());
+}
+
+TEST_F (ThreadStateCoordinatorTest, ProcessPendingEventsReportsStop)
+{
+    m_coordinator.StopCoordinator ();
+    ASSERT_EQ (ThreadStateCoordinator::eventLoopResultStop, m_coordinator.ProcessPendingEvents ());
+}
@@ -0,0 +1,221 @@
+//===-- GDBRemoteCommunicationServerLLGSTest.cpp ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string.h>
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/RegisterValue.h"
+#include "lldb/Host/common/NativeRegisterContext.h"
+#include "lldb/Host/common/NativeThreadProtocol.h"
+#include "Plugins/Process/gdb-remote/GDBRemoteCommunicationServerLLGS.h"
+
+using namespace lldb;
+using namespace lldb_private;
+using namespace lldb_private::process_gdb_remote;
+
+namespace
+{
+    enum
+    {
+        eRegR0,
+        eRegR1,
+        eRegF0,
+        eRegF1,
+        eRegW0,     // The low half of r0
+        kNumRegisters
+    };
+
+    uint32_t g_w0_value_regs[] = { eRegR0, LLDB_INVALID_REGNUM };
+
+    RegisterInfo g_register_infos[kNumRegisters] = {
+        { "r0", NULL, 8,  0, eEncodingUint, eFormatHex, { LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, eRegR0 }, NULL, NULL },
+        { "r1", NULL, 8,  8, eEncodingUint, eFormatHex, { LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, eRegR1 }, NULL, NULL },
+        { "f0", NULL, 8, 16, eEncodingUint, eFormatHex, { LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, eRegF0 }, NULL, NULL },
+        { "f1", NULL, 8, 24, eEncodingUint, eFormatHex, { LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, eRegF1 }, NULL, NULL },
+        { "w0", NULL, 4,  0, eEncodingUint, eFormatHex, { LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, LLDB_INVALID_REGNUM, eRegW0 }, g_w0_value_regs, NULL },
+    };
+
+    class TestThread : public NativeThreadProtocol
+    {
+    public:
+        TestThread () :
+            NativeThreadProtocol (NULL, 1)
+        {
+        }
+
+        std::string
+        GetName () override
+        {
+            return "test";
+        }
+
+        StateType
+        GetState () override
+        {
+            return eStateStopped;
+        }
+
+        NativeRegisterContextSP
+        GetRegisterContext () override
+        {
+            return NativeRegisterContextSP ();
+        }
+
+        bool
+        GetStopReason (ThreadStopInfo &stop_info, std::string& description) override
+        {
+            return false;
+        }
+
+        Error
+        SetWatchpoint (addr_t addr, size_t size, uint32_t watch_flags, bool hardware) override
+        {
+            return Error ("not supported");
+        }
+
+        Error
+        RemoveWatchpoint (addr_t addr) override
+        {
+            return Error ("not supported");
+        }
+    };
+
+    // Registers hold 0x1111111111111111 times their number plus one, except
+    // for the ones marked unreadable.
+    class TestRegisterContext : public NativeRegisterContext
+    {
+    public:
+        TestRegisterContext (NativeThreadProtocol &thread) :
+            NativeRegisterContext (thread, 0)
+        {
+        }
+
+        uint32_t
+        GetRegisterCount () const override
+        {
+            return kNumRegisters;
+        }
+
+        uint32_t
+        GetUserRegisterCount () const override
+        {
+            return kNumRegisters;
+        }
+
+        const RegisterInfo *
+        GetRegisterInfoAtIndex (uint32_t reg) const override
+        {
+            return reg < kNumRegisters ? &g_register_infos[reg] : NULL;
+        }
+
+        uint32_t
+        GetRegisterSetCount () const override
+        {
+            return 0;
+        }
+
+        const RegisterSet *
+        GetRegisterSet (uint32_t set_index) const override
+        {
+            return NULL;
+        }
+
+        Error
+        ReadRegister (const RegisterInfo *reg_info, RegisterValue &reg_value) override
+        {
+            const uint32_t reg = reg_info->kinds[eRegisterKindLLDB];
+            if (m_unreadable.count (reg))
+                return Error ("unable to read register %s", reg_info->name);
+            reg_value.SetUInt64 (GetValue (reg));
+            return Error ();
+        }
+
+        Error
+        WriteRegister (const RegisterInfo *reg_info, const RegisterValue &reg_value) override
+        {
+            return Error ("not supported");
+        }
+
+        Error
+        ReadAllRegisterValues (DataBufferSP &data_sp) override
+        {
+            return Error ("not supported");
+        }
+
+        Error
+        WriteAllRegisterValues (const DataBufferSP &data_sp) override
+        {
+            return Error ("not supported");
+        }
+
+        static uint64_t
+        GetValue (uint32_t reg)
+        {
+            return 0x1111111111111111ull * (reg + 1);
+        }
+
+        std::set<uint32_t> m_unreadable;
+    };
+
+    class GDBRemoteCommunicationServerLLGSTest : public ::testing::Test
+    {
+    public:
+        GDBRemoteCommunicationServerLLGSTest () :
+            m_thread (),
+            m_reg_context (m_thread)
+        {
+        }
+
+    protected:
+        uint64_t
+        GetRegisterData (const std::vector<uint8_t> &reg_data, uint32_t reg)
+        {
+            uint64_t value = 0;
+            ::memcpy (&value, &reg_data[g_register_infos[reg].byte_offset], sizeof(value));
+            return value;
+        }
+
+        TestThread m_thread;
+        TestRegisterContext m_reg_context;
+    };
+}
+
+TEST_F (GDBRemoteCommunicationServerLLGSTest, GPacketHasEveryRegister)
+{
+    std::vector<uint8_t> reg_data;
+    EXPECT_EQ (32u, GDBRemoteCommunicationServerLLGS::ReadGPacketRegisterData (m_reg_context, reg_data));
+    ASSERT_EQ (32u, reg_data.size ());
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegR0), GetRegisterData (reg_data, eRegR0));
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegR1), GetRegisterData (reg_data, eRegR1));
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegF0), GetRegisterData (reg_data, eRegF0));
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegF1), GetRegisterData (reg_data, eRegF1));
+}
+
+TEST_F (GDBRemoteCommunicationServerLLGSTest, GPacketEndsBeforeUnreadableRegister)
+{
+    // The reply must not cover f0, or the client would take zeros as its
+    // value. f1 is readable but comes after it.
+    m_reg_context.m_unreadable.insert (eRegF0);
+    std::vector<uint8_t> reg_data;
+    EXPECT_EQ (16u, GDBRemoteCommunicationServerLLGS::ReadGPacketRegisterData (m_reg_context, reg_data));
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegR0), GetRegisterData (reg_data, eRegR0));
+    EXPECT_EQ (TestRegisterContext::GetValue (eRegR1), GetRegisterData (reg_data, eRegR1));
+}
+
+TEST_F (GDBRemoteCommunicationServerLLGSTest, GPacketIsEmptyWhenFirstRegisterIsUnreadable)
+{
+    m_reg_context.m_unreadable.insert (eRegR0);
+    m_reg_context.m_unreadable.insert (eRegF1);
+    std::vector<uint8_t> reg_data;
+    EXPECT_EQ (0u, GDBRemoteCommunicationServerLLGS::ReadGPacketRegisterData (m_reg_context, reg_data));
+}
@@ -0,0 +1,222 @@
+//===-- GDBRemoteCommunicationTest.cpp --------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/StructuredData.h"
+#include "lldb/Host/TimeValue.h"
+#include "Plugins/Process/gdb-remote/GDBRemoteCommunication.h"
+
+using namespace lldb_private;
+using namespace lldb_private::process_gdb_remote;
+
+namespace
+{
+    // Nothing is ever connected, the tests only feed packets to the
+    // statistics or to CheckForPacket().
+    class TestCommunication : public GDBRemoteCommunication
+    {
+    public:
+        TestCommunication () :
+            GDBRemoteCommunication ("test", "test.listener")
+        {
+        }
+
+        bool
+        GetThreadSuffixSupported () override
+        {
+            return false;
+        }
+
+        using GDBRemoteCommunication::PacketStatistics;
+
+        // Decode one packet without sending an ack for it
+        bool
+        Decode (const char *bytes, std::string &decoded)
+        {
+            m_send_acks = false;
+            StringExtractorGDBRemote packet;
+            const bool success = CheckForPacket ((const uint8_t *)bytes, strlen (bytes), packet);
+            decoded = packet.GetStringRef();
+            return success;
+        }
+
+        void
+        Record (const char *packet, size_t response_length, PacketResult result = PacketResult::Success, uint64_t latency_usec = 0)
+        {
+            // The packet was sent latency_usec ago
+            const uint64_t send_usec = TimeValue::Now().GetAsMicroSecondsSinceJan1_1970() - latency_usec;
+            struct timespec ts;
+            ts.tv_sec = send_usec / TimeValue::MicroSecPerSec;
+            ts.tv_nsec = (send_usec % TimeValue::MicroSecPerSec) * TimeValue::NanoSecPerMicroSec;
+            const TimeValue send_time (ts);
+            RecordPacketStatistics (packet, strlen (packet), response_length, send_time, result);
+        }
+    };
+
+    class GDBRemoteCommunicationTest : public ::testing::Test
+    {
+    protected:
+        StructuredData::Dictionary *
+        GetPacketStatistics (const char *name)
+        {
+            m_stats_sp = m_comm.GetPacketStatistics();
+            StructuredData::Dictionary *packets = m_stats_sp->GetAsDictionary();
+            if (!packets)
+                return nullptr;
+            StructuredData::ObjectSP packet_sp = packets->GetValueForKey (name);
+            return packet_sp ? packet_sp->GetAsDictionary() : nullptr;
+        }
+
+        static uint64_t
+        GetInteger (StructuredData::Dictionary *dict, const char *key)
+        {
+            uint64_t value = UINT64_MAX;
+            dict->GetValueForKeyAsInteger (key, value);
+            return value;
+        }
+
+        TestCommunication m_comm;
+        StructuredData::ObjectSP m_stats_sp;
+    };
+}
+
+TEST_F (GDBRemoteCommunicationTest, GroupsPacketsByName)
+{
+    const char *packets[] = {
+        "m1000,4", "M1000,1:ff", "Z0,1000,1", "c", "vCont;c:1234", "vFile:pread:5,1000,0",
+        "qRegisterInfo1a", "qThreadStopInfo1234", "qSupported:xmlRegisters=i386",
+        "qXfer:features:read:target.xml:0,fff", "QStartNoAckMode", "jThreadsInfo", "_M1000,rwx", ""
+    };
+    for (const char *packet : packets)
+        m_comm.Record (packet, 10);
+
+    const char *names[] = {
+        "m", "M", "Z", "c", "vCont", "vFile", "qRegisterInfo", "qThreadStopInfo", "qSupported",
+        "qXfer", "QStartNoAckMode", "jThreadsInfo", "_M", "<empty>"
+    };
+    for (const char *name : names)
+    {
+        StructuredData::Dictionary *stats = GetPacketStatistics (name);
+        ASSERT_TRUE (stats != nullptr) << name;
+        EXPECT_EQ (1u, GetInteger (stats, "count")) << name;
+    }
+    EXPECT_EQ (sizeof(names) / sizeof(names[0]), m_stats_sp->GetAsDictionary()->GetSize());
+}
+
+TEST_F (GDBRemoteCommunicationTest, CountsBytesAndErrors)
+{
+    m_comm.Record ("m1000,4", 8);
+    m_comm.Record ("m2000,10", 32);
+    m_comm.Record ("m3000,10", 100, GDBRemoteCommunication::PacketResult::ErrorReplyTimeout);
+
+    StructuredData::Dictionary *stats = GetPacketStatistics ("m");
+    ASSERT_TRUE (stats != nullptr);
+    EXPECT_EQ (3u, GetInteger (stats, "count"));
+    EXPECT_EQ (1u, GetInteger (stats, "errors"));
+    EXPECT_EQ (strlen ("m1000,4") + strlen ("m2000,10") + strlen ("m3000,10"), GetInteger (stats, "bytes_sent"));
+    // Failed exchanges don't count their response
+    EXPECT_EQ (40u, GetInteger (stats, "bytes_received"));
+}
+
+TEST_F (GDBRemoteCommunicationTest, RecordsLatency)
+{
+    m_comm.Record ("g", 100, GDBRemoteCommunication::PacketResult::Success, 3000);
+    m_comm.Record ("g", 100, GDBRemoteCommunication::PacketResult::Success, 200000);
+
+    StructuredData::Dictionary *stats = GetPacketStatistics ("g");
+    ASSERT_TRUE (stats != nullptr);
+    const uint64_t min_latency = GetInteger (stats, "min_latency_usec");
+    const uint64_t max_latency = GetInteger (stats, "max_latency_usec");
+    EXPECT_LE (3000u, min_latency);
+    EXPECT_GT (200000u, min_latency);
+    EXPECT_LE (200000u, max_latency);
+    EXPECT_EQ (min_latency + max_latency, GetInteger (stats, "total_latency_usec"));
+
+    // One histogram entry per latency, in increasing order
+    StructuredData::ObjectSP histogram_sp = stats->GetValueForKey ("latency_histogram");
+    ASSERT_TRUE (histogram_sp && histogram_sp->GetAsArray());
+    StructuredData::Array *histogram = histogram_sp->GetAsArray();
+    ASSERT_EQ (2u, histogram->GetSize());
+    StructuredData::Dictionary *entry = nullptr;
+    ASSERT_TRUE (histogram->GetItemAtIndexAsDictionary (0, entry));
+    EXPECT_EQ (2048u, GetInteger (entry, "min_usec"));
+    EXPECT_EQ (1u, GetInteger (entry, "count"));
+    ASSERT_TRUE (histogram->GetItemAtIndexAsDictionary (1, entry));
+    EXPECT_EQ (131072u, GetInteger (entry, "min_usec"));
+    EXPECT_EQ (1u, GetInteger (entry, "count"));
+}
+
+TEST_F (GDBRemoteCommunicationTest, LatencyBuckets)
+{
+    typedef TestCommunication::PacketStatistics PacketStatistics;
+    EXPECT_EQ (0u, PacketStatistics::GetLatencyBucket (0));
+    EXPECT_EQ (1u, PacketStatistics::GetLatencyBucket (1));
+    EXPECT_EQ (2u, PacketStatistics::GetLatencyBucket (2));
+    EXPECT_EQ (2u, PacketStatistics::GetLatencyBucket (3));
+    EXPECT_EQ (3u, PacketStatistics::GetLatencyBucket (4));
+    EXPECT_EQ (10u, PacketStatistics::GetLatencyBucket (1023));
+    EXPECT_EQ (11u, PacketStatistics::GetLatencyBucket (1024));
+    EXPECT_EQ (PacketStatistics::kNumLatencyBuckets - 1, PacketStatistics::GetLatencyBucket (UINT64_MAX));
+
+    // Every latency falls in the range of its own bucket
+    for (uint64_t usec = 0; usec < 100000; usec = usec * 3 + 1)
+    {
+        uint64_t min_usec, max_usec;
+        PacketStatistics::GetLatencyBucketRange (PacketStatistics::GetLatencyBucket (usec), min_usec, max_usec);
+        EXPECT_LE (min_usec, usec);
+        EXPECT_GE (max_usec, usec);
+    }
+}
+
+TEST_F (GDBRemoteCommunicationTest, ResetClearsStatistics)
+{
+    m_comm.Record ("m1000,4", 8);
+    ASSERT_TRUE (GetPacketStatistics ("m") != nullptr);
+
+    m_comm.ResetPacketStatistics();
+    EXPECT_TRUE (GetPacketStatistics ("m") == nullptr);
+    EXPECT_EQ (0u, m_stats_sp->GetAsDictionary()->GetSize());
+}
+
+TEST_F (GDBRemoteCommunicationTest, DecodesRunLengthAndEscapes)
+{
+    std::string decoded;
+    EXPECT_TRUE (m_comm.Decode ("$m1000,4#00", decoded));
+    EXPECT_EQ ("m1000,4", decoded);
+    // "0* " repeats '0' three more times
+    EXPECT_TRUE (m_comm.Decode ("$a0* b#00", decoded));
+    EXPECT_EQ ("a0000b", decoded);
+    // "}]" is an escaped '}'
+    EXPECT_TRUE (m_comm.Decode ("$a}]b#00", decoded));
+    EXPECT_EQ ("a}b", decoded);
+}
+
+TEST_F (GDBRemoteCommunicationTest, RejectsTruncatedRunLengthAndEscapes)
+{
+    std::string decoded;
+    // An escape or run-length marker can't be the last content byte,
+    // the '#' delimiter isn't part of the content
+    EXPECT_FALSE (m_comm.Decode ("$ab}#00", decoded));
+    EXPECT_EQ ("", decoded);
+    EXPECT_FALSE (m_comm.Decode ("$ab*#00", decoded));
+    EXPECT_EQ ("", decoded);
+    // There is nothing to repeat before a leading run-length marker
+    EXPECT_FALSE (m_comm.Decode ("$* ab#00", decoded));
+    EXPECT_EQ ("", decoded);
+
+    // The rejected packets were consumed
+    EXPECT_TRUE (m_comm.Decode ("$ok#00", decoded));
+    EXPECT_EQ ("ok", decoded);
+}
@@ -0,0 +1,207 @@
+//===-- X86InstructionLengthTest.cpp ----------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdint.h>
+
+#include <initializer_list>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Plugins/UnwindAssembly/x86/X86InstructionLength.h"
+
+using namespace lldb_private;
+
+namespace
+{
+    class X86InstructionLengthTest: public ::testing::Test
+    {
+    };
+
+    // Put some trailing bytes after the instruction so we know the decoder
+    // stops where the instruction ends rather than where the bytes do.
+    size_t
+    Length64 (std::initializer_list<uint8_t> insn)
+    {
+        std::vector<uint8_t> bytes (insn);
+        bytes.resize (bytes.size() + 16, 0xcc);
+        return GetX86InstructionLength (bytes.data(), bytes.size(), true);
+    }
+
+    size_t
+    Length32 (std::initializer_list<uint8_t> insn)
+    {
+        std::vector<uint8_t> bytes (insn);
+        bytes.resize (bytes.size() + 16, 0xcc);
+        return GetX86InstructionLength (bytes.data(), bytes.size(), false);
+    }
+}
+
+TEST_F (X86InstructionLengthTest, Prologue)
+{
+    EXPECT_EQ (1u, Length64 ({ 0x55 }));                                        // push %rbp
+    EXPECT_EQ (3u, Length64 ({ 0x48, 0x89, 0xe5 }));                            // mov %rsp,%rbp
+    EXPECT_EQ (2u, Length64 ({ 0x41, 0x57 }));                                  // push %r15
+    EXPECT_EQ (4u, Length64 ({ 0x48, 0x83, 0xec, 0x10 }));                      // sub $0x10,%rsp
+    EXPECT_EQ (7u, Length64 ({ 0x48, 0x81, 0xec, 0x00, 0x01, 0x00, 0x00 }));    // sub $0x100,%rsp
+    EXPECT_EQ (4u, Length64 ({ 0xf3, 0x0f, 0x1e, 0xfa }));                      // endbr64
+    EXPECT_EQ (1u, Length64 ({ 0xc3 }));                                        // ret
+    EXPECT_EQ (3u, Length64 ({ 0xc2, 0x08, 0x00 }));                            // ret $8
+    EXPECT_EQ (4u, Length64 ({ 0xc8, 0x10, 0x00, 0x00 }));                      // enter $0x10,$0
+}
+
+TEST_F (X86InstructionLengthTest, Prefixes)
+{
+    EXPECT_EQ (2u, Length64 ({ 0x66, 0x90 }));                                  // xchg %ax,%ax
+    EXPECT_EQ (10u, Length64 ({ 0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }));
+    EXPECT_EQ (4u, Length64 ({ 0xf0, 0x0f, 0xc1, 0x08 }));                      // lock xadd %ecx,(%rax)
+    EXPECT_EQ (2u, Length64 ({ 0xf3, 0xa4 }));                                  // rep movsb
+
+    // A REX prefix followed by a legacy prefix is ignored, so REX.W doesn't
+    // widen the immediate here.
+    EXPECT_EQ (5u, Length64 ({ 0x48, 0x66, 0xb8, 0x34, 0x12 }));
+
+    // Up to 15 bytes are fine, one more prefix is not.
+    std::vector<uint8_t> nops (14, 0x66);
+    nops.push_back (0x90);
+    EXPECT_EQ (15u, GetX86InstructionLength (nops.data(), nops.size(), true));
+    nops.insert (nops.begin(), 0x66);
+    EXPECT_EQ (0u, GetX86InstructionLength (nops.data(), nops.size(), true));
+}
+
+TEST_F (X86InstructionLengthTest, ModRMAndSIB)
+{
+    EXPECT_EQ (2u, Length64 ({ 0x89, 0xc8 }));                                  // mov %ecx,%eax
+    EXPECT_EQ (2u, Length64 ({ 0x8b, 0x00 }));                                  // mov (%rax),%eax
+    EXPECT_EQ (3u, Length64 ({ 0x8b, 0x40, 0x08 }));                            // mov 0x8(%rax),%eax
+    EXPECT_EQ (6u, Length64 ({ 0x8b, 0x80, 0x00, 0x01, 0x00, 0x00 }));          // mov 0x100(%rax),%eax
+    EXPECT_EQ (7u, Length64 ({ 0x48, 0x8b, 0x05, 0x00, 0x00, 0x00, 0x00 }));    // mov 0x0(%rip),%rax
+    EXPECT_EQ (3u, Length64 ({ 0x8b, 0x04, 0x24 }));                            // mov (%rsp),%eax
+    EXPECT_EQ (4u, Length64 ({ 0x8b, 0x44, 0x24, 0x08 }));                      // mov 0x8(%rsp),%eax
+    EXPECT_EQ (7u, Length64 ({ 0x8b, 0x84, 0x24, 0x00, 0x01, 0x00, 0x00 }));    // mov 0x100(%rsp),%eax
+    EXPECT_EQ (7u, Length64 ({ 0x8b, 0x04, 0x25, 0x00, 0x10, 0x00, 0x00 }));    // mov 0x1000,%eax (SIB, no base)
+    EXPECT_EQ (4u, Length64 ({ 0x8b, 0x44, 0x8d, 0x00 }));                      // mov 0x0(%rbp,%rcx,4),%eax
+    EXPECT_EQ (5u, Length64 ({ 0x0f, 0x1f, 0x44, 0x00, 0x00 }));                // nopl 0x0(%rax,%rax,1)
+    EXPECT_EQ (8u, Length64 ({ 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }));
+}
+
+TEST_F (X86InstructionLengthTest, Immediates)
+{
+    EXPECT_EQ (5u, Length64 ({ 0xb8, 0x01, 0x00, 0x00, 0x00 }));                // mov $1,%eax
+    EXPECT_EQ (4u, Length64 ({ 0x66, 0xb8, 0x01, 0x00 }));                      // mov $1,%ax
+    EXPECT_EQ (10u, Length64 ({ 0x48, 0xb8, 1, 2, 3, 4, 5, 6, 7, 8 }));         // movabs $imm64,%rax
+    EXPECT_EQ (11u, Length64 ({ 0x66, 0x48, 0xb8, 1, 2, 3, 4, 5, 6, 7, 8 }));   // REX.W wins over 0x66
+    EXPECT_EQ (7u, Length64 ({ 0x48, 0xc7, 0xc0, 0x01, 0x00, 0x00, 0x00 }));    // mov $1,%rax (imm32)
+    EXPECT_EQ (5u, Length64 ({ 0x66, 0xc7, 0x00, 0x34, 0x12 }));                // movw $0x1234,(%rax)
+    EXPECT_EQ (8u, Length64 ({ 0xc7, 0x44, 0x24, 0x08, 0x01, 0x00, 0x00, 0x00 }));
+    EXPECT_EQ (2u, Length64 ({ 0x6a, 0x00 }));                                  // push $0
+    EXPECT_EQ (5u, Length64 ({ 0x68, 0x00, 0x10, 0x00, 0x00 }));                // push $0x1000
+    EXPECT_EQ (3u, Length64 ({ 0x6b, 0xc0, 0x0c }));                            // imul $12,%eax,%eax
+
+    // The f6/f7 group only has an immediate for test
+    EXPECT_EQ (3u, Length64 ({ 0xf6, 0xc0, 0x01 }));                            // test $1,%al
+    EXPECT_EQ (2u, Length64 ({ 0xf6, 0xd0 }));                                  // not %al
+    EXPECT_EQ (6u, Length64 ({ 0xf7, 0xc0, 0x01, 0x00, 0x00, 0x00 }));          // test $1,%eax
+    EXPECT_EQ (5u, Length64 ({ 0x66, 0xf7, 0xc0, 0x01, 0x00 }));                // test $1,%ax
+    EXPECT_EQ (2u, Length64 ({ 0xf7, 0xd8 }));                                  // neg %eax
+
+    // Memory offsets are address sized
+    EXPECT_EQ (9u, Length64 ({ 0xa1, 1, 2, 3, 4, 5, 6, 7, 8 }));                // movabs 0x...,%eax
+    EXPECT_EQ (6u, Length64 ({ 0x67, 0xa1, 1, 2, 3, 4 }));                      // addr32 mov 0x...,%eax
+}
+
+TEST_F (X86InstructionLengthTest, Branches)
+{
+    EXPECT_EQ (2u, Length64 ({ 0x74, 0x10 }));                                  // je
+    EXPECT_EQ (6u, Length64 ({ 0x0f, 0x84, 0x00, 0x01, 0x00, 0x00 }));          // je rel32
+    EXPECT_EQ (5u, Length64 ({ 0xe8, 0x00, 0x00, 0x00, 0x00 }));                // call
+    EXPECT_EQ (6u, Length64 ({ 0x66, 0xe8, 0x00, 0x00, 0x00, 0x00 }));          // rel32 even with 0x66 in 64 bit mode
+    EXPECT_EQ (2u, Length64 ({ 0xff, 0xd0 }));                                  // call *%rax
+    EXPECT_EQ (6u, Length64 ({ 0xff, 0x25, 0x00, 0x00, 0x00, 0x00 }));          // jmp *0x0(%rip)
+}
+
+TEST_F (X86InstructionLengthTest, ThreeByteOpcodes)
+{
+    EXPECT_EQ (5u, Length64 ({ 0x66, 0x0f, 0x38, 0x00, 0xc1 }));                // pshufb %xmm1,%xmm0
+    EXPECT_EQ (6u, Length64 ({ 0x66, 0x0f, 0x3a, 0x0f, 0xc1, 0x08 }));          // palignr $8,%xmm1,%xmm0
+    EXPECT_EQ (2u, Length64 ({ 0x0f, 0x05 }));                                  // syscall
+    EXPECT_EQ (5u, Length64 ({ 0x66, 0x0f, 0x70, 0xc1, 0x01 }));                // pshufd $1,%xmm1,%xmm0
+}
+
+TEST_F (X86InstructionLengthTest, VEX)
+{
+    EXPECT_EQ (3u, Length64 ({ 0xc5, 0xf8, 0x77 }));                            // vzeroupper
+    EXPECT_EQ (4u, Length64 ({ 0xc5, 0xfc, 0x28, 0xc1 }));                      // vmovaps %ymm1,%ymm0
+    EXPECT_EQ (6u, Length64 ({ 0xc5, 0xfd, 0x7f, 0x44, 0x24, 0x20 }));          // vmovdqa %ymm0,0x20(%rsp)
+    EXPECT_EQ (5u, Length64 ({ 0xc5, 0xf9, 0x70, 0xc1, 0x01 }));                // vpshufd $1,%xmm1,%xmm0
+    EXPECT_EQ (5u, Length64 ({ 0xc4, 0xe2, 0x7d, 0x18, 0xc0 }));                // vbroadcastss %xmm0,%ymm0
+    EXPECT_EQ (6u, Length64 ({ 0xc4, 0xe3, 0x7d, 0x18, 0xc1, 0x01 }));          // vinsertf128 $1,%xmm1,%ymm0,%ymm0
+    EXPECT_EQ (5u, Length64 ({ 0xc4, 0xe1, 0xf9, 0x7e, 0xc0 }));                // vmovq %xmm0,%rax
+
+    // VEX map 0 doesn't exist
+    EXPECT_EQ (0u, Length64 ({ 0xc4, 0xe0, 0x7d, 0x18, 0xc0 }));
+}
+
+TEST_F (X86InstructionLengthTest, EVEX)
+{
+    EXPECT_EQ (6u, Length64 ({ 0x62, 0xf1, 0x7c, 0x48, 0x28, 0xc1 }));          // vmovaps %zmm1,%zmm0
+    EXPECT_EQ (8u, Length64 ({ 0x62, 0xf1, 0x7c, 0x48, 0x11, 0x44, 0x24, 0x01 }));  // vmovups %zmm0,0x40(%rsp)
+    EXPECT_EQ (7u, Length64 ({ 0x62, 0xf3, 0x7d, 0x48, 0x1b, 0xc1, 0x01 }));    // vextractf32x8 $1,%zmm0,%ymm1
+}
+
+TEST_F (X86InstructionLengthTest, Unsupported)
+{
+    // AMD XOP is left to the llvm disassembler, but pop with a ModRM byte
+    // shares its opcode and must still decode.
+    EXPECT_EQ (0u, Length64 ({ 0x8f, 0xe8, 0x78, 0xc2, 0xc1, 0x03 }));
+    EXPECT_EQ (2u, Length64 ({ 0x8f, 0xc0 }));                                  // pop %rax
+
+    EXPECT_EQ (0u, Length64 ({ 0x06 }));                                        // push %es is invalid in 64 bit mode
+    EXPECT_EQ (0u, Length64 ({ 0x0f, 0x04 }));
+    EXPECT_EQ (2u, Length64 ({ 0x0f, 0x0b }));                                  // ud2
+}
+
+TEST_F (X86InstructionLengthTest, Truncated)
+{
+    const uint8_t mov[] = { 0x48, 0x89, 0xe5 };
+    EXPECT_EQ (3u, GetX86InstructionLength (mov, 3, true));
+    EXPECT_EQ (0u, GetX86InstructionLength (mov, 2, true));
+    EXPECT_EQ (0u, GetX86InstructionLength (mov, 1, true));
+    EXPECT_EQ (0u, GetX86InstructionLength (mov, 0, true));
+
+    const uint8_t call[] = { 0xe8, 0x00, 0x00, 0x00, 0x00 };
+    EXPECT_EQ (5u, GetX86InstructionLength (call, 5, true));
+    EXPECT_EQ (0u, GetX86InstructionLength (call, 4, true));
+
+    const uint8_t sib[] = { 0x8b, 0x44, 0x24, 0x08 };
+    EXPECT_EQ (0u, GetX86InstructionLength (sib, 2, true));
+    EXPECT_EQ (0u, GetX86InstructionLength (sib, 3, true));
+}
+
+TEST_F (X86InstructionLengthTest, Mode32)
+{
+    EXPECT_EQ (1u, Length32 ({ 0x40 }));                                        // inc %eax, not REX
+    EXPECT_EQ (1u, Length32 ({ 0x48 }));                                        // dec %eax
+    EXPECT_EQ (1u, Length32 ({ 0x06 }));                                        // push %es
+    EXPECT_EQ (3u, Length32 ({ 0x8b, 0x04, 0x24 }));                            // mov (%esp),%eax
+    EXPECT_EQ (5u, Length32 ({ 0xe8, 0x00, 0x00, 0x00, 0x00 }));                // call rel32
+    EXPECT_EQ (4u, Length32 ({ 0x66, 0xe8, 0x00, 0x00 }));                      // call rel16
+    EXPECT_EQ (5u, Length32 ({ 0xa1, 1, 2, 3, 4 }));                            // mov 0x...,%eax
+    EXPECT_EQ (4u, Length32 ({ 0x67, 0xa1, 1, 2 }));                            // addr16 mov 0x...,%eax
+    EXPECT_EQ (7u, Length32 ({ 0x9a, 1, 2, 3, 4, 5, 6 }));                      // lcall $seg,$off
+
+    // 16 bit addressing has no SIB byte
+    EXPECT_EQ (4u, Length32 ({ 0x67, 0x8b, 0x46, 0x08 }));                      // mov 0x8(%bp),%eax
+    EXPECT_EQ (5u, Length32 ({ 0x67, 0x8b, 0x06, 0x34, 0x12 }));                // mov 0x1234,%eax
+    EXPECT_EQ (3u, Length32 ({ 0x67, 0x8b, 0x04 }));                            // mov (%si),%eax
+
+    // c4/c5 are les/lds unless they are followed by a register ModRM form
+    EXPECT_EQ (2u, Length32 ({ 0xc4, 0x00 }));                                  // les (%eax),%eax
+    EXPECT_EQ (3u, Length32 ({ 0xc5, 0xf8, 0x77 }));                            // vzeroupper
+}
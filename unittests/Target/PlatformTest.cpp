@@ -0,0 +1,278 @@
+//===-- PlatformTest.cpp ----------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Host/FileSpec.h"
+#include "lldb/Host/FileSystem.h"
+#include "lldb/Target/Platform.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    // A remote platform whose only file is a local file standing in for
+    // the remote one.
+    class FakeRemotePlatform : public Platform
+    {
+    public:
+        FakeRemotePlatform (const FileSpec &remote_file_spec) :
+            Platform (false),
+            m_remote_file_spec (remote_file_spec),
+            m_bytes_read (0),
+            m_short_read_offset (UINT64_MAX),
+            m_fail_read_offset (UINT64_MAX),
+            m_supports_md5 (true)
+        {
+        }
+
+        using Platform::DownloadModuleSlice;
+
+        ConstString
+        GetPluginName () override
+        {
+            return ConstString ("fake-remote");
+        }
+
+        uint32_t
+        GetPluginVersion () override
+        {
+            return 1;
+        }
+
+        const char *
+        GetDescription () override
+        {
+            return "fake remote platform";
+        }
+
+        bool
+        GetSupportedArchitectureAtIndex (uint32_t idx, ArchSpec &arch) override
+        {
+            return false;
+        }
+
+        size_t
+        GetSoftwareBreakpointTrapOpcode (Target &target, BreakpointSite *bp_site) override
+        {
+            return 0;
+        }
+
+        ProcessSP
+        Attach (ProcessAttachInfo &attach_info, Debugger &debugger, Target *target, Error &error) override
+        {
+            return ProcessSP ();
+        }
+
+        void
+        CalculateTrapHandlerSymbolNames () override
+        {
+        }
+
+        user_id_t
+        OpenFile (const FileSpec &file_spec, uint32_t flags, uint32_t mode, Error &error) override
+        {
+            m_file.open (m_remote_file_spec.GetPath ().c_str (), std::ios::in | std::ios::binary);
+            if (!m_file.is_open ())
+            {
+                error.SetErrorString ("open failed");
+                return UINT64_MAX;
+            }
+            return 1;
+        }
+
+        bool
+        CloseFile (user_id_t fd, Error &error) override
+        {
+            m_file.close ();
+            return true;
+        }
+
+        user_id_t
+        GetFileSize (const FileSpec &file_spec) override
+        {
+            return m_remote_file_spec.GetByteSize ();
+        }
+
+        uint64_t
+        ReadFile (user_id_t fd, uint64_t offset, void *dst, uint64_t dst_len, Error &error) override
+        {
+            if (offset + dst_len > m_fail_read_offset)
+            {
+                error.SetErrorString ("read failed");
+                return UINT32_MAX;
+            }
+            if (offset + dst_len > m_short_read_offset)
+                dst_len = m_short_read_offset > offset ? m_short_read_offset - offset : 0;
+
+            m_file.clear ();
+            m_file.seekg (offset);
+            m_file.read ((char *)dst, dst_len);
+            m_bytes_read += m_file.gcount ();
+            return m_file.gcount ();
+        }
+
+        bool
+        CalculateMD5 (const FileSpec &file_spec, uint64_t &low, uint64_t &high) override
+        {
+            return m_supports_md5 && FileSystem::CalculateMD5 (m_remote_file_spec, low, high);
+        }
+
+        FileSpec m_remote_file_spec;
+        std::ifstream m_file;
+        uint64_t m_bytes_read;
+        uint64_t m_short_read_offset;  // Reads stop short at this offset
+        uint64_t m_fail_read_offset;   // Reads past this offset fail
+        bool m_supports_md5;
+    };
+
+    class PlatformTest : public testing::Test
+    {
+    public:
+        void
+        SetUp () override
+        {
+            llvm::SmallString<128> temp_dir;
+            ASSERT_FALSE ((bool)llvm::sys::fs::createUniqueDirectory ("PlatformTest", temp_dir));
+            m_temp_dir = temp_dir.str ().str ();
+
+            // Big enough for several of the blocks DownloadModuleSlice
+            // transfers at a time.
+            m_contents.resize (3 * 1024 * 1024 + 123);
+            for (size_t i = 0; i < m_contents.size (); ++i)
+                m_contents[i] = (char)(i * 7 + i / 4096);
+
+            m_remote_file_spec = FileSpec ((m_temp_dir + "/remote.so").c_str (), false);
+            m_download_file_spec = FileSpec ((m_temp_dir + "/remote.so.partial").c_str (), false);
+            WriteFile (m_remote_file_spec, m_contents);
+        }
+
+        void
+        TearDown () override
+        {
+            FileSystem::DeleteDirectory (m_temp_dir.c_str (), true);
+        }
+
+    protected:
+        static void
+        WriteFile (const FileSpec &file_spec, const std::string &contents)
+        {
+            std::ofstream file (file_spec.GetPath ().c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write (contents.data (), contents.size ());
+        }
+
+        static std::string
+        ReadFile (const FileSpec &file_spec)
+        {
+            std::ifstream file (file_spec.GetPath ().c_str (), std::ios::in | std::ios::binary);
+            return std::string (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+        }
+
+        std::string m_temp_dir;
+        std::string m_contents;
+        FileSpec m_remote_file_spec;
+        FileSpec m_download_file_spec;
+    };
+}
+
+TEST_F (PlatformTest, DownloadWholeFile)
+{
+    FakeRemotePlatform platform (m_remote_file_spec);
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (m_contents.size (), platform.m_bytes_read);
+    EXPECT_TRUE (m_contents == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, DownloadSlice)
+{
+    // A stale partial file is never resumed for a slice, there is no way to
+    // verify the result.
+    WriteFile (m_download_file_spec, std::string (100, 'x'));
+
+    FakeRemotePlatform platform (m_remote_file_spec);
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 4096, 1024 * 1024 + 1, m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_TRUE (m_contents.substr (4096, 1024 * 1024 + 1) == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, ResumeDownload)
+{
+    const size_t already_downloaded = 1024 * 1024 + 17;
+    WriteFile (m_download_file_spec, m_contents.substr (0, already_downloaded));
+
+    FakeRemotePlatform platform (m_remote_file_spec);
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (m_contents.size () - already_downloaded, platform.m_bytes_read);
+    EXPECT_TRUE (m_contents == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, ResumeDownloadDetectsCorruption)
+{
+    // The partial file doesn't match the remote file, which is only noticed
+    // once the whole file has been assembled.
+    WriteFile (m_download_file_spec, std::string (1000, 'x'));
+
+    FakeRemotePlatform platform (m_remote_file_spec);
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    EXPECT_TRUE (error.Fail ());
+    EXPECT_FALSE (m_download_file_spec.Exists ());
+
+    // The next attempt starts over.
+    error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_TRUE (m_contents == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, NoResumeWithoutMD5)
+{
+    WriteFile (m_download_file_spec, std::string (1000, 'x'));
+
+    FakeRemotePlatform platform (m_remote_file_spec);
+    platform.m_supports_md5 = false;
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (m_contents.size (), platform.m_bytes_read);
+    EXPECT_TRUE (m_contents == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, ShortReadFails)
+{
+    FakeRemotePlatform platform (m_remote_file_spec);
+    platform.m_short_read_offset = 1024 * 1024 + 5;
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    EXPECT_TRUE (error.Fail ());
+
+    // The complete blocks are kept so the download can be resumed.
+    EXPECT_EQ (1024 * 1024u, m_download_file_spec.GetByteSize ());
+
+    platform.m_short_read_offset = UINT64_MAX;
+    platform.m_bytes_read = 0;
+    error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    ASSERT_TRUE (error.Success ()) << error.AsCString ();
+    EXPECT_EQ (m_contents.size () - 1024 * 1024, platform.m_bytes_read);
+    EXPECT_TRUE (m_contents == ReadFile (m_download_file_spec));
+}
+
+TEST_F (PlatformTest, ReadErrorFails)
+{
+    FakeRemotePlatform platform (m_remote_file_spec);
+    platform.m_fail_read_offset = 2 * 1024 * 1024;
+    Error error = platform.DownloadModuleSlice (m_remote_file_spec, 0, m_contents.size (), m_download_file_spec);
+    EXPECT_TRUE (error.Fail ());
+    EXPECT_EQ (2 * 1024 * 1024u, m_download_file_spec.GetByteSize ());
+}
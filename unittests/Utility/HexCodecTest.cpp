@@ -0,0 +1,181 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Utility/HexCodec.h"
+
+using namespace lldb_private;
+
+namespace
+{
+    class HexCodecTest: public ::testing::Test
+    {
+    };
+
+    // Lengths around the 16 byte blocks the vectorized code handles
+    const size_t kTestLengths[] = { 0, 1, 2, 15, 16, 17, 31, 32, 33, 63, 64, 65, 257 };
+
+    std::vector<uint8_t>
+    MakeBytes (size_t length)
+    {
+        std::vector<uint8_t> bytes (length);
+        for (size_t i = 0; i < length; ++i)
+            bytes[i] = (uint8_t)(i * 37 + 11);
+        return bytes;
+    }
+
+    std::string
+    ReferenceHex (const std::vector<uint8_t> &bytes)
+    {
+        std::string hex;
+        char buf[3];
+        for (uint8_t byte : bytes)
+        {
+            snprintf (buf, sizeof(buf), "%2.2x", byte);
+            hex += buf;
+        }
+        return hex;
+    }
+}
+
+TEST_F (HexCodecTest, EncodeAllByteValues)
+{
+    std::vector<uint8_t> bytes (256);
+    for (size_t i = 0; i < bytes.size(); ++i)
+        bytes[i] = (uint8_t)i;
+
+    std::string hex (2 * bytes.size(), '\0');
+    ASSERT_EQ (hex.size(), EncodeHexBytes (bytes.data(), bytes.size(), &hex[0]));
+    EXPECT_EQ (ReferenceHex (bytes), hex);
+}
+
+TEST_F (HexCodecTest, EncodeLengths)
+{
+    for (size_t length : kTestLengths)
+    {
+        std::vector<uint8_t> bytes = MakeBytes (length);
+        std::string hex (2 * length, '\0');
+        ASSERT_EQ (2 * length, EncodeHexBytes (bytes.data(), length, &hex[0]));
+        EXPECT_EQ (ReferenceHex (bytes), hex) << "length " << length;
+    }
+}
+
+TEST_F (HexCodecTest, DecodeRoundTrip)
+{
+    for (size_t length : kTestLengths)
+    {
+        std::vector<uint8_t> bytes = MakeBytes (length);
+        std::string hex = ReferenceHex (bytes);
+        std::vector<uint8_t> decoded (length);
+        ASSERT_EQ (length, DecodeHexBytes (hex.data(), hex.size(), decoded.data(), decoded.size())) << "length " << length;
+        EXPECT_EQ (bytes, decoded) << "length " << length;
+    }
+}
+
+TEST_F (HexCodecTest, DecodeMixedCase)
+{
+    const char kHex[] = "0123456789ABCDEFabcdefAbCdEf0123456789aBcDeF";
+    uint8_t dst[22];
+    ASSERT_EQ (sizeof(dst), DecodeHexBytes (kHex, strlen (kHex), dst, sizeof(dst)));
+    EXPECT_EQ (0x01, dst[0]);
+    EXPECT_EQ (0xab, dst[5]);
+    EXPECT_EQ (0xef, dst[10]);
+    EXPECT_EQ (0xcd, dst[12]);
+    EXPECT_EQ (0xef, dst[21]);
+}
+
+TEST_F (HexCodecTest, DecodeStopsAtInvalidPair)
+{
+    // Put an invalid character at every position of a 64 character
+    // string, both in and out of the vectorized blocks
+    const char kInvalid[] = { 'g', 'G', 'x', '/', ':', '@', '`', ' ', '\0', '\x80', '\xff' };
+    for (char invalid : kInvalid)
+    {
+        for (size_t pos = 0; pos < 64; ++pos)
+        {
+            std::string hex (64, 'a');
+            hex[pos] = invalid;
+            uint8_t dst[32];
+            memset (dst, 0, sizeof(dst));
+            const size_t expected = pos / 2;
+            ASSERT_EQ (expected, DecodeHexBytes (hex.data(), hex.size(), dst, sizeof(dst))) << "pos " << pos;
+            for (size_t i = 0; i < expected; ++i)
+                ASSERT_EQ (0xaa, dst[i]);
+            for (size_t i = expected; i < sizeof(dst); ++i)
+                ASSERT_EQ (0, dst[i]);
+        }
+    }
+}
+
+TEST_F (HexCodecTest, DecodeLimits)
+{
+    std::string hex = ReferenceHex (MakeBytes (40));
+
+    // Limited by the destination, which must not be overrun
+    uint8_t dst[41];
+    memset (dst, 0xee, sizeof(dst));
+    ASSERT_EQ (20u, DecodeHexBytes (hex.data(), hex.size(), dst, 20));
+    EXPECT_EQ (0xee, dst[20]);
+
+    // Limited by the source, with an odd character left over
+    ASSERT_EQ (17u, DecodeHexBytes (hex.data(), 35, dst, sizeof(dst)));
+    ASSERT_EQ (0u, DecodeHexBytes (hex.data(), 1, dst, sizeof(dst)));
+    ASSERT_EQ (0u, DecodeHexBytes (hex.data(), 0, dst, sizeof(dst)));
+}
+
+TEST_F (HexCodecTest, FindGDBRemoteEscapeChar)
+{
+    const char kSpecial[] = { '#', '$', '}', '*' };
+    for (char special : kSpecial)
+    {
+        for (size_t pos = 0; pos < 40; ++pos)
+        {
+            std::string data (40, 'a');
+            data[pos] = special;
+            EXPECT_EQ (pos, FindGDBRemoteEscapeChar (data.data(), data.size()));
+        }
+    }
+    std::string plain (100, '\x7c');
+    EXPECT_EQ (plain.size(), FindGDBRemoteEscapeChar (plain.data(), plain.size()));
+    EXPECT_EQ (0u, FindGDBRemoteEscapeChar (plain.data(), 0));
+}
+
+TEST_F (HexCodecTest, FindGDBRemoteDecodeChar)
+{
+    std::string data (40, 'a');
+    data[10] = '#';
+    data[20] = '$';
+    data[30] = '*';
+    EXPECT_EQ (30u, FindGDBRemoteDecodeChar (data.data(), data.size()));
+    data[25] = '}';
+    EXPECT_EQ (25u, FindGDBRemoteDecodeChar (data.data(), data.size()));
+    EXPECT_EQ (25u, FindGDBRemoteDecodeChar (data.data(), 26));
+    EXPECT_EQ (24u, FindGDBRemoteDecodeChar (data.data(), 24));
+}
+
+// Throughput benchmark, run with --gtest_also_run_disabled_tests
+TEST_F (HexCodecTest, DISABLED_Throughput)
+{
+    const size_t kSize = 64 * 1024 * 1024;
+    std::vector<uint8_t> bytes = MakeBytes (kSize);
+    std::string hex (2 * kSize, '\0');
+
+    auto start = std::chrono::steady_clock::now();
+    EncodeHexBytes (bytes.data(), bytes.size(), &hex[0]);
+    auto encode_end = std::chrono::steady_clock::now();
+    ASSERT_EQ (kSize, DecodeHexBytes (hex.data(), hex.size(), bytes.data(), bytes.size()));
+    auto decode_end = std::chrono::steady_clock::now();
+    ASSERT_EQ (kSize, FindGDBRemoteEscapeChar (hex.data(), hex.size() / 2));
+    auto find_end = std::chrono::steady_clock::now();
+
+    const double mb = kSize / (1024.0 * 1024.0);
+    printf ("encode: %.1f MB/s\n", mb / std::chrono::duration<double>(encode_end - start).count());
+    printf ("decode: %.1f MB/s\n", mb / std::chrono::duration<double>(decode_end - encode_end).count());
+    printf ("escape scan: %.1f MB/s\n", mb / std::chrono::duration<double>(find_end - decode_end).count());
+}
@@ -0,0 +1,242 @@
+//===-- ModuleCacheTest.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleSpec.h"
+#include "lldb/Core/UUID.h"
+#include "lldb/Host/FileSpec.h"
+#include "lldb/Host/FileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "Utility/ModuleCache.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+namespace
+{
+    const char *kHostname = "host";
+    const uint64_t kModuleSize = 1000;
+
+    class ModuleCacheTest : public testing::Test
+    {
+    public:
+        void
+        SetUp () override
+        {
+            llvm::SmallString<128> temp_dir;
+            ASSERT_FALSE ((bool)llvm::sys::fs::createUniqueDirectory ("ModuleCacheTest", temp_dir));
+            m_temp_dir = temp_dir.str ().str ();
+            m_root_dir_spec = FileSpec ((m_temp_dir + "/cache").c_str (), false);
+        }
+
+        void
+        TearDown () override
+        {
+            FileSystem::DeleteDirectory (m_temp_dir.c_str (), true);
+        }
+
+    protected:
+        ModuleSpec
+        GetModuleSpec (uint8_t id)
+        {
+            uint8_t uuid_bytes[16];
+            memset (uuid_bytes, id, sizeof(uuid_bytes));
+            std::string remote_path ("/lib/libtest");
+            remote_path += std::to_string (id) + ".so";
+
+            ModuleSpec module_spec (FileSpec (remote_path.c_str (), false));
+            module_spec.GetUUID ().SetBytes (uuid_bytes);
+            return module_spec;
+        }
+
+        FileSpec
+        GetModuleDirectory (uint8_t id)
+        {
+            std::string path = m_root_dir_spec.GetPath () + "/.cache/";
+            path += GetModuleSpec (id).GetUUID ().GetAsString ();
+            return FileSpec (path.c_str (), false);
+        }
+
+        FileSpec
+        GetLockFile (uint8_t id)
+        {
+            std::string path = m_root_dir_spec.GetPath () + "/.lock/";
+            path += GetModuleSpec (id).GetUUID ().GetAsString ();
+            return FileSpec (path.c_str (), false);
+        }
+
+        // Put module id into the cache and make it look like it was last
+        // used at last_used seconds since the epoch.
+        void
+        PutModule (uint8_t id, time_t last_used)
+        {
+            const FileSpec download_spec ((m_temp_dir + "/download").c_str (), false);
+            {
+                std::ofstream download (download_spec.GetPath ().c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+                download << std::string (kModuleSize, (char)id);
+            }
+            Error error = m_cache.Put (m_root_dir_spec, kHostname, GetModuleSpec (id), download_spec);
+            ASSERT_TRUE (error.Success ()) << error.AsCString ();
+            SetLastUsed (id, last_used);
+        }
+
+        void
+        SetLastUsed (uint8_t id, time_t last_used)
+        {
+            struct utimbuf times;
+            times.actime = last_used;
+            times.modtime = last_used;
+            const std::string stamp_path = GetModuleDirectory (id).GetPath () + "/.stamp";
+            ASSERT_EQ (0, ::utime (stamp_path.c_str (), &times));
+        }
+
+        std::string m_temp_dir;
+        FileSpec m_root_dir_spec;
+        ModuleCache m_cache;
+    };
+}
+
+TEST_F (ModuleCacheTest, TrimBelowLimitKeepsEverything)
+{
+    PutModule (1, 1000);
+    PutModule (2, 2000);
+
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, 10 * kModuleSize).Success ());
+    EXPECT_TRUE (GetModuleDirectory (1).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (2).Exists ());
+    EXPECT_EQ (0u, m_cache.GetStatistics ().evictions);
+}
+
+TEST_F (ModuleCacheTest, TrimEvictsLeastRecentlyUsed)
+{
+    PutModule (1, 3000);
+    PutModule (2, 1000);
+    PutModule (3, 4000);
+    PutModule (4, 2000);
+
+    // Room for two modules
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, 2 * kModuleSize + 100).Success ());
+    EXPECT_TRUE (GetModuleDirectory (1).Exists ());
+    EXPECT_FALSE (GetModuleDirectory (2).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (3).Exists ());
+    EXPECT_FALSE (GetModuleDirectory (4).Exists ());
+    EXPECT_EQ (2u, m_cache.GetStatistics ().evictions);
+
+    // Lock files outlive the modules they protect.
+    EXPECT_TRUE (GetLockFile (2).Exists ());
+    EXPECT_TRUE (GetLockFile (4).Exists ());
+}
+
+TEST_F (ModuleCacheTest, TrimSkipsLockedModules)
+{
+    PutModule (1, 1000);
+    PutModule (2, 2000);
+    PutModule (3, 3000);
+
+    // Another process holds module 1, e.g. while it opens it.
+    const int fd = ::open (GetLockFile (1).GetPath ().c_str (), O_RDWR);
+    ASSERT_NE (-1, fd);
+    ASSERT_EQ (0, ::flock (fd, LOCK_SH));
+
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, 2 * kModuleSize + 100).Success ());
+    EXPECT_TRUE (GetModuleDirectory (1).Exists ());
+    EXPECT_FALSE (GetModuleDirectory (2).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (3).Exists ());
+
+    ::close (fd);
+
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, kModuleSize + 100).Success ());
+    EXPECT_FALSE (GetModuleDirectory (1).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (3).Exists ());
+}
+
+TEST_F (ModuleCacheTest, TrimSkipsLoadedModules)
+{
+    PutModule (1, 1000);
+    PutModule (2, 2000);
+    PutModule (3, 3000);
+
+    ModuleSP module_sp;
+    ASSERT_TRUE (m_cache.Get (m_root_dir_spec, kHostname, GetModuleSpec (1), module_sp, nullptr).Success ());
+    ASSERT_TRUE (module_sp.get () != nullptr);
+
+    // Get refreshed the stamp, make module 1 the oldest again.
+    SetLastUsed (1, 500);
+
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, 2 * kModuleSize + 100).Success ());
+    EXPECT_TRUE (GetModuleDirectory (1).Exists ());
+    EXPECT_FALSE (GetModuleDirectory (2).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (3).Exists ());
+
+    // Once nothing uses module 1 it can go.
+    module_sp.reset ();
+    ASSERT_TRUE (m_cache.Trim (m_root_dir_spec, kModuleSize + 100).Success ());
+    EXPECT_FALSE (GetModuleDirectory (1).Exists ());
+    EXPECT_TRUE (GetModuleDirectory (3).Exists ());
+}
+
+TEST_F (ModuleCacheTest, GetAndPutDownloadsOnce)
+{
+    int download_count = 0;
+    auto downloader = [&download_count] (const ModuleSpec &module_spec, const FileSpec &download_spec)
+    {
+        ++download_count;
+        std::ofstream download (download_spec.GetPath ().c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+        download << std::string (kModuleSize, 'x');
+        return Error ();
+    };
+
+    ModuleSP module_sp;
+    ASSERT_TRUE (m_cache.GetAndPut (m_root_dir_spec, kHostname, GetModuleSpec (1), downloader, module_sp, nullptr).Success ());
+    ASSERT_TRUE (module_sp.get () != nullptr);
+    module_sp.reset ();
+
+    ModuleCache other_process_cache;
+    ASSERT_TRUE (other_process_cache.GetAndPut (m_root_dir_spec, kHostname, GetModuleSpec (1), downloader, module_sp, nullptr).Success ());
+    EXPECT_EQ (1, download_count);
+
+    // The download file was moved into place.
+    const std::string partial_path = GetModuleDirectory (1).GetPath () + "/libtest1.so.partial";
+    EXPECT_FALSE (FileSpec (partial_path.c_str (), false).Exists ());
+}
+
+TEST_F (ModuleCacheTest, GetAndPutKeepsFailedDownload)
+{
+    auto failing_downloader = [] (const ModuleSpec &module_spec, const FileSpec &download_spec)
+    {
+        std::ofstream download (download_spec.GetPath ().c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+        download << std::string (kModuleSize / 2, 'x');
+        return Error ("connection lost");
+    };
+
+    ModuleSP module_sp;
+    EXPECT_TRUE (m_cache.GetAndPut (m_root_dir_spec, kHostname, GetModuleSpec (1), failing_downloader, module_sp, nullptr).Fail ());
+    EXPECT_TRUE (module_sp.get () == nullptr);
+
+    // The partial download is left for the next attempt to resume.
+    const std::string partial_path = GetModuleDirectory (1).GetPath () + "/libtest1.so.partial";
+    EXPECT_EQ (kModuleSize / 2, FileSpec (partial_path.c_str (), false).GetByteSize ());
+}
+
+#endif